@@ -25,9 +25,12 @@
 
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/read_replica.hpp>
 
 #include "database_api_helper.hxx"
 
+#include <graphene/account_history/account_history_plugin.hpp>
+
 #include <fc/crypto/base64.hpp>
 #include <fc/rpc/api_connection.hpp>
 #include <fc/thread/future.hpp>
@@ -279,12 +282,29 @@ namespace graphene { namespace app {
        FC_ASSERT( is_allowed, "Access denied" );
        if( !_database_api )
        {
-          _database_api = std::make_shared< database_api >( std::ref( *_app.chain_database() ),
-                                                            &( _app.get_options() ) );
+          _database_api_object = std::make_shared< database_api >( std::ref( *_app.chain_database() ),
+                                                                   &( _app.get_options() ),
+                                                                   _app.read_replicas() );
+          if( _batch_depth > 0 )
+             _database_api_object->begin_batch();
+          _database_api = _database_api_object;
        }
        return *_database_api;
     }
 
+    void login_api::begin_batch()
+    {
+       // only the outermost batch is passed on, also to a database API which is created during the batch
+       if( 0 == _batch_depth++ && _database_api_object )
+          _database_api_object->begin_batch();
+    }
+
+    void login_api::end_batch()
+    {
+       if( _batch_depth > 0 && 0 == --_batch_depth && _database_api_object )
+          _database_api_object->end_batch();
+    }
+
     fc::api<history_api> login_api::history()
     {
        bool is_allowed = ( _allowed_apis.find("history_api") != _allowed_apis.end() );
@@ -371,34 +391,45 @@ namespace graphene { namespace app {
     { // Nothing else to do
     }
 
+    template<typename Fn>
+    auto history_api::run_read_only( Fn&& f )const -> decltype( f( std::declval<graphene::chain::database&>() ) )
+    {
+       FC_ASSERT( _app.chain_database(), "database unavailable" );
+       const auto replicas = _app.read_replicas();
+       if( replicas )
+          return replicas->run_with_database( std::forward<Fn>( f ) );
+       return f( *_app.chain_database() );
+    }
+
     vector<order_history_object> history_api::get_fill_order_history( const std::string& asset_a,
                                                                       const std::string& asset_b,
                                                                       uint32_t limit )const
     {
        auto market_hist_plugin = _app.get_plugin<market_history_plugin>( "market_history" );
        FC_ASSERT( market_hist_plugin, "Market history plugin is not enabled" );
-       FC_ASSERT(_app.chain_database());
-       const auto& db = *_app.chain_database();
-       database_api_helper db_api_helper( _app );
-       asset_id_type a = db_api_helper.get_asset_from_string( asset_a )->get_id();
-       asset_id_type b = db_api_helper.get_asset_from_string( asset_b )->get_id();
-       if( a > b ) std::swap(a,b);
-       const auto& history_idx = db.get_index_type<graphene::market_history::history_index>().indices().get<by_key>();
-       history_key hkey;
-       hkey.base = a;
-       hkey.quote = b;
-       hkey.sequence = std::numeric_limits<int64_t>::min();
-
-       auto itr = history_idx.lower_bound( hkey );
-       vector<order_history_object> result;
-       while( itr != history_idx.end() && result.size() < limit )
-       {
-          if( itr->key.base != a || itr->key.quote != b ) break;
-          result.push_back( *itr );
-          ++itr;
-       }
+       return run_read_only( [&]( graphene::chain::database& db ) {
+          database_api_helper db_api_helper( db, &_app.get_options() );
+          asset_id_type a = db_api_helper.get_asset_from_string( asset_a )->get_id();
+          asset_id_type b = db_api_helper.get_asset_from_string( asset_b )->get_id();
+          if( a > b ) std::swap(a,b);
+          const auto& history_idx = db.get_index_type<graphene::market_history::history_index>()
+                                      .indices().get<by_key>();
+          history_key hkey;
+          hkey.base = a;
+          hkey.quote = b;
+          hkey.sequence = std::numeric_limits<int64_t>::min();
+
+          auto itr = history_idx.lower_bound( hkey );
+          vector<order_history_object> result;
+          while( itr != history_idx.end() && result.size() < limit )
+          {
+             if( itr->key.base != a || itr->key.quote != b ) break;
+             result.push_back( *itr );
+             ++itr;
+          }
 
-       return result;
+          return result;
+       });
     }
 
     vector<operation_history_object> history_api::get_account_history( const std::string& account_id_or_name,
@@ -407,29 +438,27 @@ namespace graphene { namespace app {
                                                                        operation_history_id_type start ) const
     {
        FC_ASSERT( _app.chain_database(), "database unavailable" );
-       const auto& db = *_app.chain_database();
 
        const auto configured_limit = _app.get_options().api_limit_get_account_history;
        FC_ASSERT( limit <= configured_limit,
                   "limit can not be greater than ${configured_limit}",
                   ("configured_limit", configured_limit) );
 
-       vector<operation_history_object> result;
        if( start == operation_history_id_type() )
           // Note: this means we can hardly use ID 0 as start to query for exactly the object with ID 0
           start = operation_history_id_type::max();
        if( start < stop )
-          return result;
-
-       account_id_type account;
-       try {
-          database_api_helper db_api_helper( _app );
-          account = db_api_helper.get_account_from_string(account_id_or_name)->get_id();
-       } catch(...) { return result; }
+          return vector<operation_history_object>();
 
        if(_app.is_plugin_enabled("elasticsearch")) {
           auto es = _app.get_plugin<elasticsearch::elasticsearch_plugin>("elasticsearch");
           if(es.get()->get_running_mode() != elasticsearch::mode::only_save) {
+             account_id_type account;
+             try {
+                database_api_helper db_api_helper( _app );
+                account = db_api_helper.get_account_from_string(account_id_or_name)->get_id();
+             } catch(...) { return vector<operation_history_object>(); }
+
              if(!_app.elasticsearch_thread)
                 _app.elasticsearch_thread= std::make_shared<fc::thread>("elasticsearch");
 
@@ -439,24 +468,33 @@ namespace graphene { namespace app {
           }
        }
 
-       const auto& by_op_idx = db.get_index_type<account_history_index>().indices().get<by_op>();
-       auto itr = by_op_idx.lower_bound( boost::make_tuple( account, start ) );
-       auto itr_end = by_op_idx.lower_bound( boost::make_tuple( account, stop ) );
+       return run_read_only( [&]( graphene::chain::database& db ) {
+          vector<operation_history_object> result;
+          account_id_type account;
+          try {
+             database_api_helper db_api_helper( db, &_app.get_options() );
+             account = db_api_helper.get_account_from_string(account_id_or_name)->get_id();
+          } catch(...) { return result; }
 
-       while( itr != itr_end && result.size() < limit )
-       {
-          result.emplace_back( itr->operation_id(db) );
-          ++itr;
-       }
-       // Deal with a special case : include the object with ID 0 when it fits
-       if( 0 == stop.instance.value && result.size() < limit && itr != by_op_idx.end() )
-       {
-          const auto& obj = *itr;
-          if( obj.account == account )
-             result.emplace_back( obj.operation_id(db) );
-       }
+          const auto& by_op_idx = db.get_index_type<account_history_index>().indices().get<by_op>();
+          auto itr = by_op_idx.lower_bound( boost::make_tuple( account, start ) );
+          auto itr_end = by_op_idx.lower_bound( boost::make_tuple( account, stop ) );
 
-       return result;
+          while( itr != itr_end && result.size() < limit )
+          {
+             result.emplace_back( itr->operation_id(db) );
+             ++itr;
+          }
+          // Deal with a special case : include the object with ID 0 when it fits
+          if( 0 == stop.instance.value && result.size() < limit && itr != by_op_idx.end() )
+          {
+             const auto& obj = *itr;
+             if( obj.account == account )
+                result.emplace_back( obj.operation_id(db) );
+          }
+
+          return result;
+       });
     }
 
     vector<operation_history_object> history_api::get_account_history_by_time(
@@ -464,40 +502,55 @@ namespace graphene { namespace app {
             const optional<uint32_t>& olimit,
             const optional<fc::time_point_sec>& ostart ) const
     {
-       FC_ASSERT( _app.chain_database(), "database unavailable" );
-       const auto& db = *_app.chain_database();
-
        const auto configured_limit = _app.get_options().api_limit_get_account_history;
        uint32_t limit = olimit.valid() ? *olimit : configured_limit;
        FC_ASSERT( limit <= configured_limit,
                   "limit can not be greater than ${configured_limit}",
                   ("configured_limit", configured_limit) );
 
-       vector<operation_history_object> result;
-       account_id_type account;
-       try {
-          database_api_helper db_api_helper( _app );
-          account = db_api_helper.get_account_from_string(account_name_or_id)->get_id();
-       } catch( const fc::exception& ) { return result; }
-
        fc::time_point_sec start = ostart.valid() ? *ostart : fc::time_point_sec::maximum();
 
-       const auto& op_hist_idx = db.get_index_type<operation_history_index>().indices().get<by_time>();
-       auto op_hist_itr = op_hist_idx.lower_bound( start );
-       if( op_hist_itr == op_hist_idx.end() )
-          return result;
+       return run_read_only( [&]( graphene::chain::database& db ) {
+          vector<operation_history_object> result;
+          account_id_type account;
+          try {
+             database_api_helper db_api_helper( db, &_app.get_options() );
+             account = db_api_helper.get_account_from_string(account_name_or_id)->get_id();
+          } catch( const fc::exception& ) { return result; }
+
+          const auto& op_hist_idx = db.get_index_type<operation_history_index>().indices().get<by_time>();
+          auto op_hist_itr = op_hist_idx.lower_bound( start );
+          if( op_hist_itr == op_hist_idx.end() )
+             return result;
 
-       const auto& acc_hist_idx = db.get_index_type<account_history_index>().indices().get<by_op>();
-       auto itr = acc_hist_idx.lower_bound( boost::make_tuple( account, op_hist_itr->get_id() ) );
-       auto itr_end = acc_hist_idx.upper_bound( account );
+          const auto& acc_hist_idx = db.get_index_type<account_history_index>().indices().get<by_op>();
+          auto itr = acc_hist_idx.lower_bound( boost::make_tuple( account, op_hist_itr->get_id() ) );
+          auto itr_end = acc_hist_idx.upper_bound( account );
 
-       while( itr != itr_end && result.size() < limit )
+          while( itr != itr_end && result.size() < limit )
+          {
+             result.emplace_back( itr->operation_id(db) );
+             ++itr;
+          }
+
+          return result;
+       });
+    }
+
+    /// @return the index of the account histories by operation type, if the account_history plugin keeps one
+    static const graphene::account_history::account_history_by_type_index* get_history_by_type_index(
+          const graphene::chain::database& db )
+    {
+       try
        {
-          result.emplace_back( itr->operation_id(db) );
-          ++itr;
+          const auto& by_type_idx = db.get_index_type< primary_index< account_history_index > >()
+                .get_secondary_index< graphene::account_history::account_history_by_type_index >();
+          return by_type_idx.is_ready() ? &by_type_idx : nullptr;
+       }
+       catch( const fc::exception& )
+       {
+          return nullptr;
        }
-
-       return result;
     }
 
     vector<operation_history_object> history_api::get_account_history_operations(
@@ -507,43 +560,72 @@ namespace graphene { namespace app {
           operation_history_id_type stop,
           uint32_t limit ) const
     {
-       FC_ASSERT( _app.chain_database(), "database unavailable" );
-       const auto& db = *_app.chain_database();
-
        const auto configured_limit = _app.get_options().api_limit_get_account_history_operations;
        FC_ASSERT( limit <= configured_limit,
                   "limit can not be greater than ${configured_limit}",
                   ("configured_limit", configured_limit) );
 
-       vector<operation_history_object> result;
-       account_id_type account;
-       try {
-          database_api_helper db_api_helper( _app );
-          account = db_api_helper.get_account_from_string(account_id_or_name)->get_id();
-       } catch(...) { return result; }
-       const auto& stats = account(db).statistics(db);
-       if( stats.most_recent_op == account_history_id_type() ) return result;
-       const account_history_object* node = &stats.most_recent_op(db);
-       if( start == operation_history_id_type() )
-          start = node->operation_id;
+       return run_read_only( [&]( graphene::chain::database& db ) {
+          vector<operation_history_object> result;
+          account_id_type account;
+          try {
+             database_api_helper db_api_helper( db, &_app.get_options() );
+             account = db_api_helper.get_account_from_string(account_id_or_name)->get_id();
+          } catch(...) { return result; }
+          const auto& stats = account(db).statistics(db);
+          if( stats.most_recent_op == account_history_id_type() ) return result;
+
+          const auto* by_type_idx = get_history_by_type_index( db );
+          if( by_type_idx != nullptr )
+          {
+             if( operation_type < 0 || operation_type >= operation::count()
+                   || by_type_idx->count( account, static_cast<uint16_t>( operation_type ) ) == 0 )
+                return result;
+             // translate the operation IDs into the sequence numbers of the account
+             const auto& by_op_idx = db.get_index_type<account_history_index>().indices().get<by_op>();
+             uint64_t max_sequence = stats.total_ops;
+             if( start != operation_history_id_type() )
+             {
+                auto itr = by_op_idx.lower_bound( boost::make_tuple( account, start ) );
+                if( itr == by_op_idx.end() || itr->account != account )
+                   return result;
+                max_sequence = itr->sequence;
+             }
+             uint64_t min_sequence = 0;
+             if( stop.instance.value != 0 )
+             {
+                auto itr = by_op_idx.lower_bound( boost::make_tuple( account, stop ) );
+                if( itr != by_op_idx.end() && itr->account == account )
+                   min_sequence = itr->sequence + 1;
+             }
+             for( const auto& e : by_type_idx->get_entries( account, static_cast<uint16_t>( operation_type ),
+                                                            max_sequence, min_sequence, limit ) )
+                result.push_back( e.operation_id(db) );
+             return result;
+          }
 
-       while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
-       {
-          if( node->operation_id.instance.value <= start.instance.value ) {
+          const account_history_object* node = &stats.most_recent_op(db);
+          if( start == operation_history_id_type() )
+             start = node->operation_id;
+
+          while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
+          {
+             if( node->operation_id.instance.value <= start.instance.value ) {
 
-             if(node->operation_id(db).op.which() == operation_type)
-               result.push_back( node->operation_id(db) );
+                if(node->operation_id(db).op.which() == operation_type)
+                  result.push_back( node->operation_id(db) );
+             }
+             if( node->next == account_history_id_type() )
+                node = nullptr;
+             else node = &node->next(db);
           }
-          if( node->next == account_history_id_type() )
-             node = nullptr;
-          else node = &node->next(db);
-       }
-       if( stop.instance.value == 0 && result.size() < limit ) {
-          const auto* head = db.find(account_history_id_type());
-          if (head != nullptr && head->account == account && head->operation_id(db).op.which() == operation_type)
-            result.push_back(head->operation_id(db));
-       }
-       return result;
+          if( stop.instance.value == 0 && result.size() < limit ) {
+             const auto* head = db.find(account_history_id_type());
+             if (head != nullptr && head->account == account && head->operation_id(db).op.which() == operation_type)
+               result.push_back(head->operation_id(db));
+          }
+          return result;
+       });
     }
 
 
@@ -552,18 +634,27 @@ namespace graphene { namespace app {
                                                                                 uint32_t limit,
                                                                                 uint64_t start ) const
     {
-       FC_ASSERT( _app.chain_database(), "database unavailable" );
-       const auto& db = *_app.chain_database();
-
        const auto configured_limit = _app.get_options().api_limit_get_relative_account_history;
        FC_ASSERT( limit <= configured_limit,
                   "limit can not be greater than ${configured_limit}",
                   ("configured_limit", configured_limit) );
 
+       return run_read_only( [&]( graphene::chain::database& db ) {
+          return relative_account_history( db, account_id_or_name, stop, limit, start );
+       });
+    }
+
+    vector<operation_history_object> history_api::relative_account_history(
+          graphene::chain::database& db,
+          const std::string& account_id_or_name,
+          uint64_t stop,
+          uint32_t limit,
+          uint64_t start ) const
+    {
        vector<operation_history_object> result;
        account_id_type account;
        try {
-          database_api_helper db_api_helper( _app );
+          database_api_helper db_api_helper( db, &_app.get_options() );
           account = db_api_helper.get_account_from_string(account_id_or_name)->get_id();
        } catch(...) { return result; }
        const auto& stats = account(db).statistics(db);
@@ -594,33 +685,33 @@ namespace graphene { namespace app {
           uint32_t block_num,
           const optional<uint16_t>& trx_in_block ) const
     {
-       FC_ASSERT( _app.chain_database(), "database unavailable" );
-       const auto& db = *_app.chain_database();
-       const auto& idx = db.get_index_type<operation_history_index>().indices().get<by_block>();
-       auto range = trx_in_block.valid() ? idx.equal_range( boost::make_tuple( block_num, *trx_in_block  ) )
-                                         : idx.equal_range( block_num );
-       vector<operation_history_object> result;
-       std::copy( range.first, range.second, std::back_inserter( result ) );
-       return result;
+       return run_read_only( [&]( graphene::chain::database& db ) {
+          const auto& idx = db.get_index_type<operation_history_index>().indices().get<by_block>();
+          auto range = trx_in_block.valid() ? idx.equal_range( boost::make_tuple( block_num, *trx_in_block  ) )
+                                            : idx.equal_range( block_num );
+          vector<operation_history_object> result;
+          std::copy( range.first, range.second, std::back_inserter( result ) );
+          return result;
+       });
     }
 
     vector<operation_history_object> history_api::get_block_operations_by_time(
           const optional<fc::time_point_sec>& start ) const
     {
-       FC_ASSERT( _app.chain_database(), "database unavailable" );
-       const auto& db = *_app.chain_database();
-       const auto& idx = db.get_index_type<operation_history_index>().indices().get<by_time>();
-       auto itr = start.valid() ? idx.lower_bound( *start ) : idx.begin();
+       return run_read_only( [&]( graphene::chain::database& db ) {
+          const auto& idx = db.get_index_type<operation_history_index>().indices().get<by_time>();
+          auto itr = start.valid() ? idx.lower_bound( *start ) : idx.begin();
 
-       vector<operation_history_object> result;
-       if( itr == idx.end() )
-          return result;
+          vector<operation_history_object> result;
+          if( itr == idx.end() )
+             return result;
 
-       auto itr_end = idx.upper_bound( itr->block_time );
+          auto itr_end = idx.upper_bound( itr->block_time );
 
-       std::copy( itr, itr_end, std::back_inserter( result ) );
+          std::copy( itr, itr_end, std::back_inserter( result ) );
 
-       return result;
+          return result;
+       });
     }
 
     flat_set<uint32_t> history_api::get_market_history_buckets()const
@@ -640,24 +731,65 @@ namespace graphene { namespace app {
                   "limit can not be greater than ${configured_limit}",
                   ("configured_limit", configured_limit) );
 
-       history_operation_detail result;
-       vector<operation_history_object> objs = get_relative_account_history( account_id_or_name, start, limit,
-                                                                             limit + start - 1 );
-       result.total_count = objs.size();
+       return run_read_only( [&]( graphene::chain::database& db ) {
+          history_operation_detail result;
+          const auto* by_type_idx = operation_types.empty() ? nullptr : get_history_by_type_index( db );
+          if( by_type_idx != nullptr )
+          {
+             account_id_type account;
+             try {
+                database_api_helper db_api_helper( db, &_app.get_options() );
+                account = db_api_helper.get_account_from_string(account_id_or_name)->get_id();
+             } catch(...) { return result; }
+             const auto& stats = account(db).statistics(db);
+
+             // the same page of the history as get_relative_account_history( account, start, limit, start+limit-1 )
+             uint64_t max_sequence = static_cast<uint32_t>( limit + start - 1 );
+             max_sequence = ( max_sequence == 0 ) ? stats.total_ops : std::min( stats.total_ops, max_sequence );
+             const uint64_t first_kept = std::max<uint64_t>( start, stats.removed_ops + 1 );
+             if( limit == 0 || max_sequence < start || max_sequence <= stats.removed_ops )
+                return result;
+             const uint64_t page_size = std::min<uint64_t>( limit, max_sequence - first_kept + 1 );
+             const uint64_t min_sequence = max_sequence - page_size + 1;
+             result.total_count = static_cast<uint32_t>( page_size );
+
+             vector<graphene::account_history::account_history_by_type_index::entry> entries;
+             for( const uint16_t op_type : operation_types )
+             {
+                auto type_entries = by_type_idx->get_entries( account, op_type, max_sequence, min_sequence, limit );
+                entries.insert( entries.end(), type_entries.begin(), type_entries.end() );
+             }
+             std::sort( entries.begin(), entries.end(), []( const auto& a, const auto& b ) {
+                return a.sequence > b.sequence;
+             } );
+             result.operation_history_objs.reserve( entries.size() );
+             for( const auto& e : entries )
+                result.operation_history_objs.push_back( e.operation_id(db) );
+             return result;
+          }
 
-       if( operation_types.empty() )
-          result.operation_history_objs = std::move(objs);
-       else
-       {
-          for( const operation_history_object &o : objs )
+          const auto relative_limit = _app.get_options().api_limit_get_relative_account_history;
+          FC_ASSERT( limit <= relative_limit,
+                     "limit can not be greater than ${configured_limit}",
+                     ("configured_limit", relative_limit) );
+          vector<operation_history_object> objs = relative_account_history( db, account_id_or_name, start, limit,
+                                                                            limit + start - 1 );
+          result.total_count = objs.size();
+
+          if( operation_types.empty() )
+             result.operation_history_objs = std::move(objs);
+          else
           {
-             if( operation_types.find(o.op.which()) != operation_types.end() ) {
-                result.operation_history_objs.push_back(o);
+             for( const operation_history_object &o : objs )
+             {
+                if( operation_types.find(o.op.which()) != operation_types.end() ) {
+                   result.operation_history_objs.push_back(o);
+                }
              }
           }
-       }
 
-       return result;
+          return result;
+       });
     }
 
     vector<bucket_object> history_api::get_market_history( const std::string& asset_a, const std::string& asset_b,
@@ -668,32 +800,31 @@ namespace graphene { namespace app {
 
        auto market_hist_plugin = _app.get_plugin<market_history_plugin>( "market_history" );
        FC_ASSERT( market_hist_plugin, "Market history plugin is not enabled" );
-       FC_ASSERT(_app.chain_database());
-
-       const auto& db = *_app.chain_database();
-       database_api_helper db_api_helper( _app );
-       asset_id_type a = db_api_helper.get_asset_from_string( asset_a )->get_id();
-       asset_id_type b = db_api_helper.get_asset_from_string( asset_b )->get_id();
-       vector<bucket_object> result;
-       const auto configured_limit = _app.get_options().api_limit_get_market_history;
-       result.reserve( configured_limit );
+       return run_read_only( [&]( graphene::chain::database& db ) {
+          database_api_helper db_api_helper( db, &_app.get_options() );
+          asset_id_type a = db_api_helper.get_asset_from_string( asset_a )->get_id();
+          asset_id_type b = db_api_helper.get_asset_from_string( asset_b )->get_id();
+          vector<bucket_object> result;
+          const auto configured_limit = _app.get_options().api_limit_get_market_history;
+          result.reserve( configured_limit );
 
-       if( a > b ) std::swap(a,b);
+          if( a > b ) std::swap(a,b);
 
-       const auto& bidx = db.get_index_type<bucket_index>();
-       const auto& by_key_idx = bidx.indices().get<by_key>();
+          const auto& bidx = db.get_index_type<bucket_index>();
+          const auto& by_key_idx = bidx.indices().get<by_key>();
 
-       auto itr = by_key_idx.lower_bound( bucket_key( a, b, bucket_seconds, start ) );
-       while( itr != by_key_idx.end() && itr->key.open <= end && result.size() < configured_limit )
-       {
-          if( !(itr->key.base == a && itr->key.quote == b && itr->key.seconds == bucket_seconds) )
+          auto itr = by_key_idx.lower_bound( bucket_key( a, b, bucket_seconds, start ) );
+          while( itr != by_key_idx.end() && itr->key.open <= end && result.size() < configured_limit )
           {
-            return result;
+             if( !(itr->key.base == a && itr->key.quote == b && itr->key.seconds == bucket_seconds) )
+             {
+               return result;
+             }
+             result.push_back(*itr);
+             ++itr;
           }
-          result.push_back(*itr);
-          ++itr;
-       }
-       return result;
+          return result;
+       });
     } FC_CAPTURE_AND_RETHROW( (asset_a)(asset_b)(bucket_seconds)(start)(end) ) }
 
     static uint32_t validate_get_lp_history_params( const application& _app, const optional<uint32_t>& olimit )
@@ -725,36 +856,36 @@ namespace graphene { namespace app {
        if( 0 == limit || ( start.valid() && stop.valid() && *start <= *stop ) ) // empty result
           return result;
 
-       const auto& db = *_app.chain_database();
-
-       const auto& hist_idx = db.get_index_type<liquidity_pool_history_index>();
+       run_read_only( [&]( graphene::chain::database& db ) {
+          const auto& hist_idx = db.get_index_type<liquidity_pool_history_index>();
 
-       if( operation_type.valid() ) // one operation type
-       {
-          const auto& idx = hist_idx.indices().get<by_pool_op_type_time>();
-          auto itr = start.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *operation_type, *start ) )
-                                   : idx.lower_bound( boost::make_tuple( pool_id, *operation_type ) );
-          auto itr_stop = stop.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *operation_type, *stop ) )
-                                       : idx.upper_bound( boost::make_tuple( pool_id, *operation_type ) );
-          while( itr != itr_stop && result.size() < limit )
+          if( operation_type.valid() ) // one operation type
           {
-             result.push_back( *itr );
-             ++itr;
+             const auto& idx = hist_idx.indices().get<by_pool_op_type_time>();
+             auto itr = start.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *operation_type, *start ) )
+                                      : idx.lower_bound( boost::make_tuple( pool_id, *operation_type ) );
+             auto itr_stop = stop.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *operation_type, *stop ) )
+                                          : idx.upper_bound( boost::make_tuple( pool_id, *operation_type ) );
+             while( itr != itr_stop && result.size() < limit )
+             {
+                result.push_back( *itr );
+                ++itr;
+             }
           }
-       }
-       else // all operation types
-       {
-          const auto& idx = hist_idx.indices().get<by_pool_time>();
-          auto itr = start.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *start ) )
-                                   : idx.lower_bound( pool_id );
-          auto itr_stop = stop.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *stop ) )
-                                       : idx.upper_bound( pool_id );
-          while( itr != itr_stop && result.size() < limit )
+          else // all operation types
           {
-             result.push_back( *itr );
-             ++itr;
+             const auto& idx = hist_idx.indices().get<by_pool_time>();
+             auto itr = start.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *start ) )
+                                      : idx.lower_bound( pool_id );
+             auto itr_stop = stop.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *stop ) )
+                                          : idx.upper_bound( pool_id );
+             while( itr != itr_stop && result.size() < limit )
+             {
+                result.push_back( *itr );
+                ++itr;
+             }
           }
-       }
+       });
 
        return result;
 
@@ -774,48 +905,48 @@ namespace graphene { namespace app {
        if( 0 == limit ) // empty result
           return result;
 
-       const auto& db = *_app.chain_database();
-
-       const auto& hist_idx = db.get_index_type<liquidity_pool_history_index>();
+       run_read_only( [&]( graphene::chain::database& db ) {
+          const auto& hist_idx = db.get_index_type<liquidity_pool_history_index>();
 
-       if( operation_type.valid() ) // one operation type
-       {
-          const auto& idx = hist_idx.indices().get<by_pool_op_type_seq>();
-          const auto& idx_t = hist_idx.indices().get<by_pool_op_type_time>();
-          auto itr = start.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *operation_type, *start ) )
-                                   : idx.lower_bound( boost::make_tuple( pool_id, *operation_type ) );
-          if( itr == idx.end() || itr->pool != pool_id || itr->op_type != *operation_type ) // empty result
-             return result;
-          if( stop.valid() && itr->time <= *stop ) // empty result
-             return result;
-          auto itr_temp = stop.valid() ? idx_t.lower_bound( boost::make_tuple( pool_id, *operation_type, *stop ) )
-                                       : idx_t.upper_bound( boost::make_tuple( pool_id, *operation_type ) );
-          auto itr_stop = ( itr_temp == idx_t.end() ? idx.end() : idx.iterator_to( *itr_temp ) );
-          while( itr != itr_stop && result.size() < limit )
+          if( operation_type.valid() ) // one operation type
           {
-             result.push_back( *itr );
-             ++itr;
+             const auto& idx = hist_idx.indices().get<by_pool_op_type_seq>();
+             const auto& idx_t = hist_idx.indices().get<by_pool_op_type_time>();
+             auto itr = start.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *operation_type, *start ) )
+                                      : idx.lower_bound( boost::make_tuple( pool_id, *operation_type ) );
+             if( itr == idx.end() || itr->pool != pool_id || itr->op_type != *operation_type ) // empty result
+                return;
+             if( stop.valid() && itr->time <= *stop ) // empty result
+                return;
+             auto itr_temp = stop.valid() ? idx_t.lower_bound( boost::make_tuple( pool_id, *operation_type, *stop ) )
+                                          : idx_t.upper_bound( boost::make_tuple( pool_id, *operation_type ) );
+             auto itr_stop = ( itr_temp == idx_t.end() ? idx.end() : idx.iterator_to( *itr_temp ) );
+             while( itr != itr_stop && result.size() < limit )
+             {
+                result.push_back( *itr );
+                ++itr;
+             }
           }
-       }
-       else // all operation types
-       {
-          const auto& idx = hist_idx.indices().get<by_pool_seq>();
-          const auto& idx_t = hist_idx.indices().get<by_pool_time>();
-          auto itr = start.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *start ) )
-                                   : idx.lower_bound( pool_id );
-          if( itr == idx.end() || itr->pool != pool_id ) // empty result
-             return result;
-          if( stop.valid() && itr->time <= *stop ) // empty result
-             return result;
-          auto itr_temp = stop.valid() ? idx_t.lower_bound( boost::make_tuple( pool_id, *stop ) )
-                                       : idx_t.upper_bound( pool_id );
-          auto itr_stop = ( itr_temp == idx_t.end() ? idx.end() : idx.iterator_to( *itr_temp ) );
-          while( itr != itr_stop && result.size() < limit )
+          else // all operation types
           {
-             result.push_back( *itr );
-             ++itr;
+             const auto& idx = hist_idx.indices().get<by_pool_seq>();
+             const auto& idx_t = hist_idx.indices().get<by_pool_time>();
+             auto itr = start.valid() ? idx.lower_bound( boost::make_tuple( pool_id, *start ) )
+                                      : idx.lower_bound( pool_id );
+             if( itr == idx.end() || itr->pool != pool_id ) // empty result
+                return;
+             if( stop.valid() && itr->time <= *stop ) // empty result
+                return;
+             auto itr_temp = stop.valid() ? idx_t.lower_bound( boost::make_tuple( pool_id, *stop ) )
+                                          : idx_t.upper_bound( pool_id );
+             auto itr_stop = ( itr_temp == idx_t.end() ? idx.end() : idx.iterator_to( *itr_temp ) );
+             while( itr != itr_stop && result.size() < limit )
+             {
+                result.push_back( *itr );
+                ++itr;
+             }
           }
-       }
+       });
 
        return result;
 
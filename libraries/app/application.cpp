@@ -24,7 +24,11 @@
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
 #include <graphene/app/application.hpp>
+#include <graphene/app/binary_rpc.hpp>
 #include <graphene/app/plugin.hpp>
+#include <graphene/app/read_replica.hpp>
+
+#include "websocket_batch_api.hxx"
 
 #include <graphene/chain/db_with.hpp>
 #include <graphene/chain/genesis_state.hpp>
@@ -40,6 +44,7 @@
 #include <graphene/chain/worker_evaluator.hpp>
 
 #include <fc/asio.hpp>
+#include <fc/thread/parallel.hpp>
 #include <fc/io/fstream.hpp>
 #include <fc/rpc/api_connection.hpp>
 #include <fc/rpc/websocket_api.hpp>
@@ -187,8 +192,10 @@ void application_impl::reset_p2p_node(const fc::path& data_dir)
 
 void application_impl::new_connection( const fc::http::websocket_connection_ptr& c )
 {
-   auto wsc = std::make_shared<fc::rpc::websocket_api_connection>(c, GRAPHENE_NET_MAX_NESTED_OBJECTS);
    auto login = std::make_shared<graphene::app::login_api>( _self );
+   auto wsc = std::make_shared<graphene::app::websocket_batch_api_connection>( c, GRAPHENE_NET_MAX_NESTED_OBJECTS,
+                                                                             login,
+                                                                             _app_options.api_limit_batch_calls );
 
     // Try to extract login information from "Authorization" header if present
    std::string auth = c->get_request_header("Authorization");
@@ -236,6 +243,16 @@ void application_impl::reset_websocket_server()
    _websocket_server->start_accept();
 } FC_CAPTURE_AND_RETHROW() } // GCOVR_EXCL_LINE
 
+void application_impl::reset_binary_rpc_server()
+{ try {
+   if( 0 == _options->count("rpc-binary-endpoint") )
+      return;
+
+   _binary_rpc_server = std::make_shared<binary_rpc_server>( _self );
+   ilog( "Configured binary rpc to listen on ${ip}", ("ip",_options->at("rpc-binary-endpoint").as<string>()) );
+   _binary_rpc_server->listen( fc::ip::endpoint::from_string(_options->at("rpc-binary-endpoint").as<string>()) );
+} FC_CAPTURE_AND_RETHROW() } // GCOVR_EXCL_LINE
+
 void application_impl::reset_websocket_tls_server()
 { try {
    if( 0 == _options->count("rpc-tls-endpoint") )
@@ -474,6 +491,10 @@ void application_impl::set_api_limit() {
       _app_options.api_limit_get_storage_info =
             _options->at("api-limit-get-storage-info").as<uint32_t>();
    }
+   if(_options->count("api-limit-batch-calls") > 0) {
+      _app_options.api_limit_batch_calls =
+            _options->at("api-limit-batch-calls").as<uint32_t>();
+   }
 }
 
 graphene::chain::genesis_state_type application_impl::initialize_genesis_state() const
@@ -554,6 +575,29 @@ void application_impl::open_chain_database() const
       _chain_db->enable_standby_votes_tracking( _options->at("enable-standby-votes-tracking").as<bool>() );
    }
 
+   if( _options->count("enable-block-log-compression") > 0
+         && _options->at("enable-block-log-compression").as<bool>() )
+   {
+      uint32_t blocks_per_segment = 1000;
+      if( _options->count("block-log-blocks-per-segment") > 0 )
+         blocks_per_segment = _options->at("block-log-blocks-per-segment").as<uint32_t>();
+      _chain_db->enable_block_log_compression( blocks_per_segment );
+   }
+
+   if( _options->count("replay-read-ahead-blocks") > 0 )
+      _chain_db->set_reindex_read_ahead( _options->at("replay-read-ahead-blocks").as<uint32_t>() );
+   if( _options->count("replay-precompute-depth") > 0 )
+      _chain_db->set_reindex_precompute_depth( _options->at("replay-precompute-depth").as<uint32_t>() );
+   if( _options->count("object-database-delta-percent") > 0 )
+      _chain_db->set_delta_compaction_percent( _options->at("object-database-delta-percent").as<uint32_t>() );
+   if( _options->count("persist-fork-database") > 0 )
+      _chain_db->enable_fork_db_persistence( _options->at("persist-fork-database").as<bool>() );
+
+   if( _options->count("max-pending-transactions-size") > 0 )
+      _chain_db->set_max_pending_transactions_size( _options->at("max-pending-transactions-size").as<uint64_t>() );
+   if( _options->count("authority-cache-size") > 0 )
+      _chain_db->set_authority_cache_size( _options->at("authority-cache-size").as<uint32_t>() );
+
    if( _options->count("replay-blockchain") > 0 || _options->count("revalidate-blockchain") > 0 )
       _chain_db->wipe( _data_dir / "blockchain", false );
 
@@ -604,11 +648,17 @@ void application_impl::startup()
 
    startup_plugins();
 
+   // replicas are created after the plugins so that they can mirror the secondary indexes added by plugins
+   if( _options->count("api-read-replicas") > 0 && _options->at("api-read-replicas").as<uint16_t>() > 0 )
+      _read_replicas = std::make_shared<read_replica_set>( *_chain_db, &_app_options,
+                                                           _options->at("api-read-replicas").as<uint16_t>() );
+
    if( enable_p2p_network && _active_plugins.find( "delayed_node" ) == _active_plugins.end() )
       reset_p2p_node(_data_dir);
 
    reset_websocket_server();
    reset_websocket_tls_server();
+   reset_binary_rpc_server();
 } FC_LOG_AND_RETHROW() }
 
 optional< api_access_info > application_impl::get_api_access_info(const string& username)const
@@ -730,6 +780,17 @@ bool application_impl::handle_block(const graphene::net::block_message& blk_msg,
    }
 } FC_CAPTURE_AND_RETHROW( (blk_msg)(sync_mode) ) return false; } // GCOVR_EXCL_LINE
 
+void application_impl::precompute_sync_block(const graphene::net::block_message& blk_msg)
+{
+   const uint32_t skip = (_is_block_producer || _force_validate) ?
+                            database::skip_nothing : database::skip_transaction_signatures;
+   // Each block is precomputed by a single worker, so that the blocks which arrive ahead of the head block
+   // are precomputed side by side while this thread applies the earlier ones
+   fc::do_parallel( [this,&blk_msg,skip] () {
+      _chain_db->precompute_block( blk_msg.block, skip );
+   }).wait();
+}
+
 void application_impl::handle_transaction(const graphene::net::trx_message& transaction_message)
 { try {
    static fc::time_point last_call;
@@ -1082,6 +1143,9 @@ void application_impl::shutdown()
       _websocket_tls_server.reset();
    if( _websocket_server )
       _websocket_server.reset();
+   if( _binary_rpc_server )
+      _binary_rpc_server.reset();
+   _read_replicas.reset();
    // TODO wait until all connections are closed and messages handled?
 
    // plugins E.G. witness_plugin may send data to p2p network, so shutdown them first
@@ -1207,6 +1271,8 @@ void application::set_program_options(boost::program_options::options_descriptio
           "Endpoint for websocket RPC to listen on")
          ("rpc-tls-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8089"),
           "Endpoint for TLS websocket RPC to listen on")
+         ("rpc-binary-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8091"),
+          "Endpoint for the binary RPC protocol to listen on, which serves blocks and objects packed with fc::raw")
          ("server-pem,p", bpo::value<string>()->implicit_value("server.pem"),
           "The TLS certificate file for this server")
          ("server-pem-password,P", bpo::value<string>()->implicit_value(""), "Password for this certificate")
@@ -1226,6 +1292,34 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("enable-standby-votes-tracking", bpo::value<bool>()->implicit_value(true),
           "Whether to enable tracking of votes of standby witnesses and committee members. "
           "Set it to true to provide accurate data to API clients, set to false for slightly better performance.")
+         ("enable-block-log-compression", bpo::value<bool>()->implicit_value(true),
+          "Whether to store blocks compressed when a new block log is created (default: false). "
+          "An existing block log keeps its format, resync to convert it.")
+         ("block-log-blocks-per-segment", bpo::value<uint32_t>()->default_value(1000),
+          "Number of blocks per compressed segment of the block log, only takes effect when "
+          "enable-block-log-compression is true")
+         ("replay-read-ahead-blocks", bpo::value<uint32_t>()->default_value(200),
+          "Maximum number of blocks read from disk ahead of the blocks being applied during a replay")
+         ("replay-precompute-depth", bpo::value<uint32_t>()->default_value(0),
+          "Maximum number of blocks whose transactions are precomputed in parallel during a replay, "
+          "0 for twice the number of IO threads")
+         ("object-database-delta-percent", bpo::value<uint32_t>()->default_value(25),
+          "When saving the object database, only write the objects changed since the last full save "
+          "as long as they are at most this percentage of it, 0 to always write the full state")
+         ("persist-fork-database", bpo::value<bool>()->default_value(false),
+          "Keep the reversible blocks and competing forks in a journal, so that they survive a restart "
+          "and blocks applied before the restart are not validated again")
+         ("max-pending-transactions-size", bpo::value<uint64_t>()->default_value(64*1024*1024),
+          "Maximum total size in bytes of the transactions waiting to be included in a block, 0 for no limit. "
+          "When it is reached, transactions with the lowest fee per byte are dropped")
+         ("authority-cache-size", bpo::value<uint32_t>()->default_value(64*1024),
+          "Maximum number of cached authority checks of transactions, 0 to check every transaction in full")
+         ("api-read-replicas", bpo::value<uint16_t>()->default_value(0),
+          "Number of copies of the chain state which serve read-only database and history API calls on their "
+          "own threads, 0 to serve all calls from the chain database. Each copy holds all objects, including the "
+          "history kept by plugins, so it needs about as much memory as the chain state. The copies apply the "
+          "objects changed by each block instead of the block itself. Copying the state at startup, or again "
+          "after a copy could not follow a fork switch, pauses the chain database")
          ("api-limit-get-account-history-operations",
           bpo::value<uint32_t>()->default_value(default_opts.api_limit_get_account_history_operations),
           "For history_api::get_account_history_operations to set max limit value")
@@ -1337,6 +1431,9 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("api-limit-get-storage-info",
           bpo::value<uint32_t>()->default_value(default_opts.api_limit_get_storage_info),
           "Set maximum limit value for APIs which query for account storage info")
+         ("api-limit-batch-calls",
+          bpo::value<uint32_t>()->default_value(default_opts.api_limit_batch_calls),
+          "Maximum number of calls in a JSON-RPC batch")
          ;
    command_line_options.add(configuration_file_options);
    command_line_options.add_options()
@@ -1406,6 +1503,11 @@ std::shared_ptr<chain::database> application::chain_database() const
    return my->_chain_db;
 }
 
+std::shared_ptr<read_replica_set> application::read_replicas() const
+{
+   return my->_read_replicas;
+}
+
 void application::set_block_production(bool producing_blocks)
 {
    my->set_block_production(producing_blocks);
@@ -1446,6 +1548,16 @@ const string& application::get_node_info() const
    return my->_node_info;
 }
 
+const fc::path& application::get_data_dir() const
+{
+   return my->_data_dir;
+}
+
+chain::chain_id_type application::get_configured_chain_id() const
+{
+   return my->initialize_genesis_state().compute_chain_id();
+}
+
 // namespace detail
 } }
 
@@ -5,6 +5,7 @@
 
 #include <graphene/app/application.hpp>
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/binary_rpc.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/protocol/types.hpp>
 #include <graphene/net/message.hpp>
@@ -28,6 +29,8 @@ class application_impl : public net::node_delegate, public std::enable_shared_fr
 
       void reset_websocket_tls_server();
 
+      void reset_binary_rpc_server();
+
       explicit application_impl(application& self)
          : _self(self),
            _chain_db(std::make_shared<chain::database>())
@@ -65,6 +68,12 @@ class application_impl : public net::node_delegate, public std::enable_shared_fr
       bool handle_block(const graphene::net::block_message& blk_msg, bool sync_mode,
                         std::vector<graphene::net::message_hash_type>& contained_transaction_msg_ids) override;
 
+      /**
+       * @brief allow the application to precompute a sync block in a worker thread while earlier blocks
+       *        are being applied
+       */
+      void precompute_sync_block(const graphene::net::block_message& blk_msg) override;
+
       void handle_transaction(const graphene::net::trx_message& transaction_message) override;
 
       void handle_message(const graphene::net::message& message_to_process) override;
@@ -215,9 +224,11 @@ class application_impl : public net::node_delegate, public std::enable_shared_fr
       api_access _apiaccess;
 
       std::shared_ptr<graphene::chain::database>            _chain_db;
+      std::shared_ptr<read_replica_set>                     _read_replicas;
       std::shared_ptr<graphene::net::node>                  _p2p_network;
       std::shared_ptr<fc::http::websocket_server>      _websocket_server;
       std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
+      std::shared_ptr<binary_rpc_server>               _binary_rpc_server;
 
       std::map<string, std::shared_ptr<abstract_plugin>> _active_plugins;
       std::map<string, std::shared_ptr<abstract_plugin>> _available_plugins;
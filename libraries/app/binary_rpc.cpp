@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/binary_rpc.hpp>
+
+#include <graphene/app/api.hpp>
+#include <graphene/app/application.hpp>
+
+#include <boost/endian/buffers.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+
+namespace graphene { namespace app {
+
+namespace {
+
+   void write_message( fc::tcp_socket& socket, const std::vector<char>& packed )
+   {
+      FC_ASSERT( packed.size() <= std::numeric_limits<uint32_t>::max(), "Message is too large" );
+      const boost::endian::little_uint32_buf_t size( static_cast<uint32_t>( packed.size() ) );
+      socket.write( reinterpret_cast<const char*>( &size ), sizeof( size ) );
+      socket.write( packed.data(), packed.size() );
+      socket.flush();
+   }
+
+   template<typename T>
+   void write_message( fc::tcp_socket& socket, const T& message )
+   {
+      write_message( socket, fc::raw::pack( message ) );
+   }
+
+   template<typename T>
+   T read_message( fc::tcp_socket& socket, uint32_t max_size )
+   {
+      boost::endian::little_uint32_buf_t size;
+      socket.read( reinterpret_cast<char*>( &size ), sizeof( size ) );
+      FC_ASSERT( size.value() <= max_size, "Message of ${s} bytes is too large", ("s", size.value()) );
+      std::vector<char> packed( size.value() );
+      if( !packed.empty() )
+         socket.read( packed.data(), packed.size() );
+      return fc::raw::unpack<T>( packed, GRAPHENE_MAX_NESTED_OBJECTS );
+   }
+
+   template<typename T>
+   T unpack_param( fc::datastream<const char*>& params )
+   {
+      T value;
+      fc::raw::unpack( params, value, GRAPHENE_MAX_NESTED_OBJECTS );
+      return value;
+   }
+
+   /// Appends a packed optional<signed_block>, the block is copied as it is
+   void append_optional_block( std::vector<char>& result, const optional<std::vector<char>>& packed_block )
+   {
+      result.push_back( packed_block.valid() ? 1 : 0 );
+      if( packed_block.valid() )
+         result.insert( result.end(), packed_block->begin(), packed_block->end() );
+   }
+
+}
+
+class binary_rpc_server::connection
+{
+   public:
+      explicit connection( application& app );
+
+      /// Handles the messages of the client until it disconnects
+      void serve();
+
+      fc::tcp_socket   socket;
+      fc::future<void> complete;
+
+   private:
+      using method = std::function<std::vector<char>( fc::datastream<const char*>& params )>;
+
+      binary_rpc_welcome negotiate( const binary_rpc_hello& hello );
+      binary_rpc_response handle( const binary_rpc_request& request );
+
+      application&                  _app;
+      graphene::chain::database&    _db;
+      std::shared_ptr<database_api> _database_api;
+      std::map<std::string, method> _methods;
+};
+
+binary_rpc_server::connection::connection( application& app )
+: _app( app ), _db( *app.chain_database() )
+{
+   _methods["get_block"] = [this]( fc::datastream<const char*>& params ) {
+      std::vector<char> result;
+      append_optional_block( result, _db.fetch_packed_block_by_number( unpack_param<uint32_t>( params ) ) );
+      return result;
+   };
+   _methods["get_blocks"] = [this]( fc::datastream<const char*>& params ) {
+      const auto first_block_num = unpack_param<uint32_t>( params );
+      const auto count = unpack_param<uint32_t>( params );
+      FC_ASSERT( count <= binary_rpc_max_blocks, "At most ${n} blocks can be requested at once",
+                 ("n", binary_rpc_max_blocks) );
+      std::vector<char> result = fc::raw::pack( fc::unsigned_int( count ) );
+      for( uint32_t i = 0; i < count; ++i )
+         append_optional_block( result, _db.fetch_packed_block_by_number( first_block_num + i ) );
+      return result;
+   };
+   _methods["get_objects"] = [this]( fc::datastream<const char*>& params ) {
+      const auto ids = unpack_param< std::vector<object_id_type> >( params );
+      std::vector<char> result = fc::raw::pack( fc::unsigned_int( ids.size() ) );
+      for( const object_id_type& id : ids )
+      {
+         const graphene::db::object* obj = _db.find_object( id );
+         result.push_back( obj ? 1 : 0 );
+         if( obj )
+         {
+            const std::vector<char> packed = obj->pack();
+            result.insert( result.end(), packed.begin(), packed.end() );
+         }
+      }
+      return result;
+   };
+   _methods["get_full_accounts"] = [this]( fc::datastream<const char*>& params ) {
+      const auto names_or_ids = unpack_param< std::vector<std::string> >( params );
+      return fc::raw::pack( _database_api->get_full_accounts( names_or_ids, false ) );
+   };
+   _methods["get_dynamic_global_properties"] = [this]( fc::datastream<const char*>& ) {
+      return fc::raw::pack( _db.get_dynamic_global_properties() );
+   };
+}
+
+void binary_rpc_server::connection::serve()
+{
+   const binary_rpc_welcome welcome = negotiate( read_message<binary_rpc_hello>( socket,
+                                                                                  binary_rpc_max_request_size ) );
+   write_message( socket, welcome );
+   if( welcome.protocol_version == 0 )
+      return;
+   while( true )
+      write_message( socket, handle( read_message<binary_rpc_request>( socket, binary_rpc_max_request_size ) ) );
+}
+
+binary_rpc_welcome binary_rpc_server::connection::negotiate( const binary_rpc_hello& hello )
+{
+   binary_rpc_welcome welcome;
+   welcome.chain_id = _db.get_chain_id();
+   if( hello.protocol_version == 0 )
+   {
+      welcome.error = "Unsupported protocol version";
+      return welcome;
+   }
+   // the database API is needed by all methods
+   login_api login( _app );
+   login.login( hello.user, hello.password );
+   if( !login.is_database_api_allowed() )
+   {
+      welcome.error = "Access denied";
+      return welcome;
+   }
+   _database_api = std::make_shared<database_api>( _db, &_app.get_options(), _app.read_replicas() );
+   welcome.protocol_version = std::min( hello.protocol_version, binary_rpc_protocol_version );
+   for( const auto& m : _methods )
+      welcome.methods.push_back( m.first );
+   return welcome;
+}
+
+binary_rpc_response binary_rpc_server::connection::handle( const binary_rpc_request& request )
+{
+   binary_rpc_response response;
+   response.id = request.id;
+   try
+   {
+      auto itr = _methods.find( request.method );
+      FC_ASSERT( itr != _methods.end(), "Unknown method ${m}", ("m", request.method) );
+      fc::datastream<const char*> params( request.params.data(), request.params.size() );
+      response.result = itr->second( params );
+   }
+   catch( const fc::exception& e )
+   {
+      response.result.clear();
+      response.error = e.to_string();
+   }
+   return response;
+}
+
+binary_rpc_server::binary_rpc_server( application& app )
+: _app( app )
+{ // Nothing else to do
+}
+
+binary_rpc_server::~binary_rpc_server()
+{
+   _tcp_server.close();
+   if( _accept_loop_complete.valid() && !_accept_loop_complete.ready() )
+   {
+      try
+      {
+         _accept_loop_complete.cancel_and_wait( "binary RPC server destroyed" );
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "Exception while stopping the binary RPC server: ${e}", ("e", e.to_detail_string()) );
+      }
+   }
+   const auto connections = _connections;
+   for( const auto& c : connections )
+   {
+      c->socket.close();
+      try
+      {
+         c->complete.cancel_and_wait( "binary RPC server destroyed" );
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "Exception while closing a binary RPC connection: ${e}", ("e", e.to_detail_string()) );
+      }
+   }
+}
+
+void binary_rpc_server::listen( const fc::ip::endpoint& endpoint )
+{
+   _tcp_server.set_reuse_address();
+   _tcp_server.listen( endpoint );
+   _accept_loop_complete = fc::async( [this]() { accept_loop(); }, "binary RPC accept loop" );
+}
+
+fc::ip::endpoint binary_rpc_server::get_listening_endpoint()
+{
+   return _tcp_server.get_local_endpoint();
+}
+
+void binary_rpc_server::accept_loop()
+{
+   while( !_accept_loop_complete.canceled() )
+   {
+      auto c = std::make_shared<connection>( _app );
+      try
+      {
+         _tcp_server.accept( c->socket );
+      }
+      catch( const fc::exception& e )
+      {
+         // the server has been closed
+         dlog( "Binary RPC accept loop stopped: ${e}", ("e", e.to_string()) );
+         return;
+      }
+      _connections.insert( c );
+      c->complete = fc::async( [this,c]() {
+         try
+         {
+            c->serve();
+         }
+         catch( const fc::eof_exception& )
+         {
+            // the client disconnected
+         }
+         catch( const fc::canceled_exception& )
+         {
+            // the server is being destroyed
+         }
+         catch( const fc::exception& e )
+         {
+            wlog( "Closing binary RPC connection: ${e}", ("e", e.to_string()) );
+         }
+         c->socket.close();
+         _connections.erase( c );
+      }, "binary RPC connection" );
+   }
+}
+
+binary_rpc_client::binary_rpc_client( const fc::ip::endpoint& server, const std::string& user,
+                                      const std::string& password )
+{
+   _socket.connect_to( server );
+   binary_rpc_hello hello;
+   hello.user = user;
+   hello.password = password;
+   write_message( _socket, hello );
+   _welcome = read_message<binary_rpc_welcome>( _socket, std::numeric_limits<uint32_t>::max() );
+   FC_ASSERT( _welcome.protocol_version > 0, "Binary RPC connection refused: ${e}", ("e", _welcome.error) );
+}
+
+std::vector<char> binary_rpc_client::call_packed( const std::string& method, std::vector<char> params )
+{
+   binary_rpc_request request;
+   request.id = ++_last_request_id;
+   request.method = method;
+   request.params = std::move( params );
+   write_message( _socket, request );
+   binary_rpc_response response = read_message<binary_rpc_response>( _socket, std::numeric_limits<uint32_t>::max() );
+   FC_ASSERT( response.id == request.id, "Unexpected response ${r} to request ${q}",
+              ("r", response.id)("q", request.id) );
+   FC_ASSERT( !response.error.valid(), "${m} failed: ${e}", ("m", method)("e", *response.error) );
+   return std::move( response.result );
+}
+
+} } // graphene::app
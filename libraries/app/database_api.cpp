@@ -26,6 +26,7 @@
 
 #include "database_api_impl.hxx"
 
+#include <graphene/app/read_replica.hpp>
 #include <graphene/app/util.hpp>
 #include <graphene/chain/get_config.hpp>
 #include <graphene/chain/hardfork.hpp>
@@ -49,11 +50,31 @@ namespace graphene { namespace app {
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
 
-database_api::database_api( graphene::chain::database& db, const application_options* app_options )
-: my( std::make_shared<database_api_impl>( db, app_options ) )
+database_api::database_api( graphene::chain::database& db, const application_options* app_options,
+                            std::shared_ptr<read_replica_set> replicas )
+: my( std::make_shared<database_api_impl>( db, app_options ) ), _replicas( std::move( replicas ) )
 { // Nothing else to do
 }
 
+template<typename Fn>
+auto database_api::run_read_only( Fn&& f )const -> decltype( f( std::declval<database_api_impl&>() ) )
+{
+   if( _replicas && 0 == _batch_depth )
+      return _replicas->run( std::forward<Fn>( f ) );
+   return f( *my );
+}
+
+void database_api::begin_batch()
+{
+   ++_batch_depth;
+}
+
+void database_api::end_batch()
+{
+   if( _batch_depth > 0 )
+      --_batch_depth;
+}
+
 database_api::~database_api() = default;
 
 database_api_helper::database_api_helper( graphene::chain::database& db, const application_options* app_options )
@@ -67,24 +88,9 @@ database_api_helper::database_api_helper( const graphene::app::application& app
 }
 
 database_api_impl::database_api_impl( graphene::chain::database& db, const application_options* app_options )
-:database_api_helper( db, app_options )
+:database_api_helper( db, app_options ), _fanout( subscription_fanout::get_instance( db ) )
 {
    dlog("creating database api ${x}", ("x",int64_t(this)) );
-   _new_connection = _db.new_objects.connect([this](const vector<object_id_type>& ids,
-                                                    const flat_set<account_id_type>& impacted_accounts) {
-                                on_objects_new(ids, impacted_accounts);
-                                });
-   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids,
-                                                           const flat_set<account_id_type>& impacted_accounts) {
-                                on_objects_changed(ids, impacted_accounts);
-                                });
-   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type>& ids,
-                                                            const vector<const object*>& objs,
-                                                            const flat_set<account_id_type>& impacted_accounts) {
-                                on_objects_removed(ids, objs, impacted_accounts);
-                                });
-   _applied_block_connection = _db.applied_block.connect([this](const signed_block&){ on_applied_block(); });
-
    _pending_trx_connection = _db.on_pending_transaction.connect([this](const signed_transaction& trx ){
                                 if( _pending_trx_callback )
                                    _pending_trx_callback( fc::variant(trx, GRAPHENE_MAX_NESTED_OBJECTS) );
@@ -124,6 +130,7 @@ database_api_impl::database_api_impl( graphene::chain::database& db, const appli
 database_api_impl::~database_api_impl()
 {
    dlog("freeing database api ${x}", ("x",int64_t(this)) );
+   _fanout->remove_subscriber( this );
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -180,7 +187,8 @@ void database_api_impl::set_subscribe_callback( std::function<void(const variant
    cancel_all_subscriptions(false, false);
 
    _subscribe_callback = cb;
-   _notify_remove_create = notify_remove_create;
+   enable_notifications();
+   _fanout->set_notify_remove_create( this, notify_remove_create );
 }
 
 void database_api::set_auto_subscription( bool enable )
@@ -211,6 +219,7 @@ void database_api::set_block_applied_callback( std::function<void(const variant&
 void database_api_impl::set_block_applied_callback( std::function<void(const variant& block_id)> cb )
 {
    _block_applied_callback = cb;
+   enable_notifications();
 }
 
 void database_api::cancel_all_subscriptions()
@@ -226,10 +235,7 @@ void database_api_impl::cancel_all_subscriptions( bool reset_callback, bool rese
    if ( reset_market_subscriptions )
       _market_subscriptions.clear();
 
-   _notify_remove_create = false;
-   _subscribed_accounts.clear();
-   static fc::bloom_parameters param(10000, 1.0/100, 1024*8*8*2);
-   _subscribe_filter = fc::bloom_filter(param);
+   _fanout->cancel_subscriptions( this, reset_market_subscriptions );
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -516,7 +522,11 @@ vector<optional<account_object>> database_api_impl::get_accounts( const vector<s
 std::map<string, full_account, std::less<>> database_api::get_full_accounts( const vector<string>& names_or_ids,
                                                                              const optional<bool>& subscribe )const
 {
-   return my->get_full_accounts( names_or_ids, subscribe );
+   if( my->get_whether_to_subscribe( subscribe ) )
+      return my->get_full_accounts( names_or_ids, subscribe );
+   return run_read_only( [&names_or_ids]( database_api_impl& impl ) {
+      return impl.get_full_accounts( names_or_ids, false );
+   });
 }
 
 std::map<std::string, full_account, std::less<>> database_api_impl::get_full_accounts(
@@ -538,9 +548,10 @@ std::map<std::string, full_account, std::less<>> database_api_impl::get_full_acc
       if( !account )
          continue;
 
-      if( to_subscribe && _subscribed_accounts.size() < _app_options->api_limit_get_full_accounts_subscribe )
+      if( to_subscribe
+            && _fanout->subscribed_account_count( this ) < _app_options->api_limit_get_full_accounts_subscribe )
       {
-         _subscribed_accounts.insert( account->get_id() );
+         _fanout->subscribe_to_account( this, account->get_id() );
          subscribe_to_item( account->id );
       }
 
@@ -700,7 +711,9 @@ std::map<std::string, full_account, std::less<>> database_api_impl::get_full_acc
 
 vector<account_statistics_object> database_api::get_top_voters(uint32_t limit)const
 {
-   return my->get_top_voters( limit );
+   return run_read_only( [limit]( database_api_impl& impl ) {
+      return impl.get_top_voters( limit );
+   });
 }
 
 vector<account_statistics_object> database_api_impl::get_top_voters(uint32_t limit)const
@@ -971,7 +984,9 @@ vector<optional<extended_asset_object>> database_api_impl::get_assets(
 
 vector<extended_asset_object> database_api::list_assets(const string& lower_bound_symbol, uint32_t limit)const
 {
-   return my->list_assets( lower_bound_symbol, limit );
+   return run_read_only( [&lower_bound_symbol,limit]( database_api_impl& impl ) {
+      return impl.list_assets( lower_bound_symbol, limit );
+   });
 }
 
 vector<extended_asset_object> database_api_impl::list_assets(const string& lower_bound_symbol, uint32_t limit)const
@@ -1052,7 +1067,9 @@ vector<optional<extended_asset_object>> database_api_impl::lookup_asset_symbols(
 
 vector<limit_order_object> database_api::get_limit_orders(std::string a, std::string b, uint32_t limit)const
 {
-   return my->get_limit_orders( a, b, limit );
+   return run_read_only( [&a,&b,limit]( database_api_impl& impl ) {
+      return impl.get_limit_orders( a, b, limit );
+   });
 }
 
 vector<limit_order_object> database_api_impl::get_limit_orders( const std::string& a, const std::string& b,
@@ -1205,7 +1222,9 @@ vector<limit_order_object> database_api_impl::get_account_limit_orders(
 
 vector<call_order_object> database_api::get_call_orders(const std::string& a, uint32_t limit)const
 {
-   return my->get_call_orders( a, limit );
+   return run_read_only( [&a,limit]( database_api_impl& impl ) {
+      return impl.get_call_orders( a, limit );
+   });
 }
 
 vector<call_order_object> database_api_impl::get_call_orders(const std::string& a, uint32_t limit)const
@@ -1261,7 +1280,9 @@ vector<call_order_object> database_api_impl::get_call_orders_by_account(const st
 
 vector<force_settlement_object> database_api::get_settle_orders(const std::string& a, uint32_t limit)const
 {
-   return my->get_settle_orders( a, limit );
+   return run_read_only( [&a,limit]( database_api_impl& impl ) {
+      return impl.get_settle_orders( a, limit );
+   });
 }
 
 vector<force_settlement_object> database_api_impl::get_settle_orders(const std::string& a, uint32_t limit)const
@@ -1330,7 +1351,9 @@ vector<call_order_object> database_api::get_margin_positions( const std::string&
 vector<collateral_bid_object> database_api::get_collateral_bids( const std::string& asset,
                                                                  uint32_t limit, uint32_t start )const
 {
-   return my->get_collateral_bids( asset, limit, start );
+   return run_read_only( [&asset,limit,start]( database_api_impl& impl ) {
+      return impl.get_collateral_bids( asset, limit, start );
+   });
 }
 
 vector<collateral_bid_object> database_api_impl::get_collateral_bids( const std::string& asset_id_or_symbol,
@@ -1372,6 +1395,8 @@ void database_api_impl::subscribe_to_market( std::function<void(const variant&)>
    if(asset_a_id > asset_b_id) std::swap(asset_a_id,asset_b_id);
    FC_ASSERT(asset_a_id != asset_b_id);
    _market_subscriptions[ std::make_pair(asset_a_id,asset_b_id) ] = callback;
+   enable_notifications();
+   _fanout->subscribe_to_market( this, std::make_pair(asset_a_id,asset_b_id) );
 }
 
 void database_api::unsubscribe_from_market(const std::string& a, const std::string& b)
@@ -1387,6 +1412,7 @@ void database_api_impl::unsubscribe_from_market(const std::string& a, const std:
    if(a > b) std::swap(asset_a_id,asset_b_id);
    FC_ASSERT(asset_a_id != asset_b_id);
    _market_subscriptions.erase(std::make_pair(asset_a_id,asset_b_id));
+   _fanout->unsubscribe_from_market( this, std::make_pair(asset_a_id,asset_b_id) );
 }
 
 market_ticker database_api::get_ticker( const string& base, const string& quote )const
@@ -1444,7 +1470,9 @@ market_volume database_api_impl::get_24_volume( const string& base, const string
 
 order_book database_api::get_order_book( const string& base, const string& quote, uint32_t limit )const
 {
-   return my->get_order_book( base, quote, limit );
+   return run_read_only( [&base,&quote,limit]( database_api_impl& impl ) {
+      return impl.get_order_book( base, quote, limit );
+   });
 }
 
 order_book database_api_impl::get_order_book( const string& base, const string& quote, uint32_t limit )const
@@ -3042,7 +3070,6 @@ vector<ticket_object> database_api::get_tickets_by_account(
 const account_object* database_api_helper::get_account_from_string( const std::string& name_or_id,
                                                                   bool throw_if_not_found ) const
 {
-   // TODO cache the result to avoid repeatly fetching from db
    if( name_or_id.empty() )
    {
       if( throw_if_not_found )
@@ -3068,7 +3095,6 @@ const account_object* database_api_helper::get_account_from_string( const std::s
 const asset_object* database_api_helper::get_asset_from_string( const std::string& symbol_or_id,
                                                               bool throw_if_not_found ) const
 {
-   // TODO cache the result to avoid repeatly fetching from db
    if( symbol_or_id.empty() )
    {
       if( throw_if_not_found )
@@ -3148,191 +3174,29 @@ vector<limit_order_object> database_api_impl::get_limit_orders( const asset_id_t
    return result;
 }
 
-bool database_api_impl::is_impacted_account( const flat_set<account_id_type>& accounts)
-{
-   if( _subscribed_accounts.empty() || accounts.empty() )
-      return false;
-
-   return std::any_of(accounts.begin(), accounts.end(), [this](const account_id_type& account) {
-      return _subscribed_accounts.find(account) != _subscribed_accounts.end();
-   });
-}
-
-void database_api_impl::broadcast_updates( const vector<variant>& updates )
-{
-   if( !updates.empty() && _subscribe_callback ) {
-      auto capture_this = shared_from_this();
-      fc::async([capture_this,updates](){
-          if(capture_this->_subscribe_callback)
-            capture_this->_subscribe_callback( fc::variant(updates) );
-      });
-   }
-}
-
-void database_api_impl::broadcast_market_updates( const market_queue_type& queue)
-{
-   if( !queue.empty() )
-   {
-      auto capture_this = shared_from_this();
-      fc::async([capture_this, this, queue](){
-          for( const auto& item : queue )
-          {
-            auto sub = _market_subscriptions.find(item.first);
-            if( sub != _market_subscriptions.end() )
-                sub->second( fc::variant(item.second ) );
-          }
-      });
-   }
-}
-
-void database_api_impl::on_objects_removed( const vector<object_id_type>& ids,
-                                            const vector<const object*>& objs,
-                                            const flat_set<account_id_type>& impacted_accounts )
+void database_api_impl::enable_notifications()
 {
-   handle_object_changed(_notify_remove_create, false, ids, impacted_accounts,
-      [objs](object_id_type id) -> const object* {
-         auto it = std::find_if(
-               objs.begin(), objs.end(),
-               [id](const object* o) {return o != nullptr && o->id == id;});
-
-         if (it != objs.end())
-            return *it;
-
-         return nullptr;
-      }
-   );
+   _fanout->add_subscriber( shared_from_this() );
 }
 
-void database_api_impl::on_objects_new( const vector<object_id_type>& ids,
-                                        const flat_set<account_id_type>& impacted_accounts )
+void database_api_impl::on_object_updates( const fc::variant& updates )
 {
-   handle_object_changed(_notify_remove_create, true, ids, impacted_accounts,
-      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
-   );
+   if( _subscribe_callback )
+      _subscribe_callback( updates );
 }
 
-void database_api_impl::on_objects_changed( const vector<object_id_type>& ids,
-                                            const flat_set<account_id_type>& impacted_accounts )
+void database_api_impl::on_market_updates( const subscription_fanout::market_type& market,
+                                           const fc::variant& updates )
 {
-   handle_object_changed(false, true, ids, impacted_accounts,
-      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
-   );
+   auto sub = _market_subscriptions.find( market );
+   if( sub != _market_subscriptions.end() )
+      sub->second( updates );
 }
 
-void database_api_impl::handle_object_changed( bool force_notify,
-                                               bool full_object,
-                                               const vector<object_id_type>& ids,
-                                               const flat_set<account_id_type>& impacted_accounts,
-                                               std::function<const object*(object_id_type id)> find_object )
+void database_api_impl::on_block_applied( const fc::variant& block_id )
 {
-   if( _subscribe_callback )
-   {
-      vector<variant> updates;
-
-      for(auto id : ids)
-      {
-         if( force_notify || is_subscribed_to_item(id) || is_impacted_account(impacted_accounts) )
-         {
-            if( full_object )
-            {
-               auto obj = find_object(id);
-               if( obj )
-               {
-                  updates.emplace_back( obj->to_variant() );
-               }
-            }
-            else
-            {
-               updates.emplace_back( fc::variant( id, 1 ) );
-            }
-         }
-      }
-
-      if( !updates.empty() )
-         broadcast_updates(updates);
-   }
-
-   if( !_market_subscriptions.empty() )
-   {
-      market_queue_type broadcast_queue;
-
-      for(auto id : ids)
-      {
-         if( id.is<call_order_id_type>() )
-         {
-            enqueue_if_subscribed_to_market<call_order_object>( find_object(id), broadcast_queue, full_object );
-         }
-         else if( id.is<limit_order_id_type>() )
-         {
-            enqueue_if_subscribed_to_market<limit_order_object>( find_object(id), broadcast_queue, full_object );
-         }
-         else if( id.is<force_settlement_id_type>() )
-         {
-            enqueue_if_subscribed_to_market<force_settlement_object>( find_object(id), broadcast_queue,
-                                                                      full_object );
-         }
-      }
-
-      if( !broadcast_queue.empty() )
-         broadcast_market_updates(broadcast_queue);
-   }
-}
-
-/** note: this method cannot yield because it is called in the middle of
- * apply a block.
- */
-void database_api_impl::on_applied_block()
-{
-   if (_block_applied_callback)
-   {
-      auto capture_this = shared_from_this();
-      block_id_type block_id = _db.head_block_id();
-      fc::async([this,capture_this,block_id](){
-         _block_applied_callback(fc::variant(block_id, 1));
-      });
-   }
-
-   if( _market_subscriptions.empty() )
-      return;
-
-   const auto& ops = _db.get_applied_operations();
-   map< std::pair<asset_id_type,asset_id_type>, vector<pair<operation, operation_result>> > subscribed_markets_ops;
-   for(const optional< operation_history_object >& o_op : ops)
-   {
-      if( !o_op.valid() )
-         continue;
-      const operation_history_object& op = *o_op;
-
-      optional< std::pair<asset_id_type,asset_id_type> > market;
-      switch(op.op.which())
-      {
-         /*  This is sent via the object_changed callback
-         case operation::tag<limit_order_create_operation>::value:
-            market = op.op.get<limit_order_create_operation>().get_market();
-            break;
-         */
-         case operation::tag<fill_order_operation>::value:
-            market = op.op.get<fill_order_operation>().get_market();
-            break;
-            /*
-         case operation::tag<limit_order_cancel_operation>::value:
-         */
-         default: break;
-      }
-      if( market.valid() && _market_subscriptions.count(*market) > 0 )
-         // FIXME this may cause fill_order_operation be pushed before order creation
-         subscribed_markets_ops[*market].emplace_back(std::make_pair(op.op, op.result));
-   }
-   /// we need to ensure the database_api is not deleted for the life of the async operation
-   auto capture_this = shared_from_this();
-   fc::async([this,capture_this,subscribed_markets_ops](){
-      for(auto item : subscribed_markets_ops)
-      {
-         auto itr = _market_subscriptions.find(item.first);
-         if(itr != _market_subscriptions.end())
-            itr->second(fc::variant(item.second, GRAPHENE_NET_MAX_NESTED_OBJECTS));
-      }
-   });
+   if( _block_applied_callback )
+      _block_applied_callback( block_id );
 }
 
 } } // graphene::app
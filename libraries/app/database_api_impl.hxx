@@ -23,17 +23,15 @@
  */
 #pragma once
 
-#include <fc/bloom_filter.hpp>
 #include "database_api_helper.hxx"
+#include "subscription_fanout.hxx"
 
 #define GET_REQUIRED_FEES_MAX_RECURSION 4
 
 namespace graphene { namespace app {
 
-using market_queue_type = std::map< std::pair<graphene::chain::asset_id_type, graphene::chain::asset_id_type>,
-                                    std::vector<fc::variant> >;
-
-class database_api_impl : public std::enable_shared_from_this<database_api_impl>, public database_api_helper
+class database_api_impl : public std::enable_shared_from_this<database_api_impl>, public database_api_helper,
+                          public subscription_fanout::subscriber
 {
    public:
       database_api_impl( graphene::chain::database& db, const application_options* app_options );
@@ -323,110 +321,37 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
          return _enabled_auto_subscription;
       }
 
-      // Note:
-      //   Different type of object_id<T> objects could become identical after packed.
-      //   For example, both `account_id_type a=1.2.0` and `asset_id_type b=1.3.0` will become `0` after packed.
-      //   In order to avoid collision, we don't use a template function here, instead, we implicitly convert all
-      //   object IDs to `object_id_type` when subscribing.
-      //
-      //   If need to subscribe to other data types, override this function with the types as parameter.
-      //   For example, we had a `get_subscription_key( const public_key_type& item )` function here, which was
-      //   removed lately since we no longer subscribe to public keys.
-      vector<char> get_subscription_key( const object_id_type& item )const
-      {
-         return fc::raw::pack(item);
-      }
-
       template<typename T>
       void subscribe_to_item( const T& item )const
       {
          if( !_subscribe_callback )
             return;
 
-         vector<char> key = get_subscription_key( object_id_type(item) );
-         if( !_subscribe_filter.contains( key.data(), key.size() ) )
-         {
-            _subscribe_filter.insert( key.data(), key.size() );
-         }
-      }
-
-      template<typename T>
-      bool is_subscribed_to_item( const T& item )const
-      {
-         if( !_subscribe_callback )
-            return false;
-
-         vector<char> key = get_subscription_key( object_id_type(item) );
-         return _subscribe_filter.contains( key.data(), key.size() );
+         _fanout->subscribe_to_object( this, object_id_type(item) );
       }
 
-      // for full-account subscription
-      bool is_impacted_account( const flat_set<account_id_type>& accounts );
-
-      // for market subscription
-      template<typename T>
-      const std::pair<asset_id_type,asset_id_type> get_order_market( const T& order )
-      {
-         return order.get_market();
-      }
-
-      // for market subscription
-      const std::pair<asset_id_type,asset_id_type> get_order_market( const force_settlement_object& order )
-      {
-         // TODO cache the result to avoid repeatly fetching from db
-         asset_id_type backing_id = order.balance.asset_id( _db ).bitasset_data( _db ).options.short_backing_asset;
-         auto tmp = std::make_pair( order.balance.asset_id, backing_id );
-         if( tmp.first > tmp.second ) std::swap( tmp.first, tmp.second );
-         return tmp;
-      }
-
-      template<typename T>
-      void enqueue_if_subscribed_to_market(const object* obj, market_queue_type& queue, bool full_object=true)
-      {
-         const T* order = dynamic_cast<const T*>(obj);
-         FC_ASSERT( order != nullptr);
-
-         const auto& market = get_order_market( *order );
-
-         auto sub = _market_subscriptions.find( market );
-         if( sub != _market_subscriptions.end() ) {
-            queue[market].emplace_back( full_object ? obj->to_variant() : fc::variant(obj->id, 1) );
-         }
-      }
+      /// Registers this connection with the shared subscription fan-out
+      void enable_notifications();
 
-      void broadcast_updates( const vector<variant>& updates );
-      void broadcast_market_updates( const market_queue_type& queue);
-      void handle_object_changed( bool force_notify,
-                                  bool full_object,
-                                  const vector<object_id_type>& ids,
-                                  const flat_set<account_id_type>& impacted_accounts,
-                                  std::function<const object*(object_id_type id)> find_object );
-
-      /** called every time a block is applied to report the objects that were changed */
-      void on_objects_new(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts);
-      void on_objects_changed(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts);
-      void on_objects_removed(const vector<object_id_type>& ids, const vector<const object*>& objs,
-                              const flat_set<account_id_type>& impacted_accounts);
-      void on_applied_block();
+      /// called by the subscription fan-out after a block was applied
+      ///@{
+      void on_object_updates( const fc::variant& updates ) override;
+      void on_market_updates( const subscription_fanout::market_type& market, const fc::variant& updates ) override;
+      void on_block_applied( const fc::variant& block_id ) override;
+      ///@}
 
       ////////////////////////////////////////////////
       // Member variables
       ////////////////////////////////////////////////
 
-      bool _notify_remove_create = false;
       bool _enabled_auto_subscription = true;
 
-      mutable fc::bloom_filter  _subscribe_filter;
-      std::set<account_id_type> _subscribed_accounts;
+      std::shared_ptr<subscription_fanout> _fanout;
 
       std::function<void(const fc::variant&)> _subscribe_callback;
       std::function<void(const fc::variant&)> _pending_trx_callback;
       std::function<void(const fc::variant&)> _block_applied_callback;
 
-      boost::signals2::scoped_connection _new_connection;
-      boost::signals2::scoped_connection _change_connection;
-      boost::signals2::scoped_connection _removed_connection;
-      boost::signals2::scoped_connection _applied_block_connection;
       boost::signals2::scoped_connection _pending_trx_connection;
 
       map< pair<asset_id_type,asset_id_type>, std::function<void(const variant&)> > _market_subscriptions;
@@ -142,6 +142,8 @@ namespace graphene { namespace app {
           *              @a api_limit_get_account_history_operations
           * @param start ID of the most recent operation to retrieve
           * @return A list of operations related to the specified account, ordered from most recent to oldest.
+          * @note If the node keeps the history by operation type (the @a history-by-operation-type option of the
+          *       account_history plugin), the time this takes does not depend on the size of the history.
           */
          vector<operation_history_object> get_account_history_operations(
             const std::string& account_name_or_id,
@@ -300,6 +302,17 @@ namespace graphene { namespace app {
                const optional<int64_t>& operation_type = optional<int64_t>() )const;
 
       private:
+           /// Runs @p f with the database of a read replica if there are any, otherwise with the chain database
+           template<typename Fn>
+           auto run_read_only( Fn&& f )const -> decltype( f( std::declval<graphene::chain::database&>() ) );
+
+           /// @see get_relative_account_history, without checking the limit
+           vector<operation_history_object> relative_account_history( graphene::chain::database& db,
+                                                                      const std::string& account_id_or_name,
+                                                                      uint64_t stop,
+                                                                      uint32_t limit,
+                                                                      uint64_t start ) const;
+
            application& _app;
    };
 
@@ -783,13 +796,23 @@ namespace graphene { namespace app {
          /// @return @a true if database_api is allowed, @a false otherwise
          bool is_database_api_allowed() const;
 
+         /// @brief Start a batch of calls of this connection, not reflected, batches can be nested
+         /// @see database_api::begin_batch
+         void begin_batch();
+         /// @brief End a batch of calls of this connection, not reflected
+         void end_batch();
+
       private:
          application& _app;
 
          flat_set< string > _allowed_apis;
+         /// Number of batches which have been started and not ended yet
+         uint32_t _batch_depth = 0;
 
          optional< fc::api<block_api> >                          _block_api;
          optional< fc::api<database_api> >                       _database_api;
+         /// The object behind @ref _database_api, for starting and ending batches
+         std::shared_ptr< database_api >                         _database_api_object;
          optional< fc::api<network_broadcast_api> >              _network_broadcast_api;
          optional< fc::api<network_node_api> >                   _network_node_api;
          optional< fc::api<history_api> >                        _history_api;
@@ -34,6 +34,7 @@ namespace graphene { namespace app {
    using std::string;
 
    class abstract_plugin;
+   class read_replica_set;
 
    class application_options
    {
@@ -80,6 +81,7 @@ namespace graphene { namespace app {
          uint32_t api_limit_get_samet_funds = 101;
          uint32_t api_limit_get_credit_offers = 101;
          uint32_t api_limit_get_storage_info = 101;
+         uint32_t api_limit_batch_calls = 100;
 
          static constexpr application_options get_default()
          {
@@ -140,6 +142,8 @@ namespace graphene { namespace app {
 
          net::node_ptr                    p2p_node();
          std::shared_ptr<chain::database> chain_database()const;
+         /// The read replicas serving read-only database API calls, null if there are none
+         std::shared_ptr<read_replica_set> read_replicas()const;
          void set_api_limit();
          void set_block_production(bool producing_blocks);
          fc::optional< api_access_info > get_api_access_info( const string& username )const;
@@ -159,6 +163,13 @@ namespace graphene { namespace app {
 
          const string& get_node_info() const;
 
+         /// The directory passed to @ref initialize, plugins may keep their own files in sub-directories
+         const fc::path& get_data_dir() const;
+
+         /// The ID of the chain which the genesis options describe, i.e. of the chain a new chain state is
+         /// created for
+         chain::chain_id_type get_configured_chain_id() const;
+
    private:
          /// Add an available plugin
          void add_available_plugin( std::shared_ptr<abstract_plugin> p ) const;
@@ -212,6 +223,7 @@ FC_REFLECT( graphene::app::application_options,
             ( api_limit_get_samet_funds )
             ( api_limit_get_credit_offers )
             ( api_limit_get_storage_info )
+            ( api_limit_batch_calls )
           )
 
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION( graphene::app::application_options )
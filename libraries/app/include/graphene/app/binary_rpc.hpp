@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/database_api.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/io/raw_variant.hpp>
+#include <fc/network/tcp_socket.hpp>
+#include <fc/thread/future.hpp>
+
+#include <set>
+
+namespace graphene { namespace app {
+
+   class application;
+
+   /**
+    * @defgroup binary_rpc Binary RPC protocol
+    *
+    * An alternative to the JSON-RPC API for bulk consumers such as indexers, served on its own endpoint. All
+    * messages are packed with fc::raw and preceded by their size as a 32 bit little endian integer. The client
+    * starts with a @ref binary_rpc_hello, the server answers with a @ref binary_rpc_welcome which holds the
+    * negotiated protocol version, then the client sends @ref binary_rpc_request messages and gets one
+    * @ref binary_rpc_response for each, in order.
+    *
+    * The parameters of a request are its arguments packed one after another, the result of a response is the
+    * packed return value. The methods of version 1 are
+    * - get_block( uint32_t block_num ) -> optional<signed_block>, irreversible blocks are passed on as they are
+    *   stored in the block log without being unpacked
+    * - get_blocks( uint32_t first_block_num, uint32_t count ) -> vector<optional<signed_block>>, at most
+    *   @ref binary_rpc_max_blocks blocks
+    * - get_objects( vector<object_id_type> ids ) -> vector<optional<object>>, each object is packed as the type
+    *   which its ID refers to
+    * - get_full_accounts( vector<string> names_or_ids ) -> map<string, full_account>, like the database API
+    * - get_dynamic_global_properties() -> dynamic_global_property_object
+    * @{
+    */
+
+   /// The highest protocol version which is supported
+   constexpr uint32_t binary_rpc_protocol_version = 1;
+   /// Maximum size of a message sent by a client
+   constexpr uint32_t binary_rpc_max_request_size = 1024 * 1024;
+   /// Maximum number of blocks returned by one call of get_blocks
+   constexpr uint32_t binary_rpc_max_blocks = 100;
+
+   /// The first message of a client
+   struct binary_rpc_hello
+   {
+      uint32_t    protocol_version = binary_rpc_protocol_version; ///< the highest version the client supports
+      std::string user;
+      std::string password;
+   };
+
+   /// The answer of the server to @ref binary_rpc_hello
+   struct binary_rpc_welcome
+   {
+      uint32_t                 protocol_version = 0; ///< the version to use, 0 if the connection is refused
+      chain_id_type            chain_id;
+      std::vector<std::string> methods;
+      std::string              error;
+   };
+
+   struct binary_rpc_request
+   {
+      uint64_t          id = 0;
+      std::string       method;
+      std::vector<char> params;
+   };
+
+   struct binary_rpc_response
+   {
+      uint64_t                  id = 0;
+      std::vector<char>         result;
+      fc::optional<std::string> error;
+   };
+
+   /// Serves the binary RPC protocol, the connections are handled by the thread which creates the server
+   class binary_rpc_server
+   {
+      public:
+         explicit binary_rpc_server( application& app );
+         ~binary_rpc_server();
+
+         void listen( const fc::ip::endpoint& endpoint );
+         fc::ip::endpoint get_listening_endpoint();
+
+      private:
+         class connection;
+
+         void accept_loop();
+
+         application&                           _app;
+         fc::tcp_server                         _tcp_server;
+         fc::future<void>                       _accept_loop_complete;
+         std::set< std::shared_ptr<connection> > _connections;
+   };
+
+   /// A client of @ref binary_rpc_server
+   class binary_rpc_client
+   {
+      public:
+         /// Connects to @p server and negotiates the protocol version, throws if the server refuses the connection
+         explicit binary_rpc_client( const fc::ip::endpoint& server, const std::string& user = std::string(),
+                                     const std::string& password = std::string() );
+
+         const binary_rpc_welcome& get_welcome()const { return _welcome; }
+
+         /// Calls @p method with @p args and unpacks the result as @p Result
+         template<typename Result, typename... Args>
+         Result call( const std::string& method, const Args&... args )
+         {
+            return fc::raw::unpack<Result>( call_packed( method, pack_params( args... ) ),
+                                            GRAPHENE_MAX_NESTED_OBJECTS );
+         }
+
+         /// Calls @p method with packed parameters and returns the packed result, throws if the call failed
+         std::vector<char> call_packed( const std::string& method, std::vector<char> params );
+
+      private:
+         template<typename... Args>
+         static std::vector<char> pack_params( const Args&... args )
+         {
+            using expand = int[];
+            size_t size = 0;
+            (void)expand{ 0, ( size += fc::raw::pack_size( args ), 0 )... };
+            std::vector<char> params( size );
+            fc::datastream<char*> ds( params.data(), params.size() );
+            (void)expand{ 0, ( fc::raw::pack( ds, args ), 0 )... };
+            return params;
+         }
+
+         fc::tcp_socket     _socket;
+         binary_rpc_welcome _welcome;
+         uint64_t           _last_request_id = 0;
+   };
+
+   /// @}
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::binary_rpc_hello, (protocol_version)(user)(password) )
+FC_REFLECT( graphene::app::binary_rpc_welcome, (protocol_version)(chain_id)(methods)(error) )
+FC_REFLECT( graphene::app::binary_rpc_request, (id)(method)(params) )
+FC_REFLECT( graphene::app::binary_rpc_response, (id)(result)(error) )
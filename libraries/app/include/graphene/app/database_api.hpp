@@ -59,6 +59,7 @@ using std::vector;
 using std::map;
 
 class database_api_impl;
+class read_replica_set;
 
 /**
  * @brief The database_api class implements the RPC API for the chain database.
@@ -70,9 +71,25 @@ class database_api_impl;
 class database_api
 {
    public:
-      database_api(graphene::chain::database& db, const application_options* app_options = nullptr );
+      /**
+       * @param replicas if given, calls which only read the chain state and do not subscribe to changes are
+       *                 served by these replicas instead of @p db
+       */
+      database_api( graphene::chain::database& db, const application_options* app_options = nullptr,
+                    std::shared_ptr<read_replica_set> replicas = nullptr );
       ~database_api();
 
+      /**
+       * @brief Starts a batch of calls of one API connection, this is not available through RPC
+       *
+       * Until @ref end_batch is called, all calls are served by the chain database even if there are read
+       * replicas, so that the calls of the batch see the same state as long as none of them waits. Batches can
+       * be nested, the outermost one ends with the last call of @ref end_batch.
+       */
+      void begin_batch();
+      /// Ends a batch of calls which has been started by @ref begin_batch
+      void end_batch();
+
       /////////////
       // Objects //
       /////////////
@@ -1458,7 +1475,14 @@ class database_api
             const optional<ticket_id_type>& start_id = optional<ticket_id_type>() )const;
 
 private:
+      /// Runs a call which only reads the chain state on a read replica, if there are any and no batch runs
+      template<typename Fn>
+      auto run_read_only( Fn&& f )const -> decltype( f( std::declval<database_api_impl&>() ) );
+
       std::shared_ptr< database_api_impl > my;
+      std::shared_ptr< read_replica_set > _replicas;
+      /// Number of batches which have been started and not ended yet
+      uint32_t _batch_depth = 0;
 };
 
 } }
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace graphene { namespace app {
+
+   class application_options;
+   class database_api_impl;
+
+   /// Monitoring counters of the read replicas
+   struct read_replica_metrics
+   {
+      uint32_t replicas = 0;
+      uint32_t lag = 0;                   ///< blocks the slowest replica is behind the primary database
+      uint64_t calls = 0;                 ///< API calls served by the replicas
+      uint64_t call_microseconds = 0;     ///< time spent in these calls on the replica threads
+      uint64_t blocks = 0;                ///< changes of blocks applied by all replicas
+      uint64_t apply_microseconds = 0;    ///< time spent applying these changes on the replica threads
+      uint64_t resyncs = 0;               ///< times a replica copied the state again because it could not follow
+   };
+
+   /**
+    *  A copy of the chain state on its own thread. It follows the blocks applied by the primary database, and
+    *  serves API calls which only read the chain state, so that these calls neither wait for block application
+    *  nor delay it.
+    *
+    *  The replica does not apply the blocks itself. It applies copies of the objects which each block created or
+    *  modified, and removes the objects which the block removed, see @ref read_replica_set. Still, every replica
+    *  holds a full copy of all objects, including the ones of the plugins, so each replica needs about as much
+    *  memory as the chain state of the primary.
+    *
+    *  The replica is only touched by its own thread, except for copying the state of the primary, which is done
+    *  by the thread of the primary before the replica thread uses the copy.
+    *
+    *  When the replica can not apply the changes of a block, e.g. because the primary popped a block which was
+    *  part of the copy, it copies the state again. The copy is made by a task on the thread of the primary,
+    *  between blocks and without the pending transactions, and the primary does not apply blocks meanwhile.
+    *  Repeated copies are spaced out by growing intervals.
+    */
+   class read_replica
+   {
+      public:
+         read_replica( graphene::chain::database& primary, const application_options* app_options,
+                       uint32_t number );
+         ~read_replica();
+
+         /// Runs @p f with the database API of the replica on the replica thread, the caller yields while waiting
+         template<typename Fn>
+         auto run( Fn&& f ) -> decltype( f( std::declval<database_api_impl&>() ) )
+         {
+            return _thread.async( [this,&f]() {
+               const call_timer timer( *this );
+               return f( *_api );
+            }, "read replica call" ).wait();
+         }
+
+         /// Runs @p f with the database of the replica on the replica thread, the caller yields while waiting
+         template<typename Fn>
+         auto run_with_database( Fn&& f ) -> decltype( f( std::declval<graphene::chain::database&>() ) )
+         {
+            return _thread.async( [this,&f]() {
+               const call_timer timer( *this );
+               return f( *_db );
+            }, "read replica call" ).wait();
+         }
+
+         /**
+          * Called on the thread of the primary for every block it applies
+          * @param changes the changes of the objects made by the block, null if they could not be copied
+          */
+         void on_block_changes_applied( const graphene::chain::block_id_type& previous, uint32_t block_num,
+                                        const std::shared_ptr<const graphene::db::object_changes>& changes );
+
+         /// Number of the last block applied by the replica
+         uint32_t head_block_num()const { return _head_block_num; }
+
+         void add_metrics( read_replica_metrics& metrics )const;
+
+      private:
+         struct call_timer
+         {
+            explicit call_timer( read_replica& r ) : replica( r ), start( fc::time_point::now() ) {}
+            ~call_timer()
+            {
+               ++replica._calls;
+               replica._call_microseconds += ( fc::time_point::now() - start ).count();
+            }
+            read_replica&        replica;
+            const fc::time_point start;
+         };
+
+         enum class sync_state { following, failed, resync_scheduled };
+
+         /// Creates a copy of the primary, called on the thread of the primary
+         std::shared_ptr<graphene::chain::database> copy_primary()const;
+         /// Replaces the state of the replica, called on the replica thread
+         void install( std::shared_ptr<graphene::chain::database> db );
+         /// Schedules a copy of the state after a failure, called on the thread of the primary
+         void schedule_resync();
+         /// Copies the state again and installs the copy, a task on the thread of the primary
+         void resync();
+         /// Applies the changes of a block of the primary, called on the replica thread
+         void follow( const graphene::chain::block_id_type& previous, uint32_t block_num,
+                      const std::shared_ptr<const graphene::db::object_changes>& changes );
+
+         graphene::chain::database&                 _primary;
+         const application_options* const           _app_options;
+         fc::thread                                 _thread;
+         std::shared_ptr<graphene::chain::database> _db;
+         std::shared_ptr<database_api_impl>         _api;
+         /// The resync task and its rate limit, only used on the thread of the primary. The first copy after the
+         /// construction is not delayed.
+         fc::future<void>                           _resync_done;
+         fc::time_point                             _last_resync;
+         fc::microseconds                           _resync_interval;
+
+         std::atomic<sync_state>                    _state { sync_state::following };
+         std::atomic<uint32_t>                      _head_block_num { 0 };
+         std::atomic<uint64_t>                      _calls { 0 };
+         std::atomic<uint64_t>                      _call_microseconds { 0 };
+         std::atomic<uint64_t>                      _blocks { 0 };
+         std::atomic<uint64_t>                      _apply_microseconds { 0 };
+         std::atomic<uint64_t>                      _resyncs { 0 };
+   };
+
+   /**
+    *  Read replicas which API calls are distributed to in turn. After each block the set copies the objects which
+    *  the block changed once, on the thread of the primary, and all replicas apply the same copy.
+    */
+   class read_replica_set
+   {
+      public:
+         /// Creates @p count replicas of @p primary, which must not be modified meanwhile
+         read_replica_set( graphene::chain::database& primary, const application_options* app_options,
+                           uint16_t count );
+
+         /// Runs @p f with the database API of the next replica on its thread, see @ref read_replica::run
+         template<typename Fn>
+         auto run( Fn&& f ) -> decltype( f( std::declval<database_api_impl&>() ) )
+         {
+            return _replicas[ _next_replica++ % _replicas.size() ]->run( std::forward<Fn>( f ) );
+         }
+
+         /// Runs @p f with the database of the next replica on its thread, see @ref read_replica::run_with_database
+         template<typename Fn>
+         auto run_with_database( Fn&& f ) -> decltype( f( std::declval<graphene::chain::database&>() ) )
+         {
+            return _replicas[ _next_replica++ % _replicas.size() ]->run_with_database( std::forward<Fn>( f ) );
+         }
+
+         read_replica_metrics get_metrics()const;
+
+      private:
+         /// Copies the changes of a block and hands them to the replicas, called on the thread of the primary
+         void on_block_changes_applied( const graphene::chain::signed_block& block );
+
+         graphene::chain::database&                   _primary;
+         std::vector< std::unique_ptr<read_replica> > _replicas;
+         std::atomic<uint32_t>                        _next_replica { 0 };
+         boost::signals2::scoped_connection           _block_changes_connection;
+   };
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::read_replica_metrics,
+            (replicas)(lag)(calls)(call_microseconds)(blocks)(apply_microseconds)(resyncs) )
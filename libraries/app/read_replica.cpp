@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/app/read_replica.hpp>
+
+#include "database_api_impl.hxx"
+
+#include <graphene/account_history/account_history_plugin.hpp>
+#include <graphene/api_helper_indexes/api_helper_indexes.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/proposal_object.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace app {
+
+namespace {
+
+   /// The time between two copies of the state, doubled for every copy until the replica follows for a while
+   const int64_t min_resync_interval_seconds = 5;
+   const int64_t max_resync_interval_seconds = 300;
+
+   /// Adds a secondary index which the APIs use to the replica, if the primary database has it
+   template<typename PrimaryIndex, typename SecondaryIndex>
+   SecondaryIndex* mirror_secondary_index( const graphene::chain::database& primary,
+                                           graphene::chain::database& replica )
+   {
+      try
+      {
+         primary.get_index_type<PrimaryIndex>().template get_secondary_index<SecondaryIndex>();
+      }
+      catch( const fc::assert_exception& )
+      {
+         return nullptr;
+      }
+      return replica.add_secondary_index<PrimaryIndex, SecondaryIndex>();
+   }
+
+}
+
+read_replica::read_replica( graphene::chain::database& primary, const application_options* app_options,
+                            uint32_t number )
+: _primary( primary ), _app_options( app_options ), _thread( "read replica " + fc::to_string( number ) ),
+  _resync_interval( fc::seconds( min_resync_interval_seconds ) )
+{
+   const fc::time_point start = fc::time_point::now();
+   auto db = copy_primary();
+   _head_block_num = db->head_block_num();
+   // calls and the changes of later blocks are queued behind the installation
+   _thread.async( [this,db]() { install( db ); }, "read replica install" );
+   ilog( "Read replica ${n} copied the state at block ${b} in ${ms} ms",
+         ("n", number)("b", _head_block_num.load())("ms", ( fc::time_point::now() - start ).count() / 1000) );
+}
+
+read_replica::~read_replica()
+{
+   try
+   {
+      if( _resync_done.valid() && !_resync_done.ready() )
+         _resync_done.cancel_and_wait( "read replica destroyed" );
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "Read replica resync ended with: ${e}", ("e", e.to_detail_string()) );
+   }
+   _thread.async( [this]() {
+      _api.reset();
+      _db.reset();
+   }, "read replica shutdown" ).wait();
+   _thread.quit();
+}
+
+std::shared_ptr<graphene::chain::database> read_replica::copy_primary()const
+{
+   using namespace graphene::chain;
+   auto db = std::make_shared<database>();
+   // the indexes of the plugins are needed before their secondary indexes can be mirrored
+   db->add_missing_indexes_from( _primary );
+   mirror_secondary_index< primary_index<account_index, 20>, account_member_index >( _primary, *db );
+   mirror_secondary_index< primary_index<proposal_index>, required_approval_index >( _primary, *db );
+   mirror_secondary_index< primary_index<call_order_index>,
+                           graphene::api_helper_indexes::amount_in_collateral_index >( _primary, *db );
+   mirror_secondary_index< primary_index<liquidity_pool_index>,
+                           graphene::api_helper_indexes::asset_in_liquidity_pools_index >( _primary, *db );
+   auto* history_by_type = mirror_secondary_index< primary_index<account_history_index>,
+                              graphene::account_history::account_history_by_type_index >( _primary, *db );
+   db->copy_state_from( _primary );
+   // the index is only maintained after it is built, since the objects are copied in parallel
+   if( history_by_type != nullptr )
+      history_by_type->rebuild( *db );
+   return db;
+}
+
+void read_replica::install( std::shared_ptr<graphene::chain::database> db )
+{
+   _api.reset();
+   _db = std::move( db );
+   _api = std::make_shared<database_api_impl>( *_db, _app_options );
+   _head_block_num = _db->head_block_num();
+}
+
+void read_replica::on_block_changes_applied( const graphene::chain::block_id_type& previous, uint32_t block_num,
+                                             const std::shared_ptr<const graphene::db::object_changes>& changes )
+{
+   if( !changes && _state == sync_state::following )
+      _state = sync_state::failed;
+   if( _state == sync_state::failed )
+   {
+      // the copy is made after this block, so it includes the block
+      schedule_resync();
+      return;
+   }
+   // While a resync is scheduled the changes are queued anyway, since the copy may have been made already and
+   // only wait for its installation. Changes which are queued before the installation are skipped.
+   _thread.async( [this,previous,block_num,changes]() { follow( previous, block_num, changes ); },
+                  "read replica follow" );
+}
+
+void read_replica::schedule_resync()
+{
+   sync_state expected = sync_state::failed;
+   if( !_state.compare_exchange_strong( expected, sync_state::resync_scheduled ) )
+      return;
+   // Copying the state inside the applied_block signal would block the primary, and the copy could include a block
+   // which a failing fork switch undoes. The task runs after the primary has finished pushing the block instead.
+   const fc::time_point now = fc::time_point::now();
+   if( now - _last_resync >= fc::seconds( max_resync_interval_seconds ) )
+      _resync_interval = fc::seconds( min_resync_interval_seconds );
+   _resync_done = fc::schedule( [this]() { resync(); }, std::max( now, _last_resync + _resync_interval ),
+                                "read replica resync" );
+   _resync_interval = std::min( fc::microseconds( _resync_interval.count() * 2 ),
+                                fc::microseconds( fc::seconds( max_resync_interval_seconds ) ) );
+}
+
+void read_replica::resync()
+{
+   _last_resync = fc::time_point::now();
+   ++_resyncs;
+   std::shared_ptr<graphene::chain::database> db;
+   try
+   {
+      _primary.with_head_block_state( [this,&db]() { db = copy_primary(); } );
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "Read replica failed to copy the state: ${e}", ("e", e.to_detail_string()) );
+      _state = sync_state::failed;
+      return;
+   }
+   // Blocks which are queued before the new state is installed are skipped, the ones which are queued after it
+   // are applied on top of it.
+   _thread.async( [this,db]() {
+      install( db );
+      _state = sync_state::following;
+   }, "read replica install" );
+}
+
+void read_replica::follow( const graphene::chain::block_id_type& previous, uint32_t block_num,
+                           const std::shared_ptr<const graphene::db::object_changes>& changes )
+{
+   if( _state != sync_state::following || !changes )
+      return;
+   const fc::time_point start = fc::time_point::now();
+   try
+   {
+      _db->apply_replicated_changes( previous, *changes );
+      _head_block_num = block_num;
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "Read replica failed to apply the changes of block ${n}, copying the state again: ${e}",
+            ("n", block_num)("e", e.to_detail_string()) );
+      _state = sync_state::failed;
+   }
+   ++_blocks;
+   _apply_microseconds += ( fc::time_point::now() - start ).count();
+}
+
+void read_replica::add_metrics( read_replica_metrics& metrics )const
+{
+   ++metrics.replicas;
+   metrics.calls += _calls;
+   metrics.call_microseconds += _call_microseconds;
+   metrics.blocks += _blocks;
+   metrics.apply_microseconds += _apply_microseconds;
+   metrics.resyncs += _resyncs;
+}
+
+read_replica_set::read_replica_set( graphene::chain::database& primary, const application_options* app_options,
+                                    uint16_t count )
+: _primary( primary )
+{
+   FC_ASSERT( count > 0, "At least one read replica is needed" );
+   _replicas.reserve( count );
+   for( uint16_t i = 0; i < count; ++i )
+      _replicas.emplace_back( std::make_unique<read_replica>( primary, app_options, i ) );
+   _block_changes_connection = _primary.block_changes_applied.connect(
+         [this]( const graphene::chain::signed_block& b ) { on_block_changes_applied( b ); } );
+}
+
+void read_replica_set::on_block_changes_applied( const graphene::chain::signed_block& block )
+{
+   std::shared_ptr<const graphene::db::object_changes> changes;
+   if( _primary._undo_db.enabled() )
+   {
+      try
+      {
+         changes = std::make_shared<const graphene::db::object_changes>( _primary.copy_head_changes() );
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "Failed to copy the changes of block ${n} for the read replicas: ${e}",
+               ("n", block.block_num())("e", e.to_detail_string()) );
+      }
+   }
+   const uint32_t block_num = block.block_num();
+   for( const auto& replica : _replicas )
+      replica->on_block_changes_applied( block.previous, block_num, changes );
+}
+
+read_replica_metrics read_replica_set::get_metrics()const
+{
+   read_replica_metrics metrics;
+   const uint32_t head = _primary.head_block_num();
+   for( const auto& replica : _replicas )
+   {
+      replica->add_metrics( metrics );
+      if( head > replica->head_block_num() )
+         metrics.lag = std::max( metrics.lag, head - replica->head_block_num() );
+   }
+   return metrics;
+}
+
+} } // graphene::app
@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "subscription_fanout.hxx"
+
+#include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/market_object.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <graphene/net/config.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+namespace graphene { namespace app {
+
+using namespace graphene::chain;
+
+subscription_fanout::subscription_fanout( database& db )
+:_db(db)
+{
+   _new_connection = _db.new_objects.connect([this](const vector<object_id_type>& ids,
+                                                    const flat_set<account_id_type>& impacted_accounts) {
+                                on_objects_new(ids, impacted_accounts);
+                                });
+   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids,
+                                                           const flat_set<account_id_type>& impacted_accounts) {
+                                on_objects_changed(ids, impacted_accounts);
+                                });
+   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type>& ids,
+                                                            const vector<const object*>& objs,
+                                                            const flat_set<account_id_type>& impacted_accounts) {
+                                on_objects_removed(ids, objs, impacted_accounts);
+                                });
+   _applied_block_connection = _db.applied_block.connect([this](const signed_block&){ on_applied_block(); });
+}
+
+std::shared_ptr<subscription_fanout> subscription_fanout::get_instance( database& db )
+{
+   static std::mutex instances_mutex;
+   static std::map< const database*, std::weak_ptr<subscription_fanout> > instances;
+
+   std::lock_guard<std::mutex> guard( instances_mutex );
+   for( auto itr = instances.begin(); itr != instances.end(); )
+   {
+      if( itr->second.expired() )
+         itr = instances.erase( itr );
+      else
+         ++itr;
+   }
+   std::shared_ptr<subscription_fanout> result = instances[&db].lock();
+   if( !result )
+   {
+      result = std::make_shared<subscription_fanout>( db );
+      instances[&db] = result;
+   }
+   return result;
+}
+
+subscription_fanout::subscriber_state* subscription_fanout::find_state( const subscriber* s )
+{
+   auto itr = _subscribers.find( s );
+   return itr != _subscribers.end() ? &itr->second : nullptr;
+}
+
+const subscription_fanout::subscriber_state* subscription_fanout::find_state( const subscriber* s )const
+{
+   auto itr = _subscribers.find( s );
+   return itr != _subscribers.end() ? &itr->second : nullptr;
+}
+
+void subscription_fanout::add_subscriber( const std::shared_ptr<subscriber>& s )
+{
+   FC_ASSERT( s, "Internal error" );
+   _subscribers[s.get()].handle = s;
+}
+
+void subscription_fanout::remove_subscriber( const subscriber* s )
+{
+   auto itr = _subscribers.find( s );
+   if( itr == _subscribers.end() )
+      return;
+   remove_from_indexes( s, itr->second, true );
+   _subscribers.erase( itr );
+}
+
+void subscription_fanout::remove_from_indexes( const subscriber* s, subscriber_state& state, bool markets )
+{
+   const auto remove_from = [s]( auto& index, const auto& key ) {
+      auto itr = index.find( key );
+      if( itr == index.end() )
+         return;
+      itr->second.erase( s );
+      if( itr->second.empty() )
+         index.erase( itr );
+   };
+
+   for( const auto& id : state.objects )
+      remove_from( _object_subscribers, id );
+   state.objects.clear();
+   state.overflow_objects.reset();
+   _overflowing_subscribers.erase( s );
+
+   for( const auto& account : state.accounts )
+      remove_from( _account_subscribers, account );
+   state.accounts.clear();
+
+   state.notify_remove_create = false;
+   _remove_create_subscribers.erase( s );
+
+   if( markets )
+   {
+      for( const auto& market : state.markets )
+         remove_from( _market_subscribers, market );
+      state.markets.clear();
+   }
+}
+
+void subscription_fanout::set_notify_remove_create( const subscriber* s, bool notify )
+{
+   subscriber_state* state = find_state( s );
+   if( state == nullptr )
+      return;
+   state->notify_remove_create = notify;
+   if( notify )
+      _remove_create_subscribers.insert( s );
+   else
+      _remove_create_subscribers.erase( s );
+}
+
+void subscription_fanout::subscribe_to_object( const subscriber* s, const object_id_type& id )
+{
+   subscriber_state* state = find_state( s );
+   if( state == nullptr )
+      return;
+   if( state->objects.size() < max_indexed_objects_per_subscriber )
+   {
+      if( _object_subscribers[id].insert( s ).second )
+         state->objects.push_back( id );
+      return;
+   }
+
+   auto itr = _object_subscribers.find( id );
+   if( itr != _object_subscribers.end() && itr->second.find( s ) != itr->second.end() )
+      return;
+   if( !state->overflow_objects )
+   {
+      static fc::bloom_parameters param(10000, 1.0/100, 1024*8*8*2);
+      state->overflow_objects = std::make_unique<fc::bloom_filter>( param );
+      _overflowing_subscribers.insert( s );
+   }
+   // Note: different types of object_id<T> could become identical after packed, so always pack object_id_type
+   vector<char> key = fc::raw::pack( id );
+   state->overflow_objects->insert( key.data(), key.size() );
+}
+
+void subscription_fanout::subscribe_to_account( const subscriber* s, const account_id_type& account )
+{
+   subscriber_state* state = find_state( s );
+   if( state == nullptr )
+      return;
+   if( _account_subscribers[account].insert( s ).second )
+      state->accounts.push_back( account );
+}
+
+void subscription_fanout::subscribe_to_market( const subscriber* s, const market_type& market )
+{
+   subscriber_state* state = find_state( s );
+   if( state == nullptr )
+      return;
+   if( _market_subscribers[market].insert( s ).second )
+      state->markets.push_back( market );
+}
+
+void subscription_fanout::unsubscribe_from_market( const subscriber* s, const market_type& market )
+{
+   subscriber_state* state = find_state( s );
+   if( state == nullptr )
+      return;
+   auto itr = std::find( state->markets.begin(), state->markets.end(), market );
+   if( itr == state->markets.end() )
+      return;
+   state->markets.erase( itr );
+   auto sub = _market_subscribers.find( market );
+   sub->second.erase( s );
+   if( sub->second.empty() )
+      _market_subscribers.erase( sub );
+}
+
+void subscription_fanout::cancel_subscriptions( const subscriber* s, bool markets )
+{
+   subscriber_state* state = find_state( s );
+   if( state != nullptr )
+      remove_from_indexes( s, *state, markets );
+}
+
+size_t subscription_fanout::subscribed_account_count( const subscriber* s )const
+{
+   const subscriber_state* state = find_state( s );
+   return state != nullptr ? state->accounts.size() : 0;
+}
+
+void subscription_fanout::on_objects_new( const vector<object_id_type>& ids,
+                                          const flat_set<account_id_type>& impacted_accounts )
+{
+   handle_object_changed( true, true, ids, impacted_accounts,
+      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
+   );
+}
+
+void subscription_fanout::on_objects_changed( const vector<object_id_type>& ids,
+                                              const flat_set<account_id_type>& impacted_accounts )
+{
+   handle_object_changed( false, true, ids, impacted_accounts,
+      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
+   );
+}
+
+void subscription_fanout::on_objects_removed( const vector<object_id_type>& ids,
+                                              const vector<const object*>& objs,
+                                              const flat_set<account_id_type>& impacted_accounts )
+{
+   handle_object_changed( true, false, ids, impacted_accounts,
+      [&objs](object_id_type id) -> const object* {
+         auto it = std::find_if(
+               objs.begin(), objs.end(),
+               [id](const object* o) {return o != nullptr && o->id == id;});
+
+         if (it != objs.end())
+            return *it;
+
+         return nullptr;
+      }
+   );
+}
+
+fc::optional<subscription_fanout::market_type> subscription_fanout::get_order_market( const object& obj )const
+{
+   if( obj.id.is<limit_order_id_type>() )
+      return static_cast<const limit_order_object&>( obj ).get_market();
+   if( obj.id.is<call_order_id_type>() )
+      return static_cast<const call_order_object&>( obj ).get_market();
+   if( obj.id.is<force_settlement_id_type>() )
+   {
+      const auto& order = static_cast<const force_settlement_object&>( obj );
+      asset_id_type backing_id = order.balance.asset_id( _db ).bitasset_data( _db ).options.short_backing_asset;
+      auto market = std::make_pair( order.balance.asset_id, backing_id );
+      if( market.first > market.second ) std::swap( market.first, market.second );
+      return market;
+   }
+   return {};
+}
+
+void subscription_fanout::handle_object_changed( bool creation_or_removal,
+                                                 bool full_object,
+                                                 const vector<object_id_type>& ids,
+                                                 const flat_set<account_id_type>& impacted_accounts,
+                                                 const std::function<const object*(object_id_type id)>& find_object )
+{
+   if( _subscribers.empty() )
+      return;
+
+   // Subscribers to creation and removal, and subscribers to an impacted account, are notified of all objects
+   subscriber_set all_objects;
+   if( creation_or_removal )
+      all_objects = _remove_create_subscribers;
+   for( const auto& account : impacted_accounts )
+   {
+      auto itr = _account_subscribers.find( account );
+      if( itr != _account_subscribers.end() )
+         all_objects.insert( itr->second.begin(), itr->second.end() );
+   }
+
+   std::unordered_map< const subscriber*, vector<variant> > updates;
+   std::unordered_map< const subscriber*, std::map< market_type, vector<variant> > > market_updates;
+   const bool check_markets = !_market_subscribers.empty();
+   vector<const subscriber*> item_subscribers;
+
+   for( const object_id_type& id : ids )
+   {
+      item_subscribers.clear();
+      auto object_itr = _object_subscribers.find( id );
+      if( object_itr != _object_subscribers.end() )
+      {
+         for( const subscriber* s : object_itr->second )
+            if( all_objects.find( s ) == all_objects.end() )
+               item_subscribers.push_back( s );
+      }
+      if( !_overflowing_subscribers.empty() )
+      {
+         vector<char> key = fc::raw::pack( id );
+         for( const subscriber* s : _overflowing_subscribers )
+         {
+            if( all_objects.find( s ) != all_objects.end()
+                  || ( object_itr != _object_subscribers.end() && object_itr->second.find( s ) != object_itr->second.end() ) )
+               continue;
+            if( _subscribers.at( s ).overflow_objects->contains( key.data(), key.size() ) )
+               item_subscribers.push_back( s );
+         }
+      }
+      const bool is_order = check_markets && ( id.is<limit_order_id_type>() || id.is<call_order_id_type>()
+                                               || id.is<force_settlement_id_type>() );
+      if( all_objects.empty() && item_subscribers.empty() && !is_order )
+         continue;
+
+      // the only conversion of this object, shared by all subscribers
+      const object* obj = ( full_object || is_order ) ? find_object( id ) : nullptr;
+      variant update;
+      if( !full_object )
+         update = variant( id, 1 );
+      else if( obj != nullptr )
+         update = obj->to_variant();
+      if( update.is_null() )
+         continue;
+
+      for( const subscriber* s : all_objects )
+         updates[s].push_back( update );
+      for( const subscriber* s : item_subscribers )
+         updates[s].push_back( update );
+
+      if( is_order && obj != nullptr )
+      {
+         const fc::optional<market_type> market = get_order_market( *obj );
+         auto market_itr = market.valid() ? _market_subscribers.find( *market ) : _market_subscribers.end();
+         if( market_itr != _market_subscribers.end() )
+            for( const subscriber* s : market_itr->second )
+               market_updates[s][*market].push_back( update );
+      }
+   }
+
+   if( updates.empty() && market_updates.empty() )
+      return;
+
+   using object_batch = std::pair< std::weak_ptr<subscriber>, variant >;
+   using market_batch = std::tuple< std::weak_ptr<subscriber>, market_type, variant >;
+   auto object_batches = std::make_shared< vector<object_batch> >();
+   auto market_batches = std::make_shared< vector<market_batch> >();
+   object_batches->reserve( updates.size() );
+   for( auto& item : updates )
+      object_batches->emplace_back( _subscribers.at( item.first ).handle, variant( std::move( item.second ) ) );
+   for( auto& item : market_updates )
+      for( auto& market : item.second )
+         market_batches->emplace_back( _subscribers.at( item.first ).handle, market.first,
+                                       variant( std::move( market.second ) ) );
+
+   fc::async([object_batches, market_batches](){
+      for( const auto& batch : *object_batches )
+      {
+         auto s = batch.first.lock();
+         if( s )
+            s->on_object_updates( batch.second );
+      }
+      for( const auto& batch : *market_batches )
+      {
+         auto s = std::get<0>( batch ).lock();
+         if( s )
+            s->on_market_updates( std::get<1>( batch ), std::get<2>( batch ) );
+      }
+   });
+}
+
+/** note: this method cannot yield because it is called in the middle of
+ * apply a block.
+ */
+void subscription_fanout::on_applied_block()
+{
+   if( _subscribers.empty() )
+      return;
+
+   auto block_id = std::make_shared<variant>( _db.head_block_id(), 1 );
+   auto handles = std::make_shared< vector< std::weak_ptr<subscriber> > >();
+   handles->reserve( _subscribers.size() );
+   for( const auto& item : _subscribers )
+      handles->push_back( item.second.handle );
+
+   using market_batch = std::pair< vector< std::weak_ptr<subscriber> >, variant >;
+   auto market_batches = std::make_shared< std::map< market_type, market_batch > >();
+   if( !_market_subscribers.empty() )
+   {
+      map< market_type, vector<pair<operation, operation_result>> > subscribed_markets_ops;
+      for( const optional< operation_history_object >& o_op : _db.get_applied_operations() )
+      {
+         if( !o_op.valid() )
+            continue;
+         const operation_history_object& op = *o_op;
+
+         // order creation and cancellation are sent via the object_changed callback
+         if( op.op.which() != operation::tag<fill_order_operation>::value )
+            continue;
+         const market_type market = op.op.get<fill_order_operation>().get_market();
+         if( _market_subscribers.count( market ) > 0 )
+            // FIXME this may cause fill_order_operation be pushed before order creation
+            subscribed_markets_ops[market].emplace_back( std::make_pair( op.op, op.result ) );
+      }
+      for( auto& item : subscribed_markets_ops )
+      {
+         market_batch& batch = (*market_batches)[item.first];
+         for( const subscriber* s : _market_subscribers.at( item.first ) )
+            batch.first.push_back( _subscribers.at( s ).handle );
+         batch.second = variant( item.second, GRAPHENE_NET_MAX_NESTED_OBJECTS );
+      }
+   }
+
+   fc::async([block_id, handles, market_batches](){
+      for( const auto& handle : *handles )
+      {
+         auto s = handle.lock();
+         if( s )
+            s->on_block_applied( *block_id );
+      }
+      for( const auto& item : *market_batches )
+         for( const auto& handle : item.second.first )
+         {
+            auto s = handle.lock();
+            if( s )
+               s->on_market_updates( item.first, item.second.second );
+         }
+   });
+}
+
+} } // graphene::app
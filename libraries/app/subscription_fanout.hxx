@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/bloom_filter.hpp>
+
+#include <boost/signals2/connection.hpp>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace graphene { namespace app {
+
+/**
+ * Delivers object, market and block notifications to the subscribers of all API connections of one database.
+ *
+ * Every changed object is looked up and converted to a variant at most once per notification, no matter how
+ * many connections are interested in it.  The interested subscribers are found through inverted indexes by
+ * object, account and market, and a single task hands the prebuilt updates to the connections after the
+ * block has been applied, so block application does not slow down as connections are added.
+ */
+class subscription_fanout
+{
+public:
+   using market_type = std::pair<graphene::chain::asset_id_type, graphene::chain::asset_id_type>;
+
+   /// Receives notifications, implemented by the API connections
+   class subscriber
+   {
+   public:
+      virtual ~subscriber() = default;
+      /// @param updates an array of changed objects, or of the IDs of removed objects
+      virtual void on_object_updates( const fc::variant& updates ) = 0;
+      /// @param updates an array of changed orders, or of filled order operations
+      virtual void on_market_updates( const market_type& market, const fc::variant& updates ) = 0;
+      virtual void on_block_applied( const fc::variant& block_id ) = 0;
+   };
+
+   explicit subscription_fanout( graphene::chain::database& db );
+
+   /// @return the instance shared by all API connections of @p db
+   static std::shared_ptr<subscription_fanout> get_instance( graphene::chain::database& db );
+
+   /// Registers @p s, does nothing if it is registered already
+   void add_subscriber( const std::shared_ptr<subscriber>& s );
+   void remove_subscriber( const subscriber* s );
+
+   /// The following do nothing for subscribers which are not registered
+   ///@{
+   void set_notify_remove_create( const subscriber* s, bool notify );
+   void subscribe_to_object( const subscriber* s, const graphene::chain::object_id_type& id );
+   void subscribe_to_account( const subscriber* s, const graphene::chain::account_id_type& account );
+   void subscribe_to_market( const subscriber* s, const market_type& market );
+   void unsubscribe_from_market( const subscriber* s, const market_type& market );
+   /// Cancels the object and account subscriptions of @p s and the creation and removal notifications,
+   /// and optionally its market subscriptions
+   void cancel_subscriptions( const subscriber* s, bool markets );
+   ///@}
+
+   size_t subscribed_account_count( const subscriber* s )const;
+   size_t subscriber_count()const { return _subscribers.size(); }
+
+   /// Number of objects subscribed to by one subscriber which are indexed exactly, further subscriptions are
+   /// tracked in a bloom filter of the subscriber
+   static constexpr size_t max_indexed_objects_per_subscriber = 10000;
+
+private:
+   struct subscriber_state
+   {
+      std::weak_ptr<subscriber>                          handle;
+      bool                                               notify_remove_create = false;
+      std::vector<graphene::chain::object_id_type>       objects;
+      std::vector<graphene::chain::account_id_type>      accounts;
+      std::vector<market_type>                           markets;
+      std::unique_ptr<fc::bloom_filter>                  overflow_objects;
+   };
+
+   struct account_hash
+   {
+      size_t operator()( const graphene::chain::account_id_type& a )const
+      {
+         return std::hash<uint64_t>()( a.instance.value );
+      }
+   };
+
+   struct market_hash
+   {
+      size_t operator()( const market_type& m )const
+      {
+         return std::hash<uint64_t>()( ( m.first.instance.value << 24 ) ^ m.second.instance.value );
+      }
+   };
+
+   using subscriber_set = std::unordered_set<const subscriber*>;
+
+   subscriber_state* find_state( const subscriber* s );
+   const subscriber_state* find_state( const subscriber* s )const;
+   void remove_from_indexes( const subscriber* s, subscriber_state& state, bool markets );
+
+   void on_objects_new( const std::vector<graphene::chain::object_id_type>& ids,
+                        const boost::container::flat_set<graphene::chain::account_id_type>& impacted_accounts );
+   void on_objects_changed( const std::vector<graphene::chain::object_id_type>& ids,
+                            const boost::container::flat_set<graphene::chain::account_id_type>& impacted_accounts );
+   void on_objects_removed( const std::vector<graphene::chain::object_id_type>& ids,
+                            const std::vector<const graphene::chain::object*>& objs,
+                            const boost::container::flat_set<graphene::chain::account_id_type>& impacted_accounts );
+   void on_applied_block();
+
+   void handle_object_changed( bool creation_or_removal,
+                               bool full_object,
+                               const std::vector<graphene::chain::object_id_type>& ids,
+                               const boost::container::flat_set<graphene::chain::account_id_type>& impacted_accounts,
+                               const std::function<const graphene::chain::object*(graphene::chain::object_id_type)>&
+                                  find_object );
+   fc::optional<market_type> get_order_market( const graphene::chain::object& obj )const;
+
+   graphene::chain::database& _db;
+
+   std::unordered_map<const subscriber*, subscriber_state>                        _subscribers;
+   std::unordered_map<graphene::chain::object_id_type, subscriber_set>            _object_subscribers;
+   std::unordered_map<graphene::chain::account_id_type, subscriber_set, account_hash> _account_subscribers;
+   std::unordered_map<market_type, subscriber_set, market_hash>                   _market_subscribers;
+   subscriber_set                                                                 _remove_create_subscribers;
+   /// subscribers whose object subscriptions do not all fit into the index
+   subscriber_set                                                                 _overflowing_subscribers;
+
+   boost::signals2::scoped_connection _new_connection;
+   boost::signals2::scoped_connection _change_connection;
+   boost::signals2::scoped_connection _removed_connection;
+   boost::signals2::scoped_connection _applied_block_connection;
+};
+
+} } // graphene::app
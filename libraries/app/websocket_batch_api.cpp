@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "websocket_batch_api.hxx"
+
+#include <fc/io/json.hpp>
+
+#include <cctype>
+
+namespace graphene { namespace app {
+
+namespace {
+
+   /// JSON-RPC error codes
+   constexpr int64_t parse_error = -32700;
+   constexpr int64_t invalid_request = -32600;
+   constexpr int64_t internal_error = -32603;
+
+   /// Whether the first character of @p message which is not white space opens an array
+   bool is_batch( const std::string& message )
+   {
+      for( const char c : message )
+      {
+         if( 0 == std::isspace( static_cast<unsigned char>( c ) ) )
+            return c == '[';
+      }
+      return false;
+   }
+
+   /// Whether a response is to be sent, which is not the case for calls without an ID
+   bool has_content( const fc::rpc::response& response )
+   {
+      return response.id || response.result || response.error || response.jsonrpc;
+   }
+
+   fc::rpc::response make_error( const fc::variant& id, int64_t code, const std::string& message )
+   {
+      fc::rpc::error_object error;
+      error.code = code;
+      error.message = message;
+      fc::rpc::response response;
+      response.id = id;
+      response.jsonrpc = "2.0";
+      response.error = error;
+      return response;
+   }
+
+   /// Sets the HTTP status of a single response like the base class does
+   void set_http_status( const fc::rpc::response& response, fc::http::reply& result )
+   {
+      if( !response.error )
+         return;
+      if( response.error->code == internal_error )
+         result.status = fc::http::reply::InternalServerError;
+      else if( response.error->code <= invalid_request )
+         result.status = fc::http::reply::BadRequest;
+   }
+
+   /// Keeps the API of a connection in batch mode while it exists
+   struct batch_scope
+   {
+      explicit batch_scope( login_api& l ) : login( l ) { login.begin_batch(); }
+      ~batch_scope() { login.end_batch(); }
+      login_api& login;
+   };
+
+}
+
+websocket_batch_api_connection::websocket_batch_api_connection( const fc::http::websocket_connection_ptr& c,
+                                                                uint32_t max_conversion_depth,
+                                                                std::shared_ptr<login_api> login,
+                                                                uint32_t max_batch_calls )
+: fc::rpc::websocket_api_connection( c, max_conversion_depth ),
+  _login( std::move( login ) ),
+  _max_batch_calls( max_batch_calls )
+{
+   // The handlers replace the ones of the base class, which reject arrays. Single calls are still passed to it.
+   _connection->on_message_handler( [this]( const std::string& message ) {
+      auto send = [this]( const fc::rpc::response& response ) {
+         if( _connection && has_content( response ) )
+            _connection->send_message( to_json( response ) );
+      };
+      if( !is_batch( message ) )
+      {
+         send( on_message( message ) );
+         return;
+      }
+      const auto batch_error = on_batch( message, send );
+      if( batch_error )
+         send( *batch_error );
+   } );
+   _connection->on_http_handler( [this]( const std::string& message ) {
+      fc::http::reply result;
+      if( !is_batch( message ) )
+      {
+         const fc::rpc::response response = on_message( message );
+         set_http_status( response, result );
+         if( has_content( response ) )
+            result.body_as_string = to_json( response );
+         else
+            result.status = fc::http::reply::NoContent;
+         return result;
+      }
+      fc::variants responses;
+      const auto batch_error = on_batch( message, [this,&responses]( const fc::rpc::response& response ) {
+         responses.emplace_back( response, _max_conversion_depth );
+      } );
+      if( batch_error )
+      {
+         set_http_status( *batch_error, result );
+         result.body_as_string = to_json( *batch_error );
+      }
+      else if( responses.empty() )
+         result.status = fc::http::reply::NoContent;
+      else
+         result.body_as_string = fc::json::to_string( responses, fc::json::stringify_large_ints_and_doubles,
+                                                      _max_conversion_depth );
+      return result;
+   } );
+}
+
+optional<fc::rpc::response> websocket_batch_api_connection::on_batch( const std::string& message,
+      const std::function<void(const fc::rpc::response&)>& on_response )
+{
+   fc::variants calls;
+   try
+   {
+      calls = fc::json::from_string( message, fc::json::legacy_parser, _max_conversion_depth ).get_array();
+   }
+   catch( const fc::exception& e )
+   {
+      return make_error( fc::variant(), parse_error, e.to_string() );
+   }
+   if( calls.empty() )
+      return make_error( fc::variant(), invalid_request, "Empty batch" );
+   if( calls.size() > _max_batch_calls )
+      return make_error( fc::variant(), invalid_request,
+                         "Too many calls in batch, at most " + std::to_string( _max_batch_calls ) + " are allowed" );
+
+   const batch_scope scope( *_login );
+   for( const fc::variant& call : calls )
+   {
+      if( !call.is_object() || !call.get_object().contains( "method" ) )
+      {
+         on_response( make_error( fc::variant(), invalid_request, "Invalid request" ) );
+         continue;
+      }
+      const fc::variant_object& call_object = call.get_object();
+      fc::rpc::response response;
+      try
+      {
+         response = on_request( call );
+      }
+      catch( const fc::exception& e )
+      {
+         response = make_error( call_object.contains( "id" ) ? call_object["id"] : fc::variant(), internal_error,
+                                e.to_string() );
+      }
+      if( has_content( response ) )
+         on_response( response );
+      // the connection may have been closed while a call was waiting
+      if( !_connection )
+         break;
+   }
+   return {};
+}
+
+std::string websocket_batch_api_connection::to_json( const fc::rpc::response& response )const
+{
+   return fc::json::to_string( fc::variant( response, _max_conversion_depth ),
+                               fc::json::stringify_large_ints_and_doubles, _max_conversion_depth );
+}
+
+} } // graphene::app
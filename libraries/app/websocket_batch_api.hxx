@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/api.hpp>
+
+#include <fc/rpc/websocket_api.hpp>
+
+namespace graphene { namespace app {
+
+/**
+ * A websocket or HTTP API connection which also accepts JSON-RPC batches, i.e. arrays of calls in one message.
+ *
+ * The calls of a batch run one after another without waiting for other messages, and the database API of the
+ * connection serves them from the chain database, see @ref database_api::begin_batch. Over websocket the
+ * response to each call is sent as soon as the call completes, over HTTP the responses are returned as an array.
+ * As defined by JSON-RPC, calls without an ID get no response.
+ */
+class websocket_batch_api_connection : public fc::rpc::websocket_api_connection
+{
+   public:
+      websocket_batch_api_connection( const fc::http::websocket_connection_ptr& c, uint32_t max_conversion_depth,
+                                      std::shared_ptr<login_api> login, uint32_t max_batch_calls );
+
+   private:
+      /**
+       * Runs the calls of a batch and passes each response which is to be sent to @p on_response
+       * @return an error response if @p message is not a valid batch, in which case no call is run
+       */
+      optional<fc::rpc::response> on_batch( const std::string& message,
+                                            const std::function<void(const fc::rpc::response&)>& on_response );
+
+      std::string to_json( const fc::rpc::response& response )const;
+
+      const std::shared_ptr<login_api> _login;
+      const uint32_t                   _max_batch_calls;
+};
+
+} } // graphene::app
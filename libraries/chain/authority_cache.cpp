@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/authority_cache.hpp>
+
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/custom_authority_object.hpp>
+#include <graphene/chain/database.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+   /// Drops cached results when an account or a custom authority changes
+   class authority_observer : public graphene::db::index_observer
+   {
+      public:
+         authority_observer( authority_cache& cache, bool custom ) : _cache( cache ), _custom( custom ) {}
+
+         void on_add( const object& obj ) override
+         {
+            // a new account can not be part of a cached result
+            if( _custom )
+               _cache.invalidate( static_cast<const custom_authority_object&>( obj ).account );
+         }
+         void on_remove( const object& obj ) override { changed( obj ); }
+         void on_modify( const object& obj ) override { changed( obj ); }
+
+      private:
+         void changed( const object& obj )
+         {
+            if( _custom )
+               _cache.invalidate( static_cast<const custom_authority_object&>( obj ).account );
+            else
+               _cache.invalidate( account_id_type( obj.id ) );
+         }
+
+         authority_cache& _cache;
+         const bool       _custom;
+   };
+
+   template<typename Stream>
+   void pack_key( Stream& s, const flat_set<public_key_type>& keys, const flat_set<account_id_type>& active,
+                  const flat_set<account_id_type>& owner, const vector<authority>& other,
+                  bool allow_non_immediate_owner, uint32_t max_recursion )
+   {
+      fc::raw::pack( s, keys );
+      fc::raw::pack( s, active );
+      fc::raw::pack( s, owner );
+      fc::raw::pack( s, other );
+      fc::raw::pack( s, allow_non_immediate_owner );
+      fc::raw::pack( s, max_recursion );
+   }
+
+}
+
+void authority_cache::set_max_size( size_t entries )
+{
+   _max_size = entries;
+   if( _results.size() > _max_size )
+      clear();
+}
+
+void authority_cache::attach( graphene::db::index& account_index, graphene::db::index& custom_authority_index )
+{
+   clear();
+   account_index.add_observer( std::make_shared<authority_observer>( *this, false ) );
+   custom_authority_index.add_observer( std::make_shared<authority_observer>( *this, true ) );
+}
+
+void authority_cache::verify_authority( const database& db, const signed_transaction& trx,
+                                        bool allow_non_immediate_owner, bool ignore_custom_operation_required_auths,
+                                        uint32_t max_recursion )
+{
+   const fc::time_point start = fc::time_point::now();
+   const chain_id_type& chain_id = db.get_chain_id();
+   auto get_custom = [&db]( account_id_type id, const operation& op, rejected_predicate_map* rejects ) {
+      return db.get_viable_custom_authorities( id, op, rejects );
+   };
+
+   flat_set<account_id_type> required_active;
+   flat_set<account_id_type> required_owner;
+   vector<authority> other;
+   for( const auto& op : trx.operations )
+      operation_get_required_authorities( op, required_active, required_owner, other,
+                                          ignore_custom_operation_required_auths );
+
+   const auto& custom_auths = db.get_index_type<custom_authority_index>().indices().get<by_account_custom>();
+   const bool cacheable = _max_size > 0
+         && std::none_of( required_active.begin(), required_active.end(), [&custom_auths]( account_id_type id ) {
+               const auto itr = custom_auths.lower_bound( boost::make_tuple( id ) );
+               return itr != custom_auths.end() && itr->account == id;
+            });
+   if( !cacheable )
+   {
+      auto get_active = [&db]( account_id_type id ) { return &id(db).active; };
+      auto get_owner  = [&db]( account_id_type id ) { return &id(db).owner;  };
+      trx.verify_authority( chain_id, get_active, get_owner, get_custom, allow_non_immediate_owner,
+                            ignore_custom_operation_required_auths, max_recursion );
+      ++_metrics.uncacheable;
+      _metrics.miss_microseconds += ( fc::time_point::now() - start ).count();
+      return;
+   }
+
+   const flat_set<public_key_type>& keys = trx.get_signature_keys( chain_id );
+   fc::datastream<size_t> size_stream;
+   pack_key( size_stream, keys, required_active, required_owner, other, allow_non_immediate_owner, max_recursion );
+   std::string key( size_stream.tellp(), '\0' );
+   fc::datastream<char*> key_stream( &key[0], key.size() );
+   pack_key( key_stream, keys, required_active, required_owner, other, allow_non_immediate_owner, max_recursion );
+
+   if( _results.find( key ) != _results.end() )
+   {
+      ++_metrics.hits;
+      _metrics.hit_microseconds += ( fc::time_point::now() - start ).count();
+      return;
+   }
+
+   // the result depends on every account whose authorities are read
+   flat_set<account_id_type> accounts( required_active.begin(), required_active.end() );
+   accounts.insert( required_owner.begin(), required_owner.end() );
+   auto get_active = [&db,&accounts]( account_id_type id ) {
+      accounts.insert( id );
+      return &id(db).active;
+   };
+   auto get_owner = [&db,&accounts]( account_id_type id ) {
+      accounts.insert( id );
+      return &id(db).owner;
+   };
+   trx.verify_authority( chain_id, get_active, get_owner, get_custom, allow_non_immediate_owner,
+                         ignore_custom_operation_required_auths, max_recursion );
+   insert( std::move( key ), std::move( accounts ) );
+   ++_metrics.misses;
+   _metrics.miss_microseconds += ( fc::time_point::now() - start ).count();
+}
+
+void authority_cache::insert( std::string&& key, flat_set<account_id_type>&& accounts )
+{
+   if( _results.size() >= _max_size )
+      clear();
+   const auto result = _results.emplace( std::move( key ), std::move( accounts ) );
+   const std::string* stored_key = &result.first->first;
+   for( const auto& account : result.first->second )
+      _by_account[ account.instance.value ].insert( stored_key );
+}
+
+void authority_cache::invalidate( account_id_type account )
+{
+   const auto itr = _by_account.find( account.instance.value );
+   if( itr == _by_account.end() )
+      return;
+   const std::unordered_set<const std::string*> keys = std::move( itr->second );
+   _by_account.erase( itr );
+   for( const std::string* key : keys )
+   {
+      const auto result = _results.find( *key );
+      for( const auto& other : result->second )
+      {
+         if( other == account )
+            continue;
+         const auto other_itr = _by_account.find( other.instance.value );
+         other_itr->second.erase( key );
+         if( other_itr->second.empty() )
+            _by_account.erase( other_itr );
+      }
+      _results.erase( result );
+      ++_metrics.invalidations;
+   }
+}
+
+void authority_cache::clear()
+{
+   _results.clear();
+   _by_account.clear();
+}
+
+authority_cache_metrics authority_cache::get_metrics()const
+{
+   authority_cache_metrics result = _metrics;
+   result.size = _results.size();
+   return result;
+}
+
+} } // graphene::chain
@@ -23,9 +23,14 @@
  */
 #include <graphene/chain/block_database.hpp>
 #include <graphene/protocol/fee_schedule.hpp>
+#include <fc/interprocess/file_mapping.hpp>
 #include <fc/io/raw.hpp>
 #include <boost/endian/buffers.hpp>
 
+#include <zlib.h>
+
+#include <cstring>
+
 namespace graphene { namespace chain {
 
 struct index_entry
@@ -38,11 +43,132 @@ struct index_entry
    boost::endian::little_uint32_buf_t block_size;
    block_id_type                      block_id;
 };
+
+/// Index entry of a compressed block log
+struct compressed_index_entry
+{
+   compressed_index_entry() {
+      segment_pos = 0;
+      block_offset = 0;
+      block_size = 0;
+      raw_size = 0;
+   };
+   boost::endian::little_uint64_buf_t segment_pos;  ///< position of the segment header in the blocks file
+   boost::endian::little_uint32_buf_t block_offset; ///< position of the block relative to the segment header
+   boost::endian::little_uint32_buf_t block_size;   ///< compressed size of the block, 0 if it was removed
+   boost::endian::little_uint32_buf_t raw_size;     ///< size of the packed block
+   block_id_type                      block_id;
+};
+
+/// Header of a segment of a compressed block log, followed by @c dictionary_size bytes of dictionary
+struct segment_header
+{
+   boost::endian::little_uint32_buf_t magic;
+   boost::endian::little_uint32_buf_t dictionary_size;
+};
+
+/// Location of a block in the blocks file, independent of the on-disk format
+struct block_location
+{
+   uint64_t      block_pos = 0;
+   uint32_t      block_size = 0;
+   uint32_t      raw_size = 0;    ///< 0 if the block is not compressed
+   uint64_t      segment_pos = 0; ///< only valid if the block is compressed
+   block_id_type block_id;
+};
  }}
 FC_REFLECT( graphene::chain::index_entry, (block_pos)(block_size)(block_id) );
 
 namespace graphene { namespace chain {
 
+namespace {
+
+const uint32_t segment_magic = 0x4c425342; // "BSBL"
+/// Size of the deflate window, larger dictionaries are of no use
+const size_t max_dictionary_size = 32 * 1024;
+const int compression_level = 6;
+
+const char* compression_filename = "compression";
+
+std::vector<char> deflate_block( const std::vector<char>& data, const std::vector<char>& dictionary )
+{
+   z_stream strm;
+   std::memset( &strm, 0, sizeof(strm) );
+   // raw deflate streams, the index already records sizes and block ids protect against corruption
+   FC_ASSERT( deflateInit2( &strm, compression_level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY ) == Z_OK );
+   std::vector<char> result;
+   try
+   {
+      if( !dictionary.empty() )
+         FC_ASSERT( deflateSetDictionary( &strm, (const Bytef*)dictionary.data(), (uInt)dictionary.size() ) == Z_OK );
+      result.resize( deflateBound( &strm, (uLong)data.size() ) );
+      strm.next_in = (Bytef*)data.data();
+      strm.avail_in = (uInt)data.size();
+      strm.next_out = (Bytef*)result.data();
+      strm.avail_out = (uInt)result.size();
+      FC_ASSERT( deflate( &strm, Z_FINISH ) == Z_STREAM_END, "Unable to compress block" );
+      result.resize( strm.total_out );
+   }
+   catch( ... )
+   {
+      deflateEnd( &strm );
+      throw;
+   }
+   deflateEnd( &strm );
+   return result;
+}
+
+void inflate_block( const char* data, uint32_t size, const char* dictionary, uint32_t dictionary_size,
+                    std::vector<char>& out, uint32_t raw_size )
+{
+   z_stream strm;
+   std::memset( &strm, 0, sizeof(strm) );
+   FC_ASSERT( inflateInit2( &strm, -15 ) == Z_OK );
+   int status = Z_OK;
+   if( dictionary_size > 0 )
+      status = inflateSetDictionary( &strm, (const Bytef*)dictionary, dictionary_size );
+   if( status == Z_OK )
+   {
+      out.resize( raw_size );
+      strm.next_in = (Bytef*)data;
+      strm.avail_in = size;
+      strm.next_out = (Bytef*)out.data();
+      strm.avail_out = raw_size;
+      status = inflate( &strm, Z_FINISH );
+   }
+   const uLong total_out = strm.total_out;
+   inflateEnd( &strm );
+   FC_ASSERT( status == Z_STREAM_END && total_out == raw_size, "Unable to decompress block" );
+}
+
+} // anonymous namespace
+
+/**
+ * A read-only mapping of the first @c size bytes of a file. Empty files can not be mapped, in that case
+ * @c data() returns nullptr.
+ */
+struct block_database::mapped_file
+{
+   mapped_file( const fc::path& file, uint64_t file_size ) : size( file_size )
+   {
+      if( size == 0 )
+         return;
+      mapping = std::make_unique<fc::file_mapping>( file.generic_string().c_str(), fc::read_only );
+      region = std::make_unique<fc::mapped_region>( *mapping, fc::read_only, 0, size );
+   }
+
+   const char* data()const { return region ? static_cast<const char*>( region->get_address() ) : nullptr; }
+
+   const uint64_t                     size;
+   std::unique_ptr<fc::file_mapping>  mapping;
+   std::unique_ptr<fc::mapped_region> region;
+};
+
+void block_database::enable_compression( uint32_t blocks_per_segment )
+{
+   _new_log_blocks_per_segment = blocks_per_segment;
+}
+
 void block_database::open( const fc::path& dbdir )
 { try {
    fc::create_directories(dbdir);
@@ -50,15 +176,56 @@ void block_database::open( const fc::path& dbdir )
    _blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
 
    _index_filename = dbdir / "index";
+   _blocks_filename = dbdir / "blocks";
+   const fc::path compression_file = dbdir / compression_filename;
    if( !fc::exists( _index_filename ) )
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
+     _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
+     _blocks_per_segment = _new_log_blocks_per_segment;
+     if( _blocks_per_segment > 0 )
+     {
+        std::ofstream out( compression_file.generic_string().c_str(),
+                           std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+        fc::raw::pack( out, _blocks_per_segment );
+     }
+     else if( fc::exists( compression_file ) )
+        fc::remove( compression_file );
    }
    else
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+     _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+     _blocks_per_segment = 0;
+     if( fc::exists( compression_file ) )
+     {
+        std::ifstream in( compression_file.generic_string().c_str(), std::ifstream::binary | std::ifstream::in );
+        fc::raw::unpack( in, _blocks_per_segment );
+        FC_ASSERT( _blocks_per_segment > 0, "Invalid compression settings in block database" );
+     }
+     if( _blocks_per_segment != _new_log_blocks_per_segment )
+        wlog( "Block database in ${dir} is ${c}compressed, keeping its format. Resync to change it.",
+              ("dir",dbdir)("c",_blocks_per_segment > 0 ? "" : "not ") );
+   }
+   _index_entry_size = _blocks_per_segment > 0 ? sizeof(compressed_index_entry) : sizeof(index_entry);
+   _index_size = fc::file_size( _index_filename );
+   _blocks_size = fc::file_size( _blocks_filename );
+   _blocks_read_position = 0;
+   truncate_index();
+
+   // always start a new segment after reopening, seeded with the most recent block
+   _segment_blocks = 0;
+   _segment_dictionary.clear();
+   _next_dictionary.clear();
+   if( _blocks_per_segment > 0 )
+   {
+      optional<signed_block> last_block = last();
+      if( last_block.valid() )
+      {
+         _next_dictionary = fc::raw::pack( *last_block );
+         if( _next_dictionary.size() > max_dictionary_size )
+            _next_dictionary.erase( _next_dictionary.begin(), _next_dictionary.end() - max_dictionary_size );
+      }
    }
 } FC_CAPTURE_AND_RETHROW( (dbdir) ) }
 
@@ -69,8 +236,13 @@ bool block_database::is_open()const
 
 void block_database::close()
 {
+  unmap();
   _blocks.close();
   _block_num_to_pos.close();
+  _index_size = 0;
+  _blocks_size = 0;
+  _segment_dictionary.clear();
+  _next_dictionary.clear();
 }
 
 void block_database::flush()
@@ -79,6 +251,145 @@ void block_database::flush()
   _block_num_to_pos.flush();
 }
 
+void block_database::unmap()const
+{
+   std::lock_guard<std::mutex> guard( _remap_mutex );
+   std::atomic_store( &_index_map, mapped_file_ptr() );
+   std::atomic_store( &_blocks_map, mapped_file_ptr() );
+}
+
+block_database::mapped_file_ptr block_database::get_mapping( mapped_file_ptr& current, const fc::path& file,
+                                                             const std::atomic<uint64_t>& file_size,
+                                                             uint64_t min_size )const
+{
+   mapped_file_ptr result = std::atomic_load( &current );
+   if( result && result->size >= min_size )
+      return result;
+   // Only remap if the file actually has grown, so that lookups past the end stay cheap
+   if( result && result->size >= file_size.load() )
+      return result;
+
+   std::lock_guard<std::mutex> guard( _remap_mutex );
+   result = std::atomic_load( &current ); // another thread may have remapped in the meantime
+   const uint64_t size = file_size.load();
+   if( !result || result->size < size )
+   {
+      result = std::make_shared<mapped_file>( file, size );
+      std::atomic_store( &current, result );
+   }
+   return result;
+}
+
+bool block_database::read_index_entry( uint32_t block_num, block_location& loc )const
+{
+   const uint64_t index_pos = _index_entry_size * uint64_t(block_num);
+   const mapped_file_ptr index = get_mapping( _index_map, _index_filename, _index_size,
+                                              index_pos + _index_entry_size );
+   if( !index || index->size < index_pos + _index_entry_size )
+      return false;
+   if( _blocks_per_segment > 0 )
+   {
+      compressed_index_entry e;
+      std::memcpy( (char*)&e, index->data() + index_pos, sizeof(e) );
+      loc.segment_pos = e.segment_pos.value();
+      loc.block_pos = e.segment_pos.value() + e.block_offset.value();
+      loc.block_size = e.block_size.value();
+      loc.raw_size = e.raw_size.value();
+      loc.block_id = e.block_id;
+   }
+   else
+   {
+      index_entry e;
+      std::memcpy( (char*)&e, index->data() + index_pos, sizeof(e) );
+      loc.block_pos = e.block_pos.value();
+      loc.block_size = e.block_size.value();
+      loc.raw_size = 0;
+      loc.block_id = e.block_id;
+   }
+   return true;
+}
+
+void block_database::write_index_entry( uint32_t block_num, const block_location& loc )
+{
+   _block_num_to_pos.seekp( _index_entry_size * uint64_t(block_num) );
+   if( _blocks_per_segment > 0 )
+   {
+      compressed_index_entry e;
+      e.segment_pos  = loc.segment_pos;
+      e.block_offset = uint32_t( loc.block_pos - loc.segment_pos );
+      e.block_size   = loc.block_size;
+      e.raw_size     = loc.raw_size;
+      e.block_id     = loc.block_id;
+      _block_num_to_pos.write( (char*)&e, sizeof(e) );
+   }
+   else
+   {
+      index_entry e;
+      e.block_pos  = loc.block_pos;
+      e.block_size = loc.block_size;
+      e.block_id   = loc.block_id;
+      _block_num_to_pos.write( (char*)&e, sizeof(e) );
+   }
+}
+
+bool block_database::read_packed_block( const block_location& loc,
+                                        const std::function<void(const char*, size_t)>& reader )const
+{
+   const uint64_t end_pos = loc.block_pos + loc.block_size;
+   const mapped_file_ptr blocks = get_mapping( _blocks_map, _blocks_filename, _blocks_size, end_pos );
+   if( loc.block_size == 0 || !blocks || blocks->size < end_pos )
+      return false;
+
+   if( loc.raw_size == 0 )
+      reader( blocks->data() + loc.block_pos, loc.block_size );
+   else
+   {
+      FC_ASSERT( loc.segment_pos + sizeof(segment_header) <= loc.block_pos );
+      segment_header header;
+      std::memcpy( (char*)&header, blocks->data() + loc.segment_pos, sizeof(header) );
+      FC_ASSERT( header.magic.value() == segment_magic, "Invalid segment in block database" );
+      FC_ASSERT( loc.segment_pos + sizeof(header) + header.dictionary_size.value() <= loc.block_pos );
+
+      // keep the buffer around, reads of the same thread would otherwise allocate for every block
+      static thread_local std::vector<char> raw;
+      inflate_block( blocks->data() + loc.block_pos, loc.block_size,
+                     blocks->data() + loc.segment_pos + sizeof(header), header.dictionary_size.value(),
+                     raw, loc.raw_size );
+      reader( raw.data(), loc.raw_size );
+   }
+   _blocks_read_position = end_pos;
+   return true;
+}
+
+optional<signed_block> block_database::read_block( const block_location& loc )const
+{
+   optional<signed_block> result;
+   if( !read_packed_block( loc, [&result]( const char* data, size_t size ) {
+         fc::datastream<const char*> ds( data, size );
+         result = signed_block();
+         fc::raw::unpack( ds, *result );
+      } ) )
+      return result;
+   FC_ASSERT( result->id() == loc.block_id );
+   return result;
+}
+
+uint64_t block_database::start_segment( uint64_t pos )
+{
+   _segment_dictionary = _next_dictionary;
+   _segment_pos = pos;
+   _segment_blocks = 0;
+
+   segment_header header;
+   header.magic = segment_magic;
+   header.dictionary_size = uint32_t( _segment_dictionary.size() );
+   _blocks.seekp( _segment_pos );
+   _blocks.write( (char*)&header, sizeof(header) );
+   if( !_segment_dictionary.empty() )
+      _blocks.write( _segment_dictionary.data(), _segment_dictionary.size() );
+   return _segment_pos + sizeof(header) + _segment_dictionary.size();
+}
+
 void block_database::store( const block_id_type& _id, const signed_block& b )
 {
    block_id_type id = _id;
@@ -87,33 +398,56 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
       id = b.id();
       elog( "id argument of block_database::store() was not initialized for block ${id}", ("id", id) );
    }
-   _block_num_to_pos.seekp( sizeof( index_entry ) * int64_t(block_header::num_from_id(id)) );
-   index_entry e;
-   _blocks.seekp( 0, _blocks.end );
+   const uint32_t block_num = block_header::num_from_id(id);
    auto vec = fc::raw::pack( b );
-   e.block_pos  = _blocks.tellp();
-   e.block_size = vec.size();
-   e.block_id   = id;
-   _blocks.write( vec.data(), vec.size() );
-   _block_num_to_pos.write( (char*)&e, sizeof(e) );
+
+   block_location loc;
+   loc.block_id = id;
+   if( _blocks_per_segment > 0 )
+   {
+      uint64_t write_pos = _blocks_size.load();
+      if( _segment_blocks == 0 || _segment_blocks >= _blocks_per_segment )
+         write_pos = start_segment( write_pos );
+      const std::vector<char> compressed = deflate_block( vec, _segment_dictionary );
+      loc.segment_pos = _segment_pos;
+      loc.block_pos = write_pos;
+      loc.block_size = uint32_t( compressed.size() );
+      loc.raw_size = uint32_t( vec.size() );
+      _blocks.seekp( loc.block_pos );
+      _blocks.write( compressed.data(), compressed.size() );
+      ++_segment_blocks;
+
+      _next_dictionary.insert( _next_dictionary.end(), vec.begin(), vec.end() );
+      if( _next_dictionary.size() > max_dictionary_size )
+         _next_dictionary.erase( _next_dictionary.begin(), _next_dictionary.end() - max_dictionary_size );
+   }
+   else
+   {
+      _blocks.seekp( 0, _blocks.end );
+      loc.block_pos  = _blocks.tellp();
+      loc.block_size = uint32_t( vec.size() );
+      _blocks.write( vec.data(), vec.size() );
+   }
+   write_index_entry( block_num, loc );
+   // readers only look at the mapped files, so everything has to hit the OS before it is announced
+   flush();
+   _blocks_size = loc.block_pos + loc.block_size;
+   const uint64_t index_end = _index_entry_size * uint64_t(block_num) + _index_entry_size;
+   if( _index_size.load() < index_end )
+      _index_size = index_end;
 }
 
 void block_database::remove( const block_id_type& id )
 { try {
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   block_location loc;
+   if( !read_index_entry( block_header::num_from_id(id), loc ) )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block ${id} not contained in block database", ("id", id));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-   if( e.block_id == id )
+   if( loc.block_id == id )
    {
-      e.block_size = 0;
-      _block_num_to_pos.seekp( sizeof(e) * int64_t(block_header::num_from_id(id)) );
-      _block_num_to_pos.write( (char*)&e, sizeof(e) );
+      loc.block_size = 0;
+      write_index_entry( block_header::num_from_id(id), loc );
+      _block_num_to_pos.flush();
    }
 } FC_CAPTURE_AND_RETHROW( (id) ) }
 
@@ -122,55 +456,35 @@ bool block_database::contains( const block_id_type& id )const
    if( id == block_id_type() )
       return false;
 
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() < int64_t(index_pos + sizeof(e)) )
+   block_location loc;
+   if( !read_index_entry( block_header::num_from_id(id), loc ) )
       return false;
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
 
-   return e.block_id == id && e.block_size.value() > 0;
+   return loc.block_id == id && loc.block_size > 0;
 }
 
 block_id_type block_database::fetch_block_id( uint32_t block_num )const
 {
    assert( block_num != 0 );
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_num);
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   block_location loc;
+   if( !read_index_entry( block_num, loc ) )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block number ${block_num} not contained in block database", ("block_num", block_num));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-   FC_ASSERT( e.block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
-   return e.block_id;
+   FC_ASSERT( loc.block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
+   return loc.block_id;
 }
 
 optional<signed_block> block_database::fetch_optional( const block_id_type& id )const
 {
    try
    {
-      index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
+      block_location loc;
+      if( !read_index_entry( block_header::num_from_id(id), loc ) )
          return {};
 
-      _block_num_to_pos.seekg( index_pos );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-      if( e.block_id != id ) return optional<signed_block>();
+      if( loc.block_id != id ) return optional<signed_block>();
 
-      vector<char> data( e.block_size.value() );
-      _blocks.seekg( e.block_pos.value() );
-      if (e.block_size.value())
-         _blocks.read( data.data(), e.block_size.value() );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
-      return result;
+      return read_block( loc );
    }
    catch (const fc::exception&)
    {
@@ -185,20 +499,33 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
 {
    try
    {
-      index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_num);
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
+      block_location loc;
+      if( !read_index_entry( block_num, loc ) )
          return {};
 
-      _block_num_to_pos.seekg( index_pos, _block_num_to_pos.beg );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
+      return read_block( loc );
+   }
+   catch (const fc::exception&)
+   {
+   }
+   catch (const std::exception&)
+   {
+   }
+   return optional<signed_block>();
+}
+
+optional<std::vector<char>> block_database::fetch_packed_by_number( uint32_t block_num )const
+{
+   try
+   {
+      block_location loc;
+      if( !read_index_entry( block_num, loc ) )
+         return {};
 
-      vector<char> data( e.block_size.value() );
-      _blocks.seekg( e.block_pos.value() );
-      _blocks.read( data.data(), e.block_size.value() );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
+      optional<std::vector<char>> result;
+      read_packed_block( loc, [&result]( const char* data, size_t size ) {
+         result = std::vector<char>( data, data + size );
+      } );
       return result;
    }
    catch (const fc::exception&)
@@ -207,41 +534,28 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
    catch (const std::exception&)
    {
    }
-   return optional<signed_block>();
+   return optional<std::vector<char>>();
 }
 
-optional<index_entry> block_database::last_index_entry()const {
+optional<block_location> block_database::last_index_entry()const {
    try
    {
-      index_entry e;
+      block_location loc;
 
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      std::streampos pos = _block_num_to_pos.tellg();
-      if( pos < long(sizeof(index_entry)) )
-         return optional<index_entry>();
+      uint64_t pos = _index_size.load();
+      if( pos < _index_entry_size )
+         return optional<block_location>();
 
-      pos -= pos % sizeof(index_entry);
+      pos -= pos % _index_entry_size;
 
-      _blocks.seekg( 0, _block_num_to_pos.end );
-      const std::streampos blocks_size = _blocks.tellg();
       while( pos > 0 )
       {
-         pos -= sizeof(index_entry);
-         _block_num_to_pos.seekg( pos );
-         _block_num_to_pos.read( (char*)&e, sizeof(e) );
-         if( _block_num_to_pos.gcount() == sizeof(e) && e.block_size.value() > 0
-                && int64_t(e.block_pos.value() + e.block_size.value()) <= blocks_size )
+         pos -= _index_entry_size;
+         if( read_index_entry( pos / _index_entry_size, loc ) && loc.block_size > 0 )
             try
             {
-               vector<char> data( e.block_size.value() );
-               _blocks.seekg( e.block_pos.value() );
-               _blocks.read( data.data(), e.block_size.value() );
-               if( _blocks.gcount() == long(e.block_size.value()) )
-               {
-                  const signed_block block = fc::raw::unpack<signed_block>(data);
-                  if( block.id() == e.block_id )
-                     return e;
-               }
+               if( read_block( loc ).valid() )
+                  return loc;
             }
             catch (const fc::exception&)
             {
@@ -249,7 +563,6 @@ optional<index_entry> block_database::last_index_entry()const {
             catch (const std::exception&)
             {
             }
-         fc::resize_file( _index_filename, pos );
       }
    }
    catch (const fc::exception&)
@@ -258,32 +571,46 @@ optional<index_entry> block_database::last_index_entry()const {
    catch (const std::exception&)
    {
    }
-   return optional<index_entry>();
+   return optional<block_location>();
+}
+
+void block_database::truncate_index()
+{
+   optional<block_location> entry = last_index_entry();
+   const uint64_t valid_size = entry.valid()
+                               ? _index_entry_size * ( uint64_t( block_header::num_from_id( entry->block_id ) ) + 1 )
+                               : 0;
+   if( valid_size < _index_size.load() )
+   {
+      // The file must not be truncated while it is mapped
+      unmap();
+      fc::resize_file( _index_filename, valid_size );
+      _index_size = valid_size;
+   }
 }
 
 optional<signed_block> block_database::last()const
 {
-   optional<index_entry> entry = last_index_entry();
+   optional<block_location> entry = last_index_entry();
    if( entry.valid() ) return fetch_by_number( block_header::num_from_id(entry->block_id) );
    return optional<signed_block>();
 }
 
 optional<block_id_type> block_database::last_id()const
 {
-   optional<index_entry> entry = last_index_entry();
+   optional<block_location> entry = last_index_entry();
    if( entry.valid() ) return entry->block_id;
    return optional<block_id_type>();
 }
 
 size_t block_database::blocks_current_position()const
 {
-   return (size_t)_blocks.tellg();
+   return (size_t)_blocks_read_position.load();
 }
 
 size_t block_database::total_block_size()const
 {
-   _blocks.seekg( 0, _blocks.end );
-   return (size_t)_blocks.tellg();
+   return (size_t)_blocks_size.load();
 }
 
 } }
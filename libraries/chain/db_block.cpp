@@ -42,9 +42,52 @@
 
 #include <fc/io/raw.hpp>
 #include <fc/thread/parallel.hpp>
+#include <fc/uint128.hpp>
+
+#include <limits>
 
 namespace graphene { namespace chain {
 
+namespace {
+
+   struct operation_fee_visitor
+   {
+      typedef asset result_type;
+
+      template<typename Op>
+      asset operator()( const Op& op )const { return op.fee; }
+   };
+
+   /// @return the fees of @p trx converted to the core asset with the core exchange rates of the fee assets
+   uint64_t get_core_fee( const database& db, const transaction& trx )
+   {
+      fc::uint128_t total = 0;
+      for( const operation& op : trx.operations )
+      {
+         const asset fee = op.visit( operation_fee_visitor() );
+         if( fee.amount <= 0 )
+            continue;
+         if( fee.asset_id == asset_id_type() )
+            total += static_cast<uint64_t>( fee.amount.value );
+         else
+         {
+            try
+            {
+               const asset core_fee = fee * fee.asset_id( db ).options.core_exchange_rate;
+               if( core_fee.asset_id == asset_id_type() && core_fee.amount > 0 )
+                  total += static_cast<uint64_t>( core_fee.amount.value );
+            }
+            catch( const fc::exception& )
+            { // the transaction is rejected later for an invalid fee asset
+            }
+         }
+      }
+      return total > std::numeric_limits<uint64_t>::max() ? std::numeric_limits<uint64_t>::max()
+                                                         : static_cast<uint64_t>( total );
+   }
+
+} // anonymous namespace
+
 bool database::is_known_block( const block_id_type& id )const
 {
    return _fork_db.is_known_block(id) || _block_id_to_block.contains(id);
@@ -82,6 +125,15 @@ optional<signed_block> database::fetch_block_by_number( uint32_t num )const
       return _block_id_to_block.fetch_by_number(num);
 }
 
+optional<std::vector<char>> database::fetch_packed_block_by_number( uint32_t num )const
+{
+   auto results = _fork_db.fetch_block_by_number(num);
+   if( results.size() == 1 )
+      return fc::raw::pack( results[0]->data );
+   else
+      return _block_id_to_block.fetch_packed_by_number(num);
+}
+
 const signed_transaction& database::get_recent_transaction(const transaction_id_type& trx_id) const
 {
    auto& index = get_index_type<transaction_index>().indices().get<by_trx_id>();
@@ -121,7 +173,7 @@ bool database::push_block(const signed_block& new_block, uint32_t skip)
    bool result;
    detail::with_skip_flags( *this, skip, [&]()
    {
-      detail::without_pending_transactions( *this, std::move(_pending_tx),
+      detail::without_pending_transactions( *this, _pending_tx.take_all(),
       [&]()
       {
          result = _push_block(new_block);
@@ -153,6 +205,7 @@ bool database::_push_block(const signed_block& new_block)
       if( new_head->data.block_num() > head_block_num() )
       {
          wlog( "Switching to fork: ${id}", ("id",new_head->data.id()) );
+         const auto switch_start = fc::time_point::now();
          auto branches = _fork_db.fetch_branch_from(new_head->data.id(), head_block_id());
 
          // pop blocks until we hit the forked block
@@ -173,6 +226,7 @@ bool database::_push_block(const signed_block& new_block)
                   update_witnesses( **ritr );
                   _block_id_to_block.store( (*ritr)->id, (*ritr)->data );
                   session.commit();
+                  _fork_db.mark_applied( **ritr );
                }
                catch ( const fc::exception& e ) { except = e; }
                if( except )
@@ -208,6 +262,7 @@ bool database::_push_block(const signed_block& new_block)
                   throw *except;
                }
          }
+         _fork_db.record_fork_switch( fc::time_point::now() - switch_start );
          return true;
       }
       else return false;
@@ -220,6 +275,7 @@ bool database::_push_block(const signed_block& new_block)
          update_witnesses( *new_head );
       _block_id_to_block.store(new_block.id(), new_block);
       session.commit();
+      _fork_db.mark_applied( *new_head );
    } catch ( const fc::exception& e ) {
       elog("Failed to push new block:\n${e}", ("e", e.to_detail_string()));
       _fork_db.remove( new_block.id() );
@@ -291,9 +347,19 @@ processed_transaction database::_push_transaction( const precomputable_transacti
    // _apply_transaction fails.  If we make it to merge(), we
    // apply the changes.
 
+   // When the pool is full only transactions paying a higher fee per byte are accepted
+   const uint32_t trx_size = static_cast<uint32_t>( fc::raw::pack_size( trx ) );
+   const uint64_t core_fee = get_core_fee( *this, trx );
+   if( !_pending_tx.can_accept( pending_transaction_pool::fee_density( core_fee, trx_size ), trx_size ) )
+   {
+      _pending_tx.record_rejection();
+      FC_THROW_EXCEPTION( pending_pool_full, "The pending transaction pool is full, a higher fee is required",
+                          ("max_size", _pending_tx.max_size()) );
+   }
+
    auto temp_session = _undo_db.start_undo_session();
    auto processed_trx = _apply_transaction( trx );
-   _pending_tx.push_back(processed_trx);
+   _pending_tx.insert( processed_trx, trx_size, core_fee );
 
    // notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
@@ -447,7 +513,10 @@ signed_block database::_generate_block(
    _pending_tx_session = _undo_db.start_undo_session();
 
    uint64_t postponed_tx_count = 0;
-   for( const processed_transaction& tx : _pending_tx )
+   // The block is filled by decreasing fee density.  A transaction may depend on an earlier one of another
+   // fee payer with a lower fee density, so the ones which fail are tried again at the end.
+   vector<const processed_transaction*> failed_txs;
+   const auto apply_pending = [&]( const processed_transaction& tx, bool retry_on_failure )
    {
       size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
 
@@ -455,7 +524,7 @@ signed_block database::_generate_block(
       if( new_total_size > maximum_block_size )
       {
          postponed_tx_count++;
-         continue;
+         return;
       }
 
       try
@@ -474,7 +543,7 @@ signed_block database::_generate_block(
          if( new_total_size > maximum_block_size )
          {
             postponed_tx_count++;
-            continue;
+            return;
          }
 
          temp_session.merge();
@@ -484,11 +553,20 @@ signed_block database::_generate_block(
       }
       catch ( const fc::exception& e )
       {
+         if( retry_on_failure )
+         {
+            failed_txs.push_back( &tx );
+            return;
+         }
          // Do nothing, transaction will not be re-applied
          wlog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
          wlog( "The transaction was ${t}", ("t", tx) );
       }
-   }
+   };
+   for( const pending_transaction* tx : _pending_tx.block_order() )
+      apply_pending( tx->trx, true );
+   for( const processed_transaction* tx : failed_txs )
+      apply_pending( *tx, false );
    if( postponed_tx_count > 0 )
    {
       wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
@@ -538,6 +616,18 @@ void database::pop_block()
                       fork_db_head->data.transactions.end() );
 } FC_CAPTURE_AND_RETHROW() } // GCOVR_EXCL_LINE
 
+void database::apply_replicated_changes( const block_id_type& previous, const object_changes& changes )
+{ try {
+   while( head_block_id() != previous )
+   {
+      FC_ASSERT( _undo_db.size() > 0, "Unable to undo the state back to block ${id}", ("id", previous) );
+      pop_undo();
+   }
+   auto session = _undo_db.start_undo_session();
+   apply_changes( changes );
+   session.commit();
+} FC_CAPTURE_AND_RETHROW( (previous) ) } // GCOVR_EXCL_LINE
+
 void database::clear_pending()
 { try {
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
@@ -545,6 +635,11 @@ void database::clear_pending()
    _pending_tx_session.reset();
 } FC_CAPTURE_AND_RETHROW() } // GCOVR_EXCL_LINE
 
+void database::with_head_block_state( const std::function<void()>& callback )
+{
+   detail::without_pending_transactions( *this, _pending_tx.take_all(), callback );
+}
+
 uint32_t database::push_applied_operation( const operation& op, bool is_virtual /* = true */ )
 {
    _applied_ops.emplace_back( operation_history_object( op, _current_block_num, _current_trx_in_block,
@@ -678,6 +773,7 @@ void database::_apply_block( const signed_block& next_block )
    _applied_ops.clear();
 
    notify_changed_objects();
+   notify_block_changes_applied( processed_block );
 } FC_CAPTURE_AND_RETHROW( (next_block.block_num()) )  } // GCOVR_EXCL_LINE
 
 /**
@@ -702,7 +798,6 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    trx.validate();
 
    auto& trx_idx = get_mutable_index_type<transaction_index>();
-   const chain_id_type& chain_id = get_chain_id();
    if( 0 == (skip & skip_transaction_dupe_check) )
    {
       GRAPHENE_ASSERT( trx_idx.indices().get<by_trx_id>().find(trx.id()) == trx_idx.indices().get<by_trx_id>().end(),
@@ -717,15 +812,9 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    if( 0 == (skip & skip_transaction_signatures) )
    {
       bool allow_non_immediate_owner = ( head_block_time() >= HARDFORK_CORE_584_TIME );
-      auto get_active = [this]( account_id_type id ) { return &id(*this).active; };
-      auto get_owner  = [this]( account_id_type id ) { return &id(*this).owner;  };
-      auto get_custom = [this]( account_id_type id, const operation& op, rejected_predicate_map* rejects ) {
-         return get_viable_custom_authorities(id, op, rejects);
-      };
-
-      trx.verify_authority(chain_id, get_active, get_owner, get_custom, allow_non_immediate_owner,
-                           MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(head_block_time()),
-                           get_global_properties().parameters.max_authority_depth);
+      _authority_cache.verify_authority( *this, trx, allow_non_immediate_owner,
+                                         MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(head_block_time()),
+                                         get_global_properties().parameters.max_authority_depth );
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
@@ -923,6 +1012,17 @@ fc::future<void> database::precompute_parallel( const signed_block& block, const
    return *first;
 } FC_LOG_AND_RETHROW() }
 
+void database::precompute_block( const signed_block& block, const uint32_t skip )const
+{
+   if( !block.transactions.empty() )
+      _precompute_parallel( &block.transactions[0], block.transactions.size(), skip );
+   if( 0 == (skip&skip_witness_signature) )
+      block.signee();
+   if( 0 == (skip&skip_merkle_check) )
+      block.calculate_merkle_root();
+   block.id();
+}
+
 fc::future<void> database::precompute_parallel( const precomputable_transaction& trx )const
 {
    return fc::do_parallel([this,&trx] () {
@@ -160,10 +160,12 @@ void database::initialize_indexes()
    add_index< primary_index<asset_index, 13> >(); // 8192 assets per chunk
    add_index< primary_index<force_settlement_index> >();
 
-   add_index< primary_index<account_index, 20> >(); // ~1 million accounts per chunk
+   auto acnt_idx = add_index< primary_index<account_index, 20> >(); // ~1 million accounts per chunk
+   acnt_idx->add_secondary_index<voting_change_index>( &_vote_tally_cache );
    add_index< primary_index<committee_member_index, 8> >(); // 256 members per chunk
    add_index< primary_index<witness_index, 10> >(); // 1024 witnesses per chunk
-   add_index< primary_index<limit_order_index > >();
+   auto limit_order_idx = add_index< primary_index<limit_order_index > >();
+   limit_order_idx->add_secondary_index<limit_order_book_index>();
    add_index< primary_index<call_order_index > >();
    add_index< primary_index<proposal_index > >();
    add_index< primary_index<withdraw_permission_index > >();
@@ -172,7 +174,8 @@ void database::initialize_indexes()
    add_index< primary_index<balance_index> >();
    add_index< primary_index<blinded_balance_index> >();
    add_index< primary_index< htlc_index> >();
-   add_index< primary_index< custom_authority_index> >();
+   auto custom_auth_idx = add_index< primary_index< custom_authority_index> >();
+   _authority_cache.attach( *acnt_idx, *custom_auth_idx );
    add_index< primary_index<ticket_index> >();
    add_index< primary_index<liquidity_pool_index> >();
    add_index< primary_index<samet_fund_index> >();
@@ -188,7 +191,8 @@ void database::initialize_indexes()
    add_index< primary_index<asset_bitasset_data_index,                 13 > >(); // 8192
    add_index< primary_index<simple_index<global_property_object          >> >();
    add_index< primary_index<simple_index<dynamic_global_property_object  >> >();
-   add_index< primary_index<account_stats_index,                       20 > >(); // 1 Mi
+   auto stats_idx = add_index< primary_index<account_stats_index,      20 > >(); // 1 Mi
+   stats_idx->add_secondary_index<voting_change_index>( &_vote_tally_cache );
    add_index< primary_index<simple_index<asset_dynamic_data_object       >> >();
    add_index< primary_index<simple_index<block_summary_object            >> >();
    add_index< primary_index<simple_index<chain_property_object          > > >();
@@ -199,6 +203,26 @@ void database::initialize_indexes()
    add_index< primary_index<collateral_bid_index                          > >();
    add_index< primary_index< simple_index< fba_accumulator_object       > > >();
    add_index< primary_index<credit_deal_summary_index                     > >();
+
+#ifdef GRAPHENE_DIRECT_INDEXES
+   // Densely allocated objects that are never removed are looked up in vectors
+   get_mutable_index_type< primary_index<worker_index> >()
+         .add_id_lookup_index< direct_index< worker_object, 10 > >(); // 1024 workers per chunk
+   bal_idx->add_id_lookup_index< direct_index< account_balance_object, 16 > >(); // 64 Ki balances per chunk
+   // Objects that are removed regularly are looked up in pages that are only allocated while they hold objects
+   get_mutable_index_type< primary_index<proposal_index> >()
+         .add_id_lookup_index< sparse_direct_index< proposal_object, 8 > >();
+   get_mutable_index_type< primary_index<vesting_balance_index> >()
+         .add_id_lookup_index< sparse_direct_index< vesting_balance_object, 10 > >();
+   get_mutable_index_type< primary_index<balance_index> >()
+         .add_id_lookup_index< sparse_direct_index< balance_object, 10 > >();
+   get_mutable_index_type< primary_index<htlc_index> >()
+         .add_id_lookup_index< sparse_direct_index< htlc_object, 8 > >();
+   get_mutable_index_type< primary_index<custom_authority_index> >()
+         .add_id_lookup_index< sparse_direct_index< custom_authority_object, 8 > >();
+   get_mutable_index_type< primary_index<ticket_index> >()
+         .add_id_lookup_index< sparse_direct_index< ticket_object, 8 > >();
+#endif
 }
 
 } }
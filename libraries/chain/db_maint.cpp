@@ -48,6 +48,8 @@
 #include <graphene/chain/worker_object.hpp>
 #include <graphene/chain/custom_authority_object.hpp>
 
+#include <thread>
+
 namespace graphene { namespace chain {
 
 template<class Index>
@@ -75,7 +77,7 @@ vector<std::reference_wrapper<const typename Index::object_type>> database::sort
 }
 
 template<class Type>
-void database::perform_account_maintenance(Type tally_helper)
+void database::perform_account_maintenance(Type& tally_helper)
 {
    const auto& bal_idx = get_index_type< account_balance_index >().indices().get< by_maintenance_flag >();
    if( bal_idx.begin() != bal_idx.end() )
@@ -926,8 +928,8 @@ void update_call_orders_hf_1270( database& db )
    for( const auto& call_obj : db.get_index_type<call_order_index>().indices().get<by_id>() )
    {
       db.modify( call_obj, []( call_order_object& call ) {
-         call.call_price.base.amount = 1;
-         call.call_price.quote.amount = 1;
+         call.call_price = price( asset( 1, call.call_price.base.asset_id ),
+                                  asset( 1, call.call_price.quote.asset_id ) );
       });
    }
 }
@@ -1219,6 +1221,18 @@ namespace detail {
          stake_to_subtract /= GRAPHENE_100_PERCENT;
          return stake - static_cast<uint64_t>(stake_to_subtract);
       }
+
+      // return the time from which get_recalced_voting_stake() returns another stake, or the maximum time
+      time_point_sec get_next_recalc_time( const time_point_sec last_vote_time, const time_point_sec now ) const
+      {
+         const time_point_sec full_power_end = last_vote_time + full_power_seconds;
+         if( now < full_power_end )
+            return full_power_end;
+         uint32_t diff = now.sec_since_epoch() - full_power_end.sec_since_epoch();
+         if( diff >= total_recalc_seconds )
+            return time_point_sec::maximum();
+         return full_power_end + ( diff / seconds_per_step + 1 ) * seconds_per_step;
+      }
    };
 
    const vote_recalc_options& vote_recalc_options::witness()
@@ -1264,23 +1278,54 @@ void database::perform_chain_maintenance( const signed_block& next_block )
       const size_t vid_committee = static_cast<size_t>( vote_id_type::committee ); // 0
       const size_t vid_witness = static_cast<size_t>( vote_id_type::witness ); // 1
       const size_t vid_worker = static_cast<size_t>( vote_id_type::worker ); // 2
+      /// Accounts per shard below which the votes are not worth tallying in parallel
+      const size_t min_accounts_per_shard = 500;
+      const bool parallel;
+      const vote_tally_cache::tally_parameters tally_params;
+      /// Whether to keep the votes in the cache for the next maintenance
+      const bool incremental;
+      /// Whether the cache holds the votes of the last maintenance, so that only the changed accounts are counted
+      const bool count_changes_only;
 
       optional<detail::vote_recalc_times> witness_recalc_times;
       optional<detail::vote_recalc_times> committee_recalc_times;
       optional<detail::vote_recalc_times> worker_recalc_times;
       optional<detail::vote_recalc_times> delegator_recalc_times;
 
+      /// The votes tallied from a part of the accounts
+      struct tally_buffers
+      {
+         vote_tally_cache::vote_tally  tally;
+         /// The contributions of the stake accounts, to update the voting power stats and the cache
+         vector< std::pair< account_id_type, vote_tally_cache::contribution > > contributions;
+      };
+
+      tally_buffers sequential_tally;
+      /// Accounts to be tallied in parallel, in maintenance order
+      vector< std::pair< const account_object*, const account_statistics_object* > > stake_accounts;
+
       explicit vote_tally_helper( database& db )
          : d(db), props( d.get_global_properties() ), dprops( d.get_dynamic_global_properties() ),
            now( d.head_block_time() ), hf2103_passed( HARDFORK_CORE_2103_PASSED( now ) ),
            hf2262_passed( HARDFORK_CORE_2262_PASSED( now ) ),
-           pob_activated( dprops.total_pob > 0 || dprops.total_inactive > 0 )
+           pob_activated( dprops.total_pob > 0 || dprops.total_inactive > 0 ),
+           // Before hard fork core-2262 the voting stake includes cashback, which process_fees() of the accounts
+           // tallied before can change, so the votes must be tallied in the same loop
+           parallel( hf2262_passed && d._parallel_vote_tally ),
+           tally_params{ props.next_available_vote_id, props.parameters.maximum_witness_count,
+                         props.parameters.maximum_committee_count, props.parameters.count_non_member_votes,
+                         pob_activated },
+           // For the same reason, and since membership expires without a change of the account, only keep the votes
+           // after hard fork core-2262 and when the votes of non-members count
+           incremental( hf2262_passed && props.parameters.count_non_member_votes && d._incremental_vote_tally ),
+           count_changes_only( incremental && d._vote_tally_cache.is_valid( d, d.head_block_num(), tally_params ) )
       {
          d._vote_tally_buffer.resize( props.next_available_vote_id, 0 );
          d._witness_count_histogram_buffer.resize( (props.parameters.maximum_witness_count / two) + 1, 0 );
          d._committee_count_histogram_buffer.resize( (props.parameters.maximum_committee_count / two) + 1, 0 );
          d._total_voting_stake[vid_committee] = 0;
          d._total_voting_stake[vid_witness] = 0;
+         init_buffers( sequential_tally );
          if( hf2103_passed )
          {
             witness_recalc_times   = detail::vote_recalc_options::witness().get_vote_recalc_times( now );
@@ -1290,179 +1335,333 @@ void database::perform_chain_maintenance( const signed_block& next_block )
          }
       }
 
+      void init_buffers( tally_buffers& buffers )const
+      {
+         buffers.tally.init( tally_params );
+      }
+
       void operator()( const account_object& stake_account, const account_statistics_object& stats )
       {
-         // PoB activation
-         if( pob_activated && stats.total_core_pob == 0 && stats.total_core_inactive == 0 )
+         if( count_changes_only )
+            return;
+         if( parallel )
+            stake_accounts.emplace_back( &stake_account, &stats );
+         else
+            tally( stake_account, stats, sequential_tally );
+      }
+
+      /// Tallies the votes of one stake account into @p buffers, does not modify the database
+      void tally( const account_object& stake_account, const account_statistics_object& stats,
+                  tally_buffers& buffers )const
+      {
+         const account_object* opinion_account = nullptr;
+         optional<vote_tally_cache::contribution> c = get_contribution( stake_account, stats, opinion_account );
+         if( !c.valid() )
             return;
+         buffers.tally.add( *c, opinion_account->options.votes, opinion_account->options.num_witness,
+                            opinion_account->options.num_committee, tally_params );
+         buffers.contributions.emplace_back( stake_account.get_id(), *c );
+      }
 
-         if( props.parameters.count_non_member_votes || stake_account.is_member( now ) )
+      /**
+       * Calculates the stakes which one stake account adds to the votes of its opinion account, does not modify
+       * the database.
+       * @param opinion_account set to the opinion account if the stake account votes
+       */
+      optional<vote_tally_cache::contribution> get_contribution( const account_object& stake_account,
+                                                                  const account_statistics_object& stats,
+                                                                  const account_object*& opinion_account )const
+      {
+         // PoB activation
+         if( pob_activated && stats.total_core_pob == 0 && stats.total_core_inactive == 0 )
+            return {};
+
+         if( !props.parameters.count_non_member_votes && !stake_account.is_member( now ) )
+            return {};
+
+         // There may be a difference between the account whose stake is voting and the one specifying opinions.
+         // Usually they're the same, but if the stake account has specified a voting_account, that account is the
+         // one specifying the opinions.
+         bool directly_voting = ( stake_account.options.voting_account == GRAPHENE_PROXY_TO_SELF_ACCOUNT );
+         opinion_account = ( directly_voting ? &stake_account : &d.get(stake_account.options.voting_account) );
+
+         std::array<uint64_t,3> voting_stake; // 0=committee, 1=witness, 2=worker, as in vote_id_type::vote_type
+         uint64_t num_committee_voting_stake; // number of committee members
+         voting_stake[vid_worker] = pob_activated ? 0 : stats.total_core_in_orders.value;
+         voting_stake[vid_worker] += ( !hf2262_passed && stake_account.cashback_vb.valid() ) ?
+                                          (*stake_account.cashback_vb)(d).balance.amount.value : 0;
+         voting_stake[vid_worker] += hf2262_passed ? 0 : stats.core_in_balance.value;
+
+         // voting power stats
+         uint64_t vp_all = 0;       ///<  all voting power.
+         ///  the voting power of the proxy, if there is no attenuation, it is equal to vp_all.
+         uint64_t vp_active = 0;
+
+         //PoB
+         const uint64_t pol_amount = stats.total_core_pol.value;
+         const uint64_t pol_value = stats.total_pol_value.value;
+         const uint64_t pob_amount = stats.total_core_pob.value;
+         const uint64_t pob_value = stats.total_pob_value.value;
+         if( 0 == pob_amount )
          {
-            // There may be a difference between the account whose stake is voting and the one specifying opinions.
-            // Usually they're the same, but if the stake account has specified a voting_account, that account is the
-            // one specifying the opinions.
-            bool directly_voting = ( stake_account.options.voting_account == GRAPHENE_PROXY_TO_SELF_ACCOUNT );
-            const account_object& opinion_account = ( directly_voting ? stake_account
-                                                      : d.get(stake_account.options.voting_account) );
-
-            std::array<uint64_t,3> voting_stake; // 0=committee, 1=witness, 2=worker, as in vote_id_type::vote_type
-            uint64_t num_committee_voting_stake; // number of committee members
-            voting_stake[vid_worker] = pob_activated ? 0 : stats.total_core_in_orders.value;
-            voting_stake[vid_worker] += ( !hf2262_passed && stake_account.cashback_vb.valid() ) ?
-                                             (*stake_account.cashback_vb)(d).balance.amount.value : 0;
-            voting_stake[vid_worker] += hf2262_passed ? 0 : stats.core_in_balance.value;
-
-            // voting power stats
-            uint64_t vp_all = 0;       ///<  all voting power.
-            ///  the voting power of the proxy, if there is no attenuation, it is equal to vp_all.
-            uint64_t vp_active = 0;
-            uint64_t vp_committee = 0; ///<  the final voting power for the committees.
-            uint64_t vp_witness = 0;   ///<  the final voting power for the witnesses.
-            uint64_t vp_worker = 0;    ///<  the final voting power for the workers.
-
-            //PoB
-            const uint64_t pol_amount = stats.total_core_pol.value;
-            const uint64_t pol_value = stats.total_pol_value.value;
-            const uint64_t pob_amount = stats.total_core_pob.value;
-            const uint64_t pob_value = stats.total_pob_value.value;
-            if( 0 == pob_amount )
+            voting_stake[vid_worker] += pol_value;
+         }
+         else if( 0 == pol_amount ) // and pob_amount > 0
+         {
+            if( pob_amount <= voting_stake[vid_worker] )
             {
-               voting_stake[vid_worker] += pol_value;
+               voting_stake[vid_worker] += ( pob_value - pob_amount );
             }
-            else if( 0 == pol_amount ) // and pob_amount > 0
+            else
             {
-               if( pob_amount <= voting_stake[vid_worker] )
-               {
-                  voting_stake[vid_worker] += ( pob_value - pob_amount );
-               }
-               else
-               {
-                  auto base_value = ( static_cast<fc::uint128_t>( voting_stake[vid_worker] ) * pob_value )
-                                    / pob_amount;
-                  voting_stake[vid_worker] = static_cast<uint64_t>( base_value );
-               }
+               auto base_value = ( static_cast<fc::uint128_t>( voting_stake[vid_worker] ) * pob_value )
+                                 / pob_amount;
+               voting_stake[vid_worker] = static_cast<uint64_t>( base_value );
             }
-            else if( pob_amount <= pol_amount ) // pob_amount > 0 && pol_amount > 0
+         }
+         else if( pob_amount <= pol_amount ) // pob_amount > 0 && pol_amount > 0
+         {
+            auto base_value = ( static_cast<fc::uint128_t>( pob_value ) * pol_value ) / pol_amount;
+            auto diff_value = ( static_cast<fc::uint128_t>( pob_amount ) * pol_value ) / pol_amount;
+            base_value += ( pol_value - diff_value );
+            voting_stake[vid_worker] += static_cast<uint64_t>( base_value );
+         }
+         else // pob_amount > pol_amount > 0
+         {
+            auto base_value = ( static_cast<fc::uint128_t>( pol_value ) * pob_value ) / pob_amount;
+            fc::uint128_t diff_amount = pob_amount - pol_amount;
+            if( diff_amount <= voting_stake[vid_worker] )
             {
-               auto base_value = ( static_cast<fc::uint128_t>( pob_value ) * pol_value ) / pol_amount;
-               auto diff_value = ( static_cast<fc::uint128_t>( pob_amount ) * pol_value ) / pol_amount;
-               base_value += ( pol_value - diff_value );
-               voting_stake[vid_worker] += static_cast<uint64_t>( base_value );
+               auto diff_value = ( static_cast<fc::uint128_t>( pol_amount ) * pob_value ) / pob_amount;
+               base_value += ( pob_value - diff_value );
+               voting_stake[vid_worker] += static_cast<uint64_t>( base_value - diff_amount );
             }
-            else // pob_amount > pol_amount > 0
+            else // diff_amount > voting_stake[vid_worker]
             {
-               auto base_value = ( static_cast<fc::uint128_t>( pol_value ) * pob_value ) / pob_amount;
-               fc::uint128_t diff_amount = pob_amount - pol_amount;
-               if( diff_amount <= voting_stake[vid_worker] )
-               {
-                  auto diff_value = ( static_cast<fc::uint128_t>( pol_amount ) * pob_value ) / pob_amount;
-                  base_value += ( pob_value - diff_value );
-                  voting_stake[vid_worker] += static_cast<uint64_t>( base_value - diff_amount );
-               }
-               else // diff_amount > voting_stake[vid_worker]
-               {
-                  base_value += ( static_cast<fc::uint128_t>( voting_stake[vid_worker] ) * pob_value ) / pob_amount;
-                  voting_stake[vid_worker] = static_cast<uint64_t>( base_value );
-               }
+               base_value += ( static_cast<fc::uint128_t>( voting_stake[vid_worker] ) * pob_value ) / pob_amount;
+               voting_stake[vid_worker] = static_cast<uint64_t>( base_value );
             }
+         }
 
-            // Shortcut
-            if( 0 == voting_stake[vid_worker] )
-               return;
+         // Shortcut
+         if( 0 == voting_stake[vid_worker] )
+            return {};
 
-            const auto& opinion_account_stats = ( directly_voting ? stats : opinion_account.statistics( d ) );
+         const auto& opinion_account_stats = ( directly_voting ? stats : opinion_account->statistics( d ) );
+         vote_tally_cache::contribution c;
 
-            // Recalculate votes
-            if( !hf2103_passed )
+         // Recalculate votes
+         if( !hf2103_passed )
+         {
+            voting_stake[vid_committee] = voting_stake[vid_worker];
+            voting_stake[vid_witness]   = voting_stake[vid_worker];
+            num_committee_voting_stake  = voting_stake[vid_worker];
+            vp_all       = voting_stake[vid_worker];
+            vp_active    = voting_stake[vid_worker];
+         }
+         else
+         {
+            const auto& witness_options = detail::vote_recalc_options::witness();
+            const auto& committee_options = detail::vote_recalc_options::committee();
+            const auto& worker_options = detail::vote_recalc_options::worker();
+            vp_all = voting_stake[vid_worker];
+            vp_active = voting_stake[vid_worker];
+            if( !directly_voting )
             {
-               voting_stake[vid_committee] = voting_stake[vid_worker];
-               voting_stake[vid_witness]   = voting_stake[vid_worker];
-               num_committee_voting_stake  = voting_stake[vid_worker];
-               vp_all       = voting_stake[vid_worker];
-               vp_active    = voting_stake[vid_worker];
-               vp_committee = voting_stake[vid_worker];
-               vp_witness   = voting_stake[vid_worker];
-               vp_worker    = voting_stake[vid_worker];
+               const auto& delegator_options = detail::vote_recalc_options::delegator();
+               voting_stake[vid_worker] = delegator_options.get_recalced_voting_stake(
+                  voting_stake[vid_worker], stats.last_vote_time, *delegator_recalc_times );
+               vp_active = voting_stake[vid_worker];
+               c.valid_until = delegator_options.get_next_recalc_time( stats.last_vote_time, now );
             }
+            voting_stake[vid_witness] = witness_options.get_recalced_voting_stake(
+               voting_stake[vid_worker], opinion_account_stats.last_vote_time, *witness_recalc_times );
+            voting_stake[vid_committee] = committee_options.get_recalced_voting_stake(
+               voting_stake[vid_worker], opinion_account_stats.last_vote_time, *committee_recalc_times );
+            num_committee_voting_stake = voting_stake[vid_committee];
+            if( opinion_account->num_committee_voted > 1 )
+               voting_stake[vid_committee] /= opinion_account->num_committee_voted;
+            voting_stake[vid_worker] = worker_options.get_recalced_voting_stake(
+               voting_stake[vid_worker], opinion_account_stats.last_vote_time, *worker_recalc_times );
+            // the stakes decay further as time goes by
+            c.valid_until = std::min( { c.valid_until,
+                  witness_options.get_next_recalc_time( opinion_account_stats.last_vote_time, now ),
+                  committee_options.get_next_recalc_time( opinion_account_stats.last_vote_time, now ),
+                  worker_options.get_next_recalc_time( opinion_account_stats.last_vote_time, now ) } );
+         }
+
+         // the final voting power for the committees, the witnesses and the workers are the stakes
+         c.opinion_account = opinion_account->get_id();
+         c.opinion_stats = opinion_account->statistics;
+         c.stakes = voting_stake;
+         c.num_committee_stake = num_committee_voting_stake;
+         c.vp_all = vp_all;
+         c.vp_active = vp_active;
+         return c;
+      }
+
+      /// Counts the votes and updates the voting power stats, applied at the end of the account maintenance
+      void finish()
+      {
+         if( count_changes_only )
+            count_changes();
+         else
+            count_all();
+         if( incremental )
+            d._vote_tally_cache.set_block( d.head_block_num(), d.head_block_id() );
+      }
+
+      /**
+       * Tallies the collected accounts in parallel shards, then merges the tallies of all shards in shard order
+       * and applies the voting power updates in maintenance order. Sums do not depend on the order of addition,
+       * so the result is the same as tallying sequentially.
+       */
+      void count_all()
+      {
+         vector<tally_buffers> shards;
+         if( !parallel )
+            shards.push_back( std::move( sequential_tally ) );
+         else if( !stake_accounts.empty() )
+         {
+            const size_t max_shards = std::max( std::thread::hardware_concurrency(), 1u );
+            const size_t shard_count = std::min( max_shards, ( stake_accounts.size() + min_accounts_per_shard - 1 )
+                                                             / min_accounts_per_shard );
+            const size_t shard_size = ( stake_accounts.size() + shard_count - 1 ) / shard_count;
+            shards.resize( shard_count );
+            auto tally_shard = [this,&shards,shard_size]( size_t shard ) {
+               tally_buffers& buffers = shards[shard];
+               init_buffers( buffers );
+               const size_t end = std::min( stake_accounts.size(), ( shard + 1 ) * shard_size );
+               buffers.contributions.reserve( end - shard * shard_size );
+               for( size_t i = shard * shard_size; i < end; ++i )
+                  tally( *stake_accounts[i].first, *stake_accounts[i].second, buffers );
+            };
+            if( shard_count == 1 )
+               tally_shard( 0 );
             else
             {
-               vp_all = voting_stake[vid_worker];
-               vp_active = voting_stake[vid_worker];
-               if( !directly_voting )
-               {
-                  voting_stake[vid_worker] = detail::vote_recalc_options::delegator().get_recalced_voting_stake(
-                     voting_stake[vid_worker], stats.last_vote_time, *delegator_recalc_times );
-                  vp_active = voting_stake[vid_worker];
-               }
-               voting_stake[vid_witness] = detail::vote_recalc_options::witness().get_recalced_voting_stake(
-                  voting_stake[vid_worker], opinion_account_stats.last_vote_time, *witness_recalc_times );
-               vp_witness = voting_stake[vid_witness];
-               voting_stake[vid_committee] = detail::vote_recalc_options::committee().get_recalced_voting_stake(
-                  voting_stake[vid_worker], opinion_account_stats.last_vote_time, *committee_recalc_times );
-               vp_committee = voting_stake[vid_committee];
-               num_committee_voting_stake = voting_stake[vid_committee];
-               if( opinion_account.num_committee_voted > 1 )
-                  voting_stake[vid_committee] /= opinion_account.num_committee_voted;
-               voting_stake[vid_worker] = detail::vote_recalc_options::worker().get_recalced_voting_stake(
-                  voting_stake[vid_worker], opinion_account_stats.last_vote_time, *worker_recalc_times );
-               vp_worker = voting_stake[vid_worker];
+               // Plain threads instead of fc tasks: waiting for an fc future would let other tasks of the calling
+               // thread run in the middle of applying the block.
+               vector<std::exception_ptr> errors( shard_count );
+               auto run_shard = [&tally_shard,&errors]( size_t shard ) {
+                  try {
+                     tally_shard( shard );
+                  } catch( ... ) {
+                     errors[shard] = std::current_exception();
+                  }
+               };
+               std::vector<std::thread> threads;
+               threads.reserve( shard_count - 1 );
+               for( size_t shard = 1; shard < shard_count; ++shard )
+                  threads.emplace_back( run_shard, shard );
+               run_shard( 0 );
+               // join all threads before rethrowing, they use the buffers on this stack
+               for( auto& thread : threads )
+                  thread.join();
+               for( const auto& error : errors )
+                  if( error )
+                     std::rethrow_exception( error );
             }
+         }
 
-            // update voting power
-            d.modify( opinion_account_stats, [vp_all,vp_active,vp_committee,vp_witness,vp_worker,this]
-                                             ( account_statistics_object& update_stats ) {
-               if (update_stats.vote_tally_time != now)
-               {
-                  update_stats.vp_all = vp_all;
-                  update_stats.vp_active = vp_active;
-                  update_stats.vp_committee = vp_committee;
-                  update_stats.vp_witness = vp_witness;
-                  update_stats.vp_worker = vp_worker;
-                  update_stats.vote_tally_time = now;
-               }
-               else
-               {
-                  update_stats.vp_all += vp_all;
-                  update_stats.vp_active += vp_active;
-                  update_stats.vp_committee += vp_committee;
-                  update_stats.vp_witness += vp_witness;
-                  update_stats.vp_worker += vp_worker;
-               }
-            });
+         for( const tally_buffers& buffers : shards )
+         {
+            for( size_t i = 0; i < buffers.tally.votes.size(); ++i )
+               d._vote_tally_buffer[i] += buffers.tally.votes[i];
+            for( size_t i = 0; i < buffers.tally.witness_count_histogram.size(); ++i )
+               d._witness_count_histogram_buffer[i] += buffers.tally.witness_count_histogram[i];
+            for( size_t i = 0; i < buffers.tally.committee_count_histogram.size(); ++i )
+               d._committee_count_histogram_buffer[i] += buffers.tally.committee_count_histogram[i];
+            d._total_voting_stake[vid_committee] += buffers.tally.total_voting_stake[vid_committee];
+            d._total_voting_stake[vid_witness] += buffers.tally.total_voting_stake[vid_witness];
+
+            for( const auto& stake_contribution : buffers.contributions )
+            {
+               vote_tally_cache::voting_power vp;
+               vp.add( stake_contribution.second );
+               add_voting_power( vp );
+            }
+         }
+
+         if( !incremental )
+         {
+            d._vote_tally_cache.reset();
+            return;
+         }
+         vote_tally_cache::vote_tally tally;
+         tally.votes = d._vote_tally_buffer;
+         tally.witness_count_histogram = d._witness_count_histogram_buffer;
+         tally.committee_count_histogram = d._committee_count_histogram_buffer;
+         tally.total_voting_stake = d._total_voting_stake;
+         d._vote_tally_cache.rebuild( tally_params, std::move( tally ) );
+         for( const tally_buffers& buffers : shards )
+            for( const auto& stake_contribution : buffers.contributions )
+               d._vote_tally_cache.insert( stake_contribution.first, stake_contribution.second );
+      }
 
-            for( vote_id_type id : opinion_account.options.votes )
+      /// Replaces the contributions of the accounts which changed since the last maintenance in the cache
+      void count_changes()
+      {
+         vote_tally_cache& cache = d._vote_tally_cache;
+         const auto get_options = [this]( account_id_type account ) -> const account_options& {
+            return account(d).options;
+         };
+         for( const uint64_t instance : cache.get_accounts_to_count( now ) )
+         {
+            const account_id_type stake_id( instance );
+            optional<vote_tally_cache::contribution> c;
+            const account_object* stake_account = d.find( stake_id );
+            if( stake_account != nullptr )
             {
-               uint32_t offset = id.instance();
-               uint32_t type = std::min( id.type(), vote_id_type::vote_type::worker ); // cap the data
-               // if they somehow managed to specify an illegal offset, ignore it.
-               if( offset < d._vote_tally_buffer.size() )
-                  d._vote_tally_buffer[offset] += voting_stake[type];
+               const account_statistics_object& stats = stake_account->statistics( d );
+               const account_object* opinion_account = nullptr;
+               if( stats.has_some_core_voting() )
+                  c = get_contribution( *stake_account, stats, opinion_account );
             }
+            cache.update( stake_id, c, get_options );
+         }
+         cache.clear_changes();
+
+         const vote_tally_cache::vote_tally& tally = cache.get_tally();
+         d._vote_tally_buffer = tally.votes;
+         d._witness_count_histogram_buffer = tally.witness_count_histogram;
+         d._committee_count_histogram_buffer = tally.committee_count_histogram;
+         d._total_voting_stake = tally.total_voting_stake;
+
+         // the stats of all opinion accounts are refreshed, since get_top_voters() relies on vote_tally_time
+         for( const auto& opinion_vp : cache.get_voting_power() )
+            add_voting_power( opinion_vp.second );
+      }
 
-            // votes for a number greater than maximum_witness_count are skipped here
-            if( voting_stake[vid_witness] > 0
-                  && opinion_account.options.num_witness <= props.parameters.maximum_witness_count )
+      /// Adds @p vp to the voting power stats of its opinion account, replacing the stats of the last maintenance
+      void add_voting_power( const vote_tally_cache::voting_power& vp )const
+      {
+         d.modify( vp.opinion_stats( d ), [&vp,this]( account_statistics_object& update_stats ) {
+            if (update_stats.vote_tally_time != now)
             {
-               uint16_t offset = opinion_account.options.num_witness / two;
-               d._witness_count_histogram_buffer[offset] += voting_stake[vid_witness];
+               update_stats.vp_all = vp.vp_all;
+               update_stats.vp_active = vp.vp_active;
+               update_stats.vp_committee = vp.vp_committee;
+               update_stats.vp_witness = vp.vp_witness;
+               update_stats.vp_worker = vp.vp_worker;
+               update_stats.vote_tally_time = now;
             }
-            // votes for a number greater than maximum_committee_count are skipped here
-            if( num_committee_voting_stake > 0
-                  && opinion_account.options.num_committee <= props.parameters.maximum_committee_count )
+            else
             {
-               uint16_t offset = opinion_account.options.num_committee / two;
-               d._committee_count_histogram_buffer[offset] += num_committee_voting_stake;
+               update_stats.vp_all += vp.vp_all;
+               update_stats.vp_active += vp.vp_active;
+               update_stats.vp_committee += vp.vp_committee;
+               update_stats.vp_witness += vp.vp_witness;
+               update_stats.vp_worker += vp.vp_worker;
             }
-
-            d._total_voting_stake[vid_committee] += num_committee_voting_stake;
-            d._total_voting_stake[vid_witness] += voting_stake[vid_witness];
-         }
+         });
       }
    };
 
    vote_tally_helper tally_helper(*this);
 
    perform_account_maintenance( tally_helper );
+   tally_helper.finish();
 
    struct clear_canary {
       explicit clear_canary(vector<uint64_t>& target): target(target){}
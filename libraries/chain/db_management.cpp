@@ -32,12 +32,15 @@
 #include <graphene/protocol/fee_schedule.hpp>
 
 #include <fc/io/fstream.hpp>
+#include <fc/asio.hpp>
+#include <fc/thread/parallel.hpp>
+#include <fc/thread/thread.hpp>
 
+#include <atomic>
+#include <deque>
 #include <fstream>
 #include <functional>
 #include <iostream>
-#include <queue>
-#include <tuple>
 
 namespace graphene { namespace chain {
 
@@ -52,6 +55,55 @@ database::~database()
    clear_pending();
 }
 
+namespace {
+
+/// Busy time, stalls and throughput of one stage of the replay pipeline since the last progress report
+struct reindex_stage_stats
+{
+   explicit reindex_stage_stats( const char* n ) : name( n ) {}
+
+   void add_busy( const fc::microseconds& elapsed )
+   {
+      ++blocks;
+      busy_us += elapsed.count();
+   }
+
+   /// Records that the next stage had to wait for this stage
+   void add_stall( const fc::microseconds& waited )
+   {
+      ++stalls;
+      stall_us += waited.count();
+   }
+
+   void log_and_reset()
+   {
+      const uint64_t b = blocks.exchange( 0 );
+      const uint64_t busy = busy_us.exchange( 0 );
+      ilog( "   ${name}: ${b} blocks, ${bps} blocks/s busy, ${s} stalls waiting ${st} ms",
+            ("name", name)("b", b)("bps", busy > 0 ? b * 1000000 / busy : 0)
+            ("s", stalls)("st", stall_us / 1000) );
+      stalls = 0;
+      stall_us = 0;
+   }
+
+   const char*           name;
+   std::atomic<uint64_t> blocks { 0 };
+   std::atomic<uint64_t> busy_us { 0 };
+   uint64_t              stalls = 0;   ///< only touched by the thread driving the pipeline
+   uint64_t              stall_us = 0;
+};
+
+struct reindex_item
+{
+   size_t                     block_pos = 0; ///< position in the block log after the block, for progress
+   fc::optional<signed_block> block;
+   uint32_t                   skip = 0;
+   fc::future<void>           precomputed;
+};
+using reindex_item_ptr = std::shared_ptr<reindex_item>;
+
+} // anonymous namespace
+
 void database::reindex( fc::path data_dir )
 { try {
    auto last_block = _block_id_to_block.last();
@@ -77,55 +129,130 @@ void database::reindex( fc::path data_dir )
       _undo_db.disable();
 
    uint32_t skip = node_properties().skip_flags;
+   const uint32_t validated_block_skip = skip_witness_signature
+                                       | skip_transaction_signatures
+                                       | skip_tapos_check
+                                       | skip_merkle_check
+                                       | skip_block_size_check
+                                       | skip_witness_schedule_check;
+
+   // The replay is a three stage pipeline connected by bounded queues:
+   // 1. a dedicated thread reads and deserializes blocks in order,
+   // 2. up to precompute_depth blocks are precomputed in parallel on the IO thread pool,
+   // 3. this thread applies the blocks in order.
+   const uint32_t read_ahead = _reindex_read_ahead;
+   const uint32_t precompute_depth = _reindex_precompute_depth > 0 ? _reindex_precompute_depth
+                                   : 2 * std::max<uint32_t>( fc::asio::default_io_service_scope::get_num_threads(), 1 );
+   ilog( "Replay pipeline: reading up to ${r} blocks ahead, precomputing up to ${p} blocks in parallel",
+         ("r", read_ahead)("p", precompute_depth) );
+
+   reindex_stage_stats read_stats( "read" );
+   reindex_stage_stats precompute_stats( "precompute" );
+   reindex_stage_stats apply_stats( "apply" );
+
+   fc::thread reader( "reindex_reader" );
+   std::deque< fc::future< reindex_item_ptr > > read_queue;
+   std::deque< reindex_item_ptr > precompute_queue;
+   // Tasks running on other threads refer to locals, make sure they are done before leaving
+   auto drain = [&read_queue,&precompute_queue]() {
+      for( auto& f : read_queue )
+         try { f.wait(); } catch( ... ) {}
+      for( auto& item : precompute_queue )
+         try { item->precomputed.wait(); } catch( ... ) {}
+      read_queue.clear();
+      precompute_queue.clear();
+   };
 
    size_t total_block_size = _block_id_to_block.total_block_size();
    const auto& gpo = get_global_properties();
-   std::queue< std::tuple< size_t, signed_block, fc::future< void > > > blocks;
    uint32_t next_block_num = head_block_num() + 1;
    uint32_t i = next_block_num;
-   while( next_block_num <= last_block_num || !blocks.empty() )
+   try
    {
-      if( next_block_num <= last_block_num && blocks.size() < 20 )
+      while( next_block_num <= last_block_num || !read_queue.empty() || !precompute_queue.empty() )
       {
-         const size_t processed_block_size = _block_id_to_block.blocks_current_position();
-         fc::optional< signed_block > block = _block_id_to_block.fetch_by_number( next_block_num );
-         ++next_block_num;
-         if( block.valid() )
+         // stage 1: keep the reader busy
+         while( next_block_num <= last_block_num && read_queue.size() < read_ahead )
          {
-            if( block->timestamp >= (last_block->timestamp - gpo.parameters.maximum_time_until_expiration) )
-               skip &= (uint32_t)(~skip_transaction_dupe_check);
-            blocks.emplace( processed_block_size, std::move(*block), fc::future<void>() );
-            std::get<2>(blocks.back()) = precompute_parallel( std::get<1>(blocks.back()), skip );
+            const uint32_t num = next_block_num++;
+            read_queue.push_back( reader.async( [this,num,&read_stats]() {
+               const auto read_start = fc::time_point::now();
+               auto item = std::make_shared<reindex_item>();
+               item->block = _block_id_to_block.fetch_by_number( num );
+               item->block_pos = _block_id_to_block.blocks_current_position();
+               read_stats.add_busy( fc::time_point::now() - read_start );
+               return item;
+            }, "reindex read" ) );
          }
-         else
+
+         // stage 2: start precomputing the blocks that have been read, wait only if nothing else is left to do
+         while( !read_queue.empty() && precompute_queue.size() < precompute_depth
+                && ( precompute_queue.empty() || read_queue.front().ready() ) )
          {
-            wlog( "Reindexing terminated due to gap:  Block ${i} does not exist!", ("i", i) );
-            uint32_t dropped_count = 0;
-            while( true )
+            if( !read_queue.front().ready() )
+            {
+               const auto wait_start = fc::time_point::now();
+               read_queue.front().wait();
+               read_stats.add_stall( fc::time_point::now() - wait_start );
+            }
+            reindex_item_ptr item = read_queue.front().wait();
+            read_queue.pop_front();
+            if( !item->block.valid() )
             {
-               fc::optional< block_id_type > last_id = _block_id_to_block.last_id();
-               // this can trigger if we attempt to e.g. read a file that has block #2 but no block #1
-               // OR
-               // we've caught up to the gap
-               if( !last_id.valid() || block_header::num_from_id( *last_id ) <= i )
-                  break;
-               _block_id_to_block.remove( *last_id );
-               ++dropped_count;
+               const uint32_t missing = i + uint32_t( precompute_queue.size() );
+               wlog( "Reindexing terminated due to gap:  Block ${i} does not exist!", ("i", missing) );
+               // don't load more blocks, and let the reader finish before the block log is modified
+               next_block_num = last_block_num + 1;
+               for( auto& f : read_queue )
+                  f.wait();
+               read_queue.clear();
+               uint32_t dropped_count = 0;
+               while( true )
+               {
+                  fc::optional< block_id_type > last_id = _block_id_to_block.last_id();
+                  // this can trigger if we attempt to e.g. read a file that has block #2 but no block #1
+                  // OR
+                  // we've caught up to the gap
+                  if( !last_id.valid() || block_header::num_from_id( *last_id ) <= missing )
+                     break;
+                  _block_id_to_block.remove( *last_id );
+                  ++dropped_count;
+               }
+               wlog( "Dropped ${n} blocks from after the gap", ("n", dropped_count) );
+               break;
             }
-            wlog( "Dropped ${n} blocks from after the gap", ("n", dropped_count) );
-            next_block_num = last_block_num + 1; // don't load more blocks
+            if( item->block->timestamp >= (last_block->timestamp - gpo.parameters.maximum_time_until_expiration) )
+               skip &= (uint32_t)(~skip_transaction_dupe_check);
+            item->skip = skip;
+            const signed_block* block = &(*item->block);
+            const uint32_t block_skip = skip;
+            item->precomputed = fc::do_parallel( [this,block,block_skip,&precompute_stats]() {
+               const auto precompute_start = fc::time_point::now();
+               precompute_block( *block, block_skip );
+               precompute_stats.add_busy( fc::time_point::now() - precompute_start );
+            } );
+            precompute_queue.push_back( std::move( item ) );
          }
-      }
-      else
-      {
-         std::get<2>(blocks.front()).wait();
-         const signed_block& block = std::get<1>(blocks.front());
+
+         if( precompute_queue.empty() )
+            continue;
+
+         // stage 3: apply the oldest block
+         reindex_item_ptr item = precompute_queue.front();
+         if( !item->precomputed.ready() )
+         {
+            const auto wait_start = fc::time_point::now();
+            item->precomputed.wait();
+            precompute_stats.add_stall( fc::time_point::now() - wait_start );
+         }
+         item->precomputed.wait();
+         const signed_block& block = *item->block;
 
          if( i % 10000 == 0 )
          {
             std::stringstream bysize;
             std::stringstream bynum;
-            size_t current_pos = std::get<0>(blocks.front());
+            size_t current_pos = item->block_pos;
             if( current_pos > total_block_size )
                total_block_size = current_pos;
             bysize << std::fixed << std::setprecision(5) << (100 * double(current_pos) / total_block_size);
@@ -139,6 +266,9 @@ void database::reindex( fc::path data_dir )
                ("i", i)
                ("last", last_block_num)
             );
+            read_stats.log_and_reset();
+            precompute_stats.log_and_reset();
+            apply_stats.log_and_reset();
          }
          if( i == undo_point )
          {
@@ -146,17 +276,28 @@ void database::reindex( fc::path data_dir )
             flush();
             ilog( "Done writing object database to disk" );
          }
+         const auto apply_start = fc::time_point::now();
          if( i < undo_point )
-            apply_block( block, skip );
+            apply_block( block, item->skip );
          else
          {
             _undo_db.enable();
-            push_block( block, skip );
+            // blocks which were applied before the restart have been validated already
+            if( _fork_db.is_open() && _fork_db.is_validated( block.id() ) )
+               push_block( block, item->skip | validated_block_skip );
+            else
+               push_block( block, item->skip );
          }
-         blocks.pop();
+         apply_stats.add_busy( fc::time_point::now() - apply_start );
+         precompute_queue.pop_front();
          ++i;
       }
    }
+   catch( ... )
+   {
+      drain();
+      throw;
+   }
    _undo_db.enable();
    auto end = fc::time_point::now();
    ilog( "Done reindexing, elapsed time: ${t} sec", ("t",double((end-start).count())/1000000.0 ) );
@@ -169,6 +310,9 @@ void database::wipe(const fc::path& data_dir, bool include_blocks)
      close();
    }
    object_database::wipe(data_dir);
+   // the fork database journal is only meaningful together with the state it was written with
+   if( fc::exists( data_dir / "database" / "fork_db" ) )
+      fc::remove( data_dir / "database" / "fork_db" );
    if( include_blocks )
       fc::remove_all( data_dir / "database" );
 }
@@ -201,18 +345,13 @@ void database::open(
       object_database::open(data_dir);
 
       _block_id_to_block.open(data_dir / "database" / "block_num_to_block");
+      if( _persist_fork_db )
+         _fork_db.open( data_dir / "database" / "fork_db" );
 
       if( !find(global_property_id_type()) )
          init_genesis(genesis_loader());
       else
-      {
-         _p_core_asset_obj = &get( asset_id_type() );
-         _p_core_dynamic_data_obj = &get( asset_dynamic_data_id_type() );
-         _p_global_prop_obj = &get( global_property_id_type() );
-         _p_chain_property_obj = &get( chain_property_id_type() );
-         _p_dyn_global_prop_obj = &get( dynamic_global_property_id_type() );
-         _p_witness_schedule_obj = &get( witness_schedule_id_type() );
-      }
+         init_object_pointers();
 
       fc::optional<block_id_type> last_block = _block_id_to_block.last_id();
       if( last_block.valid() )
@@ -222,11 +361,36 @@ void database::open(
                     ("last_block->id", last_block)("head_block_id",head_block_num()) );
          reindex( data_dir );
       }
+      if( _fork_db.is_open() )
+         _fork_db.restore( head_block_id() );
       _opened = true;
    }
    FC_CAPTURE_LOG_AND_RETHROW( (data_dir) )
 }
 
+void database::init_object_pointers()
+{
+   _p_core_asset_obj = &get( asset_id_type() );
+   _p_core_dynamic_data_obj = &get( asset_dynamic_data_id_type() );
+   _p_global_prop_obj = &get( global_property_id_type() );
+   _p_chain_property_obj = &get( chain_property_id_type() );
+   _p_dyn_global_prop_obj = &get( dynamic_global_property_id_type() );
+   _p_witness_schedule_obj = &get( witness_schedule_id_type() );
+}
+
+void database::copy_state_from( const database& primary )
+{ try {
+   FC_ASSERT( !_opened, "Can not copy the state into a database which has been opened" );
+   FC_ASSERT( primary._opened, "Can not copy the state of a database which has not been opened" );
+   FC_ASSERT( !find( global_property_id_type() ), "The state has been copied already" );
+   add_missing_indexes_from( primary );
+   copy_objects_from( primary );
+   init_object_pointers();
+   _undo_db.set_max_size( primary._undo_db.max_size() );
+   // the undo history of the primary is not copied, blocks before the copy can not be popped
+   _undo_db.enable();
+} FC_CAPTURE_AND_RETHROW() } // GCOVR_EXCL_LINE
+
 void database::close(bool rewinding)
 {
    if (!_opened)
@@ -234,6 +398,9 @@ void database::close(bool rewinding)
    // TODO:  Save pending tx's on close()
    clear_pending();
 
+   // journal the fork database before rewinding removes the reversible blocks from it
+   _fork_db.close();
+
    // pop all of the blocks that we can given our undo history, this should
    // throw when there is no more undo history to pop
    if( rewinding )
@@ -266,6 +433,8 @@ void database::close(bool rewinding)
    ilog( "Done writing object database to disk" );
 
    object_database::close();
+   // the cached votes point to the objects, which are loaded again when the database is opened
+   _vote_tally_cache.reset();
 
    if( _block_id_to_block.is_open() )
       _block_id_to_block.close();
@@ -691,8 +691,9 @@ bool database::apply_order_before_hardfork_625(const limit_order_object& new_ord
    // constant time check. Potential optimization.
 
    auto max_price = ~new_order_object.sell_price;
-   auto limit_itr = limit_price_idx.lower_bound(max_price.max());
-   auto limit_end = limit_price_idx.upper_bound(max_price);
+   // ranked keys compare by rank first, see ranked_price
+   auto limit_itr = limit_price_idx.lower_bound( ranked_price( max_price.max() ) );
+   auto limit_end = limit_price_idx.upper_bound( ranked_price( max_price ) );
 
    bool finished = false;
    while( !finished && limit_itr != limit_end )
@@ -744,20 +745,21 @@ bool database::apply_order(const limit_order_object& new_order_object)
    asset_id_type sell_asset_id = new_order_object.sell_asset_id();
    asset_id_type recv_asset_id = new_order_object.receive_asset_id();
 
+   // Only the orders of this market are relevant, so use the per-market order books.
+   // Books are never removed, iterators into them stay valid while orders are filled or re-priced.
+   const auto& order_books = get_index_type< primary_index< limit_order_index > >()
+                                .get_secondary_index< limit_order_book_index >();
+
    // We only need to check if the new order will match with others if it is at the front of the book
-   const auto& limit_price_idx = get_index_type<limit_order_index>().indices().get<by_price>();
-   auto limit_itr = limit_price_idx.iterator_to( new_order_object );
-   if( limit_itr != limit_price_idx.begin() )
-   {
-      --limit_itr;
-      if( limit_itr->sell_asset_id() == sell_asset_id && limit_itr->receive_asset_id() == recv_asset_id )
-         return false;
-   }
+   const auto& own_book = order_books.get_book( sell_asset_id, recv_asset_id ).get<by_price>();
+   if( own_book.begin()->id != order_id )
+      return false;
 
    // this is the opposite side (on the book)
+   const auto& limit_price_idx = order_books.get_book( recv_asset_id, sell_asset_id ).get<by_price>();
    auto max_price = ~new_order_object.sell_price;
-   limit_itr = limit_price_idx.lower_bound( max_price.max() );
-   auto limit_end = limit_price_idx.upper_bound( max_price );
+   auto limit_itr = limit_price_idx.lower_bound( ranked_price( max_price.max() ) );
+   auto limit_end = limit_price_idx.upper_bound( ranked_price( max_price ) );
 
    // Order matching should be in favor of the taker.
    // When a new limit order is created, e.g. an ask, need to check if it will match the highest bid.
@@ -828,7 +830,7 @@ bool database::apply_order(const limit_order_object& new_order_object)
       auto limit_itr_after_call = limit_price_idx.lower_bound( call_match_price );
       while( !finished && limit_itr != limit_itr_after_call )
       {
-         const limit_order_object& matching_limit_order = *limit_itr;
+         const limit_order_object& matching_limit_order = *limit_itr->order;
          ++limit_itr;
          // match returns 2 when only the old order was fully filled.
          // In this case, we keep matching; otherwise, we stop.
@@ -912,7 +914,7 @@ bool database::apply_order(const limit_order_object& new_order_object)
    // still need to check limit orders
    while( !finished && limit_itr != limit_end )
    {
-      const limit_order_object& matching_limit_order = *limit_itr;
+      const limit_order_object& matching_limit_order = *limit_itr->order;
       ++limit_itr;
       // match returns 2 when only the old order was fully filled. In this case, we keep matching; otherwise, we stop.
       finished = ( match( new_order_object, matching_limit_order, matching_limit_order.sell_price )
@@ -584,6 +584,11 @@ void database::notify_applied_block( const signed_block& block )
    GRAPHENE_TRY_NOTIFY( applied_block, block )
 }
 
+void database::notify_block_changes_applied( const signed_block& block )
+{
+   GRAPHENE_TRY_NOTIFY( block_changes_applied, block )
+}
+
 void database::notify_on_pending_transaction( const signed_transaction& tx )
 {
    GRAPHENE_TRY_NOTIFY( on_pending_transaction, tx )
@@ -600,16 +605,16 @@ void database::notify_changed_objects()
       if( !new_objects.empty() )
       {
         vector<object_id_type> new_ids;
-        new_ids.reserve(head_undo.new_ids.size());
+        new_ids.reserve(head_undo.count(undo_state::created));
         flat_set<account_id_type> new_accounts_impacted;
-        for( const auto& item : head_undo.new_ids )
+        head_undo.for_each( undo_state::created, [&]( const undo_state::entry& item )
         {
-          new_ids.push_back(item);
-          auto* obj = find_object(item);
+          new_ids.push_back(item.id);
+          auto* obj = find_object(item.id);
           if(obj != nullptr)
             get_relevant_accounts(obj, new_accounts_impacted,
                                   MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(chain_time));
-        }
+        });
 
         if( !new_ids.empty() )
            GRAPHENE_TRY_NOTIFY( new_objects, new_ids, new_accounts_impacted)
@@ -619,14 +624,14 @@ void database::notify_changed_objects()
       if( !changed_objects.empty() )
       {
         vector<object_id_type> changed_ids;
-        changed_ids.reserve(head_undo.old_values.size());
+        changed_ids.reserve(head_undo.count(undo_state::modified));
         flat_set<account_id_type> changed_accounts_impacted;
-        for( const auto& item : head_undo.old_values )
+        head_undo.for_each( undo_state::modified, [&]( const undo_state::entry& item )
         {
-          changed_ids.push_back(item.first);
-          get_relevant_accounts(item.second.get(), changed_accounts_impacted,
+          changed_ids.push_back(item.id);
+          get_relevant_accounts(item.old_value, changed_accounts_impacted,
                                 MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(chain_time));
-        }
+        });
 
         if( !changed_ids.empty() )
            GRAPHENE_TRY_NOTIFY( changed_objects, changed_ids, changed_accounts_impacted)
@@ -636,18 +641,18 @@ void database::notify_changed_objects()
       if( !removed_objects.empty() )
       {
         vector<object_id_type> removed_ids;
-        removed_ids.reserve( head_undo.removed.size() );
+        removed_ids.reserve( head_undo.count(undo_state::removed) );
         vector<const object*> removed;
-        removed.reserve( head_undo.removed.size() );
+        removed.reserve( head_undo.count(undo_state::removed) );
         flat_set<account_id_type> removed_accounts_impacted;
-        for( const auto& item : head_undo.removed )
+        head_undo.for_each( undo_state::removed, [&]( const undo_state::entry& item )
         {
-          removed_ids.emplace_back( item.first );
-          auto* obj = item.second.get();
+          removed_ids.emplace_back( item.id );
+          const object* obj = item.old_value;
           removed.emplace_back( obj );
           get_relevant_accounts(obj, removed_accounts_impacted,
                                 MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(chain_time));
-        }
+        });
 
         if( !removed_ids.empty() )
            GRAPHENE_TRY_NOTIFY( removed_objects, removed_ids, removed, removed_accounts_impacted )
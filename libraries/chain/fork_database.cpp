@@ -24,7 +24,71 @@
 #include <graphene/chain/fork_database.hpp>
 #include <graphene/chain/exceptions.hpp>
 
+#include <fc/filesystem.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+namespace graphene { namespace chain { namespace detail {
+
+   /// One entry of the fork database journal, later entries for the same block take precedence
+   struct fork_journal_record
+   {
+      enum action_type : uint8_t
+      {
+         store  = 0, ///< the block is held by the fork database
+         erase  = 1  ///< the block was removed from the fork database
+      };
+
+      uint8_t                                                     action = store;
+      block_id_type                                               id;
+      /// omitted when a block which is already journaled has been applied
+      optional< signed_block >                                    block;
+      bool                                                        applied = false;
+      optional< vector< pair< witness_id_type, public_key_type > > > scheduled_witnesses;
+      uint64_t                                                    next_block_aslot = 0;
+      fc::time_point_sec                                          next_block_time;
+   };
+
+} } } // graphene::chain::detail
+
+FC_REFLECT( graphene::chain::detail::fork_journal_record,
+            (action)(id)(block)(applied)(scheduled_witnesses)(next_block_aslot)(next_block_time) )
+
 namespace graphene { namespace chain {
+
+namespace {
+
+   detail::fork_journal_record make_journal_record( const fork_item& item, bool with_block )
+   {
+      detail::fork_journal_record record;
+      record.id = item.id;
+      if( with_block )
+         record.block = item.data;
+      record.applied = item.applied;
+      if( item.scheduled_witnesses )
+         record.scheduled_witnesses = *item.scheduled_witnesses;
+      record.next_block_aslot = item.next_block_aslot;
+      record.next_block_time = item.next_block_time;
+      return record;
+   }
+
+   void apply_journal_record( fork_item& item, detail::fork_journal_record& record )
+   {
+      if( !record.applied )
+         return;
+      item.applied = true;
+      if( record.scheduled_witnesses.valid() )
+         item.scheduled_witnesses = std::make_shared< vector< pair< witness_id_type, public_key_type > > >(
+                                       std::move( *record.scheduled_witnesses ) );
+      item.next_block_aslot = record.next_block_aslot;
+      item.next_block_time = record.next_block_time;
+   }
+
+} // anonymous namespace
+
 fork_database::fork_database()
 {
 }
@@ -45,8 +109,10 @@ void fork_database::pop_block()
 void     fork_database::start_block(signed_block b)
 {
    auto item = std::make_shared<fork_item>(std::move(b));
+   item->applied = true;
    _index.insert(item);
    _head = item;
+   _journal_item( *item );
 }
 
 /**
@@ -58,6 +124,7 @@ shared_ptr<fork_item>  fork_database::push_block(const signed_block& b)
    auto item = std::make_shared<fork_item>(b);
    try {
       _push_block(item);
+      _journal_item(*item);
    }
    catch ( const unlinkable_block_exception& e )
    {
@@ -196,7 +263,8 @@ void fork_database::set_head(shared_ptr<fork_item> h)
 
 void fork_database::remove(block_id_type id)
 {
-   _index.get<block_id>().erase(id);
+   if( _index.get<block_id>().erase(id) > 0 )
+      _journal_removal(id);
    // If we're removing head, try to pop it
    if( _head && _head->id == id )
    {
@@ -211,4 +279,228 @@ void fork_database::remove(block_id_type id)
    }
 }
 
+void fork_database::open( const fc::path& journal_file )
+{ try {
+   if( _journal.is_open() )
+      _journal.close();
+   _journal_file = journal_file;
+   _loaded.clear();
+   _journal_records = 0;
+
+   if( fc::exists( journal_file ) && fc::file_size( journal_file ) > 0 )
+   {
+      fc::file_mapping fm( journal_file.generic_string().c_str(), fc::read_only );
+      fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size( journal_file ) );
+      const char* pos = (const char*)mr.get_address();
+      const char* const end = pos + mr.get_size();
+      while( pos < end )
+      {
+         uint32_t size = 0;
+         if( end - pos < int64_t( sizeof(size) ) )
+            break;
+         memcpy( &size, pos, sizeof(size) );
+         pos += sizeof(size);
+         if( end - pos < int64_t( size ) )
+            break;
+         detail::fork_journal_record record;
+         try {
+            fc::datastream<const char*> ds( pos, size );
+            fc::raw::unpack( ds, record );
+         } catch( const fc::exception& e ) {
+            wlog( "Ignoring corrupted fork database journal record: ${e}", ("e", e.to_detail_string()) );
+            break;
+         }
+         pos += size;
+
+         if( record.action == detail::fork_journal_record::erase )
+         {
+            _loaded.erase( record.id );
+            continue;
+         }
+         if( record.block.valid() )
+         {
+            FC_ASSERT( record.block->id() == record.id, "fork database journal record does not match its block" );
+            _loaded[record.id] = std::make_shared<fork_item>( std::move( *record.block ) );
+         }
+         auto itr = _loaded.find( record.id );
+         if( itr != _loaded.end() )
+            apply_journal_record( *itr->second, record );
+      }
+      if( pos < end )
+         wlog( "Fork database journal ${f} is truncated, ignoring the last ${n} bytes",
+               ("f", journal_file.preferred_string())("n", end - pos) );
+      ilog( "Loaded ${n} blocks from fork database journal", ("n", _loaded.size()) );
+   }
+
+   _compact_journal();
+} FC_CAPTURE_AND_RETHROW( (journal_file) ) }
+
+void fork_database::close()
+{
+   if( !is_open() )
+      return;
+   _compact_journal();
+   _journal.close();
+   _loaded.clear();
+}
+
+bool fork_database::is_validated( const block_id_type& id )const
+{
+   auto itr = _loaded.find( id );
+   return itr != _loaded.end() && itr->second->applied;
+}
+
+uint32_t fork_database::restore( const block_id_type& head_id )
+{
+   if( _loaded.empty() )
+      return 0;
+
+   uint32_t added = 0;
+   if( !_head )
+   {
+      auto itr = _loaded.find( head_id );
+      if( itr == _loaded.end() )
+      {
+         wlog( "Head block ${id} is not in the fork database journal, not restoring", ("id", head_id) );
+         _loaded.clear();
+         return 0;
+      }
+      itr->second->prev.reset();
+      itr->second->applied = true;
+      _index.insert( itr->second );
+      _head = itr->second;
+      _loaded.erase( itr );
+      ++added;
+   }
+
+   vector<item_ptr> items;
+   items.reserve( _loaded.size() );
+   for( const auto& loaded : _loaded )
+      items.push_back( loaded.second );
+   std::sort( items.begin(), items.end(), []( const item_ptr& a, const item_ptr& b ) { return a->num < b->num; } );
+   _loaded.clear();
+
+   const uint32_t min_num = _head->num - std::min( _max_size, _head->num );
+   for( const item_ptr& item : items )
+   {
+      if( item->num < min_num )
+         continue;
+      item_ptr known = fetch_block( item->id );
+      if( known )
+      {
+         if( !known->scheduled_witnesses && item->scheduled_witnesses )
+         {
+            known->scheduled_witnesses = item->scheduled_witnesses;
+            known->next_block_aslot = item->next_block_aslot;
+            known->next_block_time = item->next_block_time;
+         }
+         continue;
+      }
+      item_ptr prev = fetch_block( item->previous_id() );
+      if( !prev )
+         continue;
+      item->prev = prev;
+      _index.insert( item );
+      ++added;
+   }
+   ilog( "Restored ${n} blocks from fork database journal", ("n", added) );
+   return added;
+}
+
+void fork_database::mark_applied( fork_item& item )
+{
+   item.applied = true;
+   if( !is_open() )
+      return;
+   _write_journal_record( fc::raw::pack( make_journal_record( item, false ) ) );
+}
+
+void fork_database::record_fork_switch( const fc::microseconds& latency )
+{
+   ++_fork_switches;
+   _last_switch_latency = latency;
+   _max_switch_latency = std::max( _max_switch_latency, latency );
+}
+
+fork_database_metrics fork_database::get_metrics()const
+{
+   fork_database_metrics result;
+   result.size = _index.size();
+   if( _head && !_index.empty() )
+      result.depth = _head->num - std::min( _head->num, (*_index.get<block_num>().begin())->num );
+
+   std::unordered_set< block_id_type, std::hash<fc::ripemd160> > parents;
+   parents.reserve( _index.size() );
+   for( const item_ptr& item : _index )
+      parents.insert( item->previous_id() );
+   for( const item_ptr& item : _index )
+      if( parents.find( item->id ) == parents.end() )
+         ++result.branch_count;
+
+   result.fork_switches = _fork_switches;
+   result.last_switch_latency = _last_switch_latency;
+   result.max_switch_latency = _max_switch_latency;
+   return result;
+}
+
+void fork_database::_journal_item( const fork_item& item )
+{
+   if( !is_open() )
+      return;
+   _write_journal_record( fc::raw::pack( make_journal_record( item, true ) ) );
+}
+
+void fork_database::_journal_removal( const block_id_type& id )
+{
+   if( !is_open() )
+      return;
+   detail::fork_journal_record record;
+   record.action = detail::fork_journal_record::erase;
+   record.id = id;
+   _write_journal_record( fc::raw::pack( record ) );
+}
+
+void fork_database::_write_journal_record( const std::vector<char>& record )
+{
+   const uint32_t size = record.size();
+   _journal.write( (const char*)&size, sizeof(size) );
+   _journal.write( record.data(), record.size() );
+   _journal.flush();
+   ++_journal_records;
+   // every block is journaled about twice, compact once old and superseded records dominate
+   if( _journal_records > 4 * ( _index.size() + _loaded.size() ) + 64 )
+      _compact_journal();
+}
+
+void fork_database::_compact_journal()
+{ try {
+   if( _journal.is_open() )
+      _journal.close();
+
+   vector<item_ptr> items( _index.begin(), _index.end() );
+   for( const auto& loaded : _loaded )
+      if( !is_known_block( loaded.first ) )
+         items.push_back( loaded.second );
+   std::sort( items.begin(), items.end(), []( const item_ptr& a, const item_ptr& b ) { return a->num < b->num; } );
+
+   const fc::path tmp_file = _journal_file.generic_string() + ".tmp";
+   {
+      std::ofstream out( tmp_file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+      for( const item_ptr& item : items )
+      {
+         const std::vector<char> record = fc::raw::pack( make_journal_record( *item, true ) );
+         const uint32_t size = record.size();
+         out.write( (const char*)&size, sizeof(size) );
+         out.write( record.data(), record.size() );
+      }
+      out.flush();
+      FC_ASSERT( out.good(), "unable to write ${f}", ("f", tmp_file.preferred_string()) );
+   }
+   fc::rename( tmp_file, _journal_file );
+
+   _journal.open( _journal_file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::app );
+   FC_ASSERT( _journal.is_open(), "unable to open ${f}", ("f", _journal_file.preferred_string()) );
+   _journal_records = items.size();
+} FC_CAPTURE_AND_RETHROW( (_journal_file) ) }
+
 } } // graphene::chain
@@ -404,7 +404,8 @@ namespace graphene { namespace chain {
                std::less< account_id_type >
             >
          >
-      >
+      >,
+      graphene::db::pool_allocator<account_balance_object>
    > account_balance_object_multi_index_type;
 
    /**
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/protocol/transaction.hpp>
+
+#include <graphene/chain/types.hpp>
+
+#include <graphene/db/index.hpp>
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace graphene { namespace chain {
+   class database;
+
+   /// Hit rate and timing of the authority cache, for monitoring
+   struct authority_cache_metrics
+   {
+      uint32_t size = 0;               ///< cached results
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      uint64_t uncacheable = 0;        ///< checks of accounts which have custom authorities
+      uint64_t invalidations = 0;      ///< results dropped because an authority changed
+      uint64_t hit_microseconds = 0;   ///< time spent in checks answered from the cache
+      uint64_t miss_microseconds = 0;  ///< time spent in checks which walked the authorities
+   };
+
+   /**
+    *  Remembers which sets of signature keys satisfied the authorities required by a transaction, so that
+    *  the authorities of repeat signers are not walked again for every transaction.
+    *
+    *  A result is keyed by the signature keys, the required authorities and the parameters of the check. It
+    *  depends only on the owner and active authorities of the accounts which were read while checking, so it
+    *  is dropped when one of these accounts is modified or removed, or when a custom authority of one of
+    *  them is created, modified or removed. Checks which involve accounts with custom authorities are not
+    *  cached, since custom authorities depend on the content of the operations and on the time.
+    *
+    *  Only successful checks are cached. A failing check is repeated in full and throws like before.
+    */
+   class authority_cache
+   {
+      public:
+         /// Set the maximum number of cached results, 0 disables the cache
+         void set_max_size( size_t entries );
+
+         /// Registers the observers which drop outdated results with the account and custom authority indexes
+         void attach( graphene::db::index& account_index, graphene::db::index& custom_authority_index );
+
+         /// Checks the signatures of @p trx like signed_transaction::verify_authority
+         void verify_authority( const database& db, const signed_transaction& trx,
+                                bool allow_non_immediate_owner, bool ignore_custom_operation_required_auths,
+                                uint32_t max_recursion );
+
+         /// Drops the results which depend on the authorities of @p account
+         void invalidate( account_id_type account );
+         void clear();
+
+         authority_cache_metrics get_metrics()const;
+
+      private:
+         /// Maps keys to the accounts whose authorities were read
+         using result_map = std::unordered_map< std::string, flat_set<account_id_type> >;
+
+         void insert( std::string&& key, flat_set<account_id_type>&& accounts );
+
+         size_t                  _max_size = 64 * 1024;
+         result_map              _results;
+         /// Keys of the results which depend on an account, by account instance
+         std::unordered_map< uint64_t, std::unordered_set<const std::string*> > _by_account;
+         authority_cache_metrics _metrics;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::authority_cache_metrics,
+            (size)(hits)(misses)(uncacheable)(invalidations)(hit_microseconds)(miss_microseconds) )
@@ -27,13 +27,45 @@
 
 #include <fc/filesystem.hpp>
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
 namespace graphene { namespace chain {
-   struct index_entry;
+   struct block_location;
    using namespace graphene::protocol;
 
+   /**
+    *  @class block_database
+    *  @brief Append-only on-disk log of irreversible blocks, indexed by block number
+    *
+    *  Blocks are stored in two files: @c blocks holds the packed blocks back to back, and @c index holds one
+    *  fixed-size @ref index_entry per block number pointing into @c blocks.
+    *
+    *  Writes go through the file streams and are flushed at the end of every call to @ref store or @ref remove.
+    *  Reads do not touch the streams at all: both files are memory-mapped read-only and blocks are unpacked
+    *  straight from the mapped region. A mapping is replaced (not modified) when the file has grown beyond it,
+    *  and readers keep the mapping they started with alive through a shared pointer, so any number of threads
+    *  may call the const methods concurrently with each other and with a single writer.
+    *
+    *  Optionally the log can be stored compressed. The @c blocks file is then split into segments of a fixed
+    *  number of blocks. Each segment starts with a preset dictionary (the tail of the packed blocks written
+    *  before the segment), and every block of the segment is deflated separately against that dictionary, so
+    *  a read inflates exactly one block. The index entries of a compressed log point to the segment and the
+    *  offset of the block inside it. The format is chosen when the log is created and recorded in the
+    *  @c compression file; an existing log is always opened in the format it was created with.
+    */
    class block_database 
    {
       public:
+         /**
+          * Store blocks compressed in segments of @p blocks_per_segment blocks if the log is created by the
+          * next call to @ref open. Pass 0 to create uncompressed logs (the default).
+          */
+         void enable_compression( uint32_t blocks_per_segment );
+         bool is_compressed()const { return _blocks_per_segment > 0; }
+
          void open( const fc::path& dbdir );
          bool is_open()const;
          void flush();
@@ -46,14 +78,53 @@ namespace graphene { namespace chain {
          block_id_type          fetch_block_id( uint32_t block_num )const;
          optional<signed_block> fetch_optional( const block_id_type& id )const;
          optional<signed_block> fetch_by_number( uint32_t block_num )const;
+         /// The block with number @p block_num as it is packed by fc::raw, without unpacking it
+         optional<std::vector<char>> fetch_packed_by_number( uint32_t block_num )const;
          optional<signed_block> last()const;
          optional<block_id_type> last_id()const;
          size_t                 blocks_current_position()const;
          size_t                 total_block_size()const;
       private:
-         optional<index_entry> last_index_entry()const;
+         struct mapped_file;
+         using mapped_file_ptr = std::shared_ptr<const mapped_file>;
+
+         /// @return a mapping of the file which covers at least @p min_size bytes if the file is that large
+         mapped_file_ptr get_mapping( mapped_file_ptr& current, const fc::path& file,
+                                      const std::atomic<uint64_t>& file_size, uint64_t min_size )const;
+         void            unmap()const;
+
+         bool                   read_index_entry( uint32_t block_num, block_location& loc )const;
+         /// Passes the packed block at @p loc to @p reader, @return false if the block is not stored
+         bool                   read_packed_block( const block_location& loc,
+                                                   const std::function<void(const char*, size_t)>& reader )const;
+         optional<signed_block> read_block( const block_location& loc )const;
+         void                   write_index_entry( uint32_t block_num, const block_location& loc );
+         /// Writes a new segment header at @p pos, @return the position right after it
+         uint64_t               start_segment( uint64_t pos );
+
+         optional<block_location> last_index_entry()const;
+         /// Cuts entries which do not point to a valid block off the end of the index, only called by @ref open
+         void                     truncate_index();
          fc::path _index_filename;
+         fc::path _blocks_filename;
+         size_t   _index_entry_size = 0;
          mutable std::fstream _blocks;
          mutable std::fstream _block_num_to_pos;
+
+         mutable mapped_file_ptr       _index_map;
+         mutable mapped_file_ptr       _blocks_map;
+         mutable std::mutex            _remap_mutex;
+         mutable std::atomic<uint64_t> _index_size { 0 };  ///< bytes of the index file visible to readers
+         mutable std::atomic<uint64_t> _blocks_size { 0 }; ///< bytes of the blocks file visible to readers
+         mutable std::atomic<uint64_t> _blocks_read_position { 0 };
+
+         /// Compression settings for newly created logs
+         uint32_t          _new_log_blocks_per_segment = 0;
+         /// Number of blocks per segment of the open log, 0 if it is not compressed
+         uint32_t          _blocks_per_segment = 0;
+         uint64_t          _segment_pos = 0;     ///< position of the segment currently being written
+         uint32_t          _segment_blocks = 0;  ///< number of blocks written to the current segment
+         std::vector<char> _segment_dictionary;  ///< dictionary of the current segment
+         std::vector<char> _next_dictionary;     ///< tail of the most recently written packed blocks
    };
 } }
@@ -64,7 +64,8 @@ namespace graphene { namespace chain {
          return rs;
       }
       /// Get predicate, from cache if possible, and update cache if not (modifies const object!)
-      restriction_predicate_function get_predicate() const {
+      /// The reference is valid until the cache is cleared; copying the function would copy the whole predicate tree
+      const restriction_predicate_function& get_predicate() const {
          if (!predicate_cache.valid())
             update_predicate_cache();
 
@@ -30,6 +30,9 @@
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/fork_database.hpp>
+#include <graphene/chain/pending_transaction_pool.hpp>
+#include <graphene/chain/authority_cache.hpp>
+#include <graphene/chain/vote_tally_cache.hpp>
 #include <graphene/chain/block_database.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
@@ -48,6 +51,7 @@ namespace graphene { namespace protocol { struct predicate_result; } }
 namespace graphene { namespace chain {
    using graphene::db::abstract_object;
    using graphene::db::object;
+   using graphene::db::object_changes;
    class op_evaluator;
    class transaction_evaluation_state;
    class proposal_object;
@@ -125,6 +129,29 @@ namespace graphene { namespace chain {
          void wipe(const fc::path& data_dir, bool include_blocks);
          void close(bool rewind = true);
 
+         /**
+          * @brief Turns this database into a read replica of @p primary
+          *
+          * Copies the objects of @p primary as of its head block, including the ones in the indexes of plugins,
+          * which are added to this database. This database must not have been opened, and secondary indexes
+          * which the replica needs must be added before. The replica has neither a block log nor a fork
+          * database, it follows @p primary through @ref apply_replicated_changes.
+          */
+         void copy_state_from( const database& primary );
+         /**
+          * Calls @p callback with the pending transactions removed, so that the objects are the ones as of the
+          * head block, e.g. to copy them with @ref copy_state_from. The pending transactions are pushed again
+          * afterwards. Must not be called while a block is being applied.
+          */
+         void with_head_block_state( const std::function<void()>& callback );
+         /**
+          * Applies the changes which the primary database made to its objects when it applied a block, see
+          * @ref block_changes_applied, without applying the block again. The blocks of a fork which the
+          * primary has switched away from are undone first.
+          * @param previous the ID of the block before the one that made the changes
+          */
+         void apply_replicated_changes( const block_id_type& previous, const object_changes& changes );
+
          //////////////////// db_witness_schedule.cpp ////////////////////
 
          /**
@@ -230,6 +257,8 @@ namespace graphene { namespace chain {
       private:
          void initialize_evaluators();
          void init_genesis(const genesis_state_type& genesis_state = genesis_state_type());
+         /// Looks up the objects which are cached in pointers, after they have been loaded
+         void init_object_pointers();
 
          template<typename EvaluatorType>
          void register_evaluator()
@@ -564,6 +593,8 @@ namespace graphene { namespace chain {
          block_id_type              get_block_id_for_num( uint32_t block_num )const;
          optional<signed_block>     fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>     fetch_block_by_number( uint32_t num )const;
+         /// Like @ref fetch_block_by_number, but packed by fc::raw, irreversible blocks are not unpacked
+         optional<std::vector<char>> fetch_packed_block_by_number( uint32_t num )const;
          const signed_transaction&  get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
 
@@ -623,6 +654,13 @@ namespace graphene { namespace chain {
           */
          fc::signal<void(const signed_block&)>           applied_block;
 
+         /**
+          *  Emitted at the end of applying a block, after the handlers of applied_block have updated their
+          *  objects too. Unless undo is disabled, the newest undo state then holds all changes that the block
+          *  made, which @ref copy_head_changes copies. The callback should not yield and should execute quickly.
+          */
+         fc::signal<void(const signed_block&)>           block_changes_applied;
+
          /**
           * This signal is emitted any time a new transaction is added to the pending
           * block state.
@@ -682,6 +720,9 @@ namespace graphene { namespace chain {
           *         precomputations applied
           */
          fc::future<void> precompute_parallel( const precomputable_transaction& trx )const;
+
+         /// Does all the precomputations of @ref precompute_parallel for the block in the calling thread
+         void precompute_block( const signed_block& block, const uint32_t skip = skip_nothing )const;
       private:
          template<typename Trx>
          void _precompute_parallel( const Trx* trx, const size_t count, const uint32_t skip )const;
@@ -729,6 +770,7 @@ namespace graphene { namespace chain {
          void notify_applied_block( const signed_block& block );
          void notify_on_pending_transaction( const signed_transaction& tx );
          void notify_changed_objects();
+         void notify_block_changes_applied( const signed_block& block );
 
          //////////////////// db_update.cpp ////////////////////
       public:
@@ -769,11 +811,13 @@ namespace graphene { namespace chain {
          void process_bitassets();
 
          template<class Type>
-         void perform_account_maintenance( Type tally_helper );
+         void perform_account_maintenance( Type& tally_helper );
          ///@}
          ///@}
 
-         vector< processed_transaction >        _pending_tx;
+         pending_transaction_pool               _pending_tx;
+         authority_cache                        _authority_cache;
+         vote_tally_cache                       _vote_tally_cache;
          fork_database                          _fork_db;
 
          /**
@@ -817,6 +861,21 @@ namespace graphene { namespace chain {
          /// Set it to true to provide accurate data to API clients, set to false to have better performance.
          bool                              _track_standby_votes = true;
 
+         /// Whether to tally the votes of the accounts in parallel when performing chain maintenance.
+         /// The result is the same either way.
+         bool                              _parallel_vote_tally = true;
+
+         /// Whether to keep the votes counted at the last chain maintenance and only count the changed accounts
+         /// again at the next one. The result is the same either way.
+         bool                              _incremental_vote_tally = true;
+
+         /// Maximum number of blocks read ahead of the apply stage during replay
+         uint32_t                          _reindex_read_ahead = 200;
+         /// Maximum number of blocks being precomputed in parallel during replay, 0 for twice the IO threads
+         uint32_t                          _reindex_precompute_depth = 0;
+         /// Whether to journal the fork database so that it survives a restart
+         bool                              _persist_fork_db = false;
+
          /**
           * Whether database is successfully opened or not.
           *
@@ -844,6 +903,32 @@ namespace graphene { namespace chain {
       public:
          /// Enable or disable tracking of votes of standby witnesses and committee members
          inline void enable_standby_votes_tracking(bool enable)  { _track_standby_votes = enable; }
+         /// Enable or disable tallying votes in parallel during chain maintenance
+         inline void enable_parallel_vote_tally(bool enable)  { _parallel_vote_tally = enable; }
+         /// Enable or disable counting only the changed accounts during chain maintenance
+         inline void enable_incremental_vote_tally(bool enable)  { _incremental_vote_tally = enable; }
+         /// The votes kept from the last chain maintenance
+         inline const vote_tally_cache& get_vote_tally_cache()const { return _vote_tally_cache; }
+         /// Store blocks compressed in segments of @p blocks_per_segment blocks when a new block log is created
+         inline void enable_block_log_compression(uint32_t blocks_per_segment)
+         { _block_id_to_block.enable_compression( blocks_per_segment ); }
+         /// Set the maximum number of blocks read ahead of the apply stage during replay
+         inline void set_reindex_read_ahead(uint32_t blocks)  { _reindex_read_ahead = std::max( blocks, 1u ); }
+         /// Set the maximum number of blocks precomputed in parallel during replay, 0 for automatic
+         inline void set_reindex_precompute_depth(uint32_t blocks)  { _reindex_precompute_depth = blocks; }
+         /// Keep the fork database in a journal file, takes effect when the database is opened
+         inline void enable_fork_db_persistence(bool enable)  { _persist_fork_db = enable; }
+         /// Size and fork activity of the fork database
+         inline fork_database_metrics get_fork_db_metrics()const { return _fork_db.get_metrics(); }
+         /// Set the maximum total size of pending transactions in bytes, 0 for no limit
+         inline void set_max_pending_transactions_size(uint64_t bytes)  { _pending_tx.set_max_size( bytes ); }
+         /// Size and activity of the pending transaction pool
+         inline pending_transaction_pool_metrics get_pending_transaction_pool_metrics()const
+         { return _pending_tx.get_metrics(); }
+         /// Set the maximum number of cached authority checks, 0 to check every transaction in full
+         inline void set_authority_cache_size(uint32_t entries)  { _authority_cache.set_max_size( entries ); }
+         /// Hit rate and timing of the authority checks of transactions
+         inline authority_cache_metrics get_authority_cache_metrics()const { return _authority_cache.get_metrics(); }
    };
 
 } }
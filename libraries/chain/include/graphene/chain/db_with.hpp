@@ -68,7 +68,7 @@ struct skip_flags_restorer
  */
 struct pending_transactions_restorer
 {
-   pending_transactions_restorer( database& db, std::vector<processed_transaction>&& pending_transactions )
+   pending_transactions_restorer( database& db, pending_transaction_pool::pool_index_type&& pending_transactions )
       : _db(db), _pending_transactions( std::move(pending_transactions) )
    {
       _db.clear_pending();
@@ -86,12 +86,17 @@ struct pending_transactions_restorer
          }
       }
       _db._popped_tx.clear();
-      for( const processed_transaction& tx : _pending_transactions )
+
+      // The authorities are checked again for every transaction, since the new block may have changed an
+      // authority they depend on indirectly.  The authority cache keeps the checks of unchanged authorities cheap.
+      _db._pending_tx.remove_expired_and_excess( _pending_transactions, _db.head_block_time() );
+      for( const pending_transaction& tx : _pending_transactions.get<pending_transaction_pool::by_sequence>() )
       {
          try
          {
-            if( !_db.is_known_transaction( tx.id() ) ) {
-               _db._push_transaction( tx );
+            if( !_db.is_known_transaction( tx.id ) ) {
+               _db._pending_tx.record_revalidation();
+               _db._push_transaction( tx.trx );
             }
          }
          catch( const fc::exception& )
@@ -101,7 +106,7 @@ struct pending_transactions_restorer
    }
 
    database& _db;
-   std::vector< processed_transaction > _pending_transactions;
+   pending_transaction_pool::pool_index_type _pending_transactions;
 };
 
 /**
@@ -131,7 +136,7 @@ void with_skip_flags(
 template< typename Lambda >
 void without_pending_transactions(
    database& db,
-   std::vector<processed_transaction>&& pending_transactions,
+   pending_transaction_pool::pool_index_type&& pending_transactions,
    Lambda callback )
 {
     pending_transactions_restorer restorer( db, std::move(pending_transactions) );
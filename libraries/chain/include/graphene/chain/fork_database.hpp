@@ -33,6 +33,9 @@
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 
+#include <fstream>
+#include <unordered_map>
+
 namespace graphene { namespace chain {
    using boost::multi_index_container;
    using namespace boost::multi_index;
@@ -53,9 +56,23 @@ namespace graphene { namespace chain {
       shared_ptr< vector< pair< witness_id_type, public_key_type > > > scheduled_witnesses;
       uint64_t                                                         next_block_aslot = 0;
       fc::time_point_sec                                               next_block_time;
+
+      /// true once the block has been applied successfully on top of its predecessor
+      bool                                                             applied = false;
    };
    typedef shared_ptr<fork_item> item_ptr;
 
+   /// Size and fork activity of the fork database, for monitoring
+   struct fork_database_metrics
+   {
+      uint32_t           size = 0;           ///< number of blocks held
+      uint32_t           depth = 0;          ///< distance from the oldest held block to the head block
+      uint32_t           branch_count = 0;   ///< number of branch tips, 1 if there are no competing forks
+      uint64_t           fork_switches = 0;  ///< number of fork switches since the node started
+      fc::microseconds   last_switch_latency;
+      fc::microseconds   max_switch_latency;
+   };
+
 
    /**
     *  As long as blocks are pushed in order the fork
@@ -66,6 +83,10 @@ namespace graphene { namespace chain {
     *
     *  Every time a block is pushed into the fork DB the
     *  block with the highest block_num will be returned.
+    *
+    *  Optionally the fork database is persisted to a journal file, see @ref open.  Blocks
+    *  which were applied before the node stopped are then known to be valid and competing
+    *  branches survive a restart.
     */
    class fork_database
    {
@@ -110,14 +131,56 @@ namespace graphene { namespace chain {
 
          void set_max_size( uint32_t s );
 
+         /**
+          *  Loads the blocks persisted in @p journal_file and journals every change from now on.
+          *  The loaded blocks are held back until @ref restore links them to the chain.
+          */
+         void                             open( const fc::path& journal_file );
+         /// Rewrites the journal with the current content and stops journaling
+         void                             close();
+         bool                             is_open()const { return _journal.is_open(); }
+
+         /// @return true if @p id was loaded from the journal and had been applied successfully
+         bool                             is_validated( const block_id_type& id )const;
+         /**
+          *  Links the blocks loaded by @ref open to the known blocks.  If the fork database is
+          *  empty, the loaded block with @p head_id becomes the head.
+          *  @return the number of blocks added
+          */
+         uint32_t                         restore( const block_id_type& head_id );
+         /// Marks @p item as applied, and journals it including its scheduled witnesses
+         void                             mark_applied( fork_item& item );
+
+         /// Records the time taken by a fork switch
+         void                             record_fork_switch( const fc::microseconds& latency );
+         fork_database_metrics            get_metrics()const;
+
       private:
          /** @return a pointer to the newly pushed item */
          void _push_block(const item_ptr& b );
          void _push_next(const item_ptr& newly_inserted);
 
+         void _journal_item( const fork_item& item );
+         void _journal_removal( const block_id_type& id );
+         void _write_journal_record( const std::vector<char>& record );
+         void _compact_journal();
+
          uint32_t                 _max_size = 1024;
 
          fork_multi_index_type    _index;
          shared_ptr<fork_item>    _head;
+
+         fc::path                 _journal_file;
+         std::ofstream            _journal;
+         uint32_t                 _journal_records = 0;
+         /// blocks loaded from the journal which are not yet linked, see @ref restore
+         std::unordered_map< block_id_type, item_ptr, std::hash<fc::ripemd160> > _loaded;
+
+         uint64_t                 _fork_switches = 0;
+         fc::microseconds         _last_switch_latency;
+         fc::microseconds         _max_switch_latency;
    };
 } } // graphene::chain
+
+FC_REFLECT( graphene::chain::fork_database_metrics,
+            (size)(depth)(branch_count)(fork_switches)(last_switch_latency)(max_switch_latency) )
@@ -23,12 +23,17 @@
  */
 #pragma once
 
+#include <graphene/chain/ranked_price.hpp>
 #include <graphene/chain/types.hpp>
 #include <graphene/db/generic_index.hpp>
 #include <graphene/protocol/asset.hpp>
 #include <graphene/protocol/market.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+
+#include <map>
+#include <stack>
 
 namespace graphene { namespace chain {
 
@@ -48,7 +53,7 @@ class limit_order_object : public abstract_object<limit_order_object, protocol_i
       time_point_sec   expiration; ///< When this limit order will expire
       account_id_type  seller; ///< Who is selling
       share_type       for_sale; ///< The amount for sale, asset id is sell_price.base.asset_id
-      price            sell_price; ///< The seller's asking price
+      ranked_price     sell_price; ///< The seller's asking price
       fc::uint128_t    filled_amount = 0; ///< The amount that has been sold, asset id is sell_price.base.asset_id
       share_type       deferred_fee; ///< fee converted to CORE
       asset            deferred_paid_fee; ///< originally paid fee
@@ -97,10 +102,10 @@ typedef multi_index_container<
       >,
       ordered_unique< tag<by_price>,
          composite_key< limit_order_object,
-            member< limit_order_object, price, &limit_order_object::sell_price>,
+            member< limit_order_object, ranked_price, &limit_order_object::sell_price>,
             member< object, object_id_type, &object::id>
          >,
-         composite_key_compare< std::greater<price>, std::less<object_id_type> >
+         composite_key_compare< ranked_price_greater, std::less<object_id_type> >
       >,
       ordered_unique< tag<by_is_settled_debt>,
          composite_key< limit_order_object,
@@ -120,16 +125,73 @@ typedef multi_index_container<
       ordered_unique< tag<by_account_price>,
          composite_key< limit_order_object,
             member<limit_order_object, account_id_type, &limit_order_object::seller>,
-            member<limit_order_object, price, &limit_order_object::sell_price>,
+            member<limit_order_object, ranked_price, &limit_order_object::sell_price>,
             member<object, object_id_type, &object::id>
          >,
-         composite_key_compare<std::less<account_id_type>, std::greater<price>, std::less<object_id_type>>
+         composite_key_compare<std::less<account_id_type>, ranked_price_greater, std::less<object_id_type>>
       >
-   >
+   >,
+   graphene::db::pool_allocator<limit_order_object>
 > limit_order_multi_index_type;
 
 typedef generic_index<limit_order_object, limit_order_multi_index_type> limit_order_index;
 
+/// An entry of a @ref limit_order_book, keeps a copy of the price to compare without dereferencing the order
+struct limit_order_book_entry
+{
+   ranked_price               sell_price;
+   object_id_type             id;
+   const limit_order_object*  order = nullptr;
+};
+
+/**
+ * @ingroup object_index
+ * The limit orders of one market, in the same order as the by_price index of @ref limit_order_index: the best
+ * price first, orders with the same price in the order they were placed
+ */
+typedef multi_index_container<
+   limit_order_book_entry,
+   indexed_by<
+      ordered_unique< tag<by_price>,
+         composite_key< limit_order_book_entry,
+            member< limit_order_book_entry, ranked_price, &limit_order_book_entry::sell_price >,
+            member< limit_order_book_entry, object_id_type, &limit_order_book_entry::id >
+         >,
+         composite_key_compare< ranked_price_greater, std::less<object_id_type> >
+      >,
+      hashed_unique< tag<by_id>, member< limit_order_book_entry, object_id_type, &limit_order_book_entry::id > >
+   >
+> limit_order_book;
+
+/**
+ * @brief This secondary index partitions the limit orders by market
+ *
+ * Every pair of sell asset and receive asset has its own @ref limit_order_book, so that finding and matching the
+ * orders of a market only involves the orders of that market. Books are kept when they become empty, so iterators
+ * into a book stay valid while orders are matched, also when an order changes its price.
+ */
+class limit_order_book_index : public secondary_index
+{
+   public:
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after  ) override;
+
+      /// @return the book of the orders which sell @p sell_asset for @p receive_asset, maybe empty
+      const limit_order_book& get_book( asset_id_type sell_asset, asset_id_type receive_asset )const;
+      /// @return the number of markets which have or had limit orders
+      size_t get_market_count()const { return _books.size(); }
+
+   private:
+      using market_type = std::pair< asset_id_type, asset_id_type >;
+      static market_type get_market_of( const limit_order_object& o )
+      { return std::make_pair( o.sell_asset_id(), o.receive_asset_id() ); }
+
+      std::map< market_type, limit_order_book > _books;
+      std::stack< std::pair< object_id_type, market_type > > _markets_being_modified;
+};
+
 /**
  * @class call_order_object
  * @brief tracks debt and call price information
@@ -150,7 +212,7 @@ class call_order_object : public abstract_object<call_order_object, protocol_ids
       account_id_type  borrower;
       share_type       collateral;  ///< call_price.base.asset_id, access via get_collateral
       share_type       debt;        ///< call_price.quote.asset_id, access via get_debt
-      price            call_price;  ///< Collateral / Debt
+      ranked_price     call_price;  ///< Collateral / Debt
 
       optional<uint16_t> target_collateral_ratio; ///< maximum CR to maintain when selling collateral on margin call
 
@@ -225,10 +287,10 @@ typedef multi_index_container<
          member< object, object_id_type, &object::id > >,
       ordered_unique< tag<by_price>,
          composite_key< call_order_object,
-            member< call_order_object, price, &call_order_object::call_price>,
+            member< call_order_object, ranked_price, &call_order_object::call_price>,
             member< object, object_id_type, &object::id>
          >,
-         composite_key_compare< std::less<price>, std::less<object_id_type> >
+         composite_key_compare< ranked_price_less, std::less<object_id_type> >
       >,
       ordered_unique< tag<by_account>,
          composite_key< call_order_object,
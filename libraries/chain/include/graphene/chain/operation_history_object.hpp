@@ -127,7 +127,8 @@ namespace graphene { namespace chain {
                std::greater< object_id_type >
             >
          >
-      >
+      >,
+      graphene::db::pool_allocator< operation_history_object >
    >;
 
    using operation_history_index = generic_index< operation_history_object, operation_history_mlti_idx_type >;
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/protocol/transaction.hpp>
+
+#include <graphene/chain/types.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
+namespace graphene { namespace chain {
+   using boost::multi_index_container;
+   using namespace boost::multi_index;
+
+   /// A transaction which has been applied to the pending state
+   struct pending_transaction
+   {
+      processed_transaction       trx;
+      transaction_id_type         id;
+      uint64_t                    sequence = 0;     ///< arrival order
+      uint32_t                    size = 0;         ///< packed size in bytes
+      uint64_t                    fee_density = 0;  ///< fees converted to the core asset per KiB
+      fc::time_point_sec          expiration;
+      account_id_type             fee_payer;        ///< fee payer of the first operation
+   };
+
+   /// Size and activity of the pending transaction pool, for monitoring
+   struct pending_transaction_pool_metrics
+   {
+      uint32_t   size = 0;
+      uint64_t   bytes = 0;
+      uint64_t   accepted = 0;         ///< transactions added to the pool
+      uint64_t   rejected = 0;         ///< transactions refused because the pool was full
+      uint64_t   evicted = 0;          ///< transactions dropped to bring the pool back to its maximum size
+      uint64_t   expired = 0;          ///< transactions dropped because they expired
+      uint64_t   revalidated = 0;      ///< transactions re-applied after a block
+   };
+
+   /**
+    *  Holds the transactions which have been applied to the pending state, in the order they were applied.
+    *
+    *  Besides the arrival order the pool is indexed by fee density, expiration and fee payer.  Blocks are
+    *  filled by decreasing fee density while the transactions of one fee payer keep their arrival order.
+    *  When the pool exceeds its maximum size the transactions with the lowest fee density are evicted.
+    *
+    *  After every block all transactions are re-applied to the new pending state. The pool does not track which
+    *  objects a transaction read, so it can not tell which transactions a block left valid. Even with such read
+    *  sets, nearly every transaction would have to be re-applied, since paying a fee reads objects that every
+    *  block with fees changes, e.g. the dynamic data of the fee asset.
+    */
+   class pending_transaction_pool
+   {
+      public:
+         struct by_id;
+         struct by_sequence;
+         struct by_fee_density;
+         struct by_expiration;
+         struct by_fee_payer;
+         typedef multi_index_container<
+            pending_transaction,
+            indexed_by<
+               hashed_unique< tag<by_id>,
+                  member< pending_transaction, transaction_id_type, &pending_transaction::id >,
+                  std::hash<transaction_id_type> >,
+               ordered_unique< tag<by_sequence>,
+                  member< pending_transaction, uint64_t, &pending_transaction::sequence > >,
+               ordered_unique< tag<by_fee_density>,
+                  composite_key< pending_transaction,
+                     member< pending_transaction, uint64_t, &pending_transaction::fee_density >,
+                     member< pending_transaction, uint64_t, &pending_transaction::sequence >
+                  >,
+                  composite_key_compare< std::greater<uint64_t>, std::less<uint64_t> > >,
+               ordered_non_unique< tag<by_expiration>,
+                  member< pending_transaction, fc::time_point_sec, &pending_transaction::expiration > >,
+               ordered_unique< tag<by_fee_payer>,
+                  composite_key< pending_transaction,
+                     member< pending_transaction, account_id_type, &pending_transaction::fee_payer >,
+                     member< pending_transaction, uint64_t, &pending_transaction::sequence >
+                  > >
+            >
+         > pool_index_type;
+
+         /// Set the maximum total size of the pooled transactions in bytes, 0 for no limit
+         void set_max_size( uint64_t bytes ) { _max_size = bytes; }
+         uint64_t max_size()const { return _max_size; }
+
+         /// @return the fee density of a transaction of @p size bytes paying @p core_fee
+         static uint64_t fee_density( uint64_t core_fee, uint32_t size );
+
+         /**
+          *  A full pool only accepts transactions which pay a higher fee density than the lowest one in the
+          *  pool, and no more than twice its maximum size until the transactions with the lowest fee density
+          *  are evicted after the next block.
+          *  @return true if a transaction with @p fee_density and @p size can be added
+          */
+         bool can_accept( uint64_t fee_density, uint32_t size )const;
+         void record_rejection() { ++_metrics.rejected; }
+
+         /// Adds a transaction which has been applied to the pending state
+         const pending_transaction& insert( processed_transaction trx, uint32_t size, uint64_t core_fee );
+
+         bool                     contains( const transaction_id_type& id )const;
+         bool                     empty()const { return _index.empty(); }
+         size_t                   size()const { return _index.size(); }
+         const pool_index_type&   indices()const { return _index; }
+         void                     clear();
+
+         /// Moves all transactions out of the pool, e.g. to re-apply them after a block
+         pool_index_type          take_all();
+         /// Drops expired transactions from @p transactions, and the ones with the lowest fee density
+         /// as long as they exceed the maximum size
+         void                     remove_expired_and_excess( pool_index_type& transactions,
+                                                             fc::time_point_sec now );
+
+         /// @return the transactions by decreasing fee density, the ones of a fee payer in arrival order
+         vector<const pending_transaction*> block_order()const;
+
+         void record_revalidation() { ++_metrics.revalidated; }
+         pending_transaction_pool_metrics get_metrics()const;
+
+      private:
+         pool_index_type                    _index;
+         uint64_t                           _next_sequence = 0;
+         uint64_t                           _bytes = 0;
+         uint64_t                           _max_size = 0;
+         pending_transaction_pool_metrics   _metrics;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::pending_transaction_pool_metrics,
+            (size)(bytes)(accepted)(rejected)(evicted)(expired)(revalidated) )
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/protocol/asset.hpp>
+
+#include <fc/uint128.hpp>
+
+namespace graphene { namespace chain {
+
+using graphene::protocol::price;
+
+/**
+ * @brief A price which carries an order-preserving fixed-point rank of its value
+ *
+ * The order book indexes compare prices on every lookup and on every rebalance of their trees, and an exact
+ * comparison of two prices takes two 128-bit multiplications. The rank is floor( base * 2^64 / quote ), which is
+ * computed once whenever the price is assigned. Ranks of two prices in the same market never disagree with the exact
+ * order of the prices, so the index comparators below only compare exactly when the ranks are equal.
+ *
+ * Prices with amounts which are not positive have no rank and are always compared exactly.
+ *
+ * The rank is not serialized, it is recomputed when the price is unpacked. Assign a whole price to change the value;
+ * the rank does not follow changes made directly to base or quote.
+ */
+class ranked_price : public price
+{
+   public:
+      ranked_price() = default;
+      explicit ranked_price( const price& p ) : price( p ), rank( compute_rank( p ) ) {}
+
+      ranked_price& operator=( const price& p )
+      {
+         price::operator=( p );
+         rank = compute_rank( p );
+         return *this;
+      }
+
+      /// The rank of the price, 0 if the price has no rank
+      const fc::uint128_t& get_rank()const { return rank; }
+
+      static fc::uint128_t compute_rank( const price& p )
+      {
+         if( p.base.amount.value <= 0 || p.quote.amount.value <= 0 )
+            return 0;
+         // base < 2^63 so the shifted value fits, and quote < 2^63 so a ranked price has a rank of at least 2
+         return ( fc::uint128_t( p.base.amount.value ) << 64 ) / static_cast<uint64_t>( p.quote.amount.value );
+      }
+
+   private:
+      fc::uint128_t rank = 0;
+};
+
+/// Same order as std::less<price>, prices with different ranks are not compared exactly
+struct ranked_price_less
+{
+   bool operator()( const ranked_price& a, const ranked_price& b )const
+   {
+      if( a.base.asset_id != b.base.asset_id )
+         return a.base.asset_id < b.base.asset_id;
+      if( a.quote.asset_id != b.quote.asset_id )
+         return a.quote.asset_id < b.quote.asset_id;
+      if( a.get_rank() != b.get_rank() && a.get_rank() != 0 && b.get_rank() != 0 )
+         return a.get_rank() < b.get_rank();
+      return static_cast<const price&>( a ) < static_cast<const price&>( b );
+   }
+   // Lookups by plain prices compare exactly
+   bool operator()( const ranked_price& a, const price& b )const { return static_cast<const price&>( a ) < b; }
+   bool operator()( const price& a, const ranked_price& b )const { return a < static_cast<const price&>( b ); }
+};
+
+/// Same order as std::greater<price>, prices with different ranks are not compared exactly
+struct ranked_price_greater
+{
+   template<typename A, typename B>
+   bool operator()( const A& a, const B& b )const { return ranked_price_less()( b, a ); }
+};
+
+} } // graphene::chain
+
+namespace fc {
+
+inline void to_variant( const graphene::chain::ranked_price& p, fc::variant& v, uint32_t max_depth )
+{
+   to_variant( static_cast<const graphene::protocol::price&>( p ), v, max_depth );
+}
+
+inline void from_variant( const fc::variant& v, graphene::chain::ranked_price& p, uint32_t max_depth )
+{
+   p = v.as<graphene::protocol::price>( max_depth );
+}
+
+namespace raw {
+
+template< typename Stream >
+void pack( Stream& s, const graphene::chain::ranked_price& p, uint32_t _max_depth=FC_PACK_MAX_DEPTH )
+{
+   fc::raw::pack( s, static_cast<const graphene::protocol::price&>( p ), _max_depth );
+}
+
+template< typename Stream >
+void unpack( Stream& s, graphene::chain::ranked_price& p, uint32_t _max_depth=FC_PACK_MAX_DEPTH )
+{
+   graphene::protocol::price tmp;
+   fc::raw::unpack( s, tmp, _max_depth );
+   p = tmp;
+}
+
+} } // fc::raw
+
+FC_REFLECT_TYPENAME( graphene::chain::ranked_price )
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/types.hpp>
+#include <graphene/protocol/vote.hpp>
+
+#include <graphene/db/index.hpp>
+
+#include <array>
+#include <map>
+#include <set>
+#include <stack>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace graphene { namespace chain {
+   class account_object;
+   class account_statistics_object;
+   class database;
+
+   /**
+    *  Keeps the votes of all accounts as counted at the last chain maintenance, so that the next maintenance only
+    *  needs to count again the accounts whose votes or voting stake changed since then.
+    *
+    *  For every account whose stake votes the cache keeps its @ref contribution, i.e. the stakes which it adds to
+    *  the votes of its opinion account, and the sums of all contributions in a @ref vote_tally. When an account
+    *  changes, its old contribution is subtracted from the sums and the new one is added. Since the sums are
+    *  modulo 2^64 like the full count, the result is exactly the same.
+    *
+    *  The decay of votes (see vote_recalc_options) changes contributions over time, so every contribution
+    *  records until when it is valid. The cache is not persisted, it is rebuilt by counting all votes again at
+    *  the first maintenance after the node started, after the last counted maintenance block was popped, and when
+    *  one of the @ref tally_parameters changed.
+    */
+   class vote_tally_cache
+   {
+      public:
+         /// The voting stakes which a stake account adds to the votes of its opinion account
+         struct contribution
+         {
+            account_id_type            opinion_account;
+            account_statistics_id_type opinion_stats;
+            std::array<uint64_t,3>     stakes {{ 0, 0, 0 }};  ///< per vote, as in vote_id_type::vote_type
+            uint64_t                   num_committee_stake = 0; ///< for the number of committee members
+            uint64_t                   vp_all = 0;
+            uint64_t                   vp_active = 0;
+            /// The stakes have to be counted again at or after this time due to the decay of votes
+            time_point_sec             valid_until = time_point_sec::maximum();
+         };
+
+         /// Everything else the contributions depend on, the cache is rebuilt when one of them changes
+         struct tally_parameters
+         {
+            uint32_t next_available_vote_id = 0;
+            uint16_t maximum_witness_count = 0;
+            uint16_t maximum_committee_count = 0;
+            bool     count_non_member_votes = false;
+            bool     pob_activated = false;
+
+            bool operator == ( const tally_parameters& o )const;
+         };
+
+         /// Sums of the contributions
+         struct vote_tally
+         {
+            vector<uint64_t>        votes;
+            vector<uint64_t>        witness_count_histogram;
+            vector<uint64_t>        committee_count_histogram;
+            std::array<uint64_t,2>  total_voting_stake {{ 0, 0 }}; // 0=committee, 1=witness
+
+            /// Sizes the sums for @p params and sets them to zero
+            void init( const tally_parameters& params );
+            void add( const contribution& c, const flat_set<vote_id_type>& votes,
+                      uint16_t num_witness, uint16_t num_committee, const tally_parameters& params );
+            void subtract( const contribution& c, const flat_set<vote_id_type>& votes,
+                           uint16_t num_witness, uint16_t num_committee, const tally_parameters& params );
+         };
+
+         /// Sums of the voting power stats of the contributions of one opinion account
+         struct voting_power
+         {
+            account_statistics_id_type opinion_stats;
+            uint32_t contributions = 0;
+            uint64_t vp_all = 0;
+            uint64_t vp_active = 0;
+            uint64_t vp_committee = 0;
+            uint64_t vp_witness = 0;
+            uint64_t vp_worker = 0;
+
+            void add( const contribution& c );
+            void subtract( const contribution& c );
+         };
+
+         /// The options of an opinion account which decide where the stakes of its contributions are added
+         struct voting_options
+         {
+            flat_set<vote_id_type> votes;
+            uint16_t               num_witness = 0;
+            uint16_t               num_committee = 0;
+         };
+
+         /// Whether the cache holds the votes counted at a maintenance block of the current chain before
+         /// @p next_block_num, with the same @p params
+         bool is_valid( const database& db, uint32_t next_block_num, const tally_parameters& params )const;
+         /// Whether changes of the accounts are tracked, i.e. whether the cache holds a tally
+         bool is_tracking()const { return _tracking; }
+         /// The maintenance block at which the votes were counted last
+         uint32_t get_block_num()const { return _block_num; }
+         /// Drops all contributions and stops tracking changes
+         void reset();
+         /// Starts over with the votes of a full count, the contributions are added with @ref insert
+         void rebuild( const tally_parameters& params, vote_tally tally );
+         /// Adds the contribution of @p stake_account, which is part of the tally passed to @ref rebuild already
+         void insert( account_id_type stake_account, const contribution& c );
+         /// Marks the cache as counted at the maintenance block @p block_num
+         void set_block( uint32_t block_num, const block_id_type& block_id );
+
+         /// The instances of the stake accounts to count again at time @p now
+         std::set<uint64_t> get_accounts_to_count( time_point_sec now )const;
+
+         /**
+          * Replaces the contribution of @p stake_account by @p c in the tally.
+          * @param get_options returns the current voting options of an opinion account
+          */
+         template<typename GetOptions>
+         void update( account_id_type stake_account, const optional<contribution>& c, const GetOptions& get_options )
+         {
+            if( _contributions.size() <= stake_account.instance.value )
+               _contributions.resize( stake_account.instance.value + 1 );
+            optional<contribution>& old = _contributions[stake_account.instance.value];
+            if( old.valid() )
+            {
+               // the votes were added according to the options of the opinion account at the last maintenance
+               const auto changed = _changed_accounts.find( old->opinion_account );
+               if( changed != _changed_accounts.end() && changed->second.valid() )
+                  _tally.subtract( *old, changed->second->votes,
+                                   changed->second->num_witness, changed->second->num_committee, _params );
+               else
+               {
+                  const auto& options = get_options( old->opinion_account );
+                  _tally.subtract( *old, options.votes, options.num_witness, options.num_committee, _params );
+               }
+               forget( stake_account, *old );
+            }
+            old = c;
+            if( c.valid() )
+            {
+               const auto& options = get_options( c->opinion_account );
+               _tally.add( *c, options.votes, options.num_witness, options.num_committee, _params );
+               remember( stake_account, *c );
+            }
+         }
+
+         /// Called by @ref voting_change_index before the voting options of @p account change from @p before
+         void voting_options_changed( account_id_type account, const voting_options& before );
+         /// Called by @ref voting_change_index when the voting stake of an account may have changed
+         void voting_stake_changed( account_id_type account );
+         /// Forgets the changed accounts, after they were counted
+         void clear_changes();
+
+         const vote_tally& get_tally()const { return _tally; }
+         /// The voting power stats of the opinion accounts with at least one contribution
+         const std::map< account_id_type, voting_power >& get_voting_power()const { return _voting_power; }
+
+      private:
+         void remember( account_id_type stake_account, const contribution& c );
+         void forget( account_id_type stake_account, const contribution& c );
+
+         bool                                  _tracking = false;
+         uint32_t                              _block_num = 0;
+         block_id_type                         _block_id;
+         tally_parameters                      _params;
+         vote_tally                            _tally;
+         /// By instance of the stake account
+         vector< optional<contribution> >      _contributions;
+         /// By opinion account
+         std::map< account_id_type, voting_power >                     _voting_power;
+         /// Stake accounts which vote through a proxy, by instance of the proxy
+         std::unordered_map< uint64_t, std::unordered_set<uint64_t> >  _delegators;
+         /// Stake accounts whose contribution decays, by the time until which it is valid
+         std::set< std::pair< time_point_sec, uint64_t > >             _expirations;
+         /// Accounts changed since the last maintenance, with their voting options as of the last maintenance
+         /// if those changed
+         std::map< account_id_type, optional<voting_options> >         _changed_accounts;
+   };
+
+   /**
+    *  Tells the @ref vote_tally_cache which accounts changed their votes or their voting stake. One instance is
+    *  attached to the account index and one to the account statistics index.
+    */
+   class voting_change_index : public graphene::db::secondary_index
+   {
+      public:
+         explicit voting_change_index( vote_tally_cache* cache ) : _cache( cache ) {}
+
+         void object_inserted( const object& obj ) override;
+         void object_removed( const object& obj ) override;
+         void about_to_modify( const object& before ) override;
+         void object_modified( const object& after ) override;
+
+      private:
+         /// The fields of an account which affect the votes of the stakes voting through it
+         struct account_fields
+         {
+            account_id_type                  voting_account;
+            vote_tally_cache::voting_options options;
+            uint16_t                         num_committee_voted = 0;
+
+            explicit account_fields( const account_object& account );
+            bool operator == ( const account_fields& o )const;
+         };
+
+         /// The fields of the statistics of an account which affect its voting stake
+         struct stats_fields
+         {
+            bool           is_voting = false;
+            time_point_sec last_vote_time;
+            share_type     total_core_in_orders;
+            share_type     core_in_balance;
+            bool           has_cashback_vb = false;
+            share_type     total_core_inactive;
+            share_type     total_core_pob;
+            share_type     total_core_pol;
+            share_type     total_pob_value;
+            share_type     total_pol_value;
+
+            explicit stats_fields( const account_statistics_object& stats );
+            bool operator == ( const stats_fields& o )const;
+         };
+
+         vote_tally_cache* _cache;
+         /// The fields of the objects being modified as they were before, to find out whether one of them changed.
+         /// Nothing is kept while the cache is not in use.
+         std::stack< optional<account_fields> > _accounts_being_modified;
+         std::stack< optional<stats_fields> >   _stats_being_modified;
+   };
+
+} } // graphene::chain
@@ -306,6 +306,68 @@ share_type call_order_object::get_max_debt_to_cover( price match_price,
 
 } FC_CAPTURE_AND_RETHROW( (*this)(feed_price)(match_price)(maintenance_collateral_ratio) ) }
 
+void limit_order_book_index::object_inserted( const object& obj )
+{
+   const auto& o = dynamic_cast< const limit_order_object& >( obj );
+   limit_order_book_entry entry;
+   entry.sell_price = o.sell_price;
+   entry.id = o.id;
+   entry.order = &o;
+   const bool inserted = _books[ get_market_of( o ) ].insert( std::move( entry ) ).second;
+   FC_ASSERT( inserted, "Limit order ${id} is already in the order book", ("id",o.id) );
+}
+
+void limit_order_book_index::object_removed( const object& obj )
+{
+   const auto& o = dynamic_cast< const limit_order_object& >( obj );
+   auto itr = _books.find( get_market_of( o ) );
+   if( itr == _books.end() ) return;
+   itr->second.get<by_id>().erase( o.id );
+}
+
+void limit_order_book_index::about_to_modify( const object& before )
+{
+   const auto& o = dynamic_cast< const limit_order_object& >( before );
+   _markets_being_modified.emplace( o.id, get_market_of( o ) );
+}
+
+void limit_order_book_index::object_modified( const object& after  )
+{
+   FC_ASSERT( _markets_being_modified.top().first == after.id, "Modification of ID is not supported!");
+   const market_type old_market = _markets_being_modified.top().second;
+   _markets_being_modified.pop();
+
+   const auto& o = dynamic_cast< const limit_order_object& >( after );
+   const market_type new_market = get_market_of( o );
+   if( new_market == old_market )
+   {
+      // modify in place, iterators to the entry stay valid even if the price changed
+      auto& by_id_idx = _books[ old_market ].get<by_id>();
+      auto itr = by_id_idx.find( o.id );
+      FC_ASSERT( itr != by_id_idx.end(), "Limit order ${id} is not in the order book", ("id",o.id) );
+      if( itr->sell_price != o.sell_price )
+      {
+         const bool modified = by_id_idx.modify( itr, [&o]( limit_order_book_entry& entry ) {
+            entry.sell_price = o.sell_price;
+         });
+         FC_ASSERT( modified, "Unable to reorder limit order ${id} in the order book", ("id",o.id) );
+      }
+      return;
+   }
+
+   _books[ old_market ].get<by_id>().erase( o.id );
+   object_inserted( o );
+}
+
+const limit_order_book& limit_order_book_index::get_book( asset_id_type sell_asset, asset_id_type receive_asset )const
+{
+   static const limit_order_book _empty;
+
+   auto itr = _books.find( std::make_pair( sell_asset, receive_asset ) );
+   if( itr == _books.end() ) return _empty;
+   return itr->second;
+}
+
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::chain::limit_order_object,
                     (graphene::db::object),
                     (expiration)(seller)(for_sale)(sell_price)(filled_amount)(deferred_fee)(deferred_paid_fee)
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/pending_transaction_pool.hpp>
+
+#include <fc/uint128.hpp>
+
+#include <queue>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+   struct fee_payer_visitor
+   {
+      typedef account_id_type result_type;
+
+      template<typename Op>
+      account_id_type operator()( const Op& op )const { return op.fee_payer(); }
+   };
+
+} // anonymous namespace
+
+uint64_t pending_transaction_pool::fee_density( uint64_t core_fee, uint32_t size )
+{
+   return size > 0 ? static_cast<uint64_t>( fc::uint128_t( core_fee ) * 1024 / size ) : core_fee;
+}
+
+bool pending_transaction_pool::can_accept( uint64_t fee_density, uint32_t size )const
+{
+   if( _max_size == 0 || _bytes + size <= _max_size )
+      return true;
+   if( _bytes + size > 2 * _max_size )
+      return false;
+   const auto& by_density = _index.get<by_fee_density>();
+   return !by_density.empty() && fee_density > std::prev( by_density.end() )->fee_density;
+}
+
+const pending_transaction& pending_transaction_pool::insert( processed_transaction trx, uint32_t size,
+                                                             uint64_t core_fee )
+{
+   pending_transaction entry;
+   entry.id = trx.id();
+   entry.sequence = _next_sequence++;
+   entry.size = size;
+   entry.fee_density = fee_density( core_fee, size );
+   entry.expiration = trx.expiration;
+   if( !trx.operations.empty() )
+      entry.fee_payer = trx.operations.front().visit( fee_payer_visitor() );
+   entry.trx = std::move( trx );
+
+   auto result = _index.insert( std::move( entry ) );
+   FC_ASSERT( result.second, "Transaction is already pending" );
+   _bytes += size;
+   ++_metrics.accepted;
+   return *result.first;
+}
+
+bool pending_transaction_pool::contains( const transaction_id_type& id )const
+{
+   const auto& by_trx_id = _index.get<by_id>();
+   return by_trx_id.find( id ) != by_trx_id.end();
+}
+
+void pending_transaction_pool::clear()
+{
+   _index.clear();
+   _bytes = 0;
+}
+
+pending_transaction_pool::pool_index_type pending_transaction_pool::take_all()
+{
+   pool_index_type result;
+   std::swap( result, _index );
+   _bytes = 0;
+   return result;
+}
+
+void pending_transaction_pool::remove_expired_and_excess( pool_index_type& transactions, fc::time_point_sec now )
+{
+   auto& by_exp = transactions.get<by_expiration>();
+   while( !by_exp.empty() && by_exp.begin()->expiration < now )
+   {
+      by_exp.erase( by_exp.begin() );
+      ++_metrics.expired;
+   }
+
+   if( _max_size == 0 )
+      return;
+   uint64_t bytes = 0;
+   for( const pending_transaction& trx : transactions )
+      bytes += trx.size;
+   auto& by_density = transactions.get<by_fee_density>();
+   while( bytes > _max_size && !by_density.empty() )
+   {
+      auto lowest = std::prev( by_density.end() );
+      bytes -= lowest->size;
+      by_density.erase( lowest );
+      ++_metrics.evicted;
+   }
+}
+
+vector<const pending_transaction*> pending_transaction_pool::block_order()const
+{
+   vector<const pending_transaction*> result;
+   result.reserve( _index.size() );
+
+   const auto& by_payer = _index.get<by_fee_payer>();
+   using payer_iterator = pool_index_type::index<by_fee_payer>::type::const_iterator;
+   const auto lower_priority = []( const payer_iterator& a, const payer_iterator& b ) {
+      if( a->fee_density != b->fee_density )
+         return a->fee_density < b->fee_density;
+      return a->sequence > b->sequence;
+   };
+   // the earliest remaining transaction of every fee payer
+   std::priority_queue< payer_iterator, vector<payer_iterator>, decltype(lower_priority) > heads( lower_priority );
+   for( auto itr = by_payer.begin(); itr != by_payer.end(); itr = by_payer.upper_bound( itr->fee_payer ) )
+      heads.push( itr );
+
+   while( !heads.empty() )
+   {
+      const payer_iterator itr = heads.top();
+      heads.pop();
+      result.push_back( &*itr );
+      const auto next = std::next( itr );
+      if( next != by_payer.end() && next->fee_payer == itr->fee_payer )
+         heads.push( next );
+   }
+   return result;
+}
+
+pending_transaction_pool_metrics pending_transaction_pool::get_metrics()const
+{
+   pending_transaction_pool_metrics result = _metrics;
+   result.size = _index.size();
+   result.bytes = _bytes;
+   return result;
+}
+
+} } // graphene::chain
@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/vote_tally_cache.hpp>
+
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/database.hpp>
+
+namespace graphene { namespace chain {
+
+voting_change_index::account_fields::account_fields( const account_object& account )
+   : voting_account( account.options.voting_account ),
+     options{ account.options.votes, account.options.num_witness, account.options.num_committee },
+     num_committee_voted( account.num_committee_voted )
+{}
+
+bool voting_change_index::account_fields::operator == ( const account_fields& o )const
+{
+   return voting_account == o.voting_account
+       && options.votes == o.options.votes
+       && options.num_witness == o.options.num_witness
+       && options.num_committee == o.options.num_committee
+       && num_committee_voted == o.num_committee_voted;
+}
+
+voting_change_index::stats_fields::stats_fields( const account_statistics_object& stats )
+   : is_voting( stats.is_voting ), last_vote_time( stats.last_vote_time ),
+     total_core_in_orders( stats.total_core_in_orders ), core_in_balance( stats.core_in_balance ),
+     has_cashback_vb( stats.has_cashback_vb ), total_core_inactive( stats.total_core_inactive ),
+     total_core_pob( stats.total_core_pob ), total_core_pol( stats.total_core_pol ),
+     total_pob_value( stats.total_pob_value ), total_pol_value( stats.total_pol_value )
+{}
+
+bool voting_change_index::stats_fields::operator == ( const stats_fields& o )const
+{
+   return is_voting == o.is_voting
+       && last_vote_time == o.last_vote_time
+       && total_core_in_orders == o.total_core_in_orders
+       && core_in_balance == o.core_in_balance
+       && has_cashback_vb == o.has_cashback_vb
+       && total_core_inactive == o.total_core_inactive
+       && total_core_pob == o.total_core_pob
+       && total_core_pol == o.total_core_pol
+       && total_pob_value == o.total_pob_value
+       && total_pol_value == o.total_pol_value;
+}
+
+void voting_change_index::object_inserted( const object& obj )
+{
+   if( const auto* account = dynamic_cast< const account_object* >( &obj ) )
+      _cache->voting_stake_changed( account->get_id() );
+   else
+      _cache->voting_stake_changed( static_cast< const account_statistics_object& >( obj ).owner );
+}
+
+void voting_change_index::object_removed( const object& obj )
+{
+   if( const auto* account = dynamic_cast< const account_object* >( &obj ) )
+      _cache->voting_options_changed( account->get_id(), account_fields( *account ).options );
+   else
+      _cache->voting_stake_changed( static_cast< const account_statistics_object& >( obj ).owner );
+}
+
+void voting_change_index::about_to_modify( const object& before )
+{
+   // nothing to compare while the cache is not in use
+   const bool tracking = _cache->is_tracking();
+   if( const auto* account = dynamic_cast< const account_object* >( &before ) )
+   {
+      _accounts_being_modified.push( optional<account_fields>() );
+      if( tracking )
+         _accounts_being_modified.top() = account_fields( *account );
+   }
+   else
+   {
+      _stats_being_modified.push( optional<stats_fields>() );
+      if( tracking )
+         _stats_being_modified.top() = stats_fields( static_cast< const account_statistics_object& >( before ) );
+   }
+}
+
+void voting_change_index::object_modified( const object& after )
+{
+   if( const auto* new_account = dynamic_cast< const account_object* >( &after ) )
+   {
+      optional<account_fields> before = std::move( _accounts_being_modified.top() );
+      _accounts_being_modified.pop();
+      if( before.valid() && !( *before == account_fields( *new_account ) ) )
+         _cache->voting_options_changed( new_account->get_id(), before->options );
+      return;
+   }
+
+   const auto& new_stats = static_cast< const account_statistics_object& >( after );
+   optional<stats_fields> before = std::move( _stats_being_modified.top() );
+   _stats_being_modified.pop();
+   if( before.valid() && !( *before == stats_fields( new_stats ) ) )
+      _cache->voting_stake_changed( new_stats.owner );
+}
+
+namespace {
+
+   template<typename Op>
+   void apply_contribution( vote_tally_cache::vote_tally& tally, const vote_tally_cache::contribution& c,
+                            const flat_set<vote_id_type>& votes, uint16_t num_witness, uint16_t num_committee,
+                            const vote_tally_cache::tally_parameters& params, const Op& op )
+   {
+      const size_t vid_committee = static_cast<size_t>( vote_id_type::committee );
+      const size_t vid_witness = static_cast<size_t>( vote_id_type::witness );
+      for( vote_id_type id : votes )
+      {
+         uint32_t offset = id.instance();
+         uint32_t type = std::min( id.type(), vote_id_type::vote_type::worker ); // cap the data
+         // if they somehow managed to specify an illegal offset, ignore it.
+         if( offset < tally.votes.size() )
+            op( tally.votes[offset], c.stakes[type] );
+      }
+
+      // votes for a number greater than the maximum are skipped here
+      if( c.stakes[vid_witness] > 0 && num_witness <= params.maximum_witness_count )
+         op( tally.witness_count_histogram[num_witness / 2], c.stakes[vid_witness] );
+      if( c.num_committee_stake > 0 && num_committee <= params.maximum_committee_count )
+         op( tally.committee_count_histogram[num_committee / 2], c.num_committee_stake );
+
+      op( tally.total_voting_stake[vid_committee], c.num_committee_stake );
+      op( tally.total_voting_stake[vid_witness], c.stakes[vid_witness] );
+   }
+
+}
+
+bool vote_tally_cache::tally_parameters::operator == ( const tally_parameters& o )const
+{
+   return next_available_vote_id == o.next_available_vote_id
+       && maximum_witness_count == o.maximum_witness_count
+       && maximum_committee_count == o.maximum_committee_count
+       && count_non_member_votes == o.count_non_member_votes
+       && pob_activated == o.pob_activated;
+}
+
+void vote_tally_cache::vote_tally::init( const tally_parameters& params )
+{
+   votes.assign( params.next_available_vote_id, 0 );
+   witness_count_histogram.assign( params.maximum_witness_count / 2 + 1, 0 );
+   committee_count_histogram.assign( params.maximum_committee_count / 2 + 1, 0 );
+   total_voting_stake = {{ 0, 0 }};
+}
+
+void vote_tally_cache::vote_tally::add( const contribution& c, const flat_set<vote_id_type>& votes,
+                                        uint16_t num_witness, uint16_t num_committee,
+                                        const tally_parameters& params )
+{
+   apply_contribution( *this, c, votes, num_witness, num_committee, params,
+                       []( uint64_t& sum, uint64_t stake ) { sum += stake; } );
+}
+
+void vote_tally_cache::vote_tally::subtract( const contribution& c, const flat_set<vote_id_type>& votes,
+                                             uint16_t num_witness, uint16_t num_committee,
+                                             const tally_parameters& params )
+{
+   apply_contribution( *this, c, votes, num_witness, num_committee, params,
+                       []( uint64_t& sum, uint64_t stake ) { sum -= stake; } );
+}
+
+void vote_tally_cache::voting_power::add( const contribution& c )
+{
+   opinion_stats = c.opinion_stats;
+   ++contributions;
+   vp_all += c.vp_all;
+   vp_active += c.vp_active;
+   vp_committee += c.num_committee_stake;
+   vp_witness += c.stakes[vote_id_type::witness];
+   vp_worker += c.stakes[vote_id_type::worker];
+}
+
+void vote_tally_cache::voting_power::subtract( const contribution& c )
+{
+   --contributions;
+   vp_all -= c.vp_all;
+   vp_active -= c.vp_active;
+   vp_committee -= c.num_committee_stake;
+   vp_witness -= c.stakes[vote_id_type::witness];
+   vp_worker -= c.stakes[vote_id_type::worker];
+}
+
+bool vote_tally_cache::is_valid( const database& db, uint32_t next_block_num, const tally_parameters& params )const
+{
+   if( !_tracking || !( params == _params ) || _block_num >= next_block_num )
+      return false;
+   try {
+      return db.get_block_id_for_num( _block_num ) == _block_id;
+   } catch( const fc::exception& ) {
+      // the block is not in the block database, e.g. because it was popped
+      return false;
+   }
+}
+
+void vote_tally_cache::reset()
+{
+   _tracking = false;
+   _block_num = 0;
+   _block_id = block_id_type();
+   _tally = vote_tally();
+   _contributions.clear();
+   _voting_power.clear();
+   _delegators.clear();
+   _expirations.clear();
+   _changed_accounts.clear();
+}
+
+void vote_tally_cache::rebuild( const tally_parameters& params, vote_tally tally )
+{
+   reset();
+   _tracking = true;
+   _params = params;
+   _tally = std::move( tally );
+}
+
+void vote_tally_cache::insert( account_id_type stake_account, const contribution& c )
+{
+   if( _contributions.size() <= stake_account.instance.value )
+      _contributions.resize( stake_account.instance.value + 1 );
+   _contributions[stake_account.instance.value] = c;
+   remember( stake_account, c );
+}
+
+void vote_tally_cache::set_block( uint32_t block_num, const block_id_type& block_id )
+{
+   _block_num = block_num;
+   _block_id = block_id;
+}
+
+std::set<uint64_t> vote_tally_cache::get_accounts_to_count( time_point_sec now )const
+{
+   std::set<uint64_t> result;
+   for( const auto& changed : _changed_accounts )
+   {
+      result.insert( changed.first.instance.value );
+      const auto delegators = _delegators.find( changed.first.instance.value );
+      if( delegators != _delegators.end() )
+         result.insert( delegators->second.begin(), delegators->second.end() );
+   }
+   for( auto itr = _expirations.begin(); itr != _expirations.end() && itr->first <= now; ++itr )
+      result.insert( itr->second );
+   return result;
+}
+
+void vote_tally_cache::voting_options_changed( account_id_type account, const voting_options& before )
+{
+   if( !_tracking )
+      return;
+   auto& options = _changed_accounts[account];
+   if( !options.valid() )
+      options = before;
+}
+
+void vote_tally_cache::voting_stake_changed( account_id_type account )
+{
+   if( _tracking )
+      _changed_accounts[account];
+}
+
+void vote_tally_cache::clear_changes()
+{
+   _changed_accounts.clear();
+}
+
+void vote_tally_cache::remember( account_id_type stake_account, const contribution& c )
+{
+   _voting_power[c.opinion_account].add( c );
+
+   if( c.opinion_account != stake_account )
+      _delegators[c.opinion_account.instance.value].insert( stake_account.instance.value );
+   if( c.valid_until != time_point_sec::maximum() )
+      _expirations.emplace( c.valid_until, stake_account.instance.value );
+}
+
+void vote_tally_cache::forget( account_id_type stake_account, const contribution& c )
+{
+   auto vp = _voting_power.find( c.opinion_account );
+   vp->second.subtract( c );
+   if( vp->second.contributions == 0 )
+      _voting_power.erase( vp );
+
+   if( c.opinion_account != stake_account )
+   {
+      auto delegators = _delegators.find( c.opinion_account.instance.value );
+      delegators->second.erase( stake_account.instance.value );
+      if( delegators->second.empty() )
+         _delegators.erase( delegators );
+   }
+   if( c.valid_until != time_point_sec::maximum() )
+      _expirations.erase( std::make_pair( c.valid_until, stake_account.instance.value ) );
+}
+
+} } // graphene::chain
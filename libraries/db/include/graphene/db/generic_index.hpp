@@ -23,10 +23,12 @@
  */
 #pragma once
 #include <graphene/db/index.hpp>
+#include <graphene/db/pool_allocator.hpp>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
+#include <boost/mpl/size.hpp>
 
 namespace graphene { namespace db {
 
@@ -34,10 +36,13 @@ namespace graphene { namespace db {
    using namespace boost::multi_index;
 
    struct by_id;
+
    /**
     *  Almost all objects can be tracked and managed via a boost::multi_index container that uses
     *  an unordered_unique key on the object ID.  This template class adapts the generic index interface
     *  to work with arbitrary boost multi_index containers on the same type.
+    *
+    *  If the container uses a @ref pool_allocator, every index owns the arena its nodes are allocated from.
     */
    template<typename ObjectType, typename MultiIndexType>
    class generic_index : public index
@@ -55,6 +60,26 @@ namespace graphene { namespace db {
             return *insert_result.first;
          }
 
+         /**
+          *  Inserts an object whose ID is greater than the IDs of all objects in the index, which is the case when
+          *  loading objects in the order they were saved. The end of the ID index is used as insertion hint.
+          */
+         const object& insert_sorted( object&& obj )
+         {
+            assert( nullptr != dynamic_cast<ObjectType*>(&obj) );
+            const auto old_size = _indices.size();
+            auto itr = _indices.insert( _indices.end(), std::move( static_cast<ObjectType&>(obj) ) );
+            FC_ASSERT( _indices.size() > old_size,
+                       "Could not insert object, most likely a uniqueness constraint was violated" );
+            return *itr;
+         }
+
+         /// Reserves space for @p count objects in all indices that support it, i.e. hashed indices
+         void reserve( size_t count )
+         {
+            reserve_from<0>( count );
+         }
+
          const object&  create(const std::function<void(object&)>& constructor )override
          {
             ObjectType item;
@@ -115,6 +140,25 @@ namespace graphene { namespace db {
          const index_type& indices()const { return _indices; }
 
       private:
+         static constexpr size_t index_count = boost::mpl::size<typename index_type::index_type_list>::value;
+
+         template<typename Index>
+         static auto reserve_index( Index& idx, size_t count, int ) -> decltype( idx.reserve( count ), void() )
+         {
+            idx.reserve( count );
+         }
+         template<typename Index>
+         static void reserve_index( Index&, size_t, long ) {}
+
+         template<size_t N>
+         typename std::enable_if< (N < index_count) >::type reserve_from( size_t count )
+         {
+            reserve_index( _indices.template get<N>(), count, 0 );
+            reserve_from<N + 1>( count );
+         }
+         template<size_t N>
+         typename std::enable_if< (N >= index_count) >::type reserve_from( size_t ) {}
+
          index_type  _indices;
    };
 
@@ -30,7 +30,9 @@
 #include <fc/crypto/sha256.hpp>
 
 #include <fstream>
+#include <memory>
 #include <stack>
+#include <unordered_set>
 
 namespace graphene { namespace db {
    class object_database;
@@ -79,6 +81,9 @@ namespace graphene { namespace db {
          virtual void           use_next_id() = 0;
          virtual void           set_next_id( object_id_type id ) = 0;
 
+         /// @return a new empty index of the same type for @p db, without the secondary indexes of this one
+         virtual std::unique_ptr<index> create_empty( object_database& db )const = 0;
+
          virtual const object&  load( const std::vector<char>& data ) = 0;
          /**
           *  Polymorphically insert by moving an object into the index.
@@ -98,7 +103,18 @@ namespace graphene { namespace db {
          virtual void open( const fc::path& db ) = 0;
          virtual void save( const fc::path& db ) = 0;
 
-
+         /**
+          *  Saves only the objects that were added, modified or removed since the last call to @ref save or
+          *  @ref open, so that @ref open_delta can bring an index opened from that save up to date.
+          */
+         virtual void   save_delta( const fc::path& db ) = 0;
+         virtual void   open_delta( const fc::path& db ) = 0;
+         /** @return the number of objects that would be written by @ref save_delta */
+         virtual size_t delta_size()const = 0;
+         /** @return the number of objects written by the last @ref save or loaded by the last @ref open */
+         virtual size_t snapshot_size()const = 0;
+         /** @return identifies the serialization of the objects in the files written by @ref save */
+         virtual fc::sha256 get_object_version()const = 0;
 
          /** @return the object with id or nullptr if not found */
          virtual const object*      find( object_id_type id )const = 0;
@@ -146,6 +162,16 @@ namespace graphene { namespace db {
          virtual void object_modified( const object& after  ){};
    };
 
+   /**
+    *  A secondary index that can find objects by ID faster than the primary index. If a primary index has one,
+    *  lookups by ID are delegated to it.
+    */
+   class id_lookup_index : public secondary_index
+   {
+      public:
+         virtual const object* find_by_id( const object_id_type& id )const = 0;
+   };
+
    /**
     *   Defines the common implementation
     */
@@ -186,9 +212,27 @@ namespace graphene { namespace db {
             FC_THROW_EXCEPTION( fc::assert_exception, "invalid index type" );
          }
 
+         /**
+          *  Adds a secondary index that takes over lookups by ID, e.g. a @ref direct_index or a
+          *  @ref sparse_direct_index. Like other secondary indexes it must be added while the index is empty.
+          */
+         template<typename T, typename... Args>
+         T* add_id_lookup_index(Args... args)
+         {
+            static_assert( std::is_base_of<id_lookup_index, T>::value, "Type must be an ID lookup index" );
+            FC_ASSERT( _id_lookup == nullptr, "The index already has an ID lookup index" );
+            T* result = add_secondary_index<T>( args... );
+            _id_lookup = result;
+            return result;
+         }
+
       protected:
+         const id_lookup_index*                           _id_lookup = nullptr;
          std::vector< std::shared_ptr<index_observer> >   _observers;
          std::vector< std::unique_ptr<secondary_index> >  _sindex;
+         /// Instances of the objects added, modified or removed since the last full save
+         std::unordered_set< uint64_t >                   _changed;
+         size_t                                           _snapshot_size = 0;
 
       private:
          object_database& _db;
@@ -204,7 +248,7 @@ namespace graphene { namespace db {
     *  indicate that this index type is not appropriate for the use-case.
     */
    template<typename Object, uint8_t chunkbits>
-   class direct_index : public secondary_index
+   class direct_index : public id_lookup_index
    {
       static_assert( chunkbits < 64, "Do you really want arrays with more than 2^63 elements???" );
 
@@ -299,6 +343,123 @@ namespace graphene { namespace db {
             if( id.instance() >= next ) return nullptr;
             return content[id.instance() >> chunkbits][id.instance() & ((1ULL << chunkbits) - 1)];
          };
+
+         const object* find_by_id( const object_id_type& id )const override { return find( id ); }
+   };
+
+   /** @class sparse_direct_index
+    *  @brief A secondary index that tracks objects in pages of pointers indexed
+    *  by object id. Only pages that hold at least one object are allocated, so
+    *  unlike @ref direct_index it tolerates arbitrary gaps between objects and
+    *  suits object types whose objects are removed regularly.
+    */
+   template<typename Object, uint8_t pagebits>
+   class sparse_direct_index : public id_lookup_index
+   {
+      static_assert( pagebits > 0 && pagebits < 32, "Pages must hold between 2 and 2^31 objects" );
+
+      // private
+         static const uint64_t _page_size = 1ULL << pagebits;
+         static const uint64_t _mask = _page_size - 1;
+         struct page
+         {
+            std::vector< const Object* > objects = std::vector< const Object* >( _page_size, nullptr );
+            uint64_t                     count = 0;
+         };
+         std::vector< std::unique_ptr< page > > pages;
+         size_t page_count = 0;
+         std::stack< object_id_type > ids_being_modified;
+
+      public:
+         void object_inserted( const object& obj ) override
+         {
+            FC_ASSERT( nullptr != dynamic_cast<const Object*>(&obj), "Wrong object type!" );
+            const uint64_t instance = obj.id.instance();
+            const uint64_t page_num = instance >> pagebits;
+            if( page_num >= pages.size() )
+               pages.resize( page_num + 1 );
+            auto& p = pages[page_num];
+            if( !p )
+            {
+               p = std::make_unique< page >();
+               ++page_count;
+            }
+            auto& slot = p->objects[instance & _mask];
+            FC_ASSERT( !slot, "Overwriting insert at ${id}!", ("id",obj.id) );
+            slot = static_cast<const Object*>( &obj );
+            ++p->count;
+         }
+
+         void object_removed( const object& obj ) override
+         {
+            FC_ASSERT( nullptr != dynamic_cast<const Object*>(&obj), "Wrong object type!" );
+            const uint64_t instance = obj.id.instance();
+            const uint64_t page_num = instance >> pagebits;
+            FC_ASSERT( page_num < pages.size() && pages[page_num] && pages[page_num]->objects[instance & _mask],
+                       "Removing non-existent object ${id}!", ("id",obj.id) );
+            auto& p = pages[page_num];
+            p->objects[instance & _mask] = nullptr;
+            if( --p->count == 0 )
+            {
+               p.reset();
+               --page_count;
+               while( !pages.empty() && !pages.back() )
+                  pages.pop_back();
+            }
+         }
+
+         void about_to_modify( const object& before ) override
+         {
+            ids_being_modified.emplace( before.id );
+         }
+
+         void object_modified( const object& after  ) override
+         {
+            FC_ASSERT( ids_being_modified.top() == after.id, "Modification of ID is not supported!");
+            ids_being_modified.pop();
+         }
+
+         template< typename object_id >
+         const Object* find( const object_id& id )const
+         {
+            static_assert( object_id::space_id == Object::space_id, "Space ID mismatch!" );
+            static_assert( object_id::type_id == Object::type_id, "Type_ID mismatch!" );
+            return find_instance( id.instance.value );
+         };
+
+         template< typename object_id >
+         const Object& get( const object_id& id )const
+         {
+            const Object* ptr = find( id );
+            FC_ASSERT( ptr != nullptr, "Object not found!" );
+            return *ptr;
+         };
+
+         const Object* find( const object_id_type& id )const
+         {
+            FC_ASSERT( id.space() == Object::space_id, "Space ID mismatch!" );
+            FC_ASSERT( id.type() == Object::type_id, "Type_ID mismatch!" );
+            return find_instance( id.instance() );
+         };
+
+         const object* find_by_id( const object_id_type& id )const override { return find( id ); }
+
+         /// @return the number of allocated pages
+         size_t allocated_pages()const { return page_count; }
+         /// @return the approximate number of bytes used for looking up objects
+         size_t memory_usage()const
+         {
+            return pages.capacity() * sizeof( std::unique_ptr< page > )
+                   + page_count * ( sizeof( page ) + _page_size * sizeof( const Object* ) );
+         }
+
+      private:
+         const Object* find_instance( uint64_t instance )const
+         {
+            const uint64_t page_num = instance >> pagebits;
+            if( page_num >= pages.size() || !pages[page_num] ) return nullptr;
+            return pages[page_num]->objects[instance & _mask];
+         }
    };
 
    /**
@@ -318,7 +479,7 @@ namespace graphene { namespace db {
          :base_primary_index(db),_next_id(object_type::space_id,object_type::type_id,0)
          {
             if( DirectBits > 0 )
-               _direct_by_id = add_secondary_index< direct_index< object_type, DirectBits > >();
+               _direct_by_id = add_id_lookup_index< direct_index< object_type, DirectBits > >();
          }
 
          uint8_t object_space_id()const override
@@ -331,15 +492,22 @@ namespace graphene { namespace db {
          void           use_next_id()override                    { ++_next_id.number;  }
          void           set_next_id( object_id_type id )override { _next_id = id;      }
 
+         std::unique_ptr<index> create_empty( object_database& db )const override
+         {
+            return std::make_unique<primary_index>( db );
+         }
+
          /** @return the object with id or nullptr if not found */
          const object*  find( object_id_type id )const override
          {
             if( DirectBits > 0 )
                return _direct_by_id->find( id );
+            if( _id_lookup != nullptr )
+               return _id_lookup->find_by_id( id );
             return DerivedIndex::find( id );
          }
 
-         fc::sha256 get_object_version()const
+         fc::sha256 get_object_version()const override
          {
             std::string desc = "1.0";
             return fc::sha256::hash(desc);
@@ -347,6 +515,8 @@ namespace graphene { namespace db {
 
          void open( const fc::path& db )override
          {
+            _changed.clear();
+            _snapshot_size = 0;
             if( !fc::exists( db ) ) return;
             fc::file_mapping fm( db.generic_string().c_str(), fc::read_only );
             fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size(db) );
@@ -357,12 +527,22 @@ namespace graphene { namespace db {
             fc::raw::unpack(ds, open_ver);
             FC_ASSERT( open_ver == get_object_version(),
                        "Incompatible Version, the serialization of objects in this index has changed" );
-            std::vector<char> tmp;
-            while( ds.remaining() > 0 )
-            {
-               fc::raw::unpack( ds, tmp );
-               load( tmp );
-            }
+            // Objects are unpacked straight from the mapped file. The first pass only reads the record sizes,
+            // so that storage for all objects can be reserved up front.
+            const char* const records = (const char*)mr.get_address() + ( mr.get_size() - ds.remaining() );
+            const char* const end = (const char*)mr.get_address() + mr.get_size();
+            size_t count = 0;
+            for_each_record( records, end, [&count]( fc::datastream<const char*>& ) { ++count; } );
+            DerivedIndex::reserve( count );
+            // save() writes the objects in the order of the index, so they can be appended at the end
+            for_each_record( records, end, [this]( fc::datastream<const char*>& record ) {
+               object_type obj;
+               fc::raw::unpack( record, obj );
+               const auto& result = DerivedIndex::insert_sorted( std::move( obj ) );
+               for( const auto& item : _sindex )
+                  item->object_inserted( result );
+            });
+            _snapshot_size = count;
          }
 
          void save( const fc::path& db ) override
@@ -373,13 +553,90 @@ namespace graphene { namespace db {
             auto ver  = get_object_version();
             fc::raw::pack( out, _next_id );
             fc::raw::pack( out, ver );
-            this->inspect_all_objects( [&out]( const object& o ) {
+            size_t count = 0;
+            this->inspect_all_objects( [&out,&count]( const object& o ) {
                 auto vec = fc::raw::pack( static_cast<const object_type&>(o) );
                 auto packed_vec = fc::raw::pack( vec );
                 out.write( packed_vec.data(), packed_vec.size() );
+                ++count;
+            });
+            _changed.clear();
+            _snapshot_size = count;
+         }
+
+         /**
+          *  The delta file has the same header as a full save, followed by the instances of the removed
+          *  objects and then the current state of all added or modified objects.
+          */
+         void save_delta( const fc::path& db ) override
+         {
+            std::ofstream out( db.generic_string(),
+                               std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+            FC_ASSERT( out );
+            auto ver  = get_object_version();
+            fc::raw::pack( out, _next_id );
+            fc::raw::pack( out, ver );
+            std::vector<uint64_t> removed;
+            std::vector<const object*> changed;
+            changed.reserve( _changed.size() );
+            for( const uint64_t instance : _changed )
+            {
+               const object* obj = DerivedIndex::find( object_id_type( object_type::space_id,
+                                                                       object_type::type_id, instance ) );
+               if( obj != nullptr )
+                  changed.push_back( obj );
+               else
+                  removed.push_back( instance );
+            }
+            fc::raw::pack( out, removed );
+            for( const object* o : changed )
+            {
+                auto vec = fc::raw::pack( static_cast<const object_type&>(*o) );
+                auto packed_vec = fc::raw::pack( vec );
+                out.write( packed_vec.data(), packed_vec.size() );
+            }
+         }
+
+         void open_delta( const fc::path& db ) override
+         {
+            if( !fc::exists( db ) ) return;
+            fc::file_mapping fm( db.generic_string().c_str(), fc::read_only );
+            fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size(db) );
+            fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
+            fc::sha256 open_ver;
+
+            fc::raw::unpack(ds, _next_id);
+            fc::raw::unpack(ds, open_ver);
+            FC_ASSERT( open_ver == get_object_version(),
+                       "Incompatible Version, the serialization of objects in this index has changed" );
+            std::vector<uint64_t> removed;
+            fc::raw::unpack( ds, removed );
+            std::vector<object_type> changed;
+            const char* const end = (const char*)mr.get_address() + mr.get_size();
+            for_each_record( end - ds.remaining(), end, [&changed]( fc::datastream<const char*>& record ) {
+               changed.emplace_back();
+               fc::raw::unpack( record, changed.back() );
             });
+
+            // remove all old versions first, replacements may depend on unique keys freed by other objects
+            for( const uint64_t instance : removed )
+               unload( object_id_type( object_type::space_id, object_type::type_id, instance ) );
+            for( const object_type& obj : changed )
+               unload( obj.id );
+            for( object_type& obj : changed )
+            {
+               _changed.insert( obj.id.instance() );
+               const auto& result = DerivedIndex::insert( std::move( obj ) );
+               for( const auto& item : _sindex )
+                  item->object_inserted( result );
+            }
+            for( const uint64_t instance : removed )
+               _changed.insert( instance );
          }
 
+         size_t delta_size()const override    { return _changed.size(); }
+         size_t snapshot_size()const override { return _snapshot_size; }
+
          const object&  load( const std::vector<char>& data )override
          {
             const auto& result = DerivedIndex::insert( fc::raw::unpack<object_type>( data ) );
@@ -450,6 +707,34 @@ namespace graphene { namespace db {
          }
 
       private:
+         /// Calls @p f with a stream over each size-prefixed object record in [begin, end)
+         template<typename Function>
+         static void for_each_record( const char* begin, const char* const end, Function&& f )
+         {
+            while( begin < end )
+            {
+               fc::datastream<const char*> ds( begin, end - begin );
+               fc::unsigned_int size;
+               fc::raw::unpack( ds, size );
+               FC_ASSERT( size.value <= ds.remaining(), "Truncated object record" );
+               const char* const data = end - ds.remaining();
+               fc::datastream<const char*> record( data, size.value );
+               f( record );
+               begin = data + size.value;
+            }
+         }
+
+         /// Removes an object while loading, without notifying observers or saving undo state
+         void unload( const object_id_type& id )
+         {
+            const object* obj = DerivedIndex::find( id );
+            if( obj == nullptr )
+               return;
+            for( const auto& item : _sindex )
+               item->object_removed( *obj );
+            DerivedIndex::remove( *obj );
+         }
+
          object_id_type                                 _next_id;
          const direct_index< object_type, DirectBits >* _direct_by_id = nullptr;
    };
@@ -29,9 +29,24 @@
 #include <fc/log/logger.hpp>
 
 #include <map>
+#include <memory>
+#include <vector>
 
 namespace graphene { namespace db {
 
+   /**
+    *  A copy of the changes recorded in an undo state, which can be applied to another database that has the same
+    *  objects as the one the changes were made to had before
+    */
+   struct object_changes
+   {
+      std::vector< object_id_type >                            removed;
+      /// Copies of the created and modified objects, ordered by ID
+      std::vector< std::unique_ptr<object> >                   upserted;
+      /// The next IDs of the indexes which objects were created in, by the ID of the index
+      std::vector< std::pair<object_id_type, object_id_type> > next_ids;
+   };
+
    /**
     *   @class object_database
     *   @brief maintains a set of indexed objects that can be modified with multi-level rollback support
@@ -53,10 +68,39 @@ namespace graphene { namespace db {
          void open(const fc::path& data_dir );
 
          /**
-          * Saves the complete state of the object_database to disk, this could take a while
+          * Saves the state of the object_database to disk. If a full snapshot was written or loaded before and
+          * only a small part of the objects changed since then, only the changes are written next to the full
+          * snapshot, otherwise the complete state is saved, which could take a while.
           */
          void flush();
+         /**
+          * Saves the complete state of the object_database to disk and discards any saved changes
+          */
+         void flush_full();
+         /**
+          * Set the maximum size of the changes saved by @ref flush, in percent of the objects in the last full
+          * snapshot, before the full state is saved again. 0 disables saving changes only.
+          */
+         void set_delta_compaction_percent( uint32_t percent ) { _delta_compaction_percent = percent; }
          void wipe(const fc::path& data_dir); // remove from disk
+         /**
+          * Loads a copy of the objects of @p other into the indexes of this database which also exist in
+          * @p other, these indexes must be empty. The indexes are copied in parallel, but the calling thread
+          * does not yield to other tasks, which could modify @p other meanwhile.
+          */
+         void copy_objects_from( const object_database& other );
+         /**
+          * Adds an empty index for every index of @p other which this database does not have, e.g. the indexes
+          * of plugins, so that @ref copy_objects_from copies all objects. Secondary indexes are not added.
+          */
+         void add_missing_indexes_from( const object_database& other );
+         /// @return a copy of the changes recorded in the newest undo state
+         object_changes copy_head_changes()const;
+         /**
+          * Applies @p changes, which were made to another database, and records them in the current undo state.
+          * The objects which are removed or modified must exist, and the indexes of all objects too.
+          */
+         void apply_changes( const object_changes& changes );
          void close();
 
          template<typename T, typename F>
@@ -83,6 +127,8 @@ namespace graphene { namespace db {
          const index&  get_index()const { return get_index(T::space_id,T::type_id); }
          const index&  get_index(uint8_t space_id, uint8_t type_id)const;
          const index&  get_index(const object_id_type& id)const { return get_index(id.space(),id.type()); }
+         /// Calls @p inspector for every index that has been added, ordered by space and type
+         void          inspect_all_indexes( const std::function<void(const index&)>& inspector )const;
          /// @}
 
          const object& get_object( const object_id_type& id )const;
@@ -188,8 +234,15 @@ namespace graphene { namespace db {
          void save_undo_add( const object& obj );
          void save_undo_remove( const object& obj );
 
+         void flush_delta();
+         /// Calls @p f for each index in parallel and waits for all of them
+         void for_each_index_parallel( const std::function<void( index&, size_t, size_t )>& f );
+
          fc::path                                                  _data_dir;
          std::vector< std::vector< std::unique_ptr<index> > >      _index;
+         /// Identifies the full snapshot on disk that the in-memory changes are tracked against, 0 if none
+         uint64_t                                                  _snapshot_generation = 0;
+         uint32_t                                                  _delta_compaction_percent = 25;
    };
 
 } } // graphene::db
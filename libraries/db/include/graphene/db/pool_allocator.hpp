@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace graphene { namespace db {
+
+   /**
+    *  The memory of the nodes of one container, carved out of slabs of @ref slab_size bytes. Freed nodes are
+    *  reused, and a slab whose nodes are all free is released, except for one spare slab. So the memory of a
+    *  shrinking index goes back to the heap.
+    *
+    *  Only single nodes of the size requested first are taken from the slabs, other allocations, e.g. the bucket
+    *  arrays of hashed indices, go to the heap. An arena is not thread safe, like the container using it.
+    */
+   class node_arena
+   {
+      public:
+         /// Slabs are aligned to their size, so that the slab of a node is found from its address
+         static constexpr size_t slab_size = 64 * 1024;
+
+         node_arena() = default;
+         node_arena( const node_arena& ) = delete;
+         node_arena& operator = ( const node_arena& ) = delete;
+         ~node_arena();
+
+         void* allocate_node( size_t size );
+         void  deallocate_node( void* node, size_t size );
+
+         /// Bytes of the nodes in use which were taken from the slabs
+         size_t used_bytes()const { return _used_nodes * _chunk_size; }
+         /// Bytes of the slabs held, including the free nodes in them
+         size_t reserved_bytes()const { return _slab_count * slab_size; }
+
+      private:
+         struct slab;
+
+         slab* take_slab();
+         void  link( slab* s );
+         void  unlink( slab* s );
+
+         size_t _node_size = 0;       ///< the size of the nodes taken from slabs, 0 until the first node
+         size_t _chunk_size = 0;      ///< the node size rounded up to the alignment
+         size_t _first_chunk = 0;     ///< offset of the first node in a slab, after the slab header
+         size_t _nodes_per_slab = 0;  ///< 0 if the nodes are too large to be worth slabs
+         slab*  _available = nullptr; ///< slabs with free nodes, doubly linked
+         slab*  _spare = nullptr;     ///< an empty slab, kept to not release and allocate slabs over and over
+         size_t _slab_count = 0;
+         size_t _used_nodes = 0;
+   };
+
+   /**
+    *  Node allocator for indexes whose objects are created and removed frequently, e.g. orders and balances.
+    *  A default constructed allocator creates its own @ref node_arena, which the copies made by the container
+    *  share. So every container, i.e. every index of every database, has its own arena, and indexes neither
+    *  share memory nor contend for a lock. The nodes of busy indexes stay close together, and the heap is not
+    *  fragmented over a long uptime.
+    *
+    *  To use it, pass it as the allocator of the multi_index_container of a generic_index.
+    */
+   template<typename T>
+   class pool_allocator
+   {
+      public:
+         using value_type      = T;
+         using pointer         = T*;
+         using const_pointer   = const T*;
+         using reference       = T&;
+         using const_reference = const T&;
+         using size_type       = std::size_t;
+         using difference_type = std::ptrdiff_t;
+
+         template<typename U>
+         struct rebind { using other = pool_allocator<U>; };
+
+         pool_allocator() : _arena( std::make_shared<node_arena>() ) {}
+         template<typename U>
+         pool_allocator( const pool_allocator<U>& other ) : _arena( other._arena ) {}
+
+         T* allocate( size_t n )
+         {
+            if( n == 1 )
+               return static_cast<T*>( _arena->allocate_node( sizeof(T) ) );
+            return static_cast<T*>( ::operator new( n * sizeof(T) ) );
+         }
+
+         void deallocate( T* p, size_t n )
+         {
+            if( n == 1 )
+               _arena->deallocate_node( p, sizeof(T) );
+            else
+               ::operator delete( p );
+         }
+
+         template<typename U, typename... Args>
+         void construct( U* p, Args&&... args ) { ::new( static_cast<void*>( p ) ) U( std::forward<Args>( args )... ); }
+         template<typename U>
+         void destroy( U* p ) { p->~U(); }
+
+         const node_arena& arena()const { return *_arena; }
+
+         template<typename U>
+         bool operator == ( const pool_allocator<U>& other )const { return _arena == other._arena; }
+         template<typename U>
+         bool operator != ( const pool_allocator<U>& other )const { return _arena != other._arena; }
+
+      private:
+         template<typename U> friend class pool_allocator;
+
+         std::shared_ptr<node_arena> _arena;
+   };
+
+} } // graphene::db
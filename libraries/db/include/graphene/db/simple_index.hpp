@@ -69,6 +69,11 @@ namespace graphene { namespace db {
             return *_objects[instance];
          }
 
+         /// Objects are addressed by instance, so the order of insertion does not matter
+         const object& insert_sorted( object&& obj ) { return insert( std::move( obj ) ); }
+
+         void reserve( size_t count ) { _objects.reserve( count ); }
+
          virtual void remove( const object& obj ) override
          {
             assert( nullptr != dynamic_cast<const T*>(&obj) );
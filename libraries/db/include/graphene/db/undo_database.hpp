@@ -24,18 +24,113 @@
 #pragma once
 #include <graphene/db/object.hpp>
 #include <deque>
+#include <memory>
+#include <vector>
 #include <fc/exception/exception.hpp>
 
 namespace graphene { namespace db {
 
    class object_database;
 
-   struct undo_state
+   /**
+    * @class undo_arena
+    * @brief bump allocator for the pre-images of an undo state
+    *
+    * Objects are copied into large chunks instead of being allocated one by one. All objects are destroyed at once
+    * when the arena is released, and the chunks go back to a free list shared by all arenas of an undo_database.
+    */
+   class undo_arena
    {
-      std::unordered_map<object_id_type, std::unique_ptr<object> > old_values;
-      std::unordered_map<object_id_type, object_id_type>           old_index_next_ids;
-      std::unordered_set<object_id_type>                           new_ids;
-      std::unordered_map<object_id_type, std::unique_ptr<object> > removed;
+      public:
+         using chunk_pool = std::vector< std::unique_ptr<char[]> >;
+         static constexpr size_t chunk_size = 64 * 1024;
+
+         undo_arena() = default;
+         undo_arena( undo_arena&& ) = default;
+         undo_arena& operator=( undo_arena&& ) = default;
+         ~undo_arena();
+
+         /// Copies @p obj into the arena, taking new chunks from @p pool if possible
+         object* clone( const object& obj, chunk_pool& pool );
+         /// Takes over all chunks and objects of @p other, which is left empty
+         void    absorb( undo_arena& other );
+         /// Destroys all objects and returns the chunks of standard size to @p pool
+         void    release( chunk_pool& pool );
+
+      private:
+         struct chunk
+         {
+            std::unique_ptr<char[]> data;
+            size_t                  size;
+         };
+         void destroy_objects();
+
+         std::vector<chunk>   _chunks;
+         size_t               _used = 0; ///< bytes used in the last chunk
+         std::vector<object*> _objects;
+   };
+
+   /**
+    * @class undo_state
+    * @brief the changes made during one undo session
+    *
+    * Every object touched in the session has one entry in an open-addressing hash table keyed by its ID. An entry
+    * records whether the object was created, modified or removed in the session, together with the pre-image of
+    * the object in the latter two cases. Pre-images live in the arena of the state. Both the table and the arena
+    * are recycled by the undo_database when the state is discarded.
+    */
+   class undo_state
+   {
+      public:
+         enum entry_kind : uint8_t
+         {
+            unused    = 0, ///< the slot is free
+            created   = 1,
+            modified  = 2,
+            removed   = 3,
+            cancelled = 4  ///< the object was created and removed again in this state, i.e. nothing happened
+         };
+
+         struct entry
+         {
+            object_id_type id;
+            entry_kind     kind = unused;
+            object*        old_value = nullptr;
+         };
+
+         /// @return the entry of @p id, or nullptr if the object was not touched in this state
+         const entry* find( const object_id_type& id )const;
+
+         /// Calls @p f for each entry of the given kind
+         template<typename Lambda>
+         void for_each( entry_kind kind, const Lambda& f )const
+         {
+            for( const entry& e : _entries )
+               if( e.kind == kind )
+                  f( e );
+         }
+         size_t count( entry_kind kind )const { return _counts[kind]; }
+
+         /// The IDs that the indexes of the object types created in this state started from
+         const std::vector< std::pair<object_id_type, object_id_type> >& old_index_next_ids()const
+         { return _old_index_next_ids; }
+
+      private:
+         friend class undo_database;
+
+         entry* find( const object_id_type& id );
+         /// @return the entry of @p id, which has kind unused or cancelled if the object was not touched yet
+         entry& find_or_add( const object_id_type& id );
+         void   set_kind( entry& e, entry_kind kind );
+         void   grow();
+         /// Empties the state, keeping the table unless it grew large
+         void   reset( undo_arena::chunk_pool& pool );
+
+         std::vector<entry>                                     _entries; ///< capacity is 0 or a power of 2
+         size_t                                                 _used = 0;
+         size_t                                                 _counts[5] = {};
+         std::vector< std::pair<object_id_type, object_id_type> > _old_index_next_ids;
+         undo_arena                                             _arena;
    };
 
 
@@ -108,6 +203,11 @@ namespace graphene { namespace db {
           * want to re-delete it if this state is undone.
           */
          void on_remove( const object& obj );
+         /**
+          * This should be called just before the next ID of an index is set other than by creating an object,
+          * with the next ID before the change
+          */
+         void on_set_next_id( const object_id_type& old_next_id );
 
          /**
           *  Removes the last committed session,
@@ -129,11 +229,22 @@ namespace graphene { namespace db {
          void merge();
          void commit();
 
+         undo_state& push_state();
+         /// Records @p old_next_id as the ID its index started from in @p state, unless one is recorded already
+         void        record_next_id( undo_state& state, const object_id_type& old_next_id );
+         /// Resets @p state and keeps it for reuse by a later session
+         void        recycle( undo_state&& state );
+         /// Reverts all changes recorded in the last state on the stack and removes it
+         void        revert_head();
+
          uint32_t                _active_sessions = 0;
          bool                    _disabled = true;
          std::deque<undo_state>  _stack;
          object_database&        _db;
          size_t                  _max_size = 256;
+
+         std::vector<undo_state>  _spare_states;
+         undo_arena::chunk_pool   _spare_chunks;
    };
 
 } } // graphene::db
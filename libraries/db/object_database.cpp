@@ -27,6 +27,13 @@
 #include <fc/container/flat.hpp>
 #include <fc/thread/parallel.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
 namespace graphene { namespace db {
 
 object_database::object_database()
@@ -78,45 +85,189 @@ index& object_database::get_mutable_index(uint8_t space_id, uint8_t type_id)
    return *idx;
 }
 
-void object_database::flush()
+void object_database::inspect_all_indexes( const std::function<void(const index&)>& inspector )const
 {
-   const auto tmp_dir = _data_dir / "object_database.tmp";
-   const auto old_dir = _data_dir / "object_database.old";
-   const auto target_dir = _data_dir / "object_database";
+   for( const auto& space : _index )
+      for( const auto& idx : space )
+         if( idx )
+            inspector( *idx );
+}
 
-   if( fc::exists( tmp_dir ) )
-      fc::remove_all( tmp_dir );
-   fc::create_directories( tmp_dir / "lock" );
+namespace {
+
+   uint64_t read_generation( const fc::path& dir )
+   {
+      const auto file = dir / "generation";
+      if( !fc::exists( file ) )
+         return 0;
+      std::ifstream in( file.generic_string(), std::ifstream::binary );
+      uint64_t generation = 0;
+      in.read( reinterpret_cast<char*>( &generation ), sizeof( generation ) );
+      return in ? generation : 0;
+   }
+
+   void write_generation( const fc::path& dir, uint64_t generation )
+   {
+      std::ofstream out( (dir / "generation").generic_string(),
+                         std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+      FC_ASSERT( out );
+      out.write( reinterpret_cast<const char*>( &generation ), sizeof( generation ) );
+   }
+
+   /// Replaces @p target_dir with @p tmp_dir, keeping the old content in @p old_dir until done
+   void replace_directory( const fc::path& tmp_dir, const fc::path& old_dir, const fc::path& target_dir )
+   {
+      if( fc::exists( target_dir ) )
+      {
+         if( fc::exists( old_dir ) )
+            fc::remove_all( old_dir );
+         fc::rename( target_dir, old_dir );
+      }
+      fc::rename( tmp_dir, target_dir );
+      fc::remove_all( old_dir );
+   }
+
+}
+
+void object_database::for_each_index_parallel( const std::function<void( index&, size_t, size_t )>& f )
+{
    std::vector<fc::future<void>> tasks;
    constexpr size_t max_tasks = 200;
    tasks.reserve(max_tasks);
 
-   auto push_task = [this,&tasks,&tmp_dir]( size_t space, size_t type ) {
-      if( _index[space][type] )
-         tasks.push_back( fc::do_parallel( [this,space,type,&tmp_dir] () {
-            _index[space][type]->save( tmp_dir / fc::to_string(space) / fc::to_string(type) );
-         } ) );
-   };
-
    const auto spaces = _index.size();
    for( size_t space = 0; space < spaces; ++space )
    {
-      fc::create_directories( tmp_dir / fc::to_string(space) );
       const auto types = _index[space].size();
       for( size_t type = 0; type  <  types; ++type )
-         push_task( space, type );
+      {
+         if( _index[space][type] )
+            tasks.push_back( fc::do_parallel( [this,space,type,&f] () {
+               f( *_index[space][type], space, type );
+            } ) );
+      }
    }
    for( auto& task : tasks )
       task.wait();
-   fc::remove_all( tmp_dir / "lock" );
-   if( fc::exists( target_dir ) )
+}
+
+void object_database::flush()
+{
+   if( _snapshot_generation == 0 || _delta_compaction_percent == 0
+         || !fc::exists( _data_dir / "object_database" ) )
+   {
+      flush_full();
+      return;
+   }
+
+   uint64_t snapshot_objects = 0;
+   uint64_t changed_objects = 0;
+   for( const auto& space : _index )
+      for( const auto& idx : space )
+         if( idx )
+         {
+            snapshot_objects += idx->snapshot_size();
+            changed_objects += idx->delta_size();
+         }
+
+   if( changed_objects * 100 > snapshot_objects * _delta_compaction_percent )
    {
-      if( fc::exists( old_dir ) )
-         fc::remove_all( old_dir );
-      fc::rename( target_dir, old_dir );
+      ilog( "Compacting object database, ${c} of ${s} objects changed since the last full snapshot",
+            ("c",changed_objects)("s",snapshot_objects) );
+      flush_full();
    }
-   fc::rename( tmp_dir, target_dir );
-   fc::remove_all( old_dir );
+   else
+      flush_delta();
+}
+
+void object_database::flush_full()
+{
+   const auto tmp_dir = _data_dir / "object_database.tmp";
+   const auto old_dir = _data_dir / "object_database.old";
+   const auto target_dir = _data_dir / "object_database";
+
+   if( fc::exists( tmp_dir ) )
+      fc::remove_all( tmp_dir );
+   fc::create_directories( tmp_dir / "lock" );
+   const auto spaces = _index.size();
+   for( size_t space = 0; space < spaces; ++space )
+      fc::create_directories( tmp_dir / fc::to_string(space) );
+   for_each_index_parallel( [&tmp_dir]( index& idx, size_t space, size_t type ) {
+      idx.save( tmp_dir / fc::to_string(space) / fc::to_string(type) );
+   });
+
+   // The delta belongs to the previous snapshot, drop it before the new snapshot becomes visible
+   fc::remove_all( _data_dir / "object_database.delta" );
+   fc::remove_all( _data_dir / "object_database.delta.tmp" );
+
+   const uint64_t generation = std::max<uint64_t>( _snapshot_generation + 1,
+                                                   fc::time_point::now().time_since_epoch().count() );
+   write_generation( tmp_dir, generation );
+   fc::remove_all( tmp_dir / "lock" );
+   replace_directory( tmp_dir, old_dir, target_dir );
+   _snapshot_generation = generation;
+}
+
+void object_database::flush_delta()
+{
+   const auto tmp_dir = _data_dir / "object_database.delta.tmp";
+   const auto old_dir = _data_dir / "object_database.delta.old";
+   const auto target_dir = _data_dir / "object_database.delta";
+
+   if( fc::exists( tmp_dir ) )
+      fc::remove_all( tmp_dir );
+   fc::create_directories( tmp_dir / "lock" );
+   const auto spaces = _index.size();
+   for( size_t space = 0; space < spaces; ++space )
+      fc::create_directories( tmp_dir / fc::to_string(space) );
+   for_each_index_parallel( [&tmp_dir]( index& idx, size_t space, size_t type ) {
+      idx.save_delta( tmp_dir / fc::to_string(space) / fc::to_string(type) );
+   });
+   write_generation( tmp_dir, _snapshot_generation );
+   fc::remove_all( tmp_dir / "lock" );
+   replace_directory( tmp_dir, old_dir, target_dir );
+}
+
+void object_database::copy_objects_from( const object_database& other )
+{
+   std::vector< std::pair< index*, const index* > > indexes;
+   for( size_t space = 0; space < _index.size() && space < other._index.size(); ++space )
+      for( size_t type = 0; type < _index[space].size() && type < other._index[space].size(); ++type )
+         if( _index[space][type] && other._index[space][type] )
+            indexes.emplace_back( _index[space][type].get(), other._index[space][type].get() );
+
+   std::atomic<size_t> next_index( 0 );
+   std::mutex error_mutex;
+   std::exception_ptr error;
+   auto copy_indexes = [&indexes,&next_index,&error_mutex,&error]() {
+      for( size_t i = next_index++; i < indexes.size(); i = next_index++ )
+      {
+         try
+         {
+            index& dest = *indexes[i].first;
+            const index& source = *indexes[i].second;
+            source.inspect_all_objects( [&dest]( const object& obj ) { dest.load( obj.pack() ); } );
+            dest.set_next_id( source.get_next_id() );
+         }
+         catch( ... )
+         {
+            std::lock_guard<std::mutex> guard( error_mutex );
+            if( !error )
+               error = std::current_exception();
+         }
+      }
+   };
+
+   const size_t thread_count = std::min<size_t>( std::max( 1u, std::thread::hardware_concurrency() ),
+                                                 indexes.size() );
+   std::vector<std::thread> threads;
+   threads.reserve( thread_count );
+   for( size_t i = 0; i < thread_count; ++i )
+      threads.emplace_back( copy_indexes );
+   for( auto& thread : threads )
+      thread.join();
+   if( error )
+      std::rethrow_exception( error );
 }
 
 void object_database::wipe(const fc::path& data_dir)
@@ -124,37 +275,41 @@ void object_database::wipe(const fc::path& data_dir)
    close();
    ilog("Wiping object database...");
    fc::remove_all(data_dir / "object_database");
+   fc::remove_all(data_dir / "object_database.delta");
+   _snapshot_generation = 0;
    ilog("Done wiping object database.");
 }
 
 void object_database::open(const fc::path& data_dir)
 { try {
    _data_dir = data_dir;
-   if( fc::exists( _data_dir / "object_database" / "lock" ) )
+   _snapshot_generation = 0;
+   const auto snapshot_dir = _data_dir / "object_database";
+   const auto delta_dir = _data_dir / "object_database.delta";
+   if( fc::exists( snapshot_dir / "lock" ) )
    {
        wlog("Ignoring locked object_database");
        return;
    }
-   std::vector<fc::future<void>> tasks;
-   tasks.reserve(200);
-
-   auto push_task = [this,&tasks]( size_t space, size_t type ) {
-      if( _index[space][type] )
-         tasks.push_back( fc::do_parallel( [this,space,type] () {
-            _index[space][type]->open( _data_dir / "object_database" / fc::to_string(space) / fc::to_string(type) );
-         } ) );
-   };
 
    ilog("Opening object database from ${d} ...", ("d", data_dir));
-   const auto spaces = _index.size();
-   for( size_t space = 0; space < spaces; ++space )
+   for_each_index_parallel( [&snapshot_dir]( index& idx, size_t space, size_t type ) {
+      idx.open( snapshot_dir / fc::to_string(space) / fc::to_string(type) );
+   });
+   _snapshot_generation = read_generation( snapshot_dir );
+
+   if( _snapshot_generation != 0 && fc::exists( delta_dir ) )
    {
-      const auto types = _index[space].size();
-      for( size_t type = 0; type  < types; ++type )
-         push_task( space, type );
+      if( fc::exists( delta_dir / "lock" ) || read_generation( delta_dir ) != _snapshot_generation )
+         wlog( "Ignoring incomplete or outdated object_database delta" );
+      else
+      {
+         ilog( "Applying object database changes from ${d} ...", ("d", delta_dir) );
+         for_each_index_parallel( [&delta_dir]( index& idx, size_t space, size_t type ) {
+            idx.open_delta( delta_dir / fc::to_string(space) / fc::to_string(type) );
+         });
+      }
    }
-   for( auto& task : tasks )
-      task.wait();
    ilog( "Done opening object database." );
 
 } FC_CAPTURE_AND_RETHROW( (data_dir) ) }
@@ -180,4 +335,61 @@ void object_database::save_undo_remove(const object& obj)
    _undo_db.on_remove( obj );
 }
 
+void object_database::add_missing_indexes_from( const object_database& other )
+{
+   for( size_t space = 0; space < other._index.size(); ++space )
+      for( size_t type = 0; type < other._index[space].size(); ++type )
+      {
+         if( !other._index[space][type] )
+            continue;
+         if( _index[space].size() <= type )
+            _index[space].resize( _index_size );
+         if( !_index[space][type] )
+            _index[space][type] = other._index[space][type]->create_empty( *this );
+      }
+}
+
+object_changes object_database::copy_head_changes()const
+{
+   const undo_state& state = _undo_db.head();
+   object_changes changes;
+   changes.removed.reserve( state.count( undo_state::removed ) );
+   state.for_each( undo_state::removed, [&changes]( const undo_state::entry& e ) {
+      changes.removed.push_back( e.id );
+   });
+   changes.upserted.reserve( state.count( undo_state::created ) + state.count( undo_state::modified ) );
+   const auto copy_current = [this,&changes]( const undo_state::entry& e ) {
+      changes.upserted.push_back( get_object( e.id ).clone() );
+   };
+   state.for_each( undo_state::created, copy_current );
+   state.for_each( undo_state::modified, copy_current );
+   // created objects are inserted in the order of their IDs, like they were created
+   std::sort( changes.upserted.begin(), changes.upserted.end(),
+              []( const std::unique_ptr<object>& a, const std::unique_ptr<object>& b ) { return a->id < b->id; } );
+   changes.next_ids.reserve( state.old_index_next_ids().size() );
+   for( const auto& item : state.old_index_next_ids() )
+      changes.next_ids.emplace_back( item.first, get_index( item.first ).get_next_id() );
+   return changes;
+}
+
+void object_database::apply_changes( const object_changes& changes )
+{
+   // removing first frees the unique keys of the removed objects for the others
+   for( const object_id_type& id : changes.removed )
+      remove( get_object( id ) );
+   for( const auto& item : changes.next_ids )
+      _undo_db.on_set_next_id( get_index( item.first ).get_next_id() );
+   for( const auto& upserted : changes.upserted )
+   {
+      std::unique_ptr<object> copy = upserted->clone();
+      const object* current = find_object( copy->id );
+      if( current != nullptr )
+         modify( *current, [&copy]( object& obj ) { obj.move_from( *copy ); } );
+      else
+         insert( std::move( *copy ) );
+   }
+   for( const auto& item : changes.next_ids )
+      get_mutable_index( item.first ).set_next_id( item.second );
+}
+
 } } // namespace graphene::db
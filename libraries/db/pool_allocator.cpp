@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/db/pool_allocator.hpp>
+
+#include <boost/align/aligned_alloc.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace graphene { namespace db {
+
+namespace {
+
+   constexpr size_t round_up( size_t size, size_t alignment )
+   {
+      return ( size + alignment - 1 ) / alignment * alignment;
+   }
+
+   /// Nodes so large that fewer of them fit into a slab are allocated from the heap
+   const size_t min_nodes_per_slab = 16;
+
+}
+
+struct node_arena::slab
+{
+   slab*  prev = nullptr;
+   slab*  next = nullptr;
+   void*  free_nodes = nullptr; ///< freed nodes, linked through their first bytes
+   size_t unused_offset = 0;    ///< the nodes from here to the end of the slab were never handed out
+   size_t used = 0;
+};
+
+node_arena::~node_arena()
+{
+   assert( _used_nodes == 0 );
+   while( _available != nullptr )
+   {
+      slab* s = _available;
+      unlink( s );
+      boost::alignment::aligned_free( s );
+   }
+   if( _spare != nullptr )
+      boost::alignment::aligned_free( _spare );
+}
+
+void* node_arena::allocate_node( size_t size )
+{
+   if( _node_size == 0 )
+   {
+      const size_t alignment = alignof( std::max_align_t );
+      _node_size = size;
+      _chunk_size = round_up( std::max( size, sizeof(void*) ), alignment );
+      _first_chunk = round_up( sizeof(slab), alignment );
+      _nodes_per_slab = ( slab_size - _first_chunk ) / _chunk_size;
+      if( _nodes_per_slab < min_nodes_per_slab )
+         _nodes_per_slab = 0;
+   }
+   if( size != _node_size || _nodes_per_slab == 0 )
+      return ::operator new( size );
+
+   if( _available == nullptr )
+      link( take_slab() );
+   slab* s = _available;
+   void* node;
+   if( s->free_nodes != nullptr )
+   {
+      node = s->free_nodes;
+      s->free_nodes = *static_cast<void**>( node );
+   }
+   else
+   {
+      node = reinterpret_cast<char*>( s ) + s->unused_offset;
+      s->unused_offset += _chunk_size;
+   }
+   ++_used_nodes;
+   if( ++s->used == _nodes_per_slab )
+      unlink( s );
+   return node;
+}
+
+void node_arena::deallocate_node( void* node, size_t size )
+{
+   if( size != _node_size || _nodes_per_slab == 0 )
+   {
+      ::operator delete( node );
+      return;
+   }
+
+   slab* s = reinterpret_cast<slab*>( reinterpret_cast<uintptr_t>( node ) & ~uintptr_t( slab_size - 1 ) );
+   // a full slab gets nodes again, it is filled first to keep the other slabs emptying
+   if( s->used == _nodes_per_slab )
+      link( s );
+   *static_cast<void**>( node ) = s->free_nodes;
+   s->free_nodes = node;
+   --_used_nodes;
+   if( --s->used > 0 )
+      return;
+
+   unlink( s );
+   if( _spare == nullptr )
+   {
+      s->free_nodes = nullptr;
+      s->unused_offset = _first_chunk;
+      _spare = s;
+   }
+   else
+   {
+      boost::alignment::aligned_free( s );
+      --_slab_count;
+   }
+}
+
+node_arena::slab* node_arena::take_slab()
+{
+   if( _spare != nullptr )
+   {
+      slab* s = _spare;
+      _spare = nullptr;
+      return s;
+   }
+   void* memory = boost::alignment::aligned_alloc( slab_size, slab_size );
+   if( memory == nullptr )
+      throw std::bad_alloc();
+   ++_slab_count;
+   slab* s = ::new( memory ) slab();
+   s->unused_offset = _first_chunk;
+   return s;
+}
+
+void node_arena::link( slab* s )
+{
+   s->prev = nullptr;
+   s->next = _available;
+   if( _available != nullptr )
+      _available->prev = s;
+   _available = s;
+}
+
+void node_arena::unlink( slab* s )
+{
+   if( s->prev != nullptr )
+      s->prev->next = s->next;
+   else
+      _available = s->next;
+   if( s->next != nullptr )
+      s->next->prev = s->prev;
+   s->prev = nullptr;
+   s->next = nullptr;
+}
+
+} } // graphene::db
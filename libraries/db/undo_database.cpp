@@ -25,8 +25,166 @@
 #include <graphene/db/undo_database.hpp>
 #include <fc/reflect/variant.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
 namespace graphene { namespace db {
 
+undo_arena::~undo_arena()
+{
+   destroy_objects();
+}
+
+void undo_arena::destroy_objects()
+{
+   for( object* obj : _objects )
+      obj->~object();
+   _objects.clear();
+}
+
+object* undo_arena::clone( const object& obj, chunk_pool& pool )
+{
+   constexpr size_t alignment = alignof( std::max_align_t );
+   const size_t size = ( obj.object_size() + alignment - 1 ) & ~( alignment - 1 );
+   if( _chunks.empty() || _chunks.back().size - _used < size )
+   {
+      if( size > chunk_size )
+         _chunks.push_back( { std::unique_ptr<char[]>( new char[size] ), size } );
+      else if( !pool.empty() )
+      {
+         _chunks.push_back( { std::move( pool.back() ), chunk_size } );
+         pool.pop_back();
+      }
+      else
+         _chunks.push_back( { std::unique_ptr<char[]>( new char[chunk_size] ), chunk_size } );
+      _used = 0;
+   }
+   object* result = obj.clone_into( _chunks.back().data.get() + _used );
+   _used += size;
+   _objects.push_back( result );
+   return result;
+}
+
+void undo_arena::absorb( undo_arena& other )
+{
+   if( other._chunks.empty() )
+      return;
+   if( _chunks.empty() )
+   {
+      _chunks = std::move( other._chunks );
+      _used = other._used;
+   }
+   else // keep allocating from our own last chunk
+      _chunks.insert( _chunks.end() - 1, std::make_move_iterator( other._chunks.begin() ),
+                      std::make_move_iterator( other._chunks.end() ) );
+   _objects.insert( _objects.end(), other._objects.begin(), other._objects.end() );
+   other._chunks.clear();
+   other._objects.clear();
+   other._used = 0;
+}
+
+void undo_arena::release( chunk_pool& pool )
+{
+   // don't hold on to more than a few MiB of unused chunks
+   constexpr size_t max_pooled_chunks = 64;
+   destroy_objects();
+   for( chunk& c : _chunks )
+      if( c.size == chunk_size && pool.size() < max_pooled_chunks )
+         pool.push_back( std::move( c.data ) );
+   _chunks.clear();
+   _used = 0;
+}
+
+namespace {
+   size_t slot_of( const object_id_type& id, size_t mask )
+   {
+      // Fibonacci hashing spreads the sequential instances of different object types over the table
+      return ( id.number * 0x9E3779B97F4A7C15ULL ) >> 17 & mask;
+   }
+}
+
+const undo_state::entry* undo_state::find( const object_id_type& id )const
+{
+   const entry* e = const_cast<undo_state*>( this )->find( id );
+   if( e == nullptr || e->kind == cancelled )
+      return nullptr;
+   return e;
+}
+
+undo_state::entry* undo_state::find( const object_id_type& id )
+{
+   if( _entries.empty() )
+      return nullptr;
+   const size_t mask = _entries.size() - 1;
+   for( size_t slot = slot_of( id, mask ); ; slot = ( slot + 1 ) & mask )
+   {
+      entry& e = _entries[slot];
+      if( e.kind == unused )
+         return nullptr;
+      if( e.id == id )
+         return &e;
+   }
+}
+
+undo_state::entry& undo_state::find_or_add( const object_id_type& id )
+{
+   // keep the load factor below 1/2
+   if( ( _used + 1 ) * 2 > _entries.size() )
+      grow();
+   const size_t mask = _entries.size() - 1;
+   for( size_t slot = slot_of( id, mask ); ; slot = ( slot + 1 ) & mask )
+   {
+      entry& e = _entries[slot];
+      if( e.kind == unused )
+      {
+         e.id = id;
+         ++_used;
+         return e;
+      }
+      if( e.id == id )
+         return e;
+   }
+}
+
+void undo_state::set_kind( entry& e, entry_kind kind )
+{
+   if( e.kind != unused )
+      --_counts[e.kind];
+   ++_counts[kind];
+   e.kind = kind;
+}
+
+void undo_state::grow()
+{
+   std::vector<entry> old_entries( std::max<size_t>( _entries.size() * 2, 64 ) );
+   old_entries.swap( _entries );
+   const size_t mask = _entries.size() - 1;
+   for( const entry& old : old_entries )
+   {
+      if( old.kind == unused )
+         continue;
+      size_t slot = slot_of( old.id, mask );
+      while( _entries[slot].kind != unused )
+         slot = ( slot + 1 ) & mask;
+      _entries[slot] = old;
+   }
+}
+
+void undo_state::reset( undo_arena::chunk_pool& pool )
+{
+   // a state that recorded a big block of changes would make clearing expensive for all later sessions
+   constexpr size_t max_kept_entries = 4096;
+   if( _entries.size() > max_kept_entries )
+      std::vector<entry>().swap( _entries );
+   else if( _used > 0 )
+      std::fill( _entries.begin(), _entries.end(), entry() );
+   _used = 0;
+   std::fill( std::begin( _counts ), std::end( _counts ), 0 );
+   _old_index_next_ids.clear();
+   _arena.release( pool );
+}
+
 void undo_database::enable()  { _disabled = false; }
 void undo_database::disable() { _disabled = true; }
 
@@ -43,6 +201,26 @@ undo_database::session::~session()
    if( _disable_on_exit ) _db.disable();
 }
 
+undo_state& undo_database::push_state()
+{
+   if( _spare_states.empty() )
+      _stack.emplace_back();
+   else
+   {
+      _stack.emplace_back( std::move( _spare_states.back() ) );
+      _spare_states.pop_back();
+   }
+   return _stack.back();
+}
+
+void undo_database::recycle( undo_state&& state )
+{
+   constexpr size_t max_spare_states = 8;
+   state.reset( _spare_chunks );
+   if( _spare_states.size() < max_spare_states )
+      _spare_states.emplace_back( std::move( state ) );
+}
+
 undo_database::session undo_database::start_undo_session( bool force_enable )
 {
    if( _disabled && !force_enable ) return session(*this);
@@ -51,9 +229,12 @@ undo_database::session undo_database::start_undo_session( bool force_enable )
       _disabled = false;
 
    while( size() > max_size() )
+   {
+      recycle( std::move( _stack.front() ) );
       _stack.pop_front();
+   }
 
-   _stack.emplace_back();
+   push_state();
    ++_active_sessions;
    return session(*this, disable_on_exit );
 }
@@ -61,76 +242,94 @@ void undo_database::on_create( const object& obj )
 {
    if( _disabled ) return;
 
-   if( _stack.empty() )
-      _stack.emplace_back();
-   auto& state = _stack.back();
-   auto index_id = object_id_type( obj.id.space(), obj.id.type(), 0 );
-   auto itr = state.old_index_next_ids.find( index_id );
-   if( itr == state.old_index_next_ids.end() )
-      state.old_index_next_ids[index_id] = obj.id;
-   state.new_ids.insert(obj.id);
+   undo_state& state = _stack.empty() ? push_state() : _stack.back();
+   record_next_id( state, obj.id );
+   auto& e = state.find_or_add( obj.id );
+   // re-inserting an object removed in this state is a modification of the object that existed before
+   state.set_kind( e, e.kind == undo_state::removed ? undo_state::modified : undo_state::created );
+}
+void undo_database::on_set_next_id( const object_id_type& old_next_id )
+{
+   if( _disabled ) return;
+
+   record_next_id( _stack.empty() ? push_state() : _stack.back(), old_next_id );
+}
+void undo_database::record_next_id( undo_state& state, const object_id_type& old_next_id )
+{
+   auto index_id = object_id_type( old_next_id.space(), old_next_id.type(), 0 );
+   auto& next_ids = state._old_index_next_ids;
+   auto itr = std::find_if( next_ids.begin(), next_ids.end(),
+                            [&index_id]( const std::pair<object_id_type, object_id_type>& item ) {
+                               return item.first == index_id;
+                            } );
+   if( itr == next_ids.end() )
+      next_ids.emplace_back( index_id, old_next_id );
 }
 void undo_database::on_modify( const object& obj )
 {
    if( _disabled ) return;
 
-   if( _stack.empty() )
-      _stack.emplace_back();
-   auto& state = _stack.back();
-   if( state.new_ids.find(obj.id) != state.new_ids.end() )
-      return;
-   auto itr =  state.old_values.find(obj.id);
-   if( itr != state.old_values.end() ) return;
-   state.old_values[obj.id] = obj.clone();
+   undo_state& state = _stack.empty() ? push_state() : _stack.back();
+   auto& e = state.find_or_add( obj.id );
+   if( e.kind != undo_state::unused && e.kind != undo_state::cancelled )
+      return; // created or already modified in this state
+   e.old_value = state._arena.clone( obj, _spare_chunks );
+   state.set_kind( e, undo_state::modified );
 }
 void undo_database::on_remove( const object& obj )
 {
    if( _disabled ) return;
 
-   if( _stack.empty() )
-      _stack.emplace_back();
-   undo_state& state = _stack.back();
-   if( state.new_ids.count(obj.id) > 0 )
+   undo_state& state = _stack.empty() ? push_state() : _stack.back();
+   auto& e = state.find_or_add( obj.id );
+   switch( e.kind )
    {
-      state.new_ids.erase(obj.id);
-      return;
-   }
-   if( state.old_values.count(obj.id) > 0 )
-   {
-      state.removed[obj.id] = std::move(state.old_values[obj.id]);
-      state.old_values.erase(obj.id);
-      return;
+      case undo_state::created:
+         state.set_kind( e, undo_state::cancelled );
+         return;
+      case undo_state::modified:
+         state.set_kind( e, undo_state::removed );
+         return;
+      case undo_state::removed:
+         return;
+      default:
+         e.old_value = state._arena.clone( obj, _spare_chunks );
+         state.set_kind( e, undo_state::removed );
    }
-   if( state.removed.count(obj.id) > 0 ) return;
-   state.removed[obj.id] = obj.clone();
 }
 
-void undo_database::undo()
-{ try {
-   FC_ASSERT( !_disabled );
-   FC_ASSERT( _active_sessions > 0 );
-   disable();
-
+void undo_database::revert_head()
+{
    auto& state = _stack.back();
-   for( auto& item : state.old_values )
-   {
-      _db.modify( _db.get_object( item.second->id ), [&]( object& obj ){ obj.move_from( *item.second ); } );
-   }
+   state.for_each( undo_state::modified, [this]( const undo_state::entry& e ) {
+      _db.modify( _db.get_object( e.id ), [&e]( object& obj ){ obj.move_from( *e.old_value ); } );
+   });
 
-   for( auto ritr = state.new_ids.begin(); ritr != state.new_ids.end(); ++ritr  )
-   {
-      _db.remove( _db.get_object(*ritr) );
-   }
+   state.for_each( undo_state::created, [this]( const undo_state::entry& e ) {
+      _db.remove( _db.get_object( e.id ) );
+   });
 
-   for( auto& item : state.old_index_next_ids )
+   for( auto& item : state._old_index_next_ids )
    {
       _db.get_mutable_index( item.first.space(), item.first.type() ).set_next_id( item.second );
    }
 
-   for( auto& item : state.removed )
-      _db.insert( std::move(*item.second) );
+   state.for_each( undo_state::removed, [this]( const undo_state::entry& e ) {
+      _db.insert( std::move( *e.old_value ) );
+   });
 
+   recycle( std::move( state ) );
    _stack.pop_back();
+}
+
+void undo_database::undo()
+{ try {
+   FC_ASSERT( !_disabled );
+   FC_ASSERT( _active_sessions > 0 );
+   disable();
+
+   revert_head();
+
    enable();
    --_active_sessions;
 } FC_CAPTURE_AND_RETHROW() }
@@ -140,6 +339,7 @@ void undo_database::merge()
    FC_ASSERT( _active_sessions > 0 );
    if( _active_sessions == 1 && _stack.size() == 1 )
    {
+      recycle( std::move( _stack.back() ) );
       _stack.pop_back();
       --_active_sessions;
       return;
@@ -148,11 +348,11 @@ void undo_database::merge()
    auto& state = _stack.back();
    auto& prev_state = _stack[_stack.size()-2];
 
-   // An object's relationship to a state can be:
-   // in new_ids            : new
-   // in old_values (was=X) : upd(was=X)
-   // in removed (was=X)    : del(was=X)
-   // not in any of above   : nop
+   // An object's relationship to a state is given by the kind of its entry:
+   // created                  : new
+   // modified (was=X)         : upd(was=X)
+   // removed (was=X)          : del(was=X)
+   // cancelled or no entry    : nop
    //
    // When merging A=prev_state and B=state we have a 4x4 matrix of all possibilities:
    //
@@ -188,70 +388,76 @@ void undo_database::merge()
    // (a serious logic error which should never happen).
    //
 
-   // We can only be outside type A/AB (the nop path) if B is not nop, so it suffices to iterate through B's three containers.
+   // We can only be outside type A/AB (the nop path) if B is not nop, so it suffices to iterate through B's entries.
+   // The pre-images of B stay where they are, prev_state takes over the arena of state.
 
-   // *+upd
-   for( auto& obj : state.old_values )
+   for( const auto& obj : state._entries )
    {
-      if( prev_state.new_ids.find(obj.second->id) != prev_state.new_ids.end() )
-      {
-         // new+upd -> new, type A
+      if( obj.kind == undo_state::unused || obj.kind == undo_state::cancelled )
          continue;
-      }
-      if( prev_state.old_values.find(obj.second->id) != prev_state.old_values.end() )
+      auto& prev = prev_state.find_or_add( obj.id );
+      const bool prev_nop = ( prev.kind == undo_state::unused || prev.kind == undo_state::cancelled );
+      switch( obj.kind )
       {
-         // upd(was=X) + upd(was=Y) -> upd(was=X), type A
-         continue;
+         case undo_state::modified:
+            // new+upd -> new, type A
+            // upd(was=X) + upd(was=Y) -> upd(was=X), type A
+            // del+upd -> N/A
+            assert( prev.kind != undo_state::removed );
+            if( prev_nop )
+            {
+               // nop+upd(was=Y) -> upd(was=Y), type B
+               prev.old_value = obj.old_value;
+               prev_state.set_kind( prev, undo_state::modified );
+            }
+            break;
+         case undo_state::created:
+            // *+new, but we assume the N/A cases don't happen, leaving type B nop+new -> new
+            prev_state.set_kind( prev, undo_state::created );
+            break;
+         case undo_state::removed:
+            if( prev.kind == undo_state::created )
+            {
+               // new + del -> nop (type C)
+               prev_state.set_kind( prev, undo_state::cancelled );
+            }
+            else if( prev.kind == undo_state::modified )
+            {
+               // upd(was=X) + del(was=Y) -> del(was=X)
+               prev_state.set_kind( prev, undo_state::removed );
+            }
+            else
+            {
+               // del + del -> N/A
+               assert( prev.kind != undo_state::removed );
+               // nop + del(was=Y) -> del(was=Y)
+               prev.old_value = obj.old_value;
+               prev_state.set_kind( prev, undo_state::removed );
+            }
+            break;
+         default:
+            break;
       }
-      // del+upd -> N/A
-      assert( prev_state.removed.find(obj.second->id) == prev_state.removed.end() );
-      // nop+upd(was=Y) -> upd(was=Y), type B
-      prev_state.old_values[obj.second->id] = std::move(obj.second);
    }
 
-   // *+new, but we assume the N/A cases don't happen, leaving type B nop+new -> new
-   for( auto id : state.new_ids )
-      prev_state.new_ids.insert(id);
-
    // old_index_next_ids can only be updated, iterate over *+upd cases
-   for( auto& item : state.old_index_next_ids )
+   for( auto& item : state._old_index_next_ids )
    {
-      if( prev_state.old_index_next_ids.find( item.first ) == prev_state.old_index_next_ids.end() )
+      auto& prev_ids = prev_state._old_index_next_ids;
+      if( std::none_of( prev_ids.begin(), prev_ids.end(),
+                        [&item]( const std::pair<object_id_type, object_id_type>& prev_item ) {
+                           return prev_item.first == item.first;
+                        } ) )
       {
          // nop+upd(was=Y) -> upd(was=Y), type B
-         prev_state.old_index_next_ids[item.first] = item.second;
-         continue;
-      }
-      else
-      {
-         // upd(was=X)+upd(was=Y) -> upd(was=X), type A
-         // type A implementation is a no-op, as discussed above, so there is no code here
-         continue;
+         prev_ids.push_back( item );
       }
+      // upd(was=X)+upd(was=Y) -> upd(was=X), type A
+      // type A implementation is a no-op, as discussed above
    }
 
-   // *+del
-   for( auto& obj : state.removed )
-   {
-      if( prev_state.new_ids.find(obj.second->id) != prev_state.new_ids.end() )
-      {
-         // new + del -> nop (type C)
-         prev_state.new_ids.erase(obj.second->id);
-         continue;
-      }
-      auto it = prev_state.old_values.find(obj.second->id);
-      if( it != prev_state.old_values.end() )
-      {
-         // upd(was=X) + del(was=Y) -> del(was=X)
-         prev_state.removed[obj.second->id] = std::move(it->second);
-         prev_state.old_values.erase(obj.second->id);
-         continue;
-      }
-      // del + del -> N/A
-      assert( prev_state.removed.find( obj.second->id ) == prev_state.removed.end() );
-      // nop + del(was=Y) -> del(was=Y)
-      prev_state.removed[obj.second->id] = std::move(obj.second);
-   }
+   prev_state._arena.absorb( state._arena );
+   recycle( std::move( state ) );
    _stack.pop_back();
    --_active_sessions;
 }
@@ -268,27 +474,7 @@ void undo_database::pop_commit()
 
    disable();
    try {
-      auto& state = _stack.back();
-
-      for( auto& item : state.old_values )
-      {
-         _db.modify( _db.get_object( item.second->id ), [&]( object& obj ){ obj.move_from( *item.second ); } );
-      }
-
-      for( auto ritr = state.new_ids.begin(); ritr != state.new_ids.end(); ++ritr  )
-      {
-         _db.remove( _db.get_object(*ritr) );
-      }
-
-      for( auto& item : state.old_index_next_ids )
-      {
-         _db.get_mutable_index( item.first.space(), item.first.type() ).set_next_id( item.second );
-      }
-
-      for( auto& item : state.removed )
-         _db.insert( std::move(*item.second) );
-
-      _stack.pop_back();
+      revert_head();
    }
    catch ( const fc::exception& e )
    {
@@ -77,6 +77,18 @@ namespace graphene { namespace net {
          virtual bool handle_block( const graphene::net::block_message& blk_msg, bool sync_mode,
                                     std::vector<message_hash_type>& contained_transaction_msg_ids ) = 0;
 
+         /**
+          *  @brief Called when a block arrives during synchronization, before the blocks which come earlier
+          *         in the chain have been applied
+          *
+          *  The delegate can do the work which does not depend on the chain state, like recovering signatures
+          *  and computing ids and merkle roots, while earlier blocks are still being applied.  The same block
+          *  is passed to @ref handle_block once this call returns, and is not touched in between.
+          *
+          *  @param blk_msg the message which contains the block
+          */
+         virtual void precompute_sync_block( const graphene::net::block_message& blk_msg ) {}
+
          /**
           *  @brief Called when a new transaction comes in from the network
           *
@@ -507,10 +507,9 @@ namespace graphene { namespace net { namespace detail {
     bool node_impl::have_already_received_sync_item( const item_hash_t& item_hash )
     {
       VERIFY_CORRECT_THREAD();
-      return std::find_if(_received_sync_items.begin(), _received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _received_sync_items.end() ||
-             std::find_if(_new_received_sync_items.begin(), _new_received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _new_received_sync_items.end();                          ;
+      auto has_id = [&item_hash]( const received_sync_block_ptr& item ) { return item->message.block_id == item_hash; };
+      return std::find_if(_received_sync_items.begin(), _received_sync_items.end(), has_id) != _received_sync_items.end() ||
+             std::find_if(_new_received_sync_items.begin(), _new_received_sync_items.end(), has_id) != _new_received_sync_items.end();
     }
 
     void node_impl::request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request )
@@ -2948,14 +2947,54 @@ namespace graphene { namespace net { namespace detail {
       schedule_peer_for_deletion(originating_peer_ptr);
     }
 
-    void node_impl::send_sync_block_to_node_delegate(const graphene::net::block_message& block_message_to_send)
+    void node_impl::send_sync_block_to_node_delegate(const received_sync_block_ptr& sync_block,
+                                                     fc::future<void> previous_block_sent)
     {
       dlog("in send_sync_block_to_node_delegate()");
+      const graphene::net::block_message& block_message_to_send = sync_block->message;
       bool client_accepted_block = false;
       bool discontinue_fetching_blocks_from_peer = false;
 
       fc::oexception handle_message_exception;
 
+      // the previous block may still be waiting for its precomputation
+      if( previous_block_sent.valid() )
+      {
+        try
+        {
+          previous_block_sent.wait();
+        }
+        catch (const fc::canceled_exception&)
+        {
+          throw;
+        }
+        catch (const fc::exception&)
+        { // reported by the task of the previous block
+        }
+      }
+
+      fc::time_point apply_start = fc::time_point::now();
+      if( sync_block->precomputed.valid() )
+      {
+        try
+        {
+          sync_block->precomputed.wait();
+        }
+        catch (const fc::canceled_exception&)
+        {
+          throw;
+        }
+        catch (const fc::exception& e)
+        {
+          // handle_block repeats the precomputation and reports the error
+          dlog("Failed to precompute sync block ${num}: ${e}",
+               ("num", block_message_to_send.block.block_num())("e", e));
+        }
+        const fc::time_point precomputed_time = fc::time_point::now();
+        _sync_pipeline_stats.precompute_wait += (precomputed_time - apply_start).count();
+        apply_start = precomputed_time;
+      }
+
       try
       {
         std::vector<message_hash_type> contained_transaction_msg_ids;
@@ -2999,6 +3038,15 @@ namespace graphene { namespace net { namespace detail {
            handle_message_exception = e;
       }
 
+      _sync_pipeline_stats.apply += (fc::time_point::now() - apply_start).count();
+      if( ++_sync_pipeline_stats.blocks % 10000 == 0 )
+        ilog( "Sync pipeline: ${n} blocks, average microseconds queued: ${q}, waiting for precomputation: ${w}, "
+              "applying: ${a}",
+              ("n", _sync_pipeline_stats.blocks)
+              ("q", _sync_pipeline_stats.queued / _sync_pipeline_stats.blocks)
+              ("w", _sync_pipeline_stats.precompute_wait / _sync_pipeline_stats.blocks)
+              ("a", _sync_pipeline_stats.apply / _sync_pipeline_stats.blocks) );
+
       // build up lists for any potentially-blocking operations we need to do, then do them
       // at the end of this function
       std::set<peer_connection_ptr> peers_with_newly_empty_item_lists;
@@ -3178,10 +3226,9 @@ namespace graphene { namespace net { namespace detail {
 
       do
       {
-        std::copy(std::make_move_iterator(_new_received_sync_items.begin()),
-                  std::make_move_iterator(_new_received_sync_items.end()),
-                  std::front_inserter(_received_sync_items));
-        _new_received_sync_items.clear();
+        while (!_new_received_sync_items.empty())
+          _received_sync_items.splice(_received_sync_items.begin(), _new_received_sync_items,
+                                      _new_received_sync_items.begin());
         dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
 
         block_processed_this_iteration = false;
@@ -3197,11 +3244,11 @@ namespace graphene { namespace net { namespace detail {
             for (const peer_connection_ptr& peer : _active_connections)
             {
                if (!peer->ids_of_items_to_get.empty() &&
-                     peer->ids_of_items_to_get.front() == received_block_iter->block_id)
+                     peer->ids_of_items_to_get.front() == (*received_block_iter)->message.block_id)
                {
                   potential_first_block = true;
                   peer->ids_of_items_to_get.pop_front();
-                  peer->ids_of_items_being_processed.insert(received_block_iter->block_id);
+                  peer->ids_of_items_being_processed.insert((*received_block_iter)->message.block_id);
                }
             }
           }
@@ -3216,24 +3263,30 @@ namespace graphene { namespace net { namespace detail {
             // we don't know they're the same (for the peer in normal operation, it has only told us the
             // message id, for the peer in the sync case we only known the block_id).
             if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
-                          received_block_iter->block_id) == _most_recent_blocks_accepted.end())
+                          (*received_block_iter)->message.block_id) == _most_recent_blocks_accepted.end())
             {
-              graphene::net::block_message block_message_to_process = *received_block_iter;
+              received_sync_block_ptr block_to_process = *received_block_iter;
               _received_sync_items.erase(received_block_iter);
-              _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
-                send_sync_block_to_node_delegate(block_message_to_process);
-              }, "send_sync_block_to_node_delegate"));
+              _sync_pipeline_stats.queued += (fc::time_point::now() - block_to_process->received_time).count();
+              _last_sync_block_sent = fc::async([this, block_to_process, previous = _last_sync_block_sent]() mutable {
+                send_sync_block_to_node_delegate(block_to_process, std::move(previous));
+              }, "send_sync_block_to_node_delegate");
+              _handle_message_calls_in_progress.push_back(_last_sync_block_sent);
               ++blocks_processed;
               block_processed_this_iteration = true;
             }
             else
             {
               dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
+              // let close() wait for the precomputation of the dropped block
+              if ((*received_block_iter)->precomputed.valid() && !(*received_block_iter)->precomputed.ready())
+                _handle_message_calls_in_progress.push_back((*received_block_iter)->precomputed);
               std::vector< peer_connection_ptr > peers_needing_next_batch;
               fc::scoped_lock<fc::mutex> lock(_active_connections.get_mutex());
               for (const peer_connection_ptr& peer : _active_connections)
               {
-                auto items_being_processed_iter = peer->ids_of_items_being_processed.find(received_block_iter->block_id);
+                auto items_being_processed_iter = peer->ids_of_items_being_processed.find(
+                                                       (*received_block_iter)->message.block_id);
                 if (items_being_processed_iter != peer->ids_of_items_being_processed.end())
                 {
                   peer->ids_of_items_being_processed.erase(items_being_processed_iter);
@@ -3295,7 +3348,14 @@ namespace graphene { namespace net { namespace detail {
 
       // add it to the front of _received_sync_items, then process _received_sync_items to try to
       // pass as many messages as possible to the client.
-      _new_received_sync_items.push_front( block_message_to_process );
+      // The client precomputes the block meanwhile, so that by the time the blocks which come before it
+      // have been applied, only the application of this block is left.
+      auto sync_block = std::make_shared<received_sync_block>( block_message_to_process );
+      if( !_node_is_shutting_down )
+        sync_block->precomputed = fc::async( [this, sync_block](){
+                                               _delegate->precompute_sync_block( sync_block->message );
+                                             }, "precompute_sync_block" );
+      _new_received_sync_items.push_front( std::move(sync_block) );
       trigger_process_backlog_of_sync_blocks();
     }
 
@@ -3812,6 +3872,30 @@ namespace graphene { namespace net { namespace detail {
         }
       }
 
+      for( const auto* sync_items : { &_new_received_sync_items, &_received_sync_items } )
+      {
+        for( const received_sync_block_ptr& sync_block : *sync_items )
+        {
+          if( !sync_block->precomputed.valid() || sync_block->precomputed.ready() )
+            continue;
+          try
+          {
+            sync_block->precomputed.cancel_and_wait("node_impl::close()");
+          }
+          catch ( const fc::canceled_exception& )
+          {
+          }
+          catch ( const fc::exception& e )
+          {
+            wlog("Exception thrown while terminating precomputation of a sync block, ignoring: ${e}", ("e", e));
+          }
+          catch (...)
+          {
+            wlog("Exception thrown while terminating precomputation of a sync block, ignoring");
+          }
+        }
+      }
+
       try
       {
         _fetch_sync_items_loop_done.cancel("node_impl::close()");
@@ -4998,7 +5082,14 @@ namespace graphene { namespace net { namespace detail {
     fc::variant_object node_impl::get_call_statistics() const
     {
       VERIFY_CORRECT_THREAD();
-      return _delegate->get_call_statistics();
+      fc::mutable_variant_object statistics( _delegate->get_call_statistics() );
+      fc::mutable_variant_object sync_pipeline;
+      sync_pipeline["blocks"] = _sync_pipeline_stats.blocks;
+      sync_pipeline["queued"] = _sync_pipeline_stats.queued;
+      sync_pipeline["precompute_wait"] = _sync_pipeline_stats.precompute_wait;
+      sync_pipeline["apply"] = _sync_pipeline_stats.apply;
+      statistics["sync_pipeline"] = sync_pipeline;
+      return statistics;
     }
 
     fc::variant_object node_impl::network_get_info() const
@@ -5345,6 +5436,11 @@ namespace graphene { namespace net { namespace detail {
       INVOKE_AND_COLLECT_STATISTICS(handle_block, block_message, sync_mode, contained_transaction_msg_ids);
     }
 
+    void statistics_gathering_node_delegate_wrapper::precompute_sync_block( const graphene::net::block_message& block_message )
+    {
+      INVOKE_AND_COLLECT_STATISTICS(precompute_sync_block, block_message);
+    }
+
     void statistics_gathering_node_delegate_wrapper::handle_transaction( const graphene::net::trx_message& transaction_message )
     {
       INVOKE_AND_COLLECT_STATISTICS(handle_transaction, transaction_message);
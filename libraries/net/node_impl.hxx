@@ -272,6 +272,7 @@ class statistics_gathering_node_delegate_wrapper : public node_delegate
 #define NODE_DELEGATE_METHOD_NAMES (has_item) \
                                (handle_message) \
                                (handle_block) \
+                               (precompute_sync_block) \
                                (handle_transaction) \
                                (get_block_ids) \
                                (get_item) \
@@ -371,6 +372,7 @@ class statistics_gathering_node_delegate_wrapper : public node_delegate
       void handle_message( const message& ) override;
       bool handle_block( const graphene::net::block_message& block_message, bool sync_mode,
                          std::vector<message_hash_type>& contained_transaction_msg_ids ) override;
+      void precompute_sync_block( const graphene::net::block_message& block_message ) override;
       void handle_transaction( const graphene::net::trx_message& transaction_message ) override;
       std::vector<item_hash_t> get_block_ids(const std::vector<item_hash_t>& blockchain_synopsis,
                                              uint32_t& remaining_item_count,
@@ -459,11 +461,40 @@ public:
 
       /// List of sync blocks we've asked for from peers but have not yet received
       active_sync_requests_map              _active_sync_requests;
+      /// A sync block we've received, with the precomputation which was started when it arrived
+      struct received_sync_block
+      {
+         explicit received_sync_block( const graphene::net::block_message& msg )
+         : message( msg ), received_time( fc::time_point::now() ) {}
+
+         graphene::net::block_message message;
+         fc::time_point               received_time;
+         /// Ready when the delegate has precomputed the block, the block must not be touched before
+         fc::future<void>             precomputed;
+      };
+      using received_sync_block_ptr = std::shared_ptr<received_sync_block>;
+
       /// List of sync blocks we've just received but haven't yet tried to process
-      std::list<graphene::net::block_message> _new_received_sync_items;
+      std::list<received_sync_block_ptr> _new_received_sync_items;
       /// List of sync blocks we've received, but can't yet process because we are still missing blocks
       /// that come earlier in the chain
-      std::list<graphene::net::block_message> _received_sync_items;
+      std::list<received_sync_block_ptr> _received_sync_items;
+
+      /// Time spent by sync blocks in each stage of the sync pipeline, in microseconds
+      struct sync_pipeline_stats
+      {
+         uint64_t blocks = 0;
+         /// From arrival until the block could be passed to the delegate
+         uint64_t queued = 0;
+         /// Waiting for the precomputation when the block could already be applied
+         uint64_t precompute_wait = 0;
+         /// In handle_block
+         uint64_t apply = 0;
+      };
+      sync_pipeline_stats _sync_pipeline_stats;
+      /// The task which passes the latest sync block to the delegate.  The task of the next block waits for it,
+      /// so that the blocks are applied in order even when their precomputations finish out of order.
+      fc::future<void> _last_sync_block_sent;
       /// @}
 
       fc::future<void> _process_backlog_of_sync_blocks_done;
@@ -720,7 +751,8 @@ public:
 
       void on_connection_closed(peer_connection* originating_peer) override;
 
-      void send_sync_block_to_node_delegate(const graphene::net::block_message& block_message_to_send);
+      void send_sync_block_to_node_delegate(const received_sync_block_ptr& sync_block,
+                                            fc::future<void> previous_block_sent);
       void process_backlog_of_sync_blocks();
       void trigger_process_backlog_of_sync_blocks();
       void process_block_during_syncing(
@@ -39,6 +39,8 @@
 
 #include <fc/thread/thread.hpp>
 
+#include <algorithm>
+
 namespace graphene { namespace account_history {
 
 namespace detail
@@ -78,6 +80,9 @@ class account_history_plugin_impl
 
       uint32_t _latest_block_number_to_remove = 0;
 
+      bool _history_by_operation_type = false;
+      account_history_by_type_index* _by_type_index = nullptr;
+
       uint64_t get_max_ops_to_keep( const account_id_type& account_id );
 
       /** add one history record, then check and remove the earliest history record(s) */
@@ -401,6 +406,95 @@ void account_history_plugin_impl::remove_old_histories_by_account( const account
 
 } // end namespace detail
 
+void account_history_by_type_index::insert_entry( const account_history_object& aho )
+{
+   const operation_history_object* oho = _db->find( aho.operation_id );
+   if( oho == nullptr )
+   {
+      _deferred.push_back( aho.get_id() );
+      return;
+   }
+   entry e;
+   e.instance = aho.id.instance();
+   e.account = aho.account;
+   e.op_type = static_cast<uint16_t>( oho->op.which() );
+   e.sequence = aho.sequence;
+   e.operation_id = aho.operation_id;
+   if( _entries.insert( e ).second )
+      ++_counts[ std::make_pair( e.account, e.op_type ) ];
+}
+
+void account_history_by_type_index::resolve_deferred()
+{
+   if( _deferred.empty() )
+      return;
+   vector<account_history_id_type> deferred;
+   std::swap( deferred, _deferred );
+   for( const account_history_id_type& id : deferred )
+   {
+      const account_history_object* aho = _db->find( id );
+      if( aho != nullptr )
+         insert_entry( *aho );
+   }
+}
+
+void account_history_by_type_index::object_inserted( const object& obj )
+{ try {
+   if( !is_ready() )
+      return;
+   resolve_deferred();
+   insert_entry( static_cast<const account_history_object&>( obj ) );
+} FC_CAPTURE_AND_RETHROW( (obj) ) } // GCOVR_EXCL_LINE
+
+void account_history_by_type_index::object_removed( const object& obj )
+{ try {
+   if( !is_ready() )
+      return;
+   auto& by_inst = _entries.get<by_instance>();
+   auto itr = by_inst.find( obj.id.instance() );
+   if( itr == by_inst.end() )
+   {
+      _deferred.erase( std::remove( _deferred.begin(), _deferred.end(), account_history_id_type( obj.id ) ),
+                       _deferred.end() );
+      return;
+   }
+   auto count_itr = _counts.find( std::make_pair( itr->account, itr->op_type ) );
+   if( count_itr != _counts.end() && --count_itr->second == 0 ) // should always be found
+      _counts.erase( count_itr );
+   by_inst.erase( itr );
+} FC_CAPTURE_AND_RETHROW( (obj) ) } // GCOVR_EXCL_LINE
+
+void account_history_by_type_index::rebuild( const graphene::chain::database& db )
+{
+   _db = &db;
+   _entries.clear();
+   _counts.clear();
+   _deferred.clear();
+   for( const account_history_object& aho : db.get_index_type<account_history_index>().indices() )
+      insert_entry( aho );
+}
+
+uint64_t account_history_by_type_index::count( const account_id_type& account, uint16_t op_type )const
+{
+   auto itr = _counts.find( std::make_pair( account, op_type ) );
+   return itr == _counts.end() ? 0 : itr->second;
+}
+
+vector<account_history_by_type_index::entry> account_history_by_type_index::get_entries(
+      const account_id_type& account, uint16_t op_type,
+      uint64_t max_sequence, uint64_t min_sequence, uint32_t limit )const
+{
+   vector<entry> result;
+   if( max_sequence < min_sequence )
+      return result;
+   const auto& by_type_idx = _entries.get<by_type>();
+   auto itr = by_type_idx.lower_bound( boost::make_tuple( account, op_type, max_sequence ) );
+   auto itr_end = by_type_idx.upper_bound( boost::make_tuple( account, op_type, min_sequence ) );
+   for( ; itr != itr_end && result.size() < limit; ++itr )
+      result.push_back( *itr );
+   return result;
+}
+
 
 account_history_plugin::account_history_plugin(graphene::app::application& app) :
    plugin(app),
@@ -444,6 +538,9 @@ void account_history_plugin::plugin_set_program_options(
           "Note that this option may cause more history records to be kept in memory than the limit defined by the "
           "max-ops-per-account option, but the amount will be limited by the max-ops-per-acc-by-min-blocks option. "
           "(default: 30000)")
+         ("history-by-operation-type", boost::program_options::value<bool>(),
+          "Keep an additional index of the account histories by operation type, so that queries for the "
+          "operations of one type do not depend on the size of the whole history (default: false)")
          ("max-ops-per-acc-by-min-blocks", boost::program_options::value<uint64_t>(),
           "A potential higher limit on the maximum number of operations per account to be kept in memory "
           "when the min-blocks-to-keep option causes the amount to exceed the limit defined by the "
@@ -460,7 +557,9 @@ void account_history_plugin::plugin_initialize(const boost::program_options::var
    // connect with group 0 to process before some special steps (e.g. snapshot or next_object_id)
    database().applied_block.connect( 0, [this]( const signed_block& b){ my->update_account_histories(b); } );
    my->_oho_index = database().add_index< primary_index< operation_history_index > >();
-   database().add_index< primary_index< account_history_index > >();
+   auto* history_index = database().add_index< primary_index< account_history_index > >();
+   if( my->_history_by_operation_type )
+      my->_by_type_index = history_index->add_secondary_index< account_history_by_type_index >();
 
    database().add_index< primary_index< exceeded_account_index > >();
 }
@@ -482,12 +581,18 @@ void detail::account_history_plugin_impl::init_program_options(const boost::prog
 
    utilities::get_program_option( options, "min-blocks-to-keep", _min_blocks_to_keep );
    utilities::get_program_option( options, "max-ops-per-acc-by-min-blocks", _max_ops_per_acc_by_min_blocks );
+   utilities::get_program_option( options, "history-by-operation-type", _history_by_operation_type );
    if( _max_ops_per_acc_by_min_blocks < _max_ops_per_account )
       _max_ops_per_acc_by_min_blocks = _max_ops_per_account;
 }
 
 void account_history_plugin::plugin_startup()
 {
+   if( my->_by_type_index != nullptr )
+   {
+      my->_by_type_index->rebuild( database() );
+      ilog( "Indexed the account histories by operation type" );
+   }
 }
 
 flat_set<account_id_type> account_history_plugin::tracked_accounts() const
@@ -24,8 +24,12 @@
 #pragma once
 
 #include <graphene/app/plugin.hpp>
+#include <graphene/chain/operation_history_object.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+
+#include <map>
 
 namespace graphene { namespace account_history {
    using namespace chain;
@@ -79,6 +83,76 @@ using exceeded_account_multi_idx_type = multi_index_container<
 
 using exceeded_account_index = generic_index< exceeded_account_object, exceeded_account_multi_idx_type >;
 
+/**
+ *  @brief This secondary index keeps the account history entries of every account ordered by operation type and
+ *         sequence, and counts them by operation type, so that the history of one operation type can be queried
+ *         without walking the whole history of the account.
+ *  @note The operation type is read from the operation history object when an entry is inserted. Objects are
+ *        loaded in parallel when the database is opened, so the index is only maintained after @ref rebuild was
+ *        called, which the plugin does at startup.
+ */
+class account_history_by_type_index : public secondary_index
+{
+   public:
+      struct entry
+      {
+         uint64_t                    instance = 0;  ///< instance of the account history object
+         account_id_type             account;
+         uint16_t                    op_type = 0;
+         uint64_t                    sequence = 0;
+         operation_history_id_type   operation_id;
+      };
+
+      struct by_instance;
+      struct by_type;
+      using entry_multi_idx_type = multi_index_container<
+         entry,
+         indexed_by<
+            hashed_unique< tag<by_instance>, member< entry, uint64_t, &entry::instance > >,
+            ordered_unique< tag<by_type>,
+               composite_key< entry,
+                  member< entry, account_id_type, &entry::account >,
+                  member< entry, uint16_t, &entry::op_type >,
+                  member< entry, uint64_t, &entry::sequence >
+               >,
+               composite_key_compare<
+                  std::less< account_id_type >,
+                  std::less< uint16_t >,
+                  std::greater< uint64_t >
+               >
+            >
+         >
+      >;
+
+      void object_inserted( const object& obj ) override;
+      void object_removed( const object& obj ) override;
+
+      /// Fills the index from the account history and starts maintaining it
+      void rebuild( const graphene::chain::database& db );
+      bool is_ready()const { return _db != nullptr; }
+
+      /// @return the number of history entries of @p account with operations of type @p op_type
+      uint64_t count( const account_id_type& account, uint16_t op_type )const;
+
+      /**
+       *  @return the history entries of @p account with operations of type @p op_type whose sequence is between
+       *          @p min_sequence and @p max_sequence inclusive, most recent first, at most @p limit of them
+       */
+      vector<entry> get_entries( const account_id_type& account, uint16_t op_type,
+                                 uint64_t max_sequence, uint64_t min_sequence, uint32_t limit )const;
+
+   private:
+      void insert_entry( const account_history_object& aho );
+      /// Inserts the entries whose operation history object was not found when they were inserted
+      void resolve_deferred();
+
+      const graphene::chain::database*                        _db = nullptr;
+      entry_multi_idx_type                                    _entries;
+      std::map< std::pair<account_id_type, uint16_t>, uint64_t > _counts;
+      /// Entries restored by an undo before their operation history object
+      vector<account_history_id_type>                         _deferred;
+};
+
 namespace detail
 {
     class account_history_plugin_impl;
@@ -66,6 +66,13 @@ class elasticsearch_plugin_impl
 
          mode elasticsearch_mode = mode::only_save;
 
+         uint16_t export_workers = 2;
+         bool compress_requests = true;
+         /// In MiB
+         uint64_t export_memory_size = 256;
+         /// In MiB, 0 means that the data is only kept in memory and that no checkpoint is saved
+         uint64_t export_queue_size = 4096;
+
          void init(const boost::program_options::variables_map& options);
       };
 
@@ -84,6 +91,11 @@ class elasticsearch_plugin_impl
       uint32_t limit_documents = _options.bulk_replay;
 
       std::unique_ptr<graphene::utilities::es_client> es;
+      /// Sends the data in the background
+      std::unique_ptr<graphene::utilities::es_bulk_exporter> exporter;
+      /// The data of the blocks up to this one has been accepted by ES before the node was restarted
+      uint32_t resume_after_block = 0;
+      bool is_first_block = true;
 
       vector <string> bulk_lines; //  vector of op lines
       size_t approximate_bulk_size = 0;
@@ -94,9 +106,14 @@ class elasticsearch_plugin_impl
       bool is_sync = false;
       bool is_es_version_7_or_above = true;
 
+      bool is_exported( uint32_t block_num ) const
+      {
+         return block_num > std::max( _options.start_es_after_block, resume_after_block );
+      }
+
       void add_elasticsearch( const account_id_type& account_id, const optional<operation_history_object>& oho,
                               uint32_t block_number );
-      void send_bulk( uint32_t block_num );
+      void queue_bulk( uint32_t block_num );
 
       void doOperationHistory(const optional <operation_history_object>& oho, operation_history_struct& os) const;
       void doBlock(uint32_t trx_in_block, const signed_block& b, block_struct& bs) const;
@@ -105,6 +122,8 @@ class elasticsearch_plugin_impl
       void cleanObjects(const account_history_object& ath, const account_id_type& account_id);
 
       void init_program_options(const boost::program_options::variables_map& options);
+      void init_exporter();
+      void check_gap( uint32_t block_num ) const;
 };
 
 static std::string generateIndexName( const fc::time_point_sec& block_date,
@@ -119,6 +138,11 @@ static std::string generateIndexName( const fc::time_point_sec& block_date,
 
 void elasticsearch_plugin_impl::update_account_histories( const signed_block& b )
 {
+   if( is_first_block )
+   {
+      check_gap( b.block_num() );
+      is_first_block = false;
+   }
    checkState(b.timestamp);
    index_name = generateIndexName(b.timestamp, _options.index_prefix);
 
@@ -162,7 +186,7 @@ void elasticsearch_plugin_impl::update_account_histories( const signed_block& b
       oho = create_oho();
 
       // populate what we can before impacted loop
-      if( o_op->block_num > _options.start_es_after_block )
+      if( is_exported( o_op->block_num ) )
       {
          bulk_line_struct.operation_type = oho->op.which();
          bulk_line_struct.operation_id_num = oho->id.instance();
@@ -207,39 +231,43 @@ void elasticsearch_plugin_impl::update_account_histories( const signed_block& b
 
       for( const auto& account_id : impacted )
       {
-         // Note: we send bulk if there are too many items in bulk_lines
+         // Note: we queue bulk if there are too many items in bulk_lines
          add_elasticsearch( account_id, oho, b.block_num() );
       }
 
    }
 
-   // we send bulk at end of block when we are in sync for better real time client experience
-   if( is_sync && !bulk_lines.empty() )
-      send_bulk( b.block_num() );
+   if( is_exported( b.block_num() ) )
+   {
+      queue_bulk( b.block_num() );
+      exporter->end_block( b.block_num() );
+      // we send bulk at end of block when we are in sync for better real time client experience
+      if( is_sync )
+         exporter->seal();
+   }
 
 }
 
-void elasticsearch_plugin_impl::send_bulk( uint32_t block_num )
+void elasticsearch_plugin_impl::queue_bulk( uint32_t block_num )
 {
-   ilog( "Sending ${n} lines of bulk data to ElasticSearch at block ${b}, approximate size ${s}",
-         ("n",bulk_lines.size())("b",block_num)("s",approximate_bulk_size) );
-   if( !es->send_bulk( bulk_lines ) )
-   {
-      elog( "Error sending ${n} lines of bulk data to ElasticSearch, the first lines are:",
-            ("n",bulk_lines.size()) );
-      const auto log_max = std::min( bulk_lines.size(), size_t(10) );
-      for( size_t i = 0; i < log_max; ++i )
-      {
-         edump( (bulk_lines[i]) );
-      }
-      FC_THROW_EXCEPTION( graphene::chain::plugin_exception,
-            "Error populating ES database, we are going to keep trying." );
-   }
+   // The exporter sends the data in the background, and retries until ES accepts it
+   if( !bulk_lines.empty() )
+      exporter->add_lines( block_num, std::move( bulk_lines ) );
    bulk_lines.clear();
    approximate_bulk_size = 0;
    bulk_lines.reserve(limit_documents);
 }
 
+void elasticsearch_plugin_impl::check_gap( uint32_t block_num ) const
+{
+   // Note: if the chain is replayed, the blocks which were accepted by ES already are skipped
+   const uint32_t stored_block = exporter->last_stored_block();
+   if( stored_block > 0 && block_num > stored_block + 1 && block_num - 1 > _options.start_es_after_block )
+      wlog( "Blocks ${f} to ${l} were applied but their data was not stored for ES, "
+            "replay the blockchain to export it",
+            ("f", std::max( stored_block, _options.start_es_after_block ) + 1)("l", block_num - 1) );
+}
+
 void elasticsearch_plugin_impl::checkState(const fc::time_point_sec& block_time)
 {
    if((fc::time_point::now() - block_time) < fc::seconds(30))
@@ -253,6 +281,7 @@ void elasticsearch_plugin_impl::checkState(const fc::time_point_sec& block_time)
       is_sync = false;
    }
    bulk_lines.reserve(limit_documents);
+   exporter->set_max_batch_lines(limit_documents);
 }
 
 struct get_fee_payer_visitor
@@ -426,7 +455,7 @@ void elasticsearch_plugin_impl::add_elasticsearch( const account_id_type& accoun
       obj.total_ops = ath.sequence;
    });
 
-   if( block_number > _options.start_es_after_block )
+   if( is_exported( block_number ) )
    {
       bulk_line_struct.account_history = ath;
 
@@ -444,7 +473,7 @@ void elasticsearch_plugin_impl::add_elasticsearch( const account_id_type& accoun
 
       if( bulk_lines.size() >= limit_documents
             || approximate_bulk_size >= graphene::utilities::es_client::request_size_threshold )
-         send_bulk( block_number );
+         queue_bulk( block_number );
    }
    cleanObjects(ath, account_id);
 }
@@ -528,6 +557,17 @@ void elasticsearch_plugin::plugin_set_program_options(
                "Save operation as string. Needed to serve history api calls(false)")
          ("elasticsearch-mode", boost::program_options::value<uint16_t>(),
                "Mode of operation: only_save(0), only_query(1), all(2) - Default: 0")
+         ("elasticsearch-export-workers", boost::program_options::value<uint16_t>(),
+               "Number of requests sent to ES concurrently(2)")
+         ("elasticsearch-compress-requests", boost::program_options::value<bool>(),
+               "Compress the bulk requests with gzip, ES needs http.compression enabled(true)")
+         ("elasticsearch-export-memory-size", boost::program_options::value<uint64_t>(),
+               "Size in MiB of the data waiting to be sent to ES which is kept in memory(256)")
+         ("elasticsearch-export-queue-size", boost::program_options::value<uint64_t>(),
+               "Size in MiB of the data waiting to be sent to ES which is kept in the elasticsearch directory "
+               "of the data directory, when the data in memory exceeds its limit. The directory also stores "
+               "the last block accepted by ES, to resume from it after a restart. "
+               "0 keeps everything in memory and does not resume(4096)")
          ;
    cfg.add(cli);
 }
@@ -546,6 +586,27 @@ void detail::elasticsearch_plugin_impl::init_program_options(const boost::progra
    es->check_version_7_or_above( is_es_version_7_or_above );
 }
 
+void detail::elasticsearch_plugin_impl::init_exporter()
+{
+   graphene::utilities::es_bulk_exporter::options exporter_options;
+   exporter_options.base_url = _options.elasticsearch_url;
+   exporter_options.auth = _options.auth;
+   exporter_options.name = "elasticsearch";
+   exporter_options.workers = _options.export_workers;
+   exporter_options.compress = _options.compress_requests;
+   exporter_options.max_batch_lines = _options.bulk_replay;
+   exporter_options.max_memory_size = _options.export_memory_size * 1024 * 1024;
+   exporter_options.max_queue_dir_size = _options.export_queue_size * 1024 * 1024;
+   if( _options.export_queue_size > 0 )
+      exporter_options.queue_dir = _self.app().get_data_dir() / "elasticsearch";
+
+   exporter = std::make_unique<graphene::utilities::es_bulk_exporter>( exporter_options );
+   resume_after_block = exporter->last_acknowledged_block();
+   if( resume_after_block > 0 )
+      ilog( "The data of blocks up to ${b} has been accepted by ES, it is not sent again",
+            ("b", resume_after_block) );
+}
+
 void detail::elasticsearch_plugin_impl::plugin_options::init(const boost::program_options::variables_map& options)
 {
    utilities::get_program_option( options, "elasticsearch-node-url",     elasticsearch_url );
@@ -558,6 +619,12 @@ void detail::elasticsearch_plugin_impl::plugin_options::init(const boost::progra
    utilities::get_program_option( options, "elasticsearch-visitor",          visitor );
    utilities::get_program_option( options, "elasticsearch-operation-object", operation_object );
    utilities::get_program_option( options, "elasticsearch-operation-string", operation_string );
+   utilities::get_program_option( options, "elasticsearch-export-workers",      export_workers );
+   utilities::get_program_option( options, "elasticsearch-compress-requests",   compress_requests );
+   utilities::get_program_option( options, "elasticsearch-export-memory-size", export_memory_size );
+   utilities::get_program_option( options, "elasticsearch-export-queue-size",  export_queue_size );
+
+   FC_ASSERT( export_workers > 0, "elasticsearch-export-workers must be positive" );
 
    FC_ASSERT( max_mapping_depth >= 2, "The minimum value of elasticsearch-max-mapping-depth is 2" );
 
@@ -583,6 +650,7 @@ void elasticsearch_plugin::plugin_initialize(const boost::program_options::varia
 
    if( my->_options.elasticsearch_mode != mode::only_query )
    {
+      my->init_exporter();
       // connect with group 0 to process before some special steps (e.g. snapshot or next_object_id)
       database().applied_block.connect( 0, [this](const signed_block &b) {
          my->update_account_histories(b);
@@ -595,6 +663,13 @@ void elasticsearch_plugin::plugin_startup()
    // Nothing to do
 }
 
+void elasticsearch_plugin::plugin_shutdown()
+{
+   // the data which is not accepted by ES yet is stored to be sent after a restart
+   if( my->exporter )
+      my->exporter->close();
+}
+
 static operation_history_object fromEStoOperation(const variant& source)
 {
    operation_history_object result;
@@ -709,4 +784,11 @@ mode elasticsearch_plugin::get_running_mode() const
    return my->_options.elasticsearch_mode;
 }
 
+graphene::utilities::es_bulk_exporter::metrics elasticsearch_plugin::get_export_metrics() const
+{
+   if( !my->exporter )
+      return {};
+   return my->exporter->get_metrics();
+}
+
 } }
@@ -27,6 +27,7 @@
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/utilities/elasticsearch.hpp>
+#include <graphene/utilities/es_bulk_exporter.hpp>
 
 namespace graphene { namespace elasticsearch {
    using namespace chain;
@@ -65,6 +66,7 @@ class elasticsearch_plugin : public graphene::app::plugin
          boost::program_options::options_description& cfg) override;
       void plugin_initialize(const boost::program_options::variables_map& options) override;
       void plugin_startup() override;
+      void plugin_shutdown() override;
 
       operation_history_object get_operation_by_id(const operation_history_id_type& id) const;
       vector<operation_history_object> get_account_history(
@@ -73,6 +75,8 @@ class elasticsearch_plugin : public graphene::app::plugin
             uint64_t limit = 100,
             const operation_history_id_type& start = operation_history_id_type() ) const;
       mode get_running_mode() const;
+      /// Progress of the data sent to ES in the background
+      graphene::utilities::es_bulk_exporter::metrics get_export_metrics() const;
 
    private:
       std::unique_ptr<detail::elasticsearch_plugin_impl> my;
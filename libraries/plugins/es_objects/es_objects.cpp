@@ -90,6 +90,13 @@ class es_objects_plugin_impl
          uint32_t start_es_after_block = 0;
          bool sync_db_on_startup = false;
 
+         uint16_t export_workers = 2;
+         bool compress_requests = true;
+         /// In MiB
+         uint64_t export_memory_size = 256;
+         /// In MiB, 0 means that the data is only kept in memory and that no checkpoint is saved
+         uint64_t export_queue_size = 4096;
+
          void init(const boost::program_options::variables_map& options);
       };
 
@@ -126,6 +133,14 @@ class es_objects_plugin_impl
       uint64_t docs_sent_total = 0;
 
       std::unique_ptr<graphene::utilities::es_client> es;
+      /// Sends the data in the background
+      std::unique_ptr<graphene::utilities::es_bulk_exporter> exporter;
+      /// The data of the blocks up to this one has been accepted by ES before the node was restarted
+      uint32_t resume_after_block = 0;
+      /// The last block whose data has been queued, 0 if none
+      uint32_t exported_block = 0;
+      /// Number of documents of the current block, part of the document versions
+      uint32_t docs_in_block = 0;
 
       vector<std::string> bulk_lines;
       size_t approximate_bulk_size = 0;
@@ -133,13 +148,20 @@ class es_objects_plugin_impl
       uint32_t block_number = 0;
       fc::time_point_sec block_time;
       bool is_es_version_7_or_above = true;
+      bool is_sync = false;
 
       template<typename T>
       void prepareTemplate( const T& blockchain_object, const plugin_options::object_options& opt );
 
+      /// Documents are versioned with the block number and their order in the block, so that ES keeps the
+      /// latest one when requests are retried or sent out of order
+      uint64_t next_doc_version();
+
       void init_program_options(const boost::program_options::variables_map& options);
+      void init_exporter();
 
       void send_bulk_if_ready( bool force = false );
+      void end_exported_block();
 };
 
 struct data_loader
@@ -172,6 +194,7 @@ struct data_loader
          my->prepareTemplate( static_cast<const ObjType&>(o), opt );
       });
       my->send_bulk_if_ready(true);
+      my->exporter->seal();
       my->docs_sent_batch = 0;
    }
 };
@@ -182,6 +205,11 @@ void es_objects_plugin_impl::sync_db( bool delete_before_load )
 
    graphene::chain::database &db = _self.database();
 
+   if( db.head_block_num() != exported_block )
+   {
+      end_exported_block();
+      exported_block = db.head_block_num();
+   }
    block_number = db.head_block_num();
    block_time = db.head_block_time();
 
@@ -202,20 +230,38 @@ void es_objects_plugin_impl::index_database(const vector<object_id_type>& ids, a
 {
    graphene::chain::database &db = _self.database();
 
-   block_number = db.head_block_num();
+   const uint32_t head_num = db.head_block_num();
 
-   if( block_number <= _options.start_es_after_block )
+   if( head_num <= std::max( _options.start_es_after_block, resume_after_block ) )
       return;
 
+   if( 0 == exported_block )
+   {
+      const uint32_t stored_block = exporter->last_stored_block();
+      if( stored_block > 0 && head_num > stored_block + 1 && head_num - 1 > _options.start_es_after_block )
+         wlog( "Blocks ${f} to ${l} were applied but their objects were not stored for ES, "
+               "replay the blockchain or enable es-objects-sync-db-on-startup to export them",
+               ("f", std::max( stored_block, _options.start_es_after_block ) + 1)("l", head_num - 1) );
+   }
+   // the changes of a block are notified after the block is applied, so a block ends when the next one begins
+   if( head_num != exported_block )
+   {
+      end_exported_block();
+      exported_block = head_num;
+   }
+
+   block_number = head_num;
    block_time = db.head_block_time();
 
    // check if we are in replay or in sync and change number of bulk documents accordingly
-   if( (fc::time_point::now() - block_time) < fc::seconds(30) )
+   is_sync = ( (fc::time_point::now() - block_time) < fc::seconds(30) );
+   if( is_sync )
       limit_documents = _options.bulk_sync;
    else
       limit_documents = _options.bulk_replay;
 
    bulk_lines.reserve(limit_documents);
+   exporter->set_max_batch_lines(limit_documents);
 
    static const unordered_map<uint16_t,plugin_options::object_options&> data_type_map = {
       { account_id_type::space_type,             _options.accounts       },
@@ -266,6 +312,26 @@ void es_objects_plugin_impl::index_database(const vector<object_id_type>& ids, a
       }
    }
 
+   // hand the lines over at once when we are in sync for better real time client experience
+   if( is_sync )
+   {
+      send_bulk_if_ready(true);
+      exporter->seal();
+   }
+}
+
+uint64_t es_objects_plugin_impl::next_doc_version()
+{
+   return ( uint64_t( block_number ) << 32 ) + ( ++docs_in_block );
+}
+
+void es_objects_plugin_impl::end_exported_block()
+{
+   if( 0 == exported_block )
+      return;
+   send_bulk_if_ready(true);
+   exporter->end_block( exported_block );
+   docs_in_block = 0;
 }
 
 void es_objects_plugin_impl::delete_from_database(
@@ -277,6 +343,8 @@ void es_objects_plugin_impl::delete_from_database(
    fc::mutable_variant_object delete_line;
    delete_line["_id"] = string(id); // Note: this does not work if `store_updates` is true
    delete_line["_index"] = _options.index_prefix + opt.index_name;
+   delete_line["version"] = next_doc_version();
+   delete_line["version_type"] = "external_gte";
    if( !is_es_version_7_or_above )
       delete_line["_type"] = "_doc";
    fc::mutable_variant_object final_delete_line;
@@ -308,10 +376,16 @@ void es_objects_plugin_impl::prepareTemplate(
    bulk_header["_index"] = _options.index_prefix + opt.index_name;
    if( !is_es_version_7_or_above )
       bulk_header["_type"] = "_doc";
+   // Note: the IDs and versions must not change when a request is sent again
+   const uint64_t version = next_doc_version();
    if( !opt.store_updates )
    {
       bulk_header["_id"] = string(blockchain_object.id);
+      bulk_header["version"] = version;
+      bulk_header["version_type"] = "external_gte";
    }
+   else
+      bulk_header["_id"] = string(blockchain_object.id) + "-" + fc::to_string(version);
 
    fc::variant blockchain_object_variant;
    fc::to_variant( blockchain_object, blockchain_object_variant, GRAPHENE_NET_MAX_NESTED_OBJECTS );
@@ -346,28 +420,18 @@ void es_objects_plugin_impl::send_bulk_if_ready( bool force )
    docs_sent_batch += bulk_lines.size();
    docs_sent_total += bulk_lines.size();
    bool log_by_next = ( docs_sent_total >= next_log_count || fc::time_point::now() >= next_log_time );
-   if( log_by_next || limit_documents == _options.bulk_replay || force )
+   if( log_by_next || ( limit_documents == _options.bulk_replay && !force ) )
    {
-      ilog( "Sending ${n} lines of bulk data to ElasticSearch at block ${blk}, "
+      ilog( "Queueing ${n} lines of bulk data for ElasticSearch at block ${blk}, "
             "this batch ${b}, total ${t}, approximate size ${s}",
             ("n",bulk_lines.size())("blk",block_number)
             ("b",docs_sent_batch)("t",docs_sent_total)("s",approximate_bulk_size) );
       next_log_count = docs_sent_total + log_count_threshold;
       next_log_time = fc::time_point::now() + fc::seconds(log_time_threshold);
    }
-   // send data to elasticsearch when being forced or bulk is too large
-   if( !es->send_bulk( bulk_lines ) )
-   {
-      elog( "Error sending ${n} lines of bulk data to ElasticSearch, the first lines are:", // GCOVR_EXCL_LINE
-            ("n",bulk_lines.size()) ); // GCOVR_EXCL_LINE
-      const auto log_max = std::min( bulk_lines.size(), size_t(10) );
-      for( size_t i = 0; i < log_max; ++i )
-      {
-         edump( (bulk_lines[i]) ); // GCOVR_EXCL_LINE
-      }
-      FC_THROW_EXCEPTION( graphene::chain::plugin_exception,
-            "Error populating ES database, we are going to keep trying." );
-   }
+   // hand data over to the exporter when being forced or bulk is too large,
+   // it is sent in the background and retried until ES accepts it
+   exporter->add_lines( block_number, std::move( bulk_lines ) );
    bulk_lines.clear();
    bulk_lines.reserve(limit_documents);
    approximate_bulk_size = 0;
@@ -454,6 +518,17 @@ void es_objects_plugin::plugin_set_program_options(
                "Start doing ES job after block(0)")
          ("es-objects-sync-db-on-startup", boost::program_options::value<bool>(),
                "Copy all applicable objects from the object database (chain state) to ES on program startup (false)")
+         ("es-objects-export-workers", boost::program_options::value<uint16_t>(),
+               "Number of requests sent to ES concurrently (2)")
+         ("es-objects-compress-requests", boost::program_options::value<bool>(),
+               "Compress the bulk requests with gzip, ES needs http.compression enabled (true)")
+         ("es-objects-export-memory-size", boost::program_options::value<uint64_t>(),
+               "Size in MiB of the data waiting to be sent to ES which is kept in memory (256)")
+         ("es-objects-export-queue-size", boost::program_options::value<uint64_t>(),
+               "Size in MiB of the data waiting to be sent to ES which is kept in the es_objects directory "
+               "of the data directory, when the data in memory exceeds its limit. The directory also stores "
+               "the last block accepted by ES, to resume from it after a restart. "
+               "0 keeps everything in memory and does not resume (4096)")
          ;
    cfg.add(cli);
 }
@@ -469,6 +544,27 @@ void detail::es_objects_plugin_impl::init_program_options(const boost::program_o
    es->check_version_7_or_above( is_es_version_7_or_above );
 }
 
+void detail::es_objects_plugin_impl::init_exporter()
+{
+   graphene::utilities::es_bulk_exporter::options exporter_options;
+   exporter_options.base_url = _options.elasticsearch_url;
+   exporter_options.auth = _options.auth;
+   exporter_options.name = "es_objects";
+   exporter_options.workers = _options.export_workers;
+   exporter_options.compress = _options.compress_requests;
+   exporter_options.max_batch_lines = _options.bulk_replay;
+   exporter_options.max_memory_size = _options.export_memory_size * 1024 * 1024;
+   exporter_options.max_queue_dir_size = _options.export_queue_size * 1024 * 1024;
+   if( _options.export_queue_size > 0 )
+      exporter_options.queue_dir = _self.app().get_data_dir() / "es_objects";
+
+   exporter = std::make_unique<graphene::utilities::es_bulk_exporter>( exporter_options );
+   resume_after_block = exporter->last_acknowledged_block();
+   if( resume_after_block > 0 )
+      ilog( "The objects changed up to block ${b} have been accepted by ES, they are not sent again",
+            ("b", resume_after_block) );
+}
+
 void detail::es_objects_plugin_impl::plugin_options::init(const boost::program_options::variables_map& options)
 {
    utilities::get_program_option( options, "es-objects-elasticsearch-url", elasticsearch_url );
@@ -494,11 +590,18 @@ void detail::es_objects_plugin_impl::plugin_options::init(const boost::program_o
    utilities::get_program_option( options, "es-objects-max-mapping-depth",    max_mapping_depth );
    utilities::get_program_option( options, "es-objects-start-es-after-block", start_es_after_block );
    utilities::get_program_option( options, "es-objects-sync-db-on-startup",   sync_db_on_startup );
+   utilities::get_program_option( options, "es-objects-export-workers",       export_workers );
+   utilities::get_program_option( options, "es-objects-compress-requests",    compress_requests );
+   utilities::get_program_option( options, "es-objects-export-memory-size",   export_memory_size );
+   utilities::get_program_option( options, "es-objects-export-queue-size",    export_queue_size );
+
+   FC_ASSERT( export_workers > 0, "es-objects-export-workers must be positive" );
 }
 
 void es_objects_plugin::plugin_initialize(const boost::program_options::variables_map& options)
 {
    my->init_program_options( options );
+   my->init_exporter();
 
    database().new_objects.connect([this]( const vector<object_id_type>& ids,
          const flat_set<account_id_type>& ) {
@@ -518,14 +621,29 @@ void es_objects_plugin::plugin_initialize(const boost::program_options::variable
 void es_objects_plugin::plugin_startup()
 {
    if( 0 == database().head_block_num() )
-      my->sync_db( true );
+   {
+      // do not wipe the objects which were exported before the node was restarted
+      if( 0 == my->resume_after_block )
+         my->sync_db( true );
+   }
    else if( my->_options.sync_db_on_startup )
       my->sync_db();
 }
 
 void es_objects_plugin::plugin_shutdown()
 {
-   my->send_bulk_if_ready(true); // flush
+   // flush, the data which is not accepted by ES yet is stored to be sent after a restart
+   if( !my->exporter )
+      return;
+   my->end_exported_block();
+   my->exporter->close();
+}
+
+graphene::utilities::es_bulk_exporter::metrics es_objects_plugin::get_export_metrics() const
+{
+   if( !my->exporter )
+      return {};
+   return my->exporter->get_metrics();
 }
 
 } }
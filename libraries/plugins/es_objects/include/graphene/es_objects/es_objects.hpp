@@ -25,6 +25,7 @@
 
 #include <graphene/app/plugin.hpp>
 #include <graphene/chain/database.hpp>
+#include <graphene/utilities/es_bulk_exporter.hpp>
 
 namespace graphene { namespace es_objects {
 
@@ -50,6 +51,9 @@ class es_objects_plugin : public graphene::app::plugin
       void plugin_startup() override;
       void plugin_shutdown() override;
 
+      /// Progress of the data sent to ES in the background
+      graphene::utilities::es_bulk_exporter::metrics get_export_metrics() const;
+
    private:
       std::unique_ptr<detail::es_objects_plugin_impl> my;
 };
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/snapshot/binary_snapshot.hpp>
+
+#include <graphene/chain/block_database.hpp>
+#include <graphene/chain/config.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/thread/parallel.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace graphene { namespace snapshot_plugin {
+
+namespace {
+
+   /// Chunks are closed once they reach this size
+   constexpr size_t snapshot_chunk_size = 1024 * 1024;
+
+   const char* const manifest_file_name = "manifest.json";
+   const char* const head_block_file_name = "head_block.bin";
+
+   void capture_index( const graphene::db::index& idx, captured_state::captured_index& result )
+   {
+      result.info.space_id = idx.object_space_id();
+      result.info.type_id = idx.object_type_id();
+      result.info.next_id = idx.get_next_id();
+      result.info.object_version = idx.get_object_version();
+
+      std::vector<char>* chunk = nullptr;
+      idx.inspect_all_objects( [&result,&chunk]( const graphene::db::object& o ) {
+         if( chunk == nullptr || chunk->size() >= snapshot_chunk_size )
+         {
+            result.chunks.emplace_back();
+            result.chunks.back().reserve( snapshot_chunk_size + snapshot_chunk_size / 4 );
+            result.chunk_objects.push_back( 0 );
+            chunk = &result.chunks.back();
+         }
+         // the same record format as in the files of the object database
+         const std::vector<char> record = fc::raw::pack( o.pack() );
+         chunk->insert( chunk->end(), record.begin(), record.end() );
+         ++result.chunk_objects.back();
+         ++result.info.objects;
+      });
+   }
+
+   snapshot_index_info write_index( const captured_state::captured_index& idx, const fc::path& dir )
+   {
+      snapshot_index_info info = idx.info;
+      info.chunks = idx.chunks.size();
+      const fc::path file = dir / info.file_name();
+      std::ofstream out( file.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+      FC_ASSERT( out, "Unable to create ${f}", ("f",file) );
+
+      fc::sha256::encoder checksums;
+      for( size_t i = 0; i < idx.chunks.size(); ++i )
+      {
+         snapshot_chunk_header header;
+         header.objects = idx.chunk_objects[i];
+         header.size = idx.chunks[i].size();
+         header.checksum = fc::sha256::hash( idx.chunks[i].data(), header.size );
+         fc::raw::pack( out, header );
+         out.write( idx.chunks[i].data(), idx.chunks[i].size() );
+         checksums.write( header.checksum.data(), header.checksum.data_size() );
+      }
+      out.flush();
+      FC_ASSERT( out.good(), "Unable to write ${f}", ("f",file) );
+      info.checksum = checksums.result();
+      info.size = fc::file_size( file );
+      return info;
+   }
+
+   /// Checks an index file against @p info and passes the packed objects of every chunk to @p f
+   void read_index( const snapshot_index_info& info, const fc::path& file,
+                    const std::function<void( const std::vector<char>& )>& f )
+   {
+      FC_ASSERT( fc::exists( file ) && fc::file_size( file ) == info.size,
+                 "${f} is missing or has the wrong size", ("f",file) );
+      std::ifstream in( file.generic_string(), std::ifstream::binary );
+      fc::sha256::encoder checksums;
+      uint64_t objects = 0;
+      std::vector<char> chunk;
+      for( uint32_t i = 0; i < info.chunks; ++i )
+      {
+         snapshot_chunk_header header;
+         fc::raw::unpack( in, header );
+         FC_ASSERT( in.good() && header.size <= info.size, "Chunk ${i} of ${f} is truncated", ("i",i)("f",file) );
+         chunk.resize( header.size );
+         in.read( chunk.data(), chunk.size() );
+         FC_ASSERT( in.good(), "Chunk ${i} of ${f} is truncated", ("i",i)("f",file) );
+         FC_ASSERT( fc::sha256::hash( chunk.data(), header.size ) == header.checksum,
+                    "Chunk ${i} of ${f} is corrupted", ("i",i)("f",file) );
+         checksums.write( header.checksum.data(), header.checksum.data_size() );
+         objects += header.objects;
+         f( chunk );
+      }
+      FC_ASSERT( objects == info.objects && checksums.result() == info.checksum,
+                 "${f} does not match the manifest", ("f",file) );
+   }
+
+}
+
+std::string snapshot_index_info::file_name()const
+{
+   return "objects-" + std::to_string( space_id ) + "-" + std::to_string( type_id ) + ".bin";
+}
+
+std::shared_ptr<captured_state> capture_state( const graphene::chain::database& db, const signed_block& head_block )
+{ try {
+   FC_ASSERT( head_block.block_num() == db.head_block_num() && head_block.id() == db.head_block_id(),
+              "The snapshot must be taken at the head block" );
+   auto state = std::make_shared<captured_state>();
+   state->manifest.chain_id = db.get_chain_id();
+   state->manifest.db_version = GRAPHENE_CURRENT_DB_VERSION;
+   state->manifest.head_block_num = head_block.block_num();
+   state->manifest.head_block_id = head_block.id();
+   state->manifest.head_block_time = head_block.timestamp;
+   state->head_block = head_block;
+
+   std::vector<const graphene::db::index*> indexes;
+   db.inspect_all_indexes( [&indexes]( const graphene::db::index& idx ) { indexes.push_back( &idx ); } );
+   state->indexes.resize( indexes.size() );
+
+   // Plain threads instead of fc tasks: waiting for an fc future would let other tasks of the calling thread
+   // run, and they could modify the database while it is being packed.
+   std::atomic<size_t> next_index { 0 };
+   std::exception_ptr failure;
+   std::mutex failure_mutex;
+   auto worker = [&]() {
+      for( size_t i = next_index++; i < indexes.size(); i = next_index++ )
+      {
+         try
+         {
+            capture_index( *indexes[i], state->indexes[i] );
+         }
+         catch( ... )
+         {
+            std::lock_guard<std::mutex> guard( failure_mutex );
+            failure = std::current_exception();
+         }
+      }
+   };
+   const size_t thread_count = std::min<size_t>( std::max( std::thread::hardware_concurrency(), 1u ),
+                                                 indexes.size() );
+   std::vector<std::thread> threads;
+   threads.reserve( thread_count );
+   for( size_t i = 1; i < thread_count; ++i )
+      threads.emplace_back( worker );
+   worker();
+   for( auto& thread : threads )
+      thread.join();
+   if( failure )
+      std::rethrow_exception( failure );
+
+   return state;
+} FC_CAPTURE_AND_RETHROW( (head_block.block_num()) ) }
+
+void write_snapshot( const captured_state& state, const fc::path& dest )
+{ try {
+   const fc::path tmp_dir = dest.generic_string() + ".tmp";
+   if( fc::exists( tmp_dir ) )
+      fc::remove_all( tmp_dir );
+   fc::create_directories( tmp_dir );
+
+   snapshot_manifest manifest = state.manifest;
+   manifest.indexes.resize( state.indexes.size() );
+   std::vector<fc::future<void>> tasks;
+   tasks.reserve( state.indexes.size() );
+   for( size_t i = 0; i < state.indexes.size(); ++i )
+      tasks.push_back( fc::do_parallel( [&state,&manifest,&tmp_dir,i]() {
+         manifest.indexes[i] = write_index( state.indexes[i], tmp_dir );
+      }) );
+   for( auto& task : tasks )
+      task.wait();
+
+   {
+      std::ofstream out( (tmp_dir / head_block_file_name).generic_string(),
+                         std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+      fc::raw::pack( out, state.head_block );
+      out.flush();
+      FC_ASSERT( out.good(), "Unable to write the head block" );
+   }
+   // the manifest is written last, a snapshot without it is incomplete
+   fc::json::save_to_file( manifest, tmp_dir / manifest_file_name );
+
+   if( fc::exists( dest ) )
+      fc::remove_all( dest );
+   fc::rename( tmp_dir, dest );
+} FC_CAPTURE_AND_RETHROW( (dest) ) }
+
+snapshot_manifest read_manifest( const fc::path& snapshot_dir )
+{ try {
+   const fc::path file = snapshot_dir / manifest_file_name;
+   FC_ASSERT( fc::exists( file ), "${d} is not a complete snapshot", ("d",snapshot_dir) );
+   auto manifest = fc::json::from_file( file ).as<snapshot_manifest>( 5 );
+   FC_ASSERT( manifest.format_version == snapshot_manifest::current_format_version,
+              "Unsupported snapshot format ${v}", ("v",manifest.format_version) );
+   return manifest;
+} FC_CAPTURE_AND_RETHROW( (snapshot_dir) ) }
+
+snapshot_manifest restore_snapshot( const fc::path& snapshot_dir, const fc::path& chain_dir,
+                                    const chain_id_type& chain_id )
+{ try {
+   const auto manifest = read_manifest( snapshot_dir );
+   FC_ASSERT( manifest.chain_id == chain_id,
+              "The snapshot is of chain ${s}, this node is configured for chain ${n}",
+              ("s",manifest.chain_id)("n",chain_id) );
+   FC_ASSERT( manifest.db_version == GRAPHENE_CURRENT_DB_VERSION,
+              "The snapshot was taken with database version ${s}, this node uses ${n}",
+              ("s",manifest.db_version)("n",GRAPHENE_CURRENT_DB_VERSION) );
+   const fc::path target_dir = chain_dir / "object_database";
+   FC_ASSERT( !fc::exists( target_dir ), "${d} already exists", ("d",target_dir) );
+
+   signed_block head_block;
+   {
+      const fc::path file = snapshot_dir / head_block_file_name;
+      FC_ASSERT( fc::exists( file ), "${f} is missing", ("f",file) );
+      std::ifstream in( file.generic_string(), std::ifstream::binary );
+      fc::raw::unpack( in, head_block );
+      FC_ASSERT( head_block.id() == manifest.head_block_id
+                    && head_block.block_num() == manifest.head_block_num,
+                 "${f} does not match the manifest", ("f",file) );
+   }
+
+   // The objects are written in the format of object_database::flush_full(), so that the database opens them
+   const fc::path tmp_dir = chain_dir / "object_database.tmp";
+   if( fc::exists( tmp_dir ) )
+      fc::remove_all( tmp_dir );
+   fc::create_directories( tmp_dir / "lock" );
+   for( const auto& info : manifest.indexes )
+      fc::create_directories( tmp_dir / std::to_string( info.space_id ) );
+
+   std::vector<fc::future<void>> tasks;
+   tasks.reserve( manifest.indexes.size() );
+   for( const auto& info : manifest.indexes )
+      tasks.push_back( fc::do_parallel( [&info,&snapshot_dir,&tmp_dir]() {
+         const fc::path file = tmp_dir / std::to_string( info.space_id ) / std::to_string( info.type_id );
+         std::ofstream out( file.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+         FC_ASSERT( out, "Unable to create ${f}", ("f",file) );
+         fc::raw::pack( out, info.next_id );
+         fc::raw::pack( out, info.object_version );
+         read_index( info, snapshot_dir / info.file_name(), [&out]( const std::vector<char>& chunk ) {
+            out.write( chunk.data(), chunk.size() );
+         });
+         out.flush();
+         FC_ASSERT( out.good(), "Unable to write ${f}", ("f",file) );
+      }) );
+   for( auto& task : tasks )
+      task.wait();
+
+   {
+      graphene::chain::block_database blocks;
+      blocks.open( chain_dir / "database" / "block_num_to_block" );
+      const auto last_id = blocks.last_id();
+      FC_ASSERT( !last_id.valid() || *last_id == manifest.head_block_id,
+                 "The block log in ${d} is not empty", ("d",chain_dir) );
+      if( !last_id.valid() )
+         blocks.store( head_block.id(), head_block );
+      blocks.close();
+   }
+   {
+      std::ofstream version_file( (chain_dir / "db_version").generic_string(),
+                                  std::ios::out | std::ios::binary | std::ios::trunc );
+      version_file.write( manifest.db_version.c_str(), manifest.db_version.size() );
+      FC_ASSERT( version_file.good(), "Unable to write the database version" );
+   }
+
+   // the object database becomes visible last, until then the restore can be repeated
+   fc::remove_all( tmp_dir / "lock" );
+   fc::rename( tmp_dir, target_dir );
+   return manifest;
+} FC_CAPTURE_AND_RETHROW( (snapshot_dir)(chain_dir)(chain_id) ) }
+
+} } //graphene::snapshot_plugin
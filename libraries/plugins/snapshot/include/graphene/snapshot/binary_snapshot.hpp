@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/filesystem.hpp>
+
+#include <memory>
+
+namespace graphene { namespace snapshot_plugin {
+
+using graphene::protocol::block_id_type;
+using graphene::protocol::chain_id_type;
+using graphene::protocol::signed_block;
+using graphene::db::object_id_type;
+
+/**
+ *  Binary snapshots are directories. The @c manifest.json file describes the snapshot and is written last, the
+ *  objects of every index are stored in a separate file, and the head block in @c head_block.bin.
+ *
+ *  An index file is a sequence of chunks. Every chunk starts with a @ref snapshot_chunk_header which is followed
+ *  by the objects of the chunk, each one packed into a vector like in the files of the object database.
+ */
+struct snapshot_chunk_header
+{
+   uint32_t   objects = 0;
+   uint32_t   size = 0;     ///< bytes of packed objects following the header
+   fc::sha256 checksum;     ///< of the packed objects
+};
+
+struct snapshot_index_info
+{
+   uint8_t        space_id = 0;
+   uint8_t        type_id = 0;
+   object_id_type next_id;
+   fc::sha256     object_version;
+   uint64_t       objects = 0;
+   uint32_t       chunks = 0;
+   uint64_t       size = 0;     ///< of the index file
+   fc::sha256     checksum;     ///< over the checksums of all chunks
+
+   std::string file_name()const;
+};
+
+struct snapshot_manifest
+{
+   static constexpr uint32_t current_format_version = 2;
+
+   uint32_t                         format_version = current_format_version;
+   chain_id_type                    chain_id;
+   std::string                      db_version;
+   uint32_t                         head_block_num = 0;
+   block_id_type                    head_block_id;
+   fc::time_point_sec               head_block_time;
+   std::vector<snapshot_index_info> indexes;
+};
+
+/// A copy of the chain state, packed into chunks which can be written without access to the database
+struct captured_state
+{
+   struct captured_index
+   {
+      snapshot_index_info              info;          ///< size and checksums are filled in when written
+      std::vector< uint32_t >          chunk_objects;
+      std::vector< std::vector<char> > chunks;
+   };
+
+   snapshot_manifest           manifest;
+   signed_block                head_block;
+   std::vector<captured_index> indexes;
+};
+
+/**
+ *  Packs all objects of @p db into memory. The indexes are packed in parallel, the caller must make sure that
+ *  the database is not modified until this returns.
+ *  @param head_block the current head block of @p db
+ */
+std::shared_ptr<captured_state> capture_state( const graphene::chain::database& db, const signed_block& head_block );
+
+/// Writes a captured state to the directory @p dest, replacing it if it exists. The indexes are written in parallel.
+void write_snapshot( const captured_state& state, const fc::path& dest );
+
+snapshot_manifest read_manifest( const fc::path& snapshot_dir );
+
+/**
+ *  Verifies a snapshot and turns it into the object database and the block log of a new node.
+ *  @param chain_dir the @c blockchain directory in the data directory of the node, it must not contain an
+ *         object database
+ *  @param chain_id the ID of the chain the node is configured for, a snapshot of another chain is refused
+ *  @return the manifest of the restored snapshot
+ */
+snapshot_manifest restore_snapshot( const fc::path& snapshot_dir, const fc::path& chain_dir,
+                                    const chain_id_type& chain_id );
+
+} } //graphene::snapshot_plugin
+
+FC_REFLECT( graphene::snapshot_plugin::snapshot_chunk_header, (objects)(size)(checksum) )
+FC_REFLECT( graphene::snapshot_plugin::snapshot_index_info,
+            (space_id)(type_id)(next_id)(object_version)(objects)(chunks)(size)(checksum) )
+FC_REFLECT( graphene::snapshot_plugin::snapshot_manifest,
+            (format_version)(chain_id)(db_version)(head_block_num)(head_block_id)(head_block_time)(indexes) )
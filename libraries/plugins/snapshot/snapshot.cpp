@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 #include <graphene/snapshot/snapshot.hpp>
+#include <graphene/snapshot/binary_snapshot.hpp>
 
 #include <graphene/chain/database.hpp>
 
@@ -36,6 +37,8 @@ namespace bpo = boost::program_options;
 static const char* OPT_BLOCK_NUM  = "snapshot-at-block";
 static const char* OPT_BLOCK_TIME = "snapshot-at-time";
 static const char* OPT_DEST       = "snapshot-to";
+static const char* OPT_FORMAT     = "snapshot-format";
+static const char* OPT_RESTORE    = "snapshot-restore-from";
 
 void snapshot_plugin::plugin_set_program_options(
    boost::program_options::options_description& command_line_options,
@@ -44,7 +47,11 @@ void snapshot_plugin::plugin_set_program_options(
    command_line_options.add_options()
          (OPT_BLOCK_NUM, bpo::value<uint32_t>(), "Block number after which to do a snapshot")
          (OPT_BLOCK_TIME, bpo::value<string>(), "Block time (ISO format) after which to do a snapshot")
-         (OPT_DEST, bpo::value<string>(), "Pathname of JSON file where to store the snapshot")
+         (OPT_DEST, bpo::value<string>(), "Pathname of JSON file or binary snapshot directory where to store the snapshot")
+         (OPT_FORMAT, bpo::value<string>()->default_value("json"),
+               "Snapshot format, json (one object per line) or binary (chunked and checksummed, can be restored)")
+         (OPT_RESTORE, bpo::value<string>(),
+               "Directory of a binary snapshot to initialize the chain state of a node which has none")
          ;
    config_file_options.add(command_line_options);
 }
@@ -63,6 +70,16 @@ void snapshot_plugin::plugin_initialize(const boost::program_options::variables_
 { try {
    ilog("snapshot plugin: plugin_initialize() begin");
 
+   if( options.count(OPT_RESTORE) > 0 )
+      restore( options[OPT_RESTORE].as<std::string>() );
+
+   if( options.count(OPT_FORMAT) > 0 )
+   {
+      const auto format = options[OPT_FORMAT].as<std::string>();
+      FC_ASSERT( format == "json" || format == "binary", "Unknown snapshot format ${f}", ("f",format) );
+      binary_format = ( format == "binary" );
+   }
+
    if( options.count(OPT_BLOCK_NUM) > 0 || options.count(OPT_BLOCK_TIME) > 0 )
    {
       FC_ASSERT( options.count(OPT_DEST) > 0,
@@ -83,6 +100,37 @@ void snapshot_plugin::plugin_initialize(const boost::program_options::variables_
    ilog("snapshot plugin: plugin_initialize() end");
 } FC_LOG_AND_RETHROW() }
 
+void snapshot_plugin::plugin_shutdown()
+{
+   if( pending_write.valid() && !pending_write.ready() )
+   {
+      ilog( "snapshot plugin: waiting for the snapshot to be written" );
+      pending_write.wait();
+   }
+   if( writer_thread )
+   {
+      writer_thread->quit();
+      writer_thread.reset();
+   }
+}
+
+void snapshot_plugin::restore( const fc::path& src )
+{ try {
+   const fc::path chain_dir = app().get_data_dir() / "blockchain";
+   if( fc::exists( chain_dir / "object_database" ) )
+   {
+      wlog( "snapshot plugin: not restoring ${s}, there is a chain state in ${d} already",
+            ("s",src)("d",chain_dir) );
+      return;
+   }
+   ilog( "snapshot plugin: restoring ${s}", ("s",src) );
+   const auto start = fc::time_point::now();
+   const snapshot_manifest manifest = restore_snapshot( src, chain_dir, app().get_configured_chain_id() );
+   ilog( "snapshot plugin: restored the state of chain ${c} at block ${n} (${id}) in ${t} ms",
+         ("c",manifest.chain_id)("n",manifest.head_block_num)("id",manifest.head_block_id)
+         ("t",( fc::time_point::now() - start ).count() / 1000) );
+} FC_CAPTURE_AND_RETHROW( (src) ) }
+
 static void create_snapshot( const graphene::chain::database& db, const fc::path& dest )
 {
    ilog("snapshot plugin: creating snapshot");
@@ -96,22 +144,11 @@ static void create_snapshot( const graphene::chain::database& db, const fc::path
       wlog( "Failed to open snapshot destination: ${ex}", ("ex",e) );
       return;
    }
-   for( uint32_t space_id = 0; space_id < 256; space_id++ )
-      for( uint32_t type_id = 0; type_id < 256; type_id++ )
-      {
-         try
-         {
-            db.get_index( (uint8_t)space_id, (uint8_t)type_id );
-         }
-         catch (fc::assert_exception& e)
-         {
-            continue;
-         }
-         auto& index = db.get_index( (uint8_t)space_id, (uint8_t)type_id );
-         index.inspect_all_objects( [&out]( const graphene::db::object& o ) {
-            out << fc::json::to_string( o.to_variant() ) << '\n';
-         });
-      }
+   db.inspect_all_indexes( [&out]( const graphene::db::index& index ) {
+      index.inspect_all_objects( [&out]( const graphene::db::object& o ) {
+         out << fc::json::to_string( o.to_variant() ) << '\n';
+      });
+   });
    out.close();
    ilog("snapshot plugin: created snapshot");
 }
@@ -121,7 +158,49 @@ void snapshot_plugin::check_snapshot( const graphene::chain::signed_block& b )
     uint32_t current_block = b.block_num();
     if( (last_block < snapshot_block && snapshot_block <= current_block)
            || (last_time < snapshot_time && snapshot_time <= b.timestamp) )
-       create_snapshot( database(), dest );
+    {
+       if( binary_format )
+          create_binary_snapshot( b );
+       else
+          create_snapshot( database(), dest );
+    }
     last_block = current_block;
     last_time = b.timestamp;
 } FC_LOG_AND_RETHROW() }
+
+void snapshot_plugin::create_binary_snapshot( const graphene::chain::signed_block& b )
+{
+   ilog( "snapshot plugin: capturing the state at block ${n}", ("n",b.block_num()) );
+   const auto start = fc::time_point::now();
+   std::shared_ptr<captured_state> state;
+   try
+   {
+      state = capture_state( database(), b );
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "Failed to capture the snapshot: ${e}", ("e",e.to_detail_string()) );
+      return;
+   }
+   ilog( "snapshot plugin: captured the state in ${t} ms, writing it to ${d} in the background",
+         ("t",( fc::time_point::now() - start ).count() / 1000)("d",dest) );
+
+   if( !writer_thread )
+      writer_thread = std::make_unique<fc::thread>( "snapshot" );
+   // a snapshot which is still being written goes first
+   pending_write = writer_thread->async( [previous = pending_write,state,dest = dest]() mutable {
+      if( previous.valid() )
+         previous.wait();
+      const auto write_start = fc::time_point::now();
+      try
+      {
+         write_snapshot( *state, dest );
+         ilog( "snapshot plugin: created snapshot at block ${n} in ${t} ms",
+               ("n",state->manifest.head_block_num)("t",( fc::time_point::now() - write_start ).count() / 1000) );
+      }
+      catch( const fc::exception& e )
+      {
+         elog( "Failed to write the snapshot to ${d}: ${e}", ("d",dest)("e",e.to_detail_string()) );
+      }
+   });
+}
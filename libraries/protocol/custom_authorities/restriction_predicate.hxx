@@ -580,6 +580,17 @@ object_restriction_predicate<Object> restrictions_to_predicate(vector<restrictio
       return create_field_predicate<Object>(std::move(r), short());
    });
 
+   // Most restriction lists are empty or hold a single restriction; don't pay for the loop in those cases
+   if (predicates.empty())
+      return [](const Object&) { return predicate_result::Success(); };
+   if (predicates.size() == 1)
+      return [p=std::move(predicates.front())](const Object& obj) {
+         auto result = p(obj);
+         if (!result)
+            result.rejection_path.push_back(size_t(0));
+         return result;
+      };
+
    return [predicates=std::move(predicates)](const Object& obj) {
       for (size_t i = 0; i < predicates.size(); ++i) {
          auto result = predicates[i](obj);
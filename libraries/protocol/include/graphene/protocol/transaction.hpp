@@ -189,6 +189,9 @@ namespace graphene { namespace protocol {
        * which returns a minimal set in all cases, including
        * some cases where get_required_signatures() returns a
        * non-minimal set.
+       *
+       * The required authorities are fetched once and evaluated as a graph, so that trying to drop a key only
+       * evaluates the authorities which depend on it again.
        */
       set<public_key_type> minimize_required_signatures(
               const chain_id_type& chain_id,
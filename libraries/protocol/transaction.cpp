@@ -31,6 +31,8 @@
 
 #include <fc/io/raw.hpp>
 
+#include <limits>
+
 namespace graphene { namespace protocol {
 
 digest_type processed_transaction::merkle_digest()const
@@ -347,6 +349,362 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
 } FC_CAPTURE_AND_RETHROW( (rejected_custom_auths)(ops)(sigs) ) }
 
 
+/**
+ * Finds out which keys of a candidate set are needed to satisfy the authorities required by some operations.
+ *
+ * The required authorities, the custom authorities which can replace them and the authorities of all accounts
+ * reachable from them within the recursion limit are fetched once and kept as a graph.  The satisfaction of every
+ * authority is memoized for the current set of keys.  When a key is tentatively removed, only the authorities
+ * from which that key can be reached are evaluated again.
+ *
+ * Unlike sign_state, an account approved somewhere in the graph is not treated as approved everywhere else, so
+ * the solver can be stricter than verify_authority, but never more lenient.  Its result is therefore only a
+ * starting point for the key-by-key check in signed_transaction::minimize_required_signatures.
+ */
+struct required_signature_solver
+{
+   static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+   struct account_edge
+   {
+      account_id_type account;
+      uint32_t        weight = 0;
+      bool            approved = false;  ///< the account is always approved
+      uint32_t        active = npos;     ///< node of the active authority of the account
+      uint32_t        owner = npos;      ///< node of the owner authority, npos if it can not be used here
+   };
+
+   struct node
+   {
+      bool                                       valid = false;
+      uint32_t                                   threshold = 0;
+      vector< std::pair<uint32_t, uint32_t> >    keys;      ///< candidate key and weight
+      vector<account_edge>                       accounts;
+      uint32_t                                   min_depth = npos;
+      flat_set<uint32_t>                         reachable_keys;
+   };
+
+   /// Satisfied if any of the alternatives is satisfied at depth 0
+   struct requirement
+   {
+      vector<uint32_t> alternatives;
+   };
+
+   required_signature_solver( const vector<operation>& ops, const set<public_key_type>& candidates,
+                              const std::function<const authority*(account_id_type)>& get_active,
+                              const std::function<const authority*(account_id_type)>& get_owner,
+                              const custom_authority_lookup& get_custom,
+                              bool allow_non_immediate_owner,
+                              bool ignore_custom_operation_required_auths,
+                              uint32_t max_recursion_depth )
+   :  get_active( get_active ),
+      get_owner( get_owner ),
+      allow_non_immediate_owner( allow_non_immediate_owner ),
+      max_recursion( max_recursion_depth ),
+      keys( candidates.begin(), candidates.end() ),
+      in_set( keys.size(), true )
+   {
+      for( uint32_t i = 0; i < keys.size(); ++i )
+         key_index[ keys[i] ] = i;
+
+      flat_set<account_id_type> required_active;
+      flat_set<account_id_type> required_owner;
+      vector<authority> other;
+      rejected_predicate_map rejected_custom_auths;
+      for( const auto& op : ops )
+      {
+         flat_set<account_id_type> operation_required_active;
+         operation_get_required_authorities( op, operation_required_active, required_owner, other,
+                                             ignore_custom_operation_required_auths );
+         for( const auto& id : operation_required_active )
+         {
+            const auto custom_auths = get_custom( id, op, &rejected_custom_auths );
+            if( custom_auths.empty() )
+            {
+               required_active.insert( id );
+               continue;
+            }
+            requirement r = account_requirement( id );
+            for( const auto& auth : custom_auths )
+               r.alternatives.push_back( add_node( &auth ) );
+            requirements.push_back( std::move( r ) );
+         }
+      }
+      for( const auto& auth : other )
+         requirements.push_back( requirement{ { add_node( &auth ) } } );
+      for( const auto& id : required_owner )
+         requirements.push_back( requirement{ { owner_node( id ) } } );
+      for( const auto& id : required_active )
+         requirements.push_back( account_requirement( id ) );
+
+      for( const auto& r : requirements )
+         for( const uint32_t alt : r.alternatives )
+            expand( alt, 0 );
+      compute_reachable_keys();
+   }
+
+   /**
+    * Removes the candidate keys one at a time in ascending order, keeping every key without which a required
+    * authority would not be satisfied.
+    * @return false if the candidates do not satisfy the required authorities in the first place
+    */
+   bool minimize( flat_set<public_key_type>& result )
+   {
+      for( const auto& r : requirements )
+         if( !satisfied( r, npos ) )
+            return false;
+
+      for( uint32_t k = 0; k < keys.size(); ++k )
+      {
+         tentative.clear();
+         bool removable = true;
+         for( const auto& r : requirements )
+         {
+            if( reaches( r, k ) && !satisfied( r, k ) )
+            {
+               removable = false;
+               break;
+            }
+         }
+         if( !removable )
+            continue;
+         in_set[k] = false;
+         // the memoized values of the authorities which can reach the key are outdated
+         for( auto itr = current.begin(); itr != current.end(); )
+         {
+            if( nodes[ itr->first.first ].reachable_keys.count( k ) > 0 )
+               itr = current.erase( itr );
+            else
+               ++itr;
+         }
+         for( const auto& item : tentative )
+            current[ item.first ] = item.second;
+      }
+
+      result.clear();
+      for( uint32_t k = 0; k < keys.size(); ++k )
+         if( in_set[k] )
+            result.insert( keys[k] );
+      return true;
+   }
+
+private:
+   requirement account_requirement( account_id_type id )
+   {
+      if( id == GRAPHENE_TEMP_ACCOUNT )
+         return requirement{ { always_satisfied_node() } };
+      // the owner authority can always satisfy a required active authority at the top level
+      return requirement{ { active_node( id ), owner_node( id ) } };
+   }
+
+   uint32_t add_node( const authority* auth )
+   {
+      node n;
+      if( auth != nullptr )
+      {
+         n.valid = true;
+         n.threshold = auth->weight_threshold;
+         for( const auto& k : auth->key_auths )
+         {
+            auto itr = key_index.find( k.first );
+            if( itr != key_index.end() )
+               n.keys.emplace_back( itr->second, k.second );
+         }
+         if( !auth->address_auths.empty() )
+         {
+            init_address_index();
+            for( const auto& a : auth->address_auths )
+            {
+               auto itr = address_index.find( a.first );
+               if( itr != address_index.end() )
+                  n.keys.emplace_back( itr->second, a.second );
+            }
+         }
+         for( const auto& a : auth->account_auths )
+         {
+            account_edge e;
+            e.account = a.first;
+            e.weight = a.second;
+            e.approved = ( a.first == GRAPHENE_TEMP_ACCOUNT );
+            n.accounts.push_back( e );
+         }
+      }
+      nodes.push_back( std::move( n ) );
+      return nodes.size() - 1;
+   }
+
+   uint32_t always_satisfied_node()
+   {
+      node n;
+      n.valid = true;
+      nodes.push_back( std::move( n ) );
+      return nodes.size() - 1;
+   }
+
+   uint32_t active_node( account_id_type id )
+   {
+      auto itr = active_nodes.find( id );
+      if( itr != active_nodes.end() )
+         return itr->second;
+      const uint32_t result = add_node( get_active( id ) );
+      active_nodes[id] = result;
+      return result;
+   }
+
+   uint32_t owner_node( account_id_type id )
+   {
+      auto itr = owner_nodes.find( id );
+      if( itr != owner_nodes.end() )
+         return itr->second;
+      const uint32_t result = add_node( get_owner( id ) );
+      owner_nodes[id] = result;
+      return result;
+   }
+
+   /// Resolves the accounts referenced by node @p i, as far as they can be evaluated when it is used at @p depth
+   void expand( uint32_t i, uint32_t depth )
+   {
+      if( depth >= nodes[i].min_depth )
+         return;
+      const bool resolved = ( nodes[i].min_depth < max_recursion );
+      nodes[i].min_depth = depth;
+      if( depth >= max_recursion )
+         return;
+      for( size_t j = 0; j < nodes[i].accounts.size(); ++j )
+      {
+         if( nodes[i].accounts[j].approved )
+            continue;
+         if( !resolved )
+         {
+            const account_id_type id = nodes[i].accounts[j].account;
+            const uint32_t active = active_node( id );
+            const uint32_t owner = allow_non_immediate_owner ? owner_node( id ) : npos;
+            nodes[i].accounts[j].active = active;
+            nodes[i].accounts[j].owner = owner;
+         }
+         expand( nodes[i].accounts[j].active, depth + 1 );
+         if( nodes[i].accounts[j].owner != npos )
+            expand( nodes[i].accounts[j].owner, depth + 1 );
+      }
+   }
+
+   void compute_reachable_keys()
+   {
+      for( auto& n : nodes )
+         for( const auto& k : n.keys )
+            n.reachable_keys.insert( k.first );
+      bool changed = true;
+      while( changed )
+      {
+         changed = false;
+         for( auto& n : nodes )
+         {
+            for( const auto& e : n.accounts )
+            {
+               for( const uint32_t child : { e.active, e.owner } )
+               {
+                  if( child == npos )
+                     continue;
+                  const size_t before = n.reachable_keys.size();
+                  n.reachable_keys.insert( nodes[child].reachable_keys.begin(), nodes[child].reachable_keys.end() );
+                  changed = changed || n.reachable_keys.size() != before;
+               }
+            }
+         }
+      }
+   }
+
+   void init_address_index()
+   {
+      if( address_index_initialized )
+         return;
+      address_index_initialized = true;
+      for( uint32_t i = 0; i < keys.size(); ++i )
+      {
+         const public_key_type& k = keys[i];
+         address_index[ address( pts_address( k, false ) ) ] = i;
+         address_index[ address( pts_address( k, true ) ) ] = i;
+         address_index[ address( pts_address( k, false, 0 ) ) ] = i;
+         address_index[ address( pts_address( k, true, 0 ) ) ] = i;
+         address_index[ address( k ) ] = i;
+      }
+   }
+
+   bool reaches( const requirement& r, uint32_t k )const
+   {
+      for( const uint32_t alt : r.alternatives )
+         if( nodes[alt].reachable_keys.count( k ) > 0 )
+            return true;
+      return false;
+   }
+
+   bool satisfied( const requirement& r, uint32_t removed )
+   {
+      for( const uint32_t alt : r.alternatives )
+         if( value( alt, 0, removed ) )
+            return true;
+      return false;
+   }
+
+   /// @return whether node @p i is satisfied at @p depth by the current keys without the key @p removed
+   bool value( uint32_t i, uint32_t depth, uint32_t removed )
+   {
+      if( removed != npos && nodes[i].reachable_keys.count( removed ) == 0 )
+         removed = npos;
+      auto& memo = ( removed == npos ) ? current : tentative;
+      const auto key = std::make_pair( i, depth );
+      auto itr = memo.find( key );
+      if( itr != memo.end() )
+         return itr->second;
+
+      const node& n = nodes[i];
+      bool result = false;
+      if( n.valid )
+      {
+         uint64_t total_weight = 0;
+         for( const auto& k : n.keys )
+         {
+            if( in_set[k.first] && k.first != removed )
+               total_weight += k.second;
+         }
+         for( size_t j = 0; j < n.accounts.size() && total_weight < n.threshold; ++j )
+         {
+            const account_edge& e = n.accounts[j];
+            if( e.approved )
+               total_weight += e.weight;
+            else if( depth < max_recursion && e.active != npos
+                     && ( value( e.active, depth + 1, removed )
+                          || ( e.owner != npos && value( e.owner, depth + 1, removed ) ) ) )
+               total_weight += e.weight;
+         }
+         result = total_weight >= n.threshold;
+      }
+      memo[key] = result;
+      return result;
+   }
+
+   const std::function<const authority*(account_id_type)>& get_active;
+   const std::function<const authority*(account_id_type)>& get_owner;
+   const bool                                     allow_non_immediate_owner;
+   const uint32_t                                 max_recursion;
+
+   vector<public_key_type>                        keys;
+   vector<bool>                                   in_set;
+   flat_map<public_key_type, uint32_t>            key_index;
+   bool                                           address_index_initialized = false;
+   map<address, uint32_t>                         address_index;
+
+   vector<node>                                   nodes;
+   vector<requirement>                            requirements;
+   flat_map<account_id_type, uint32_t>            active_nodes;
+   flat_map<account_id_type, uint32_t>            owner_nodes;
+
+   /// satisfaction of (node, depth) with the current keys
+   map< std::pair<uint32_t, uint32_t>, bool >     current;
+   /// satisfaction of (node, depth) with the current keys except the one being tried
+   map< std::pair<uint32_t, uint32_t>, bool >     tentative;
+};
+
 const flat_set<public_key_type>& signed_transaction::get_signature_keys( const chain_id_type& chain_id )const
 { try {
    auto d = sig_digest( chain_id );
@@ -411,9 +769,34 @@ set<public_key_type> signed_transaction::minimize_required_signatures(
    set< public_key_type > s = get_required_signatures( chain_id, available_keys, get_active, get_owner,
                                                        allow_non_immediate_owner,
                                                        ignore_custom_operation_required_auths, max_recursion );
-   flat_set< public_key_type > result( s.begin(), s.end() );
+   if( s.empty() )
+      return s;
+
+   flat_set< public_key_type > result;
+   flat_set< public_key_type > candidates( s.begin(), s.end() );
+   required_signature_solver solver( operations, s, get_active, get_owner, get_custom, allow_non_immediate_owner,
+                                     ignore_custom_operation_required_auths, max_recursion );
+   if( solver.minimize( result ) )
+   {
+      // the result of the solver is checked once, in corner cases it can differ from verify_authority
+      try
+      {
+         graphene::protocol::verify_authority( operations, result, get_active, get_owner, get_custom,
+                                               allow_non_immediate_owner, ignore_custom_operation_required_auths,
+                                               max_recursion );
+         candidates = result;
+      }
+      catch( const tx_missing_owner_auth& e ) {}
+      catch( const tx_missing_active_auth& e ) {}
+      catch( const tx_missing_other_auth& e ) {}
+      catch( const tx_irrelevant_sig& e ) {}
+   }
 
-   for( const public_key_type& k : s )
+   // The solver can keep keys which verify_authority does not need, since it does not treat an account approved
+   // somewhere as approved everywhere, e.g. at the recursion limit.  So the remaining keys are removed one at a
+   // time and the rest verified, which is cheap when the solver has already dropped most of them.
+   result = candidates;
+   for( const public_key_type& k : candidates )
    {
       result.erase( k );
       try
@@ -28,6 +28,8 @@
 #include <fc/io/json.hpp>
 #include <fc/exception/exception.hpp>
 
+#include <zlib.h>
+
 static size_t curl_write_function(void *contents, size_t size, size_t nmemb, void *userp)
 {
    ((std::string*)userp)->append((char*)contents, size * nmemb);
@@ -36,17 +38,28 @@ static size_t curl_write_function(void *contents, size_t size, size_t nmemb, voi
 
 namespace graphene { namespace utilities {
 
-static bool handle_bulk_response( uint16_t http_code, const std::string& curl_read_buffer )
+bool handle_bulk_response( uint16_t http_code, const std::string& curl_read_buffer )
 {
    if( curl_wrapper::http_response_code::HTTP_200 == http_code )
    {
       // all good, but check errors in response
       fc::variant j = fc::json::from_string(curl_read_buffer);
       bool errors = j["errors"].as_bool();
-      if( errors )
+      if( !errors )
+         return true;
+      // A version conflict means that a newer version of the document is stored already,
+      // and a document to delete may have been deleted already when a request is retried
+      for( const auto& item : j["items"].get_array() )
       {
-         elog( "ES returned 200 but with errors: ${e}", ("e", curl_read_buffer) );
-         return false;
+         for( const auto& action : item.get_object() )
+         {
+            const auto status = action.value()["status"].as_uint64();
+            if( curl_wrapper::http_response_code::HTTP_409 == status
+                  || ( curl_wrapper::http_response_code::HTTP_404 == status && action.key() == "delete" ) )
+               continue;
+            elog( "ES returned 200 but with errors: ${e}", ("e", curl_read_buffer) );
+            return false;
+         }
       }
       return true;
    }
@@ -77,6 +90,26 @@ std::vector<std::string> createBulk(const fc::mutable_variant_object& bulk_heade
    return bulk;
 }
 
+std::string gzip_compress( const std::string& data )
+{
+   z_stream stream {};
+   // 16 is added to the window bits to write a gzip header and trailer instead of a zlib wrapper
+   FC_ASSERT( Z_OK == deflateInit2( &stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8,
+                                    Z_DEFAULT_STRATEGY ),
+              "Unable to init gzip compression" );
+   std::string result;
+   result.resize( deflateBound( &stream, data.size() ) );
+   stream.next_in = reinterpret_cast<Bytef*>( const_cast<char*>( data.data() ) );
+   stream.avail_in = static_cast<uInt>( data.size() );
+   stream.next_out = reinterpret_cast<Bytef*>( &result[0] );
+   stream.avail_out = static_cast<uInt>( result.size() );
+   const int status = deflate( &stream, Z_FINISH );
+   deflateEnd( &stream );
+   FC_ASSERT( Z_STREAM_END == status, "Unable to compress ${n} bytes with gzip", ("n", data.size()) );
+   result.resize( stream.total_out );
+   return result;
+}
+
 bool curl_wrapper::http_response::is_200() const
 {
    return ( http_response_code::HTTP_200 == code );
@@ -93,10 +126,17 @@ CURL* curl_wrapper::init_curl()
    FC_THROW( "Unable to init cURL" );
 }
 
-curl_slist* curl_wrapper::init_request_headers()
+curl_slist* curl_wrapper::init_request_headers( bool gzip_encoded )
 {
    curl_slist* request_headers = curl_slist_append( NULL, "Content-Type: application/json" );
    FC_ASSERT( request_headers, "Unable to init cURL request headers" );
+   if( gzip_encoded )
+   {
+      curl_slist* gzip_headers = curl_slist_append( request_headers, "Content-Encoding: gzip" );
+      if( !gzip_headers )
+         curl_slist_free_all( request_headers );
+      FC_ASSERT( gzip_headers, "Unable to init cURL request headers" );
+   }
    return request_headers;
 }
 
@@ -106,6 +146,11 @@ curl_wrapper::curl_wrapper()
    curl_easy_setopt( curl.get(), CURLOPT_USERAGENT, "bitshares-core/6.1" );
 }
 
+void curl_wrapper::set_timeout( uint32_t seconds )
+{
+   curl_easy_setopt( curl.get(), CURLOPT_TIMEOUT, static_cast<long>( seconds ) );
+}
+
 void curl_wrapper::curl_deleter::operator()( CURL* p_curl ) const
 {
    if( p_curl )
@@ -121,7 +166,8 @@ void curl_wrapper::curl_slist_deleter::operator()( curl_slist* slist ) const
 curl_wrapper::http_response curl_wrapper::request( curl_wrapper::http_request_method method,
                                                    const std::string& url,
                                                    const std::string& auth,
-                                                   const std::string& query ) const
+                                                   const std::string& query,
+                                                   bool gzip_encoded ) const
 {
    curl_wrapper::http_response resp;
 
@@ -150,12 +196,18 @@ curl_wrapper::http_response curl_wrapper::request( curl_wrapper::http_request_me
    if( curl_wrapper::http_request_method::HTTP_POST == method
        || curl_wrapper::http_request_method::HTTP_PUT == method )
    {
+      curl_easy_setopt( curl.get(), CURLOPT_HTTPHEADER,
+                        gzip_encoded ? gzip_request_headers.get() : request_headers.get() );
       curl_easy_setopt( curl.get(), CURLOPT_HTTPGET, false );
       curl_easy_setopt( curl.get(), CURLOPT_POST, true );
-      curl_easy_setopt( curl.get(), CURLOPT_POSTFIELDS, query.c_str() );
+      // Note: the size is set because a compressed query may contain zero bytes
+      curl_easy_setopt( curl.get(), CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>( query.size() ) );
+      curl_easy_setopt( curl.get(), CURLOPT_POSTFIELDS, query.data() );
    }
    else // GET or DELETE (only these are used in this file)
    {
+      curl_easy_setopt( curl.get(), CURLOPT_HTTPHEADER, request_headers.get() );
+      curl_easy_setopt( curl.get(), CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>( -1 ) );
       curl_easy_setopt( curl.get(), CURLOPT_POSTFIELDS, NULL );
       curl_easy_setopt( curl.get(), CURLOPT_POST, false );
       curl_easy_setopt( curl.get(), CURLOPT_HTTPGET, true );
@@ -183,9 +235,9 @@ curl_wrapper::http_response curl_wrapper::del( const std::string& url, const std
 }
 
 curl_wrapper::http_response curl_wrapper::post( const std::string& url, const std::string& auth,
-                                                const std::string& query ) const
+                                                const std::string& query, bool gzip_encoded ) const
 {
-   return request( http_request_method::HTTP_POST, url, auth, query );
+   return request( http_request_method::HTTP_POST, url, auth, query, gzip_encoded );
 }
 
 curl_wrapper::http_response curl_wrapper::put( const std::string& url, const std::string& auth,
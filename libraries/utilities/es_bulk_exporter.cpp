@@ -0,0 +1,626 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/utilities/es_bulk_exporter.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace graphene { namespace utilities { namespace detail {
+
+/// Stored at the beginning of a batch file, followed by the lines of the batch
+struct batch_header
+{
+   uint64_t seq = 0;
+   uint32_t first_block = 0;
+   uint32_t last_block = 0;
+   uint32_t lines = 0;
+};
+
+struct export_checkpoint
+{
+   uint32_t acknowledged_block = 0;
+   uint32_t stored_block = 0;
+};
+
+} } } // graphene::utilities::detail
+
+FC_REFLECT( graphene::utilities::detail::batch_header, (seq)(first_block)(last_block)(lines) )
+FC_REFLECT( graphene::utilities::detail::export_checkpoint, (acknowledged_block)(stored_block) )
+
+namespace graphene { namespace utilities { namespace detail {
+
+class es_bulk_exporter_impl
+{
+public:
+   explicit es_bulk_exporter_impl( const es_bulk_exporter::options& opts )
+   : _options( opts ), _max_batch_lines( std::max<uint32_t>( opts.max_batch_lines, 1 ) )
+   {
+      FC_ASSERT( _options.workers > 0, "At least one worker is needed to send data to ES" );
+      load_queue_dir();
+      start();
+   }
+
+   struct batch
+   {
+      batch_header header;
+      std::string  body;         ///< the lines, each one followed by a new line, empty when spilled
+      uint64_t     size = 0;     ///< size of the body
+      bool         spilled = false;
+      bool         busy = false; ///< being sent or spilled
+   };
+
+   es_bulk_exporter::options _options;
+   uint32_t _max_batch_lines;
+
+   mutable std::mutex      _mutex;
+   std::condition_variable _work_cv;  ///< wakes the workers and the export thread
+   std::condition_variable _space_cv; ///< wakes add_lines() and the waits for acknowledgements
+
+   std::map<uint64_t, batch> _queue;      ///< sealed batches which are not accepted yet, by sequence
+   std::multiset<uint32_t>   _first_blocks; ///< first blocks of the batches in the queue
+   batch    _open;
+   uint64_t _next_seq = 1;
+   uint32_t _last_ended_block = 0;
+   uint32_t _stored_block = 0;
+   uint32_t _saved_acknowledged_block = 0;
+   bool     _spill_failed = false;
+   bool     _stopping = false;
+   bool     _closed = false;
+   es_bulk_exporter::metrics _metrics;
+
+   std::vector< std::unique_ptr<fc::thread> > _threads;
+   std::vector< fc::future<void> >            _loops;
+
+   fc::path checkpoint_file()const { return _options.queue_dir / "checkpoint.json"; }
+
+   fc::path batch_file( uint64_t seq )const
+   {
+      std::string name = std::to_string( seq );
+      name.insert( 0, 20 - name.size(), '0' ); // sorted by sequence in directory listings
+      return _options.queue_dir / ( name + ".bulk" );
+   }
+
+   void load_queue_dir();
+   void start();
+   void close();
+
+   void seal_open();
+   bool can_spill()const;
+   batch* next_to_send();
+   batch* next_to_spill();
+   uint32_t acknowledged_block()const;
+   void remove_from_queue( uint64_t seq );
+   es_bulk_exporter::metrics get_metrics()const;
+
+   void write_batch( const batch& b )const;
+   std::string read_batch( uint64_t seq )const;
+   void save_checkpoint( uint32_t acknowledged, uint32_t stored )const;
+
+   void worker_loop();
+   void export_loop();
+};
+
+void es_bulk_exporter_impl::load_queue_dir()
+{ try {
+   if( _options.queue_dir == fc::path() )
+      return;
+   fc::create_directories( _options.queue_dir );
+   if( fc::exists( checkpoint_file() ) )
+   {
+      const auto checkpoint = fc::json::from_file( checkpoint_file() ).as<export_checkpoint>( 2 );
+      _saved_acknowledged_block = checkpoint.acknowledged_block;
+      _stored_block = std::max( checkpoint.stored_block, checkpoint.acknowledged_block );
+   }
+   _last_ended_block = _stored_block;
+
+   const uint64_t header_size = fc::raw::pack_size( batch_header() );
+   for( fc::directory_iterator itr( _options.queue_dir ); itr != fc::directory_iterator(); ++itr )
+   {
+      const fc::path file = *itr;
+      if( file.extension().string() != ".bulk" )
+         continue;
+      try
+      {
+         std::vector<char> data( header_size );
+         std::ifstream in( file.generic_string().c_str(), std::ios::in | std::ios::binary );
+         in.read( data.data(), data.size() );
+         FC_ASSERT( in.good() && fc::file_size( file ) >= header_size, "truncated file" );
+         batch b;
+         b.header = fc::raw::unpack<batch_header>( data );
+         FC_ASSERT( batch_file( b.header.seq ) == file, "unexpected file name" );
+         b.size = fc::file_size( file ) - header_size;
+         b.spilled = true;
+         _next_seq = std::max( _next_seq, b.header.seq + 1 );
+         _first_blocks.insert( b.header.first_block );
+         ++_metrics.spilled_batches;
+         _metrics.spilled_bytes += b.size;
+         _queue.emplace( b.header.seq, std::move( b ) );
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "${n}: ignoring unreadable queue file ${f}: ${e}",
+               ("n", _options.name)("f", file.preferred_string())("e", e.to_detail_string()) );
+      }
+   }
+   if( !_queue.empty() )
+      ilog( "${n}: ${b} batches of ${s} bytes left in ${d} will be sent again",
+            ("n", _options.name)("b", _queue.size())("s", _metrics.spilled_bytes)
+            ("d", _options.queue_dir.preferred_string()) );
+} FC_CAPTURE_AND_RETHROW( (_options.queue_dir) ) }
+
+void es_bulk_exporter_impl::start()
+{
+   _threads.push_back( std::make_unique<fc::thread>( _options.name + " export" ) );
+   _loops.push_back( _threads.back()->async( [this]() { export_loop(); } ) );
+   for( uint16_t i = 0; i < _options.workers; ++i )
+   {
+      _threads.push_back( std::make_unique<fc::thread>( _options.name + " bulk " + std::to_string( i ) ) );
+      _loops.push_back( _threads.back()->async( [this]() { worker_loop(); } ) );
+   }
+}
+
+void es_bulk_exporter_impl::seal_open()
+{
+   if( 0 == _open.header.lines )
+      return;
+   _open.header.seq = _next_seq++;
+   _first_blocks.insert( _open.header.first_block );
+   const uint64_t seq = _open.header.seq;
+   _queue.emplace( seq, std::move( _open ) );
+   _open = batch();
+   _work_cv.notify_all();
+}
+
+bool es_bulk_exporter_impl::can_spill()const
+{
+   return _options.queue_dir != fc::path() && !_spill_failed
+          && _metrics.spilled_bytes < _options.max_queue_dir_size;
+}
+
+es_bulk_exporter_impl::batch* es_bulk_exporter_impl::next_to_send()
+{
+   // the oldest batches first, so that the checkpoint moves forward
+   for( auto& item : _queue )
+      if( !item.second.busy )
+         return &item.second;
+   return nullptr;
+}
+
+es_bulk_exporter_impl::batch* es_bulk_exporter_impl::next_to_spill()
+{
+   if( _metrics.memory_bytes <= _options.max_memory_size || !can_spill() )
+      return nullptr;
+   // the newest batches first, they are the last to be sent
+   for( auto itr = _queue.rbegin(); itr != _queue.rend(); ++itr )
+      if( !itr->second.busy && !itr->second.spilled )
+         return &itr->second;
+   return nullptr;
+}
+
+uint32_t es_bulk_exporter_impl::acknowledged_block()const
+{
+   uint32_t result = _last_ended_block;
+   if( !_first_blocks.empty() )
+      result = std::min( result, *_first_blocks.begin() - 1 );
+   if( _open.header.lines > 0 )
+      result = std::min( result, _open.header.first_block - 1 );
+   return result;
+}
+
+es_bulk_exporter::metrics es_bulk_exporter_impl::get_metrics()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   es_bulk_exporter::metrics result = _metrics;
+   result.pending_batches = _queue.size() + ( _open.header.lines > 0 ? 1 : 0 );
+   result.last_acknowledged_block = acknowledged_block();
+   return result;
+}
+
+void es_bulk_exporter_impl::remove_from_queue( uint64_t seq )
+{
+   const auto itr = _queue.find( seq );
+   _first_blocks.erase( _first_blocks.find( itr->second.header.first_block ) );
+   if( itr->second.spilled )
+   {
+      --_metrics.spilled_batches;
+      _metrics.spilled_bytes -= itr->second.size;
+   }
+   else
+      _metrics.memory_bytes -= itr->second.size;
+   _queue.erase( itr );
+}
+
+void es_bulk_exporter_impl::write_batch( const batch& b )const
+{
+   const fc::path file = batch_file( b.header.seq );
+   const fc::path tmp_file = file.generic_string() + ".tmp";
+   {
+      const std::vector<char> header = fc::raw::pack( b.header );
+      std::ofstream out( tmp_file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+      out.write( header.data(), header.size() );
+      out.write( b.body.data(), b.body.size() );
+      out.flush();
+      FC_ASSERT( out.good(), "unable to write ${f}", ("f", tmp_file.preferred_string()) );
+   }
+   fc::rename( tmp_file, file );
+}
+
+std::string es_bulk_exporter_impl::read_batch( uint64_t seq )const
+{
+   const fc::path file = batch_file( seq );
+   const uint64_t header_size = fc::raw::pack_size( batch_header() );
+   std::ifstream in( file.generic_string().c_str(), std::ios::in | std::ios::binary );
+   in.seekg( header_size );
+   std::string body( fc::file_size( file ) - header_size, '\0' );
+   in.read( &body[0], body.size() );
+   FC_ASSERT( in.good(), "unable to read ${f}", ("f", file.preferred_string()) );
+   return body;
+}
+
+void es_bulk_exporter_impl::save_checkpoint( uint32_t acknowledged, uint32_t stored )const
+{
+   export_checkpoint checkpoint;
+   checkpoint.acknowledged_block = acknowledged;
+   checkpoint.stored_block = stored;
+   const fc::path tmp_file = checkpoint_file().generic_string() + ".tmp";
+   fc::json::save_to_file( checkpoint, tmp_file );
+   fc::rename( tmp_file, checkpoint_file() );
+}
+
+void es_bulk_exporter_impl::worker_loop()
+{
+   curl_wrapper curl;
+   curl.set_timeout( _options.request_timeout_seconds );
+   const std::string url = _options.base_url + "_bulk";
+
+   while( true )
+   {
+      batch* b = nullptr;
+      {
+         std::unique_lock<std::mutex> lock( _mutex );
+         _work_cv.wait( lock, [this,&b]() { return _stopping || ( b = next_to_send() ) != nullptr; } );
+         if( _stopping )
+            return;
+         b->busy = true;
+      }
+
+      // the batch is not modified by other threads while it is busy
+      const uint64_t seq = b->header.seq;
+      const bool spilled = b->spilled;
+      std::string body;
+      try
+      {
+         if( spilled )
+            body = read_batch( seq );
+      }
+      catch( const fc::exception& e )
+      {
+         elog( "${n}: dropping batch ${s} of blocks ${f} to ${l} which can not be read: ${e}",
+               ("n", _options.name)("s", seq)("f", b->header.first_block)("l", b->header.last_block)
+               ("e", e.to_detail_string()) );
+         {
+            std::lock_guard<std::mutex> guard( _mutex );
+            remove_from_queue( seq );
+         }
+         fc::remove_all( batch_file( seq ) );
+         _space_cv.notify_all();
+         _work_cv.notify_all();
+         continue;
+      }
+      const std::string& lines = spilled ? body : b->body;
+      const std::string request = _options.compress ? gzip_compress( lines ) : std::string();
+      const std::string& payload = _options.compress ? request : lines;
+
+      uint32_t delay_ms = _options.min_retry_delay_ms;
+      while( true )
+      {
+         const auto response = curl.post( url, _options.auth, payload, _options.compress );
+         if( handle_bulk_response( response.code, response.content ) )
+            break;
+         wlog( "${n}: batch ${s} of blocks ${f} to ${l} was not accepted, retrying in ${d} ms",
+               ("n", _options.name)("s", seq)("f", b->header.first_block)("l", b->header.last_block)
+               ("d", delay_ms) );
+         std::unique_lock<std::mutex> lock( _mutex );
+         ++_metrics.retries;
+         // the batch stays in the queue when the exporter is closed
+         if( _work_cv.wait_for( lock, std::chrono::milliseconds( delay_ms ), [this]() { return _stopping; } ) )
+         {
+            b->busy = false;
+            return;
+         }
+         delay_ms = std::min( delay_ms * 2, _options.max_retry_delay_ms );
+      }
+
+      // the file is removed first, so that it is not sent again once the batch is acknowledged
+      if( spilled )
+         fc::remove_all( batch_file( seq ) );
+      {
+         std::lock_guard<std::mutex> guard( _mutex );
+         ++_metrics.accepted_batches;
+         _metrics.accepted_lines += b->header.lines;
+         _metrics.sent_bytes += payload.size();
+         remove_from_queue( seq );
+      }
+      _space_cv.notify_all();
+      _work_cv.notify_all();
+   }
+}
+
+void es_bulk_exporter_impl::export_loop()
+{
+   const bool has_queue_dir = ( _options.queue_dir != fc::path() );
+   fc::time_point next_log_time = fc::time_point::now() + fc::minutes(1);
+   uint64_t last_logged_batches = 0;
+   while( true )
+   {
+      batch* b = nullptr;
+      uint32_t acknowledged = 0;
+      {
+         std::unique_lock<std::mutex> lock( _mutex );
+         _work_cv.wait_for( lock, std::chrono::seconds(1),
+                            [this,&b]() { return _stopping || ( b = next_to_spill() ) != nullptr; } );
+         if( _stopping )
+            return;
+         if( b != nullptr )
+            b->busy = true;
+         acknowledged = acknowledged_block();
+      }
+
+      if( b != nullptr )
+      {
+         bool written = false;
+         try
+         {
+            write_batch( *b );
+            written = true;
+         }
+         catch( const fc::exception& e )
+         {
+            elog( "${n}: unable to move a batch to ${d}, keeping the batches in memory: ${e}",
+                  ("n", _options.name)("d", _options.queue_dir.preferred_string())("e", e.to_detail_string()) );
+         }
+         {
+            std::lock_guard<std::mutex> guard( _mutex );
+            b->busy = false;
+            if( written )
+            {
+               b->spilled = true;
+               std::string().swap( b->body );
+               _metrics.memory_bytes -= b->size;
+               _metrics.spilled_bytes += b->size;
+               ++_metrics.spilled_batches;
+            }
+            else
+               _spill_failed = true;
+         }
+         _space_cv.notify_all();
+         _work_cv.notify_all();
+      }
+
+      if( has_queue_dir && acknowledged > _saved_acknowledged_block )
+      {
+         try
+         {
+            save_checkpoint( acknowledged, std::max( _stored_block, acknowledged ) );
+            _saved_acknowledged_block = acknowledged;
+         }
+         catch( const fc::exception& e )
+         {
+            elog( "${n}: unable to save the checkpoint: ${e}", ("n", _options.name)("e", e.to_detail_string()) );
+         }
+      }
+
+      if( fc::time_point::now() >= next_log_time )
+      {
+         const es_bulk_exporter::metrics m = get_metrics();
+         if( m.accepted_batches != last_logged_batches || m.pending_batches > 0 )
+            ilog( "${n}: ${a} batches of ${l} lines accepted, ${p} pending of which ${s} in the queue directory, "
+                  "acknowledged up to block ${b}, ${r} retries",
+                  ("n", _options.name)("a", m.accepted_batches)("l", m.accepted_lines)("p", m.pending_batches)
+                  ("s", m.spilled_batches)("b", m.last_acknowledged_block)("r", m.retries) );
+         last_logged_batches = m.accepted_batches;
+         next_log_time = fc::time_point::now() + fc::minutes(1);
+      }
+   }
+}
+
+void es_bulk_exporter_impl::close()
+{
+   if( _closed )
+      return;
+   _closed = true;
+   {
+      std::unique_lock<std::mutex> lock( _mutex );
+      seal_open();
+      _space_cv.wait_for( lock, std::chrono::milliseconds( _options.close_timeout_ms ),
+                          [this]() { return _queue.empty(); } );
+      _stopping = true;
+   }
+   _work_cv.notify_all();
+   _space_cv.notify_all();
+   for( auto& loop : _loops )
+      loop.wait();
+   for( auto& thread : _threads )
+      thread->quit();
+   _loops.clear();
+   _threads.clear();
+
+   // the threads are stopped, nothing else accesses the queue
+   const uint32_t acknowledged = acknowledged_block();
+   if( _options.queue_dir == fc::path() )
+   {
+      if( !_queue.empty() )
+         elog( "${n}: ${b} batches from block ${f} were not accepted by ES and are lost",
+               ("n", _options.name)("b", _queue.size())("f", *_first_blocks.begin()) );
+      return;
+   }
+
+   bool stored_all = true;
+   for( auto& item : _queue )
+   {
+      batch& b = item.second;
+      if( b.spilled )
+         continue;
+      try
+      {
+         write_batch( b );
+         b.spilled = true;
+      }
+      catch( const fc::exception& e )
+      {
+         elog( "${n}: unable to store batch ${s} of blocks ${f} to ${l}: ${e}",
+               ("n", _options.name)("s", b.header.seq)("f", b.header.first_block)("l", b.header.last_block)
+               ("e", e.to_detail_string()) );
+         stored_all = false;
+      }
+   }
+   try
+   {
+      save_checkpoint( acknowledged, stored_all ? _last_ended_block : acknowledged );
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "${n}: unable to save the checkpoint: ${e}", ("n", _options.name)("e", e.to_detail_string()) );
+   }
+   if( !_queue.empty() )
+      ilog( "${n}: ${b} batches are left in ${d} to be sent after a restart, acknowledged up to block ${a}",
+            ("n", _options.name)("b", _queue.size())("d", _options.queue_dir.preferred_string())
+            ("a", acknowledged) );
+}
+
+} // end namespace detail
+
+es_bulk_exporter::es_bulk_exporter( const options& opts )
+: my( std::make_unique<detail::es_bulk_exporter_impl>( opts ) )
+{
+   // Nothing else to do
+}
+
+es_bulk_exporter::~es_bulk_exporter()
+{
+   my->close();
+}
+
+void es_bulk_exporter::add_lines( uint32_t block_num, std::vector<std::string>&& lines )
+{
+   if( lines.empty() )
+      return;
+   std::unique_lock<std::mutex> lock( my->_mutex );
+   FC_ASSERT( !my->_stopping, "The ES exporter is closed" );
+
+   auto& open = my->_open;
+   if( 0 == open.header.lines )
+   {
+      open.header.first_block = block_num;
+      open.header.last_block = block_num;
+   }
+   else
+   {
+      open.header.first_block = std::min( open.header.first_block, block_num );
+      open.header.last_block = std::max( open.header.last_block, block_num );
+   }
+   for( const std::string& line : lines )
+   {
+      open.body.append( line ).push_back( '\n' );
+      open.size += line.size() + 1;
+      my->_metrics.memory_bytes += line.size() + 1;
+   }
+   open.header.lines += lines.size();
+   lines.clear();
+   // a bulk action may span two lines, so the batch is only sealed between two calls
+   if( open.header.lines >= my->_max_batch_lines || open.size >= my->_options.max_batch_size )
+      my->seal_open();
+
+   if( my->_metrics.memory_bytes <= my->_options.max_memory_size )
+      return;
+   if( my->can_spill() )
+   {
+      my->_work_cv.notify_all();
+      return;
+   }
+   const fc::time_point start = fc::time_point::now();
+   my->_space_cv.wait( lock, [this]() {
+      return my->_stopping || my->_metrics.memory_bytes <= my->_options.max_memory_size || my->can_spill();
+   });
+   my->_metrics.blocked_microseconds += ( fc::time_point::now() - start ).count();
+}
+
+void es_bulk_exporter::end_block( uint32_t block_num )
+{
+   std::lock_guard<std::mutex> guard( my->_mutex );
+   my->_last_ended_block = block_num;
+}
+
+void es_bulk_exporter::seal()
+{
+   std::lock_guard<std::mutex> guard( my->_mutex );
+   my->seal_open();
+}
+
+void es_bulk_exporter::set_max_batch_lines( uint32_t max_lines )
+{
+   std::lock_guard<std::mutex> guard( my->_mutex );
+   my->_max_batch_lines = std::max<uint32_t>( max_lines, 1 );
+}
+
+bool es_bulk_exporter::wait_until_acknowledged( const fc::microseconds& timeout )
+{
+   std::unique_lock<std::mutex> lock( my->_mutex );
+   my->seal_open();
+   return my->_space_cv.wait_for( lock, std::chrono::microseconds( timeout.count() ),
+                                  [this]() { return my->_queue.empty(); } );
+}
+
+void es_bulk_exporter::close()
+{
+   my->close();
+}
+
+uint32_t es_bulk_exporter::last_acknowledged_block() const
+{
+   std::lock_guard<std::mutex> guard( my->_mutex );
+   return my->acknowledged_block();
+}
+
+uint32_t es_bulk_exporter::last_stored_block() const
+{
+   return my->_stored_block;
+}
+
+es_bulk_exporter::metrics es_bulk_exporter::get_metrics() const
+{
+   return my->get_metrics();
+}
+
+} } // end namespace graphene::utilities
@@ -53,6 +53,8 @@ public:
    {
       static constexpr uint16_t HTTP_200 = 200;
       static constexpr uint16_t HTTP_401 = 401;
+      static constexpr uint16_t HTTP_404 = 404;
+      static constexpr uint16_t HTTP_409 = 409;
       static constexpr uint16_t HTTP_413 = 413;
    };
 
@@ -63,20 +65,26 @@ public:
       bool is_200() const; ///< @return if @ref code is 200
    };
 
+   /// @param gzip_encoded whether @p query is compressed with gzip, only used by POST and PUT
    http_response request( http_request_method method,
                           const std::string& url,
                           const std::string& auth,
-                          const std::string& query ) const;
+                          const std::string& query,
+                          bool gzip_encoded = false ) const;
 
    http_response get( const std::string& url, const std::string& auth ) const;
    http_response del( const std::string& url, const std::string& auth ) const;
-   http_response post( const std::string& url, const std::string& auth, const std::string& query ) const;
+   http_response post( const std::string& url, const std::string& auth, const std::string& query,
+                       bool gzip_encoded = false ) const;
    http_response put( const std::string& url, const std::string& auth, const std::string& query ) const;
 
+   /// Limit the time of a whole request, 0 means no limit
+   void set_timeout( uint32_t seconds );
+
 private:
 
    static CURL* init_curl();
-   static curl_slist* init_request_headers();
+   static curl_slist* init_request_headers( bool gzip_encoded );
 
    struct curl_deleter
    {
@@ -89,7 +97,8 @@ private:
    };
 
    std::unique_ptr<CURL, curl_deleter> curl { init_curl() };
-   std::unique_ptr<curl_slist, curl_slist_deleter> request_headers { init_request_headers() };
+   std::unique_ptr<curl_slist, curl_slist_deleter> request_headers { init_request_headers( false ) };
+   std::unique_ptr<curl_slist, curl_slist_deleter> gzip_request_headers { init_request_headers( true ) };
 };
 
 class es_client
@@ -116,6 +125,15 @@ private:
 
 std::vector<std::string> createBulk(const fc::mutable_variant_object& bulk_header, std::string&& data);
 
+/**
+ * @return whether ES accepted all the actions of a bulk request.
+ * Version conflicts are accepted, they mean that a newer version of the document is already stored.
+ */
+bool handle_bulk_response( uint16_t http_code, const std::string& curl_read_buffer );
+
+/// Compress @p data in the gzip format, to be sent with a "Content-Encoding: gzip" header
+std::string gzip_compress( const std::string& data );
+
 struct es_data_adaptor
 {
    enum class data_type
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/utilities/elasticsearch.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/time.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace utilities {
+
+namespace detail
+{
+   class es_bulk_exporter_impl;
+}
+
+/**
+ * Sends bulk lines to Elasticsearch in the background.
+ *
+ * The thread which applies blocks adds the lines of each block, they are grouped into batches which are sent
+ * by a pool of worker threads, optionally compressed with gzip.  A batch which is not accepted is retried
+ * until it is, thus the documents need IDs which do not change when they are sent again.  Batches may be
+ * sent out of order, documents which can be updated need external versions.
+ *
+ * When the batches waiting in memory exceed a limit, an export thread moves them to files in the queue
+ * directory.  When the queue directory is full too, @ref add_lines blocks until some batches are accepted.
+ *
+ * The number of the last block whose lines are all accepted is saved in the queue directory, and the batches
+ * which are not accepted when the exporter is closed are left there to be sent after a restart.
+ */
+class es_bulk_exporter
+{
+public:
+   struct options
+   {
+      std::string base_url;
+      std::string auth;
+      /// Name of the exporter in logs
+      std::string name = "ES";
+      /// Number of threads sending requests concurrently
+      uint16_t workers = 2;
+      bool compress = true;
+      /// A batch is sent when it has this number of lines, or when @ref seal is called
+      uint32_t max_batch_lines = 10000;
+      /// A batch is sent when its size reaches this value
+      uint64_t max_batch_size = es_client::request_size_threshold;
+      /// Batches are moved to the queue directory when the batches in memory exceed this size
+      uint64_t max_memory_size = 256 * 1024 * 1024;
+      /// Where batches are spilled and the checkpoint is saved, empty to keep everything in memory
+      fc::path queue_dir;
+      uint64_t max_queue_dir_size = uint64_t(4096) * 1024 * 1024;
+      uint32_t min_retry_delay_ms = 100;
+      uint32_t max_retry_delay_ms = 30000;
+      uint32_t request_timeout_seconds = 120;
+      /// How long @ref close waits for the batches in memory to be accepted before moving them to disk
+      uint32_t close_timeout_ms = 5000;
+   };
+
+   struct metrics
+   {
+      uint64_t pending_batches = 0;      ///< batches which are not accepted yet, including spilled ones
+      uint64_t memory_bytes = 0;         ///< size of the lines held in memory
+      uint64_t spilled_batches = 0;      ///< batches currently in the queue directory
+      uint64_t spilled_bytes = 0;
+      uint64_t accepted_batches = 0;
+      uint64_t accepted_lines = 0;
+      uint64_t sent_bytes = 0;           ///< size of the accepted request bodies, after compression
+      uint64_t retries = 0;
+      uint64_t blocked_microseconds = 0; ///< time spent by @ref add_lines waiting for space
+      uint32_t last_acknowledged_block = 0;
+   };
+
+   explicit es_bulk_exporter( const options& opts );
+   ~es_bulk_exporter();
+
+   /// Queue @p lines of block @p block_num, blocks while both the memory and the queue directory are full
+   void add_lines( uint32_t block_num, std::vector<std::string>&& lines );
+   /// All the lines of block @p block_num have been added
+   void end_block( uint32_t block_num );
+   /// Send the lines added so far without waiting for the batch to be full
+   void seal();
+   void set_max_batch_lines( uint32_t max_lines );
+
+   /// Wait until all the lines added so far are accepted, @return false on timeout
+   bool wait_until_acknowledged( const fc::microseconds& timeout );
+   /// Stop the threads, the batches which are not accepted are moved to the queue directory
+   void close();
+
+   /// @return the last block whose lines are all accepted by ES, saved in the queue directory
+   uint32_t last_acknowledged_block() const;
+   /// @return the last block whose lines were accepted or left in the queue directory when last closed
+   uint32_t last_stored_block() const;
+   metrics get_metrics() const;
+
+private:
+   std::unique_ptr<detail::es_bulk_exporter_impl> my;
+};
+
+} } // end namespace graphene::utilities
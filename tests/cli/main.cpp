@@ -43,7 +43,9 @@
 #include <fc/crypto/hex.hpp>
 
 #include <fc/crypto/aes.hpp>
+#include <fc/io/json.hpp>
 
+#include <mutex>
 #include <thread>
 
 #include <boost/filesystem/path.hpp>
@@ -2311,3 +2313,67 @@ BOOST_AUTO_TEST_CASE( cli_create_htlc_bsip64 )
       throw;
    }
 }
+
+///////////////////
+// Send a JSON-RPC batch over a websocket connection, the response to each call is sent on its own
+///////////////////
+BOOST_FIXTURE_TEST_CASE( cli_batch_calls, cli_fixture )
+{
+   try
+   {
+      fc::http::websocket_client batch_client;
+      auto batch_connection = batch_client.connect( "ws://127.0.0.1:" + std::to_string( server_port_number ) );
+
+      std::mutex responses_mutex;
+      fc::variants responses;
+      batch_connection->on_message_handler( [&responses_mutex,&responses]( const std::string& message ) {
+         std::lock_guard<std::mutex> guard( responses_mutex );
+         responses.push_back( fc::json::from_string( message ) );
+      } );
+      auto wait_for_responses = [&responses_mutex,&responses]( size_t count ) {
+         for( int i = 0; i < 500; ++i )
+         {
+            {
+               std::lock_guard<std::mutex> guard( responses_mutex );
+               if( responses.size() >= count )
+                  return;
+            }
+            fc::usleep( fc::milliseconds( 10 ) );
+         }
+      };
+
+      batch_connection->send_message( R"([
+         {"jsonrpc":"2.0","id":1,"method":"call","params":[0,"get_objects",[["1.2.0"]]]},
+         {"jsonrpc":"2.0","id":2,"method":"call","params":[0,"get_full_accounts",[["nathan","init0"],false]]},
+         {"jsonrpc":"2.0","method":"call","params":[0,"get_chain_id",[]]},
+         {"jsonrpc":"2.0","id":3,"method":"call","params":[0,"no_such_method",[]]},
+         {"jsonrpc":"2.0","id":4,"method":"call","params":[0,"get_account_by_name",["nathan"]]}
+      ])" );
+      wait_for_responses( 4 );
+      {
+         std::lock_guard<std::mutex> guard( responses_mutex );
+         BOOST_REQUIRE_EQUAL( responses.size(), 4u );
+         BOOST_CHECK_EQUAL( responses[0]["id"].as_int64(), 1 );
+         BOOST_CHECK_EQUAL( responses[0]["result"].get_array()[0]["id"].as_string(), "1.2.0" );
+         BOOST_CHECK_EQUAL( responses[1]["id"].as_int64(), 2 );
+         BOOST_CHECK_EQUAL( responses[1]["result"].get_array().size(), 2u );
+         BOOST_CHECK_EQUAL( responses[2]["id"].as_int64(), 3 );
+         BOOST_CHECK( responses[2].get_object().contains( "error" ) );
+         BOOST_CHECK_EQUAL( responses[3]["id"].as_int64(), 4 );
+         BOOST_CHECK_EQUAL( responses[3]["result"]["name"].as_string(), "nathan" );
+         responses.clear();
+      }
+
+      // an empty batch is an invalid request, which gets a single error response
+      batch_connection->send_message( "[]" );
+      wait_for_responses( 1 );
+      {
+         std::lock_guard<std::mutex> guard( responses_mutex );
+         BOOST_REQUIRE_EQUAL( responses.size(), 1u );
+         BOOST_CHECK_EQUAL( responses[0]["error"]["code"].as_int64(), -32600 );
+      }
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
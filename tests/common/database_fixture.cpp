@@ -219,6 +219,12 @@ std::shared_ptr<boost::program_options::variables_map> database_fixture_base::in
       fc::set_option( options, "max-ops-per-account", (uint64_t)75 );
       fc::set_option( options, "min-blocks-to-keep", (uint32_t)0 );
    }
+   if (fixture.current_test_name == "history_by_operation_type_test")
+   {
+      fc::set_option( options, "max-ops-per-account", (uint64_t)75 );
+      fc::set_option( options, "min-blocks-to-keep", (uint32_t)0 );
+      fc::set_option( options, "history-by-operation-type", true );
+   }
    if (fixture.current_test_name == "api_limit_get_account_history_operations")
    {
       fc::set_option( options, "max-ops-per-account", (uint64_t)125 );
@@ -29,6 +29,7 @@
 
 #include <graphene/utilities/elasticsearch.hpp>
 #include <graphene/elasticsearch/elasticsearch_plugin.hpp>
+#include <graphene/es_objects/es_objects.hpp>
 
 #include "../common/init_unit_test_suite.hpp"
 #include "../common/database_fixture.hpp"
@@ -234,6 +235,10 @@ BOOST_AUTO_TEST_CASE(elasticsearch_objects) {
       generate_block();
       set_expiration( db, trx );
 
+      // the data is sent in the background, wait for it before deleting it
+      auto es_objects = app.get_plugin<graphene::es_objects::es_objects_plugin>( "es_objects" );
+      fc::wait_for( ES_WAIT_TIME, [&]() { return es_objects->get_export_metrics().pending_batches == 0; } );
+
       // delete all first, this will delete genesis data and data inserted at block 1
       auto delete_objects = graphene::utilities::deleteAll(es);
       BOOST_REQUIRE(delete_objects); // require successful deletion
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/binary_rpc.hpp>
+#include <graphene/app/database_api.hpp>
+
+#include <fc/network/http/websocket.hpp>
+#include <fc/rpc/websocket_api.hpp>
+#include <fc/time.hpp>
+
+#include "../common/database_fixture.hpp"
+#include "../common/utils.hpp"
+
+using namespace graphene::chain;
+
+BOOST_AUTO_TEST_SUITE( binary_rpc_benchmarks )
+
+/**
+ * Compares the throughput of get_block and get_full_accounts over a websocket JSON-RPC connection and over a
+ * binary RPC connection. Servers and clients run on the same thread, so the times include both sides.
+ */
+BOOST_FIXTURE_TEST_CASE( binary_rpc_benchmark, database_fixture )
+{ try {
+   const uint32_t num_accounts = 200;
+   const uint32_t transfers_per_block = 50;
+   const uint32_t blocks = 200;
+   const uint32_t account_calls = 2000;
+   const uint32_t accounts_per_call = 5;
+
+   std::vector<account_id_type> accounts;
+   for( uint32_t i = 0; i < num_accounts; ++i )
+   {
+      const account_id_type id = create_account( "bench" + std::to_string( i ) ).get_id();
+      transfer( account_id_type(), id, asset( 10000000 ) );
+      accounts.push_back( id );
+   }
+   generate_block();
+   const uint32_t first_block = db.head_block_num() + 1;
+   for( uint32_t b = 0; b < blocks; ++b )
+   {
+      for( uint32_t t = 0; t < transfers_per_block; ++t )
+         transfer( accounts[( b + t ) % num_accounts], accounts[( b + t + 1 ) % num_accounts], asset( 1 ) );
+      generate_block();
+   }
+   std::vector< std::vector<std::string> > account_names;
+   for( uint32_t c = 0; c < account_calls; ++c )
+   {
+      account_names.emplace_back();
+      for( uint32_t a = 0; a < accounts_per_call; ++a )
+         account_names.back().push_back( "bench" + std::to_string( ( c * accounts_per_call + a ) % num_accounts ) );
+   }
+
+   auto report = [blocks,account_calls]( const std::string& protocol, int64_t block_us, int64_t account_us ) {
+      wlog( "${p}: ${b} get_block calls per second, ${a} get_full_accounts calls per second",
+            ("p", protocol)("b", uint64_t( blocks ) * 1000000 / std::max<int64_t>( block_us, 1 ))
+            ("a", uint64_t( account_calls ) * 1000000 / std::max<int64_t>( account_us, 1 )) );
+   };
+
+   // JSON over websocket
+   {
+      auto db_api = std::make_shared<graphene::app::database_api>( db, &app.get_options() );
+      fc::http::websocket_server ws_server( "" );
+      ws_server.on_connection( [db_api]( const fc::http::websocket_connection_ptr& c ) {
+         auto wsc = std::make_shared<fc::rpc::websocket_api_connection>( c, GRAPHENE_MAX_NESTED_OBJECTS );
+         wsc->register_api( fc::api<graphene::app::database_api>( db_api ) );
+         c->set_session_data( wsc );
+      } );
+      const int port = fc::network::get_available_port();
+      ws_server.listen( port );
+      ws_server.start_accept();
+
+      fc::http::websocket_client ws_client;
+      auto connection = ws_client.connect( "ws://127.0.0.1:" + std::to_string( port ) );
+      auto api_connection = std::make_shared<fc::rpc::websocket_api_connection>( connection,
+                                                                                 GRAPHENE_MAX_NESTED_OBJECTS );
+      auto remote_api = api_connection->get_remote_api<graphene::app::database_api>( 0 );
+
+      auto start = fc::time_point::now();
+      for( uint32_t b = 0; b < blocks; ++b )
+         BOOST_REQUIRE( remote_api->get_block( first_block + b ).valid() );
+      const int64_t block_us = ( fc::time_point::now() - start ).count();
+
+      start = fc::time_point::now();
+      for( const auto& names : account_names )
+         BOOST_REQUIRE_EQUAL( remote_api->get_full_accounts( names, false ).size(), accounts_per_call );
+      const int64_t account_us = ( fc::time_point::now() - start ).count();
+      report( "JSON", block_us, account_us );
+   }
+
+   // binary
+   {
+      graphene::app::binary_rpc_server server( app );
+      server.listen( fc::ip::endpoint::from_string( "127.0.0.1:0" ) );
+      graphene::app::binary_rpc_client client( server.get_listening_endpoint() );
+
+      auto start = fc::time_point::now();
+      for( uint32_t b = 0; b < blocks; ++b )
+         BOOST_REQUIRE( client.call< optional<signed_block> >( "get_block", first_block + b ).valid() );
+      const int64_t block_us = ( fc::time_point::now() - start ).count();
+
+      start = fc::time_point::now();
+      for( const auto& names : account_names )
+      {
+         const auto result = client.call< std::map<std::string, graphene::app::full_account, std::less<>> >(
+               "get_full_accounts", names );
+         BOOST_REQUIRE_EQUAL( result.size(), accounts_per_call );
+      }
+      const int64_t account_us = ( fc::time_point::now() - start ).count();
+      report( "binary", block_us, account_us );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
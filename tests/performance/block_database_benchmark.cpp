@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/block_database.hpp>
+#include <graphene/protocol/transfer.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/time.hpp>
+
+#include <boost/endian/buffers.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <random>
+#include <thread>
+
+using namespace graphene::chain;
+
+namespace {
+
+/**
+ * Reads the block log the way the original fstream based block_database did, i.e. with a seekg/read pair
+ * on the index and on the blocks file per lookup. Only used as a baseline for the mmap based reader.
+ */
+class fstream_block_reader
+{
+   struct entry
+   {
+      boost::endian::little_uint64_buf_t block_pos;
+      boost::endian::little_uint32_buf_t block_size;
+      block_id_type                      block_id;
+   };
+
+   mutable std::fstream _index;
+   mutable std::fstream _blocks;
+
+public:
+   explicit fstream_block_reader( const fc::path& dir )
+   {
+      _index.open( (dir / "index").generic_string().c_str(), std::fstream::binary | std::fstream::in );
+      _blocks.open( (dir / "blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in );
+   }
+
+   optional<signed_block> fetch_by_number( uint32_t block_num )const
+   {
+      entry e;
+      int64_t index_pos = sizeof(e) * int64_t(block_num);
+      _index.seekg( 0, _index.end );
+      if ( _index.tellg() <= index_pos )
+         return {};
+      _index.seekg( index_pos, _index.beg );
+      _index.read( (char*)&e, sizeof(e) );
+
+      std::vector<char> data( e.block_size.value() );
+      _blocks.seekg( e.block_pos.value() );
+      _blocks.read( data.data(), e.block_size.value() );
+      auto result = fc::raw::unpack<signed_block>( data );
+      FC_ASSERT( result.id() == e.block_id );
+      return result;
+   }
+};
+
+signed_block make_block( const block_id_type& previous, uint32_t num_transfers )
+{
+   signed_block b;
+   b.previous = previous;
+   b.timestamp = fc::time_point_sec( 1600000000 + 3 * block_header::num_from_id( previous ) );
+   b.witness = witness_id_type( block_header::num_from_id( previous ) % 21 + 1 );
+   for( uint32_t i = 0; i < num_transfers; ++i )
+   {
+      processed_transaction trx;
+      transfer_operation op;
+      op.from = account_id_type( 100 + i );
+      op.to = account_id_type( 200 + block_header::num_from_id( previous ) );
+      op.amount = asset( 1000 + i );
+      op.fee = asset( 20 );
+      trx.operations.push_back( op );
+      trx.ref_block_num = block_header::num_from_id( previous ) & 0xffff;
+      trx.expiration = b.timestamp + 60;
+      trx.signatures.emplace_back();
+      trx.operation_results.emplace_back();
+      b.transactions.push_back( trx );
+   }
+   b.transaction_merkle_root = b.calculate_merkle_root();
+   return b;
+}
+
+template< typename Reader >
+void run_fetch_benchmark( const std::string& name, const Reader& reader, const std::vector<uint32_t>& order )
+{
+   const auto start = fc::time_point::now();
+   uint64_t total_tx = 0;
+   for( const uint32_t num : order )
+   {
+      auto blk = reader.fetch_by_number( num );
+      FC_ASSERT( blk.valid() );
+      total_tx += blk->transactions.size();
+   }
+   const auto elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+   wlog( "${name}: ${bps} blocks/s (${n} blocks, ${tx} transactions in ${ms}ms)",
+         ("name",name)("bps",(order.size()*1000000)/elapsed)("n",order.size())("tx",total_tx)
+         ("ms",elapsed/1000) );
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE( block_database_benchmarks )
+
+/**
+ * Compares sequential and random fetch throughput of the mmap based block_database against the
+ * fstream based access pattern it replaced, and measures concurrent reads from several threads.
+ */
+BOOST_AUTO_TEST_CASE( block_fetch_benchmark )
+{ try {
+   const uint32_t num_blocks = 100000;
+   const uint32_t transfers_per_block = 5;
+   const uint32_t num_threads = 4;
+
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+   block_database bdb;
+   bdb.open( data_dir.path() );
+   {
+      const auto start = fc::time_point::now();
+      block_id_type previous;
+      for( uint32_t i = 0; i < num_blocks; ++i )
+      {
+         signed_block b = make_block( previous, transfers_per_block );
+         previous = b.id();
+         bdb.store( previous, b );
+      }
+      const auto elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+      wlog( "Stored ${n} blocks (${size} bytes) at ${bps} blocks/s",
+            ("n",num_blocks)("size",bdb.total_block_size())("bps",(uint64_t(num_blocks)*1000000)/elapsed) );
+   }
+
+   std::vector<uint32_t> sequential( num_blocks );
+   for( uint32_t i = 0; i < num_blocks; ++i )
+      sequential[i] = i + 1;
+   std::vector<uint32_t> random_order( sequential );
+   std::shuffle( random_order.begin(), random_order.end(), std::mt19937( 42 ) );
+
+   fstream_block_reader legacy( data_dir.path() );
+   run_fetch_benchmark( "fstream sequential", legacy, sequential );
+   run_fetch_benchmark( "mmap sequential", bdb, sequential );
+   run_fetch_benchmark( "fstream random", legacy, random_order );
+   run_fetch_benchmark( "mmap random", bdb, random_order );
+
+   {
+      const auto start = fc::time_point::now();
+      for( const uint32_t num : random_order )
+         FC_ASSERT( bdb.fetch_block_id( num ) != block_id_type() );
+      const auto elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+      wlog( "mmap fetch_block_id: ${ops} lookups/s", ("ops",(uint64_t(num_blocks)*1000000)/elapsed) );
+   }
+
+   {
+      const auto start = fc::time_point::now();
+      std::atomic<uint32_t> missing( 0 );
+      std::vector<std::thread> threads;
+      for( uint32_t t = 0; t < num_threads; ++t )
+         threads.emplace_back( [&bdb,&random_order,&missing,t,num_threads]() {
+            for( size_t i = t; i < random_order.size(); i += num_threads )
+               if( !bdb.fetch_by_number( random_order[i] ).valid() )
+                  ++missing;
+         });
+      for( auto& thread : threads )
+         thread.join();
+      BOOST_CHECK_EQUAL( missing.load(), 0u );
+      const auto elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+      wlog( "mmap random with ${t} threads: ${bps} blocks/s",
+            ("t",num_threads)("bps",(uint64_t(num_blocks)*1000000)/elapsed) );
+   }
+
+   bdb.close();
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Compares disk usage and sequential (reindex style) read throughput of the compressed block log
+ * against the uncompressed one. For cold cache numbers the page cache has to be dropped before the
+ * read phase, see README.md.
+ */
+BOOST_AUTO_TEST_CASE( compressed_block_log_benchmark )
+{ try {
+   const uint32_t num_blocks = 100000;
+   const uint32_t transfers_per_block = 5;
+
+   fc::temp_directory plain_dir( graphene::utilities::temp_directory_path() );
+   fc::temp_directory compressed_dir( graphene::utilities::temp_directory_path() );
+
+   for( const uint32_t blocks_per_segment : { 0u, 1000u } )
+   {
+      const fc::path& dir = ( blocks_per_segment > 0 ? compressed_dir.path() : plain_dir.path() );
+      const std::string name = ( blocks_per_segment > 0 ? "compressed" : "plain" );
+
+      block_database bdb;
+      bdb.enable_compression( blocks_per_segment );
+      bdb.open( dir );
+      const auto start = fc::time_point::now();
+      block_id_type previous;
+      for( uint32_t i = 0; i < num_blocks; ++i )
+      {
+         signed_block b = make_block( previous, transfers_per_block );
+         previous = b.id();
+         bdb.store( previous, b );
+      }
+      const auto elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+      bdb.close();
+
+      const uint64_t disk_size = fc::file_size( dir / "blocks" ) + fc::file_size( dir / "index" );
+      wlog( "${name}: stored ${n} blocks at ${bps} blocks/s, ${size} bytes on disk",
+            ("name",name)("n",num_blocks)("bps",(uint64_t(num_blocks)*1000000)/elapsed)("size",disk_size) );
+
+      bdb.open( dir );
+      std::vector<uint32_t> sequential( num_blocks );
+      for( uint32_t i = 0; i < num_blocks; ++i )
+         sequential[i] = i + 1;
+      run_fetch_benchmark( name + " sequential", bdb, sequential );
+      bdb.close();
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/hardfork.hpp>
+#include <graphene/protocol/restriction_predicate.hpp>
+
+#include <fc/time.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+namespace {
+
+template<typename Object>
+unsigned_int member_index( const string& name )
+{
+   unsigned_int index;
+   fc::typelist::runtime::for_each( typename fc::reflector<Object>::native_members(), [&name, &index]( auto t ) {
+      if( name == decltype(t)::type::get_name() )
+         index = decltype(t)::type::index;
+   });
+   return index;
+}
+
+struct restricted_operation
+{
+   string              name;
+   operation           op;
+   vector<restriction> restrictions;
+};
+
+/// One restricted operation of each slice of custom_authorities/list_*.cpp, the operation satisfies its restrictions
+vector<restricted_operation> get_restricted_operations()
+{
+   vector<restricted_operation> result;
+   const auto amount_le = []( int64_t max ) {
+      return vector<restriction>{ restriction( member_index<asset>( "amount" ), restriction::func_le, max ) };
+   };
+
+   transfer_operation xfer;
+   xfer.to = account_id_type( 12 );
+   xfer.amount = asset( 100 );
+   result.push_back( { "transfer (list_1)", xfer, {
+         restriction( member_index<transfer_operation>( "to" ), restriction::func_in,
+                      flat_set<account_id_type>{ account_id_type( 12 ), account_id_type( 15 ) } ),
+         restriction( member_index<transfer_operation>( "amount" ), restriction::func_attr, amount_le( 1000 ) ) } } );
+
+   limit_order_create_operation loc;
+   loc.amount_to_sell = asset( 100 );
+   loc.min_to_receive = asset( 100, asset_id_type( 1 ) );
+   result.push_back( { "limit_order_create (list_1)", loc, {
+         restriction( member_index<limit_order_create_operation>( "amount_to_sell" ), restriction::func_attr,
+                      vector<restriction>{ restriction( member_index<asset>( "asset_id" ), restriction::func_eq,
+                                                        asset_id_type( 0 ) ) } ),
+         restriction( member_index<limit_order_create_operation>( "min_to_receive" ), restriction::func_attr,
+                      vector<restriction>{ restriction( member_index<asset>( "asset_id" ), restriction::func_in,
+                                                        flat_set<asset_id_type>{ asset_id_type( 1 ),
+                                                                                 asset_id_type( 2 ) } ) } ),
+         restriction( member_index<limit_order_create_operation>( "fill_or_kill" ), restriction::func_eq,
+                      false ) } } );
+
+   account_update_operation auo;
+   auo.new_options = account_options();
+   auo.new_options->voting_account = account_id_type( 5 );
+   result.push_back( { "account_update (list_2)", auo, {
+         restriction( member_index<account_update_operation>( "owner" ), restriction::func_eq, void_t() ),
+         restriction( member_index<account_update_operation>( "new_options" ), restriction::func_attr,
+                      vector<restriction>{ restriction( member_index<account_options>( "voting_account" ),
+                                                        restriction::func_eq, account_id_type( 5 ) ) } ) } } );
+
+   asset_issue_operation aio;
+   aio.asset_to_issue = asset( 100, asset_id_type( 1 ) );
+   aio.issue_to_account = account_id_type( 12 );
+   result.push_back( { "asset_issue (list_5)", aio, {
+         restriction( member_index<asset_issue_operation>( "issue_to_account" ), restriction::func_not_in,
+                      flat_set<account_id_type>{ account_id_type( 13 ), account_id_type( 14 ) } ),
+         restriction( member_index<asset_issue_operation>( "asset_to_issue" ), restriction::func_attr,
+                      amount_le( 1000 ) ) } } );
+
+   vesting_balance_withdraw_operation vbw;
+   vbw.owner = account_id_type( 12 );
+   vbw.amount = asset( 100 );
+   result.push_back( { "vesting_balance_withdraw (list_9)", vbw, {
+         restriction( member_index<vesting_balance_withdraw_operation>( "owner" ), restriction::func_eq,
+                      account_id_type( 12 ) ) } } );
+
+   htlc_create_operation hco;
+   hco.to = account_id_type( 15 );
+   hco.amount = asset( 100 );
+   hco.claim_period_seconds = 3600;
+   result.push_back( { "htlc_create (list_11)", hco, {
+         restriction( unsigned_int( 999 ), restriction::func_logical_or,
+                      vector<vector<restriction>>{
+                         { restriction( member_index<htlc_create_operation>( "to" ), restriction::func_eq,
+                                        account_id_type( 12 ) ) },
+                         { restriction( member_index<htlc_create_operation>( "to" ), restriction::func_eq,
+                                        account_id_type( 15 ) ) } } ),
+         restriction( member_index<htlc_create_operation>( "claim_period_seconds" ), restriction::func_le,
+                      int64_t( 86400 ) ) } } );
+
+   return result;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE( custom_authority_benchmarks )
+
+/**
+ * Evaluates the restrictions of one operation of each slice of custom_authorities/list_*.cpp with the predicate
+ * rebuilt for every call, with the predicate copied out of the cache for every call like get_predicate() used to,
+ * and with the cached predicate called in place.
+ */
+BOOST_AUTO_TEST_CASE( restriction_predicate_benchmark )
+{ try {
+   const uint32_t rounds = 200000;
+
+   for( const restricted_operation& ro : get_restricted_operations() )
+   {
+      const auto op_type = static_cast<operation::tag_type>( ro.op.which() );
+      uint32_t passed = 0;
+
+      auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < rounds / 10; ++i )
+         passed += get_restriction_predicate( ro.restrictions, op_type )( ro.op ).success;
+      const int64_t rebuilt = ( fc::time_point::now() - start ).count() * 10 * 1000 / rounds;
+
+      const restriction_predicate_function cached = get_restriction_predicate( ro.restrictions, op_type );
+      start = fc::time_point::now();
+      for( uint32_t i = 0; i < rounds; ++i )
+      {
+         const restriction_predicate_function copy = cached;
+         passed += copy( ro.op ).success;
+      }
+      const int64_t copied = ( fc::time_point::now() - start ).count() * 1000 / rounds;
+
+      start = fc::time_point::now();
+      for( uint32_t i = 0; i < rounds; ++i )
+         passed += cached( ro.op ).success;
+      const int64_t in_place = ( fc::time_point::now() - start ).count() * 1000 / rounds;
+
+      BOOST_CHECK_EQUAL( passed, rounds / 10 + rounds * 2 );
+      wlog( "${n}: ${r} ns rebuilt, ${c} ns copied, ${p} ns cached per evaluation",
+            ("n", ro.name)("r", rebuilt)("c", copied)("p", in_place) );
+   }
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Times get_viable_custom_authorities() for a bot account which holds custom authorities for one operation of
+ * each slice, plus a number of disabled ones, as done for every operation signed under a custom authority.
+ */
+BOOST_FIXTURE_TEST_CASE( viable_custom_authorities_benchmark, database_fixture )
+{ try {
+   const uint32_t auths_per_type = 5;
+   const uint32_t rounds = 20000;
+
+   generate_blocks( HARDFORK_BSIP_40_TIME );
+   generate_blocks( 5 );
+   db.modify( global_property_id_type()(db), []( global_property_object& gpo ) {
+      gpo.parameters.extensions.value.custom_authority_options = custom_authority_options_type();
+      gpo.parameters.extensions.value.custom_authority_options->max_custom_authorities_per_account = 1000;
+      gpo.parameters.extensions.value.custom_authority_options->max_custom_authorities_per_account_op = 100;
+   });
+   set_expiration( db, trx );
+
+   ACTORS( (bot)(teller) );
+
+   const vector<restricted_operation> ops = get_restricted_operations();
+   for( const restricted_operation& ro : ops )
+   {
+      for( uint32_t i = 0; i < auths_per_type * 2; ++i )
+      {
+         custom_authority_create_operation cop;
+         cop.account = bot_id;
+         cop.auth = authority( 1, teller_id, 1 );
+         // every other authority is disabled and must not be looked at
+         cop.enabled = ( i % 2 == 0 );
+         cop.valid_from = db.head_block_time();
+         cop.valid_to = db.head_block_time() + 86400;
+         cop.operation_type = ro.op.which();
+         cop.restrictions = ro.restrictions;
+         signed_transaction tx;
+         tx.operations.push_back( cop );
+         set_expiration( db, tx );
+         PUSH_TX( db, tx, database::skip_transaction_signatures );
+      }
+   }
+   generate_block();
+
+   for( const restricted_operation& ro : ops )
+   {
+      size_t viable = 0;
+      const auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < rounds; ++i )
+         viable += db.get_viable_custom_authorities( bot_id, ro.op ).size();
+      const int64_t elapsed = ( fc::time_point::now() - start ).count() * 1000 / rounds;
+
+      BOOST_CHECK_EQUAL( viable, size_t( rounds ) * auths_per_type );
+      wlog( "${n}: ${a} viable authorities in ${t} ns", ("n", ro.name)("a", auths_per_type)("t", elapsed) );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
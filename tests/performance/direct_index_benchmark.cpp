@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+
+#include <fc/time.hpp>
+
+#include <random>
+
+using namespace graphene::chain;
+
+namespace {
+
+using balance_primary_index = graphene::db::primary_index< account_balance_index >;
+
+/// Loads balances with the given instances into @p idx
+void fill( balance_primary_index& idx, const std::vector<uint64_t>& instances )
+{
+   account_balance_object bal;
+   for( const uint64_t instance : instances )
+   {
+      bal.id = object_id_type( account_balance_id_type( instance ) );
+      bal.owner = account_id_type( instance );
+      idx.load( fc::raw::pack( bal ) );
+   }
+}
+
+/// Looks up all IDs in random order and logs the average latency
+void run_lookups( const std::string& name, const balance_primary_index& idx, std::vector<uint64_t> instances,
+                  size_t lookup_bytes )
+{
+   std::shuffle( instances.begin(), instances.end(), std::mt19937( 42 ) );
+   const uint32_t rounds = 5;
+   uint64_t found = 0;
+   const auto start = fc::time_point::now();
+   for( uint32_t round = 0; round < rounds; ++round )
+      for( const uint64_t instance : instances )
+         if( idx.find( account_balance_id_type( instance ) ) != nullptr )
+            ++found;
+   const auto elapsed = ( fc::time_point::now() - start ).count();
+   BOOST_CHECK_EQUAL( found, rounds * instances.size() );
+   wlog( "${name}: ${ns} ns per lookup, ${kib} KiB for ID lookups",
+         ("name",name)("ns",elapsed * 1000 / int64_t( rounds * instances.size() ))("kib",lookup_bytes/1024) );
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE( direct_index_benchmarks )
+
+/**
+ * Compares the latency of lookups by ID and the memory used for them, for the ordered by_id index of a
+ * generic_index, a direct_index and a sparse_direct_index, with densely and sparsely allocated IDs.
+ */
+BOOST_AUTO_TEST_CASE( id_lookup_benchmark )
+{ try {
+   const uint64_t num_objects = 1000000;
+   database db;
+   db._undo_db.disable();
+
+   std::vector<uint64_t> dense( num_objects );
+   for( uint64_t i = 0; i < num_objects; ++i )
+      dense[i] = i;
+   // every 20th object of a range twenty times as large
+   std::vector<uint64_t> sparse( num_objects / 10 );
+   for( uint64_t i = 0; i < sparse.size(); ++i )
+      sparse[i] = i * 20;
+   // a tree node holds 3 pointers and a color besides the object
+   const size_t tree_bytes_per_object = 4 * sizeof(void*);
+
+   {
+      balance_primary_index idx( db );
+      fill( idx, dense );
+      run_lookups( "dense, by_id tree", idx, dense, num_objects * tree_bytes_per_object );
+   }
+   {
+      balance_primary_index idx( db );
+      idx.add_id_lookup_index< graphene::db::direct_index< account_balance_object, 16 > >();
+      fill( idx, dense );
+      const size_t chunks = ( num_objects >> 16 ) + 1;
+      run_lookups( "dense, direct_index", idx, dense, chunks * ( size_t(1) << 16 ) * sizeof(void*) );
+   }
+   {
+      balance_primary_index idx( db );
+      const auto& lookup = *idx.add_id_lookup_index< graphene::db::sparse_direct_index< account_balance_object,
+                                                                                         10 > >();
+      fill( idx, dense );
+      run_lookups( "dense, sparse_direct_index", idx, dense, lookup.memory_usage() );
+   }
+   {
+      balance_primary_index idx( db );
+      fill( idx, sparse );
+      run_lookups( "sparse, by_id tree", idx, sparse, sparse.size() * tree_bytes_per_object );
+   }
+   {
+      balance_primary_index idx( db );
+      const auto& lookup = *idx.add_id_lookup_index< graphene::db::sparse_direct_index< account_balance_object,
+                                                                                         10 > >();
+      fill( idx, sparse );
+      run_lookups( "sparse, sparse_direct_index", idx, sparse, lookup.memory_usage() );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/market_object.hpp>
+
+#include <fc/time.hpp>
+
+#include "../common/database_fixture.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace graphene::chain;
+
+namespace {
+
+/// The resident set size of this process in bytes, 0 if unknown (only implemented for Linux)
+uint64_t resident_set_size()
+{
+#ifndef _WIN32
+   std::ifstream statm( "/proc/self/statm" );
+   uint64_t total_pages = 0;
+   uint64_t resident_pages = 0;
+   statm >> total_pages >> resident_pages;
+   if( statm )
+      return resident_pages * sysconf( _SC_PAGESIZE );
+#endif
+   return 0;
+}
+
+/// Describes how much of the memory held for the nodes of an index is in use, if it has a node arena
+template< typename Allocator >
+std::string describe_node_memory( const Allocator& )
+{
+   return "no node arena";
+}
+
+template< typename T >
+std::string describe_node_memory( const graphene::db::pool_allocator<T>& allocator )
+{
+   const auto& arena = allocator.arena();
+   const uint64_t reserved = arena.reserved_bytes();
+   const uint64_t used = arena.used_bytes();
+   return "node arena holds " + std::to_string( reserved / 1024 ) + " KiB, "
+          + std::to_string( reserved > 0 ? 100 - used * 100 / reserved : 0 ) + "% of it unused";
+}
+
+/**
+ * Keeps a working set of limit orders and then replaces random orders in it, as an order book does over a long
+ * uptime. Finally removes most orders, as after a busy market calmed down. Reports throughput, the growth of the
+ * resident set size in every phase, and how fragmented the memory held for the nodes is.
+ */
+template< typename Index >
+void run_churn_benchmark( const std::string& name )
+{
+   const uint64_t working_set = 200000;
+   const uint64_t replacements = 4000000;
+
+   const uint64_t rss_before = resident_set_size();
+   Index idx;
+   std::vector<const limit_order_object*> orders;
+   orders.reserve( working_set );
+   std::mt19937_64 rng( 42 );
+   auto create = [&idx,&rng]() {
+      return static_cast<const limit_order_object*>( &idx.create( [&rng]( graphene::db::object& o ) {
+         auto& order = static_cast<limit_order_object&>( o );
+         order.seller = account_id_type( rng() % 100000 );
+         order.for_sale = 1 + rng() % 1000000;
+         order.sell_price = price( asset( 1 + rng() % 1000000 ), asset( 1 + rng() % 1000000, asset_id_type(1) ) );
+      }) );
+   };
+
+   auto start = fc::time_point::now();
+   for( uint64_t i = 0; i < working_set; ++i )
+      orders.push_back( create() );
+   auto elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+   const uint64_t rss_filled = resident_set_size();
+   wlog( "${name}: created ${n} orders at ${ops} orders/s, RSS grew by ${rss} KiB",
+         ("name",name)("n",working_set)("ops",working_set*1000000/elapsed)("rss",(rss_filled-rss_before)/1024) );
+
+   start = fc::time_point::now();
+   for( uint64_t i = 0; i < replacements; ++i )
+   {
+      auto& slot = orders[ rng() % working_set ];
+      idx.remove( *slot );
+      slot = create();
+   }
+   elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+   const uint64_t rss_after = resident_set_size();
+   wlog( "${name}: replaced ${n} orders at ${ops} orders/s, RSS grew by another ${rss} KiB during churn, ${mem}",
+         ("name",name)("n",replacements)("ops",replacements*1000000/elapsed)
+         ("rss",(rss_after-rss_filled)/1024)("mem",describe_node_memory( idx.indices().get_allocator() )) );
+
+   // random orders are removed, so that the remaining ones are spread over the memory
+   std::shuffle( orders.begin(), orders.end(), rng );
+   const uint64_t remaining = working_set / 10;
+   for( uint64_t i = remaining; i < working_set; ++i )
+      idx.remove( *orders[i] );
+   orders.resize( remaining );
+   const uint64_t rss_shrunk = resident_set_size();
+   wlog( "${name}: removed ${n} orders, RSS changed by ${rss} KiB, ${mem}",
+         ("name",name)("n",working_set-remaining)
+         ("rss",(static_cast<int64_t>(rss_shrunk)-static_cast<int64_t>(rss_after))/1024)
+         ("mem",describe_node_memory( idx.indices().get_allocator() )) );
+}
+
+using std_allocated_limit_order_index = graphene::db::generic_index< limit_order_object,
+      multi_index_container< limit_order_object, limit_order_multi_index_type::index_specifier_type_list,
+                             std::allocator< limit_order_object > > >;
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE( index_allocator_benchmarks )
+
+/**
+ * Run each churn benchmark in its own process for meaningful RSS numbers, the heap does not give memory back.
+ */
+BOOST_AUTO_TEST_CASE( limit_order_churn_std_allocator )
+{ try {
+   run_churn_benchmark< std_allocated_limit_order_index >( "std::allocator" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( limit_order_churn_pool_allocator )
+{ try {
+   run_churn_benchmark< limit_order_index >( "pool_allocator" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( order_matching_benchmark, database_fixture )
+{ try {
+   ACTORS( (maker)(taker) );
+   const uint64_t resting_orders = 10000;
+   const uint64_t matched_pairs = 20000;
+
+   const auto& usd = create_user_issued_asset( "MATCHUSD" );
+   const asset_id_type usd_id = usd.get_id();
+   issue_uia( maker, usd.amount( 1000 * ( resting_orders + matched_pairs ) ) );
+   transfer( committee_account, maker_id, asset( 1000 * resting_orders ) );
+   transfer( committee_account, taker_id, asset( 1000 * matched_pairs ) );
+
+   // a book that does not cross, so that matching happens against a deep index
+   for( uint64_t i = 0; i < resting_orders; ++i )
+      create_sell_order( maker, asset( 100, usd_id ), asset( 200 + i ) );
+
+   const auto start = fc::time_point::now();
+   for( uint64_t i = 0; i < matched_pairs; ++i )
+   {
+      create_sell_order( maker, asset( 100, usd_id ), asset( 100 ) );
+      BOOST_REQUIRE( create_sell_order( taker, asset( 100 ), asset( 100, usd_id ) ) == nullptr );
+   }
+   const auto elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+   wlog( "Matched ${n} order pairs at ${ops} orders/s with ${r} resting orders, RSS is ${rss} KiB",
+         ("n",matched_pairs)("ops",2*matched_pairs*1000000/elapsed)("r",resting_orders)
+         ("rss",resident_set_size()/1024) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
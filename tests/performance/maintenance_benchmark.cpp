@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/committee_member_object.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/hardfork.hpp>
+#include <graphene/chain/witness_object.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/time.hpp>
+
+#include <thread>
+
+using namespace graphene::chain;
+
+namespace {
+
+/// Generates the first block at or after the next maintenance time and returns how long it took in ms
+int64_t generate_maintenance_block( database& db, const fc::ecc::private_key& key )
+{
+   const auto maint_time = db.get_dynamic_global_properties().next_maintenance_time;
+   const uint32_t slot = db.get_slot_at_time( maint_time );
+   const auto start = fc::time_point::now();
+   db.generate_block( db.get_slot_time( slot ), db.get_scheduled_witness( slot ), key, ~0 );
+   const int64_t elapsed = ( fc::time_point::now() - start ).count() / 1000;
+   BOOST_REQUIRE( db.get_dynamic_global_properties().next_maintenance_time > maint_time );
+   return elapsed;
+}
+
+/// The votes of all witnesses and committee members
+vector<uint64_t> get_total_votes( const database& db )
+{
+   vector<uint64_t> votes;
+   for( const witness_object& wit : db.get_index_type<witness_index>().indices() )
+      votes.push_back( wit.total_votes );
+   for( const committee_member_object& cm : db.get_index_type<committee_member_index>().indices() )
+      votes.push_back( cm.total_votes );
+   return votes;
+}
+
+/// A chain with 1,000,000 voting accounts after hard fork core-2262
+struct voting_chain
+{
+   const uint32_t num_voters = 1000000;
+   const uint32_t num_candidates = 10;
+   const fc::ecc::private_key witness_priv_key
+         = fc::ecc::private_key::regenerate( fc::sha256::hash( std::string("null_key") ) );
+   fc::temp_directory data_dir { graphene::utilities::temp_directory_path() };
+   database db;
+   vector<vote_id_type> witness_votes;
+   vector<vote_id_type> committee_votes;
+   vector<account_id_type> voters;
+
+   voting_chain()
+   {
+      const auto witness_pub_key = witness_priv_key.get_public_key();
+
+      genesis_state_type genesis_state;
+      // only core in orders and tickets vote after hard fork core-2262, so the tally does not depend on fees
+      genesis_state.initial_timestamp = HARDFORK_CORE_2262_TIME + 86400;
+      genesis_state.initial_parameters.get_mutable_fees().zero_all_fees();
+      genesis_state.initial_active_witnesses = num_candidates;
+      for( uint32_t i = 0; i < num_candidates; ++i )
+      {
+         auto name = "init" + fc::to_string(i);
+         genesis_state.initial_accounts.emplace_back( name, witness_pub_key, witness_pub_key, true );
+         genesis_state.initial_committee_candidates.push_back( {name} );
+         genesis_state.initial_witness_candidates.push_back( {name, witness_pub_key} );
+      }
+      for( uint32_t i = 0; i < num_voters; ++i )
+         genesis_state.initial_accounts.emplace_back( "voter" + fc::to_string(i), public_key_type( witness_pub_key ) );
+
+      db.open( data_dir.path(), [&genesis_state]{ return genesis_state; }, GRAPHENE_CURRENT_DB_VERSION );
+      db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), witness_priv_key, ~0 );
+
+      for( const witness_object& wit : db.get_index_type<witness_index>().indices() )
+         witness_votes.push_back( wit.vote_id );
+      for( const committee_member_object& cm : db.get_index_type<committee_member_index>().indices() )
+         committee_votes.push_back( cm.vote_id );
+
+      // Let the accounts vote as if they had core in orders, every 7th through a proxy
+      auto start = fc::time_point::now();
+      const auto& accounts_by_name = db.get_index_type<account_index>().indices().get<by_name>();
+      voters.reserve( num_voters );
+      for( uint32_t i = 0; i < num_voters; ++i )
+      {
+         const account_object& voter = *accounts_by_name.find( "voter" + fc::to_string(i) );
+         set_votes( voter, i, i % 7 == 6 ? voters[ ( uint64_t(i) * 31 ) % voters.size() ]
+                                         : GRAPHENE_PROXY_TO_SELF_ACCOUNT );
+         db.modify( voter.statistics( db ), [this,i]( account_statistics_object& s ) {
+            s.is_voting = true;
+            s.total_core_in_orders = 1000000 + i;
+            s.last_vote_time = db.head_block_time();
+         });
+         voters.push_back( voter.get_id() );
+      }
+      wlog( "Set up ${n} voting accounts in ${ms}ms", ("n",num_voters)
+            ("ms",( fc::time_point::now() - start ).count() / 1000) );
+   }
+
+   ~voting_chain()
+   {
+      db.close();
+   }
+
+   void set_votes( const account_object& voter, uint32_t seed, account_id_type proxy )
+   {
+      db.modify( voter, [this,seed,proxy]( account_object& a ) {
+         a.options.votes.clear();
+         a.options.num_witness = 1 + seed % witness_votes.size();
+         for( uint16_t j = 0; j < a.options.num_witness; ++j )
+            a.options.votes.insert( witness_votes[ ( seed + j ) % witness_votes.size() ] );
+         a.options.num_committee = 1 + seed % committee_votes.size();
+         for( uint16_t j = 0; j < a.options.num_committee; ++j )
+            a.options.votes.insert( committee_votes[ ( seed + j ) % committee_votes.size() ] );
+         a.options.voting_account = proxy;
+      });
+   }
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE( maintenance_benchmarks )
+
+/**
+ * Performs chain maintenance on a chain with 1,000,000 voting accounts, once tallying the votes in one loop and
+ * once tallying them in parallel.
+ */
+BOOST_FIXTURE_TEST_CASE( vote_tally_benchmark, voting_chain )
+{ try {
+   // count all votes at both maintenance blocks
+   db.enable_incremental_vote_tally( false );
+
+   db.enable_parallel_vote_tally( false );
+   const int64_t sequential_ms = generate_maintenance_block( db, witness_priv_key );
+   const vector<uint64_t> sequential_votes = get_total_votes( db );
+
+   db.enable_parallel_vote_tally( true );
+   const int64_t parallel_ms = generate_maintenance_block( db, witness_priv_key );
+   BOOST_CHECK( get_total_votes( db ) == sequential_votes );
+
+   wlog( "Maintenance with ${n} voters: ${s}ms tallying in one loop, ${p}ms tallying in parallel on ${t} threads",
+         ("n",num_voters)("s",sequential_ms)("p",parallel_ms)
+         ("t",std::thread::hardware_concurrency()) );
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Performs chain maintenance on a chain with 1,000,000 voting accounts after 1% of them changed, once counting
+ * only the changed accounts and once counting all accounts.
+ */
+BOOST_FIXTURE_TEST_CASE( incremental_vote_tally_benchmark, voting_chain )
+{ try {
+   const uint32_t num_changes = num_voters / 100;
+
+   // count all votes and keep them
+   const int64_t full_ms = generate_maintenance_block( db, witness_priv_key );
+
+   // change the stakes of some accounts and the votes of others, including proxies
+   for( uint32_t i = 0; i < num_changes; ++i )
+   {
+      const account_object& voter = voters[ ( uint64_t(i) * 97 ) % num_voters ]( db );
+      if( i % 2 == 0 )
+         db.modify( voter.statistics( db ), [i]( account_statistics_object& s ) {
+            s.total_core_in_orders += 1000 + i;
+         });
+      else
+         set_votes( voter, i * 13, GRAPHENE_PROXY_TO_SELF_ACCOUNT );
+   }
+
+   const int64_t incremental_ms = generate_maintenance_block( db, witness_priv_key );
+   const vector<uint64_t> incremental_votes = get_total_votes( db );
+
+   db.pop_block();
+   db.enable_incremental_vote_tally( false );
+   const int64_t recount_ms = generate_maintenance_block( db, witness_priv_key );
+   BOOST_CHECK( get_total_votes( db ) == incremental_votes );
+
+   wlog( "Maintenance with ${n} voters: ${f}ms counting all votes, ${i}ms counting ${c} changed accounts, "
+         "${r}ms counting all votes again",
+         ("n",num_voters)("f",full_ms)("i",incremental_ms)("c",num_changes)("r",recount_ms) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
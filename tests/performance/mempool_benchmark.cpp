@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/time.hpp>
+
+#include <random>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+BOOST_AUTO_TEST_SUITE( mempool_benchmarks )
+
+/**
+ * Floods the pending transaction pool with signed transfers and measures how fast they are accepted, how long
+ * the pool takes to be re-applied after a block which touches none of their accounts and after one which
+ * touches all of them, how long a block takes to be generated, and how a size limited pool behaves.
+ */
+BOOST_FIXTURE_TEST_CASE( pending_transaction_flood_benchmark, database_fixture )
+{ try {
+   const uint32_t num_accounts = 1000;
+   const uint32_t transfers_per_account = 10;
+
+   ACTORS( (sink) );
+   std::vector< std::pair<account_id_type, fc::ecc::private_key> > accounts;
+   for( uint32_t i = 0; i < num_accounts; ++i )
+   {
+      const string name = "bench" + std::to_string( i );
+      const fc::ecc::private_key key = generate_private_key( name );
+      const account_id_type id = create_account( name, key.get_public_key() ).get_id();
+      transfer( account_id_type(), id, asset( 100000000 ) );
+      accounts.emplace_back( id, key );
+   }
+   generate_block();
+
+   std::mt19937 rng( 42 );
+   std::uniform_int_distribution<int64_t> pick_fee( 0, 10000 );
+   uint64_t amount = 0;
+   auto make_transfer = [&]( account_id_type from, const fc::ecc::private_key& key )
+   {
+      signed_transaction tx;
+      transfer_operation xfer_op;
+      xfer_op.from = from;
+      xfer_op.to = sink_id;
+      xfer_op.amount = asset( ++amount );
+      xfer_op.fee = asset( pick_fee( rng ) );
+      tx.operations.push_back( xfer_op );
+      tx.set_expiration( db.head_block_time() + fc::hours(1) );
+      tx.set_reference_block( db.head_block_id() );
+      sign( tx, key );
+      return tx;
+   };
+   auto make_flood = [&]()
+   {
+      std::vector<signed_transaction> txs;
+      txs.reserve( num_accounts * transfers_per_account );
+      for( uint32_t t = 0; t < transfers_per_account; ++t )
+         for( const auto& account : accounts )
+            txs.push_back( make_transfer( account.first, account.second ) );
+      return txs;
+   };
+   auto push_flood = [&]( const std::vector<signed_transaction>& txs )
+   {
+      uint64_t failed = 0;
+      for( const signed_transaction& tx : txs )
+      {
+         try {
+            db.push_transaction( tx, database::skip_nothing );
+         } catch( const fc::exception& ) {
+            ++failed;
+         }
+      }
+      return failed;
+   };
+   auto push_block_with = [&]( const std::vector<processed_transaction>& txs )
+   {
+      signed_block b;
+      b.transactions = txs;
+      b.previous = db.head_block_id();
+      b.timestamp = db.get_slot_time(1);
+      b.witness = db.get_scheduled_witness(1);
+      b.transaction_merkle_root = b.calculate_merkle_root();
+      b.sign( init_account_priv_key );
+      const auto start = fc::time_point::now();
+      db.push_block( b, database::skip_nothing );
+      return ( fc::time_point::now() - start ).count();
+   };
+   auto log_metrics = [&]( const string& phase )
+   {
+      const pending_transaction_pool_metrics m = db.get_pending_transaction_pool_metrics();
+      wlog( "${p}: ${s} pending transactions in ${b} bytes, ${a} accepted, ${r} rejected, ${e} evicted, "
+            "${v} re-applied",
+            ("p", phase)("s", m.size)("b", m.bytes)("a", m.accepted)("r", m.rejected)("e", m.evicted)
+            ("v", m.revalidated) );
+   };
+
+   std::vector<signed_transaction> flood = make_flood();
+   auto start = fc::time_point::now();
+   push_flood( flood );
+   auto elapsed = ( fc::time_point::now() - start ).count();
+   wlog( "Pushed ${n} transfers in ${t} ms, ${r} transactions per second",
+         ("n", flood.size())("t", elapsed / 1000)("r", flood.size() * 1000000 / std::max<int64_t>( elapsed, 1 )) );
+   log_metrics( "After the flood" );
+
+   elapsed = push_block_with( {} );
+   wlog( "Re-applied the pool after a block touching none of its accounts in ${t} ms", ("t", elapsed / 1000) );
+   log_metrics( "Re-application with cached authorities" );
+
+   // a transfer to the sink touches the accounts of all pending transactions
+   const signed_transaction to_sink = make_transfer( accounts.front().first, accounts.front().second );
+   elapsed = push_block_with( { processed_transaction( to_sink ) } );
+   wlog( "Re-applied the pool after a block touching all of its accounts in ${t} ms", ("t", elapsed / 1000) );
+   log_metrics( "Re-application after account changes" );
+
+   start = fc::time_point::now();
+   const signed_block generated = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1),
+                                                     init_account_priv_key, database::skip_nothing );
+   elapsed = ( fc::time_point::now() - start ).count();
+   wlog( "Generated a block with ${n} transactions by fee in ${t} ms",
+         ("n", generated.transactions.size())("t", elapsed / 1000) );
+
+   BOOST_TEST_MESSAGE( "Flooding a pool limited to a quarter of the flood" );
+   while( db.get_pending_transaction_pool_metrics().size > 0 )
+      generate_block();
+   flood = make_flood();
+   uint64_t flood_bytes = 0;
+   for( const signed_transaction& tx : flood )
+      flood_bytes += fc::raw::pack_size( tx );
+   db.set_max_pending_transactions_size( flood_bytes / 4 );
+   const uint64_t failed = push_flood( flood );
+   wlog( "${f} of ${n} transfers were refused by the limited pool", ("f", failed)("n", flood.size()) );
+   log_metrics( "Limited pool after the flood" );
+   push_block_with( {} );
+   log_metrics( "Limited pool after the next block" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
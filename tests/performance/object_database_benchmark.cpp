@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/interprocess/file_mapping.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/time.hpp>
+
+using namespace graphene::chain;
+
+namespace {
+
+/// Gives the benchmark write access to the indexes of a database
+struct benchmark_database : public database
+{
+   using object_database::get_mutable_index;
+};
+
+/**
+ * Loads an index file the way primary_index::open did before objects were unpacked straight from the mapped
+ * file, i.e. by copying each record into a temporary buffer that is handed to index::load.
+ */
+void legacy_open( graphene::db::index& idx, const fc::path& file )
+{
+   fc::file_mapping fm( file.generic_string().c_str(), fc::read_only );
+   fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size( file ) );
+   fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
+   object_id_type next_id;
+   fc::sha256 version;
+   fc::raw::unpack( ds, next_id );
+   fc::raw::unpack( ds, version );
+   std::vector<char> tmp;
+   while( ds.remaining() > 0 )
+   {
+      fc::raw::unpack( ds, tmp );
+      idx.load( tmp );
+   }
+   idx.set_next_id( next_id );
+}
+
+int64_t elapsed_ms( const fc::time_point& start )
+{
+   return ( fc::time_point::now() - start ).count() / 1000;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE( object_database_benchmarks )
+
+/**
+ * Measures how long it takes to open an object database with many accounts and balances, once through
+ * object_database::open and once with the former copy-and-load path.
+ */
+BOOST_AUTO_TEST_CASE( startup_benchmark )
+{ try {
+   const uint64_t num_accounts = 200000;
+   const uint64_t balances_per_account = 3;
+
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   {
+      database db;
+      graphene::db::object_database& odb = db;
+      odb.open( data_dir.path() );
+      const auto start = fc::time_point::now();
+      for( uint64_t i = 0; i < num_accounts; ++i )
+      {
+         db.create<account_object>( [i]( account_object& acc ) {
+            acc.name = "account" + fc::to_string( i );
+            acc.statistics = account_statistics_id_type( i );
+            acc.options.voting_account = GRAPHENE_PROXY_TO_SELF_ACCOUNT;
+         });
+         for( uint64_t j = 0; j < balances_per_account; ++j )
+            db.create<account_balance_object>( [i,j]( account_balance_object& bal ) {
+               bal.owner = account_id_type( i );
+               bal.asset_type = asset_id_type( j );
+               bal.balance = 1000 * ( i + 1 );
+            });
+      }
+      wlog( "Created ${a} accounts and ${b} balances in ${ms}ms",
+            ("a",num_accounts)("b",num_accounts*balances_per_account)("ms",elapsed_ms(start)) );
+      const auto flush_start = fc::time_point::now();
+      odb.flush_full();
+      wlog( "Saved object database in ${ms}ms", ("ms",elapsed_ms(flush_start)) );
+   }
+
+   {
+      benchmark_database db;
+      const auto dir = data_dir.path() / "object_database";
+      const auto start = fc::time_point::now();
+      legacy_open( db.get_mutable_index( account_object::space_id, account_object::type_id ),
+                   dir / fc::to_string( account_object::space_id ) / fc::to_string( account_object::type_id ) );
+      legacy_open( db.get_mutable_index( account_balance_object::space_id, account_balance_object::type_id ),
+                   dir / fc::to_string( account_balance_object::space_id )
+                       / fc::to_string( account_balance_object::type_id ) );
+      wlog( "Copy-and-load open: ${ms}ms", ("ms",elapsed_ms(start)) );
+      BOOST_CHECK_EQUAL( db.get_index_type<account_index>().indices().size(), num_accounts );
+   }
+
+   {
+      database db;
+      graphene::db::object_database& odb = db;
+      const auto start = fc::time_point::now();
+      odb.open( data_dir.path() );
+      wlog( "Streaming open: ${ms}ms", ("ms",elapsed_ms(start)) );
+      BOOST_CHECK_EQUAL( db.get_index_type<account_index>().indices().size(), num_accounts );
+      BOOST_CHECK_EQUAL( db.get_index_type<account_balance_index>().indices().size(),
+                         num_accounts * balances_per_account );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
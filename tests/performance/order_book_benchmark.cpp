@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/market_object.hpp>
+
+#include <fc/time.hpp>
+
+#include "../common/database_fixture.hpp"
+
+#include <random>
+
+using namespace graphene::chain;
+
+namespace {
+
+/// A limit order index whose price index compares the prices exactly, as it did before the prices were ranked
+using exact_price_limit_order_index = graphene::db::generic_index< limit_order_object,
+      multi_index_container< limit_order_object,
+         indexed_by<
+            ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
+            ordered_unique< tag<by_price>,
+               composite_key< limit_order_object,
+                  member< limit_order_object, ranked_price, &limit_order_object::sell_price >,
+                  member< object, object_id_type, &object::id >
+               >,
+               composite_key_compare< std::greater<price>, std::less<object_id_type> >
+            >
+         >,
+         graphene::db::pool_allocator< limit_order_object >
+      > >;
+
+/// A random price in one of 4 markets, with amounts of very different magnitudes like on a live chain
+price random_price( std::mt19937_64& rng )
+{
+   const asset_id_type base( rng() % 2 );
+   const asset_id_type quote( 2 + rng() % 2 );
+   const int64_t scale = 1 + rng() % 1000000;
+   return price( asset( scale * ( 1 + rng() % 1000000 ), base ), asset( scale * ( 1 + rng() % 10000 ), quote ) );
+}
+
+/**
+ * Fills deep books, replaces random orders in them and looks up random prices, like apply_order does for each new
+ * order. Reports the throughput of each phase.
+ */
+template< typename Index >
+void run_order_book_benchmark( const std::string& name )
+{
+   const uint64_t book_size = 400000;
+   const uint64_t replacements = 1000000;
+   const uint64_t lookups = 1000000;
+
+   Index idx;
+   std::vector<const limit_order_object*> orders;
+   orders.reserve( book_size );
+   std::mt19937_64 rng( 42 );
+   auto create = [&idx,&rng]() {
+      return static_cast<const limit_order_object*>( &idx.create( [&rng]( graphene::db::object& o ) {
+         auto& order = static_cast<limit_order_object&>( o );
+         order.for_sale = 1 + rng() % 1000000;
+         order.sell_price = random_price( rng );
+      }) );
+   };
+
+   auto start = fc::time_point::now();
+   for( uint64_t i = 0; i < book_size; ++i )
+      orders.push_back( create() );
+   auto elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+   wlog( "${name}: inserted ${n} orders at ${ops} orders/s", ("name",name)("n",book_size)
+         ("ops",book_size*1000000/elapsed) );
+
+   start = fc::time_point::now();
+   for( uint64_t i = 0; i < replacements; ++i )
+   {
+      auto& slot = orders[ rng() % book_size ];
+      idx.remove( *slot );
+      slot = create();
+   }
+   elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+   wlog( "${name}: replaced ${n} orders at ${ops} orders/s", ("name",name)("n",replacements)
+         ("ops",replacements*1000000/elapsed) );
+
+   const auto& price_idx = idx.indices().template get<by_price>();
+   std::vector<ranked_price> keys;
+   keys.reserve( lookups );
+   for( uint64_t i = 0; i < lookups; ++i )
+      keys.emplace_back( random_price( rng ) );
+   uint64_t found = 0;
+   start = fc::time_point::now();
+   for( const ranked_price& key : keys )
+      found += ( price_idx.upper_bound( key ) != price_idx.end() );
+   elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+   wlog( "${name}: ${n} lookups at ${ops} lookups/s, ${f} found an order",
+         ("name",name)("n",lookups)("ops",lookups*1000000/elapsed)("f",found) );
+}
+
+/// A random price in a market of @p asset_count assets
+price random_market_price( std::mt19937_64& rng, uint64_t asset_count )
+{
+   const asset_id_type base( rng() % asset_count );
+   const asset_id_type quote( ( base.instance.value + 1 + rng() % ( asset_count - 1 ) ) % asset_count );
+   return price( asset( 1 + rng() % 1000000, base ), asset( 1 + rng() % 1000000, quote ) );
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE( order_book_benchmarks )
+
+/**
+ * Sorts random prices with the exact comparison of prices and with the comparison of ranked prices.
+ */
+BOOST_AUTO_TEST_CASE( price_comparison_benchmark )
+{ try {
+   const uint64_t count = 1000000;
+
+   std::mt19937_64 rng( 42 );
+   std::vector<ranked_price> exact;
+   exact.reserve( count );
+   for( uint64_t i = 0; i < count; ++i )
+      exact.emplace_back( random_price( rng ) );
+   std::vector<ranked_price> ranked( exact );
+
+   auto start = fc::time_point::now();
+   std::sort( exact.begin(), exact.end(), std::greater<price>() );
+   const int64_t exact_time = ( fc::time_point::now() - start ).count();
+
+   start = fc::time_point::now();
+   std::sort( ranked.begin(), ranked.end(), ranked_price_greater() );
+   const int64_t ranked_time = ( fc::time_point::now() - start ).count();
+
+   for( uint64_t i = 0; i < count; ++i )
+      BOOST_REQUIRE( exact[i] == ranked[i] );
+   wlog( "Sorted ${n} prices in ${e} ms comparing exactly and in ${r} ms comparing ranks",
+         ("n",count)("e",exact_time/1000)("r",ranked_time/1000) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( exact_price_order_book )
+{ try {
+   run_order_book_benchmark< exact_price_limit_order_index >( "exact prices" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( ranked_price_order_book )
+{ try {
+   run_order_book_benchmark< limit_order_index >( "ranked prices" );
+} FC_LOG_AND_RETHROW() }
+
+/**
+ * Looks up where new orders stand in their own market and which orders of the opposite market they would match,
+ * once in the global by_price index like apply_order did before and once in the per-market order books.
+ */
+BOOST_AUTO_TEST_CASE( per_market_order_book )
+{ try {
+   const uint64_t asset_count = 100;
+   const uint64_t book_size = 400000;
+   const uint64_t lookups = 1000000;
+
+   limit_order_index idx;
+   limit_order_book_index books;
+   std::vector<const limit_order_object*> orders;
+   orders.reserve( book_size );
+   std::mt19937_64 rng( 42 );
+
+   auto start = fc::time_point::now();
+   for( uint64_t i = 0; i < book_size; ++i )
+   {
+      const auto& order = static_cast<const limit_order_object&>( idx.create( [&rng]( graphene::db::object& o ) {
+         auto& order = static_cast<limit_order_object&>( o );
+         order.for_sale = 1 + rng() % 1000000;
+         order.sell_price = random_market_price( rng, asset_count );
+      }) );
+      books.object_inserted( order );
+      orders.push_back( &order );
+   }
+   auto elapsed = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+   wlog( "Inserted ${n} orders in ${m} markets at ${ops} orders/s", ("n",book_size)
+         ("m",books.get_market_count())("ops",book_size*1000000/elapsed) );
+
+   std::vector<const limit_order_object*> takers;
+   takers.reserve( lookups );
+   for( uint64_t i = 0; i < lookups; ++i )
+      takers.push_back( orders[ rng() % book_size ] );
+
+   const auto& price_idx = idx.indices().get<by_price>();
+   uint64_t global_matches = 0;
+   start = fc::time_point::now();
+   for( const limit_order_object* taker : takers )
+   {
+      auto itr = price_idx.iterator_to( *taker );
+      if( itr != price_idx.begin() )
+      {
+         --itr;
+         if( itr->sell_asset_id() == taker->sell_asset_id() && itr->receive_asset_id() == taker->receive_asset_id() )
+            continue;
+      }
+      const price max_price = ~taker->sell_price;
+      itr = price_idx.lower_bound( ranked_price( max_price.max() ) );
+      const auto end = price_idx.upper_bound( ranked_price( max_price ) );
+      global_matches += ( itr != end );
+   }
+   const int64_t global_time = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+
+   uint64_t book_matches = 0;
+   start = fc::time_point::now();
+   for( const limit_order_object* taker : takers )
+   {
+      const auto& own = books.get_book( taker->sell_asset_id(), taker->receive_asset_id() ).get<by_price>();
+      if( own.begin()->id != taker->id )
+         continue;
+      const auto& opposite = books.get_book( taker->receive_asset_id(), taker->sell_asset_id() ).get<by_price>();
+      const price max_price = ~taker->sell_price;
+      auto itr = opposite.lower_bound( ranked_price( max_price.max() ) );
+      const auto end = opposite.upper_bound( ranked_price( max_price ) );
+      book_matches += ( itr != end );
+   }
+   const int64_t book_time = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+
+   BOOST_CHECK_EQUAL( global_matches, book_matches );
+   wlog( "${n} takers: ${g} lookups/s in the global index, ${b} lookups/s in the per-market books, ${m} would match",
+         ("n",lookups)("g",lookups*1000000/global_time)("b",lookups*1000000/book_time)("m",book_matches) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
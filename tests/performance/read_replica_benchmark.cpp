@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/database_api.hpp>
+#include <graphene/app/read_replica.hpp>
+
+#include <fc/thread/thread.hpp>
+#include <fc/time.hpp>
+
+#include <atomic>
+#include <random>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+BOOST_AUTO_TEST_SUITE( read_replica_benchmarks )
+
+/**
+ * Measures the throughput of order book and account queries from several API client threads while blocks with
+ * transfers are applied, once with all calls served by the chain database and once with 1, 2 and 4 read replicas.
+ */
+BOOST_FIXTURE_TEST_CASE( read_replica_benchmark, database_fixture )
+{ try {
+   const uint32_t num_accounts = 200;
+   const uint32_t transfers_per_block = 100;
+   const uint32_t blocks = 50;
+   const uint32_t num_clients = 8;
+
+   ACTORS( (issuer) );
+   const asset_object& bench = create_user_issued_asset( "BENCH", issuer, 0 );
+   const asset_id_type bench_id = bench.get_id();
+   issue_uia( issuer, bench.amount( 1000000000 ) );
+   transfer( account_id_type(), issuer_id, asset( 100000000 ) );
+
+   std::vector<account_id_type> accounts;
+   for( uint32_t i = 0; i < num_accounts; ++i )
+   {
+      const account_id_type id = create_account( "bench" + std::to_string( i ) ).get_id();
+      transfer( account_id_type(), id, asset( 10000000 ) );
+      accounts.push_back( id );
+   }
+   for( uint32_t o = 0; o < 200; ++o )
+      create_sell_order( issuer_id, asset( 1000, bench_id ), asset( 1000 + o ) );
+   generate_block();
+
+   graphene::app::application_options opt = app.get_options();
+   fc::thread& main_thread = fc::thread::current();
+   std::mt19937 rng( 42 );
+   std::uniform_int_distribution<uint32_t> pick( 0, num_accounts - 1 );
+
+   for( const uint16_t replica_count : { 0, 1, 2, 4 } )
+   {
+      std::shared_ptr<graphene::app::read_replica_set> replicas;
+      if( replica_count > 0 )
+         replicas = std::make_shared<graphene::app::read_replica_set>( db, &opt, replica_count );
+      graphene::app::database_api api( db, &opt, replicas );
+
+      std::atomic<bool> done { false };
+      std::atomic<uint64_t> calls { 0 };
+      std::vector< std::unique_ptr<fc::thread> > client_threads;
+      std::vector< fc::future<void> > clients;
+      for( uint32_t c = 0; c < num_clients; ++c )
+      {
+         client_threads.push_back( std::make_unique<fc::thread>( "api client " + std::to_string( c ) ) );
+         clients.push_back( client_threads.back()->async( [&,c]() {
+            std::mt19937 client_rng( c );
+            while( !done )
+            {
+               auto call = [&api,&client_rng]() {
+                  if( client_rng() % 2 == 0 )
+                     api.get_order_book( "BENCH", "BTS", 50 );
+                  else
+                     api.get_full_accounts( { "bench" + std::to_string( client_rng() % num_accounts ) }, false );
+               };
+               // without replicas the calls are served by the thread of the chain database, like API connections
+               if( replicas )
+                  call();
+               else
+                  main_thread.async( call, "api call" ).wait();
+               ++calls;
+            }
+         }, "api client" ) );
+      }
+
+      const auto start = fc::time_point::now();
+      int64_t apply_us = 0;
+      for( uint32_t b = 0; b < blocks; ++b )
+      {
+         for( uint32_t t = 0; t < transfers_per_block; ++t )
+         {
+            const uint32_t from = pick( rng );
+            const uint32_t to = ( from + 1 + pick( rng ) % ( num_accounts - 1 ) ) % num_accounts;
+            transfer( accounts[from], accounts[to], asset( 1 ) );
+         }
+         const auto block_start = fc::time_point::now();
+         generate_block();
+         apply_us += ( fc::time_point::now() - block_start ).count();
+         // leaves the thread of the chain database to the API calls for a while, like between blocks of a node
+         fc::usleep( fc::milliseconds( 20 ) );
+      }
+      const int64_t elapsed_us = ( fc::time_point::now() - start ).count();
+      done = true;
+      for( auto& client : clients )
+         client.wait();
+      for( auto& client_thread : client_threads )
+         client_thread->quit();
+
+      wlog( "${r} replicas: ${c} calls per second, ${a} us per block to generate",
+            ("r", replica_count)("c", calls * 1000000 / elapsed_us)("a", apply_us / blocks) );
+      if( replicas )
+      {
+         const auto metrics = replicas->get_metrics();
+         wlog( "   replica lag ${l} blocks, ${b} us per block to follow",
+               ("l", metrics.lag)("b", metrics.blocks > 0 ? metrics.apply_microseconds / metrics.blocks : 0) );
+      }
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
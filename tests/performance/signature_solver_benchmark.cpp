@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/exceptions.hpp>
+#include <graphene/chain/hardfork.hpp>
+
+#include <fc/time.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+BOOST_AUTO_TEST_SUITE( signature_solver_benchmarks )
+
+/**
+ * Compares minimize_required_signatures() with the removal of one key at a time followed by a full
+ * verify_authority(), on a treasury controlled by two levels of multisig accounts and on a batch of transfers
+ * from a hot wallet which a teller may also sign through a custom authority.
+ */
+BOOST_FIXTURE_TEST_CASE( required_signatures_benchmark, database_fixture )
+{ try {
+   const uint32_t num_holders = 30;
+   const uint32_t num_signers = 10;
+   const uint32_t rounds = 20;
+
+   generate_blocks( HARDFORK_BSIP_40_TIME );
+   generate_blocks( 5 );
+   db.modify( global_property_id_type()(db), []( global_property_object& gpo ) {
+      gpo.parameters.extensions.value.custom_authority_options = custom_authority_options_type();
+   });
+   set_expiration( db, trx );
+
+   ACTORS( (treasury)(hotwallet)(teller)(dest) );
+
+   auto set_auth = [&]( account_id_type aid, const authority& auth )
+   {
+      signed_transaction tx;
+      account_update_operation op;
+      op.account = aid;
+      op.active = auth;
+      op.owner = auth;
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      PUSH_TX( db, tx, database::skip_transaction_signatures );
+   };
+
+   // key holders, multisig signers with 2 of 3 holders each, and a treasury with 6 of 10 signers
+   std::vector<account_id_type> holders;
+   flat_set<public_key_type> holder_keys;
+   for( uint32_t i = 0; i < num_holders; ++i )
+   {
+      const string name = "holder" + std::to_string( i );
+      const public_key_type key = generate_private_key( name ).get_public_key();
+      holders.push_back( create_account( name, key ).get_id() );
+      holder_keys.insert( key );
+   }
+   authority treasury_auth;
+   treasury_auth.weight_threshold = 6;
+   for( uint32_t i = 0; i < num_signers; ++i )
+   {
+      const account_id_type signer = create_account( "signer" + std::to_string( i ) ).get_id();
+      authority signer_auth;
+      signer_auth.weight_threshold = 2;
+      for( uint32_t j = 0; j < 3; ++j )
+         signer_auth.add_authority( holders[ ( i * 3 + j ) % num_holders ], 1 );
+      set_auth( signer, signer_auth );
+      treasury_auth.add_authority( signer, 1 );
+   }
+   set_auth( treasury_id, treasury_auth );
+
+   // a hot wallet with 3 of 5 keys, whose transfers to dest may also be signed by the teller
+   authority hotwallet_auth;
+   hotwallet_auth.weight_threshold = 3;
+   flat_set<public_key_type> hotwallet_keys;
+   for( uint32_t i = 0; i < 5; ++i )
+   {
+      const public_key_type key = generate_private_key( "hotwallet" + std::to_string( i ) ).get_public_key();
+      hotwallet_auth.add_authority( key, 1 );
+      hotwallet_keys.insert( key );
+   }
+   hotwallet_auth.add_authority( teller_public_key, 1 );
+   hotwallet_keys.insert( teller_public_key );
+   set_auth( hotwallet_id, hotwallet_auth );
+
+   custom_authority_create_operation cop;
+   cop.account = hotwallet_id;
+   cop.auth = authority( 1, teller_id, 1 );
+   cop.enabled = true;
+   cop.valid_from = db.head_block_time();
+   cop.valid_to = db.head_block_time() + 86400;
+   cop.operation_type = operation::tag<transfer_operation>::value;
+   cop.restrictions = { restriction( 2, restriction::func_eq, dest_id ) }; // transfer_operation::to
+   signed_transaction ctx;
+   ctx.operations.push_back( cop );
+   set_expiration( db, ctx );
+   PUSH_TX( db, ctx, database::skip_transaction_signatures );
+   generate_block();
+
+   auto get_active = [&]( account_id_type aid ) -> const authority* { return &(aid(db).active); };
+   auto get_owner = [&]( account_id_type aid ) -> const authority* { return &(aid(db).owner); };
+   auto get_custom = [&]( account_id_type id, const operation& op, rejected_predicate_map* rejects ) {
+      return db.get_viable_custom_authorities( id, op, rejects );
+   };
+
+   // what minimize_required_signatures() did before the graph evaluation
+   auto remove_one_at_a_time = [&]( const signed_transaction& tx, const flat_set<public_key_type>& keys )
+   {
+      const set<public_key_type> s = tx.get_required_signatures( db.get_chain_id(), keys, get_active, get_owner,
+                                                                 true, false );
+      flat_set<public_key_type> result( s.begin(), s.end() );
+      for( const public_key_type& k : s )
+      {
+         result.erase( k );
+         try
+         {
+            verify_authority( tx.operations, result, get_active, get_owner, get_custom, true, false );
+            continue;
+         }
+         catch( const tx_missing_owner_auth& ) {}
+         catch( const tx_missing_active_auth& ) {}
+         catch( const tx_missing_other_auth& ) {}
+         result.insert( k );
+      }
+      return set<public_key_type>( result.begin(), result.end() );
+   };
+   auto compare = [&]( const string& name, const signed_transaction& tx, const flat_set<public_key_type>& keys )
+   {
+      set<public_key_type> expected;
+      auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < rounds; ++i )
+         expected = remove_one_at_a_time( tx, keys );
+      const int64_t baseline = ( fc::time_point::now() - start ).count() / rounds;
+
+      set<public_key_type> result;
+      start = fc::time_point::now();
+      for( uint32_t i = 0; i < rounds; ++i )
+         result = tx.minimize_required_signatures( db.get_chain_id(), keys, get_active, get_owner, get_custom,
+                                                   true, false );
+      const int64_t solver = ( fc::time_point::now() - start ).count() / rounds;
+
+      BOOST_CHECK( result == expected );
+      wlog( "${n}: ${k} of ${a} keys required, ${b} us removing one key at a time, ${s} us with the solver",
+            ("n", name)("k", result.size())("a", keys.size())("b", baseline)("s", solver) );
+   };
+
+   signed_transaction treasury_tx;
+   transfer_operation xfer;
+   xfer.from = treasury_id;
+   xfer.to = dest_id;
+   xfer.amount = asset( 1 );
+   treasury_tx.operations.push_back( xfer );
+   set_expiration( db, treasury_tx );
+   compare( "Treasury transfer", treasury_tx, holder_keys );
+
+   signed_transaction batch_tx;
+   xfer.from = hotwallet_id;
+   for( uint32_t i = 0; i < 20; ++i )
+   {
+      xfer.to = ( i % 2 == 0 ) ? dest_id : treasury_id;
+      xfer.amount = asset( i + 1 );
+      batch_tx.operations.push_back( xfer );
+   }
+   set_expiration( db, batch_tx );
+   compare( "Hot wallet batch", batch_tx, hotwallet_keys );
+
+   // with only the transfers to dest the custom authority of the teller is enough
+   batch_tx.operations.clear();
+   xfer.to = dest_id;
+   for( uint32_t i = 0; i < 20; ++i )
+   {
+      xfer.amount = asset( i + 1 );
+      batch_tx.operations.push_back( xfer );
+   }
+   compare( "Hot wallet batch to dest", batch_tx, hotwallet_keys );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/config.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/snapshot/binary_snapshot.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/time.hpp>
+
+#include <fstream>
+
+extern uint32_t GRAPHENE_TESTING_GENESIS_TIMESTAMP;
+
+using namespace graphene::chain;
+using namespace graphene::snapshot_plugin;
+
+namespace {
+
+int64_t elapsed_ms( const fc::time_point& start )
+{
+   return ( fc::time_point::now() - start ).count() / 1000;
+}
+
+uint64_t directory_size( const fc::path& dir )
+{
+   uint64_t size = 0;
+   for( fc::directory_iterator itr( dir ); itr != fc::directory_iterator(); ++itr )
+      size += fc::file_size( *itr );
+   return size;
+}
+
+/// Writes the objects like the JSON format of the snapshot plugin, one object per line
+void write_json_snapshot( const database& db, const fc::path& file )
+{
+   std::ofstream out( file.generic_string() );
+   db.inspect_all_indexes( [&out]( const graphene::db::index& index ) {
+      index.inspect_all_objects( [&out]( const graphene::db::object& o ) {
+         out << fc::json::to_string( o.to_variant() ) << '\n';
+      });
+   });
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE( snapshot_benchmarks )
+
+/**
+ * Compares the JSON snapshot with the binary snapshot of a chain with many accounts: how long the chain is
+ * blocked, how long writing takes, the size on disk, and how long it takes to restore and open the binary one.
+ */
+BOOST_AUTO_TEST_CASE( snapshot_benchmark )
+{ try {
+   const uint32_t num_accounts = 200000;
+   const auto witness_priv_key = fc::ecc::private_key::regenerate( fc::sha256::hash( std::string("null_key") ) );
+   const auto witness_pub_key = witness_priv_key.get_public_key();
+
+   genesis_state_type genesis_state;
+   genesis_state.initial_timestamp = fc::time_point_sec( GRAPHENE_TESTING_GENESIS_TIMESTAMP );
+   genesis_state.initial_parameters.get_mutable_fees().zero_all_fees();
+   genesis_state.initial_active_witnesses = 10;
+   for( unsigned int i = 0; i < genesis_state.initial_active_witnesses; ++i )
+   {
+      auto name = "init" + fc::to_string(i);
+      genesis_state.initial_accounts.emplace_back( name, witness_pub_key, witness_pub_key, true );
+      genesis_state.initial_committee_candidates.push_back( {name} );
+      genesis_state.initial_witness_candidates.push_back( {name, witness_pub_key} );
+   }
+   for( uint32_t i = 0; i < num_accounts; ++i )
+      genesis_state.initial_accounts.emplace_back( "target" + fc::to_string(i), public_key_type( witness_pub_key ) );
+
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   fc::temp_directory snapshot_dir( graphene::utilities::temp_directory_path() );
+   const fc::path json_file = snapshot_dir.path() / "snapshot.json";
+   const fc::path binary_dir = snapshot_dir.path() / "snapshot";
+
+   {
+      database db;
+      db.open( data_dir.path(), [&genesis_state]{ return genesis_state; }, GRAPHENE_CURRENT_DB_VERSION );
+      db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), witness_priv_key, ~0 );
+      const signed_block head_block = *db.fetch_block_by_number( db.head_block_num() );
+
+      auto start = fc::time_point::now();
+      write_json_snapshot( db, json_file );
+      wlog( "JSON snapshot: ${ms}ms blocking, ${s} bytes",
+            ("ms",elapsed_ms(start))("s",fc::file_size(json_file)) );
+
+      start = fc::time_point::now();
+      const auto state = capture_state( db, head_block );
+      const auto capture_ms = elapsed_ms( start );
+      start = fc::time_point::now();
+      write_snapshot( *state, binary_dir );
+      wlog( "Binary snapshot: ${c}ms blocking, ${w}ms writing in the background, ${s} bytes",
+            ("c",capture_ms)("w",elapsed_ms(start))("s",directory_size(binary_dir)) );
+      db.close();
+   }
+
+   {
+      fc::temp_directory restore_dir( graphene::utilities::temp_directory_path() );
+      const fc::path chain_dir = restore_dir.path() / "blockchain";
+      auto start = fc::time_point::now();
+      restore_snapshot( binary_dir, chain_dir, genesis_state.compute_chain_id() );
+      wlog( "Restored binary snapshot in ${ms}ms", ("ms",elapsed_ms(start)) );
+
+      start = fc::time_point::now();
+      database db;
+      db.open( chain_dir, []{ return genesis_state_type(); }, GRAPHENE_CURRENT_DB_VERSION );
+      wlog( "Opened restored database in ${ms}ms", ("ms",elapsed_ms(start)) );
+      BOOST_CHECK_GT( db.get_index_type<account_index>().indices().size(), num_accounts );
+      db.close();
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
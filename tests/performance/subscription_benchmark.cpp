@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/database_api.hpp>
+
+#include <fc/thread/thread.hpp>
+#include <fc/time.hpp>
+
+#include <random>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+BOOST_AUTO_TEST_SUITE( subscription_benchmarks )
+
+/**
+ * Measures how long blocks with transfers and orders take to apply while a growing number of synthetic API
+ * connections subscribe to accounts and to a market, and how long the notifications take to reach them.
+ */
+BOOST_FIXTURE_TEST_CASE( subscription_fanout_benchmark, database_fixture )
+{ try {
+   const uint32_t num_accounts = 200;
+   const uint32_t transfers_per_block = 100;
+   const uint32_t orders_per_block = 20;
+   const uint32_t blocks = 20;
+
+   ACTORS( (issuer) );
+   const asset_object& bench = create_user_issued_asset( "BENCH", issuer, 0 );
+   const asset_id_type bench_id = bench.get_id();
+   const std::string bench_market_side = std::string( object_id_type( bench_id ) );
+   issue_uia( issuer, bench.amount( 1000000000 ) );
+
+   std::vector<account_id_type> accounts;
+   for( uint32_t i = 0; i < num_accounts; ++i )
+   {
+      const account_id_type id = create_account( "bench" + std::to_string( i ) ).get_id();
+      transfer( account_id_type(), id, asset( 10000000 ) );
+      accounts.push_back( id );
+   }
+   transfer( account_id_type(), issuer_id, asset( 100000000 ) );
+   generate_block();
+
+   graphene::app::application_options opt = app.get_options();
+   std::mt19937 rng( 42 );
+   std::uniform_int_distribution<uint32_t> pick( 0, num_accounts - 1 );
+
+   uint64_t notifications = 0;
+   std::vector< std::unique_ptr<graphene::app::database_api> > connections;
+   for( const uint32_t subscribers : { 0u, 100u, 1000u, 5000u } )
+   {
+      while( connections.size() < subscribers )
+      {
+         connections.push_back( std::make_unique<graphene::app::database_api>( db, &opt ) );
+         auto& api = *connections.back();
+         api.set_subscribe_callback( [&notifications]( const fc::variant& ) { ++notifications; }, false );
+         api.get_full_accounts( { "bench" + std::to_string( pick( rng ) ), "bench" + std::to_string( pick( rng ) ) },
+                                true );
+         if( connections.size() % 10 == 0 )
+            api.subscribe_to_market( [&notifications]( const fc::variant& ) { ++notifications; }, bench_market_side,
+                                     "1.3.0" );
+      }
+      fc::usleep( fc::milliseconds( 10 ) );
+      notifications = 0;
+
+      int64_t apply_us = 0;
+      int64_t delivery_us = 0;
+      for( uint32_t b = 0; b < blocks; ++b )
+      {
+         for( uint32_t t = 0; t < transfers_per_block; ++t )
+         {
+            const uint32_t from = pick( rng );
+            const uint32_t to = ( from + 1 + pick( rng ) % ( num_accounts - 1 ) ) % num_accounts;
+            transfer( accounts[from], accounts[to], asset( 1 ) );
+         }
+         for( uint32_t o = 0; o < orders_per_block; ++o )
+            create_sell_order( issuer_id, asset( 1000, bench_id ), asset( 1000 + o ) );
+
+         auto start = fc::time_point::now();
+         generate_block();
+         apply_us += ( fc::time_point::now() - start ).count();
+
+         // the notifications are delivered by tasks which run when this thread yields
+         start = fc::time_point::now();
+         fc::yield();
+         delivery_us += ( fc::time_point::now() - start ).count();
+      }
+      fc::usleep( fc::milliseconds( 10 ) );
+
+      wlog( "${s} subscribers: ${a} us per block to generate, ${d} us per block to deliver ${n} notifications",
+            ("s", subscribers)("a", apply_us / blocks)("d", delivery_us / blocks)("n", notifications) );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
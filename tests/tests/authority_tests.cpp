@@ -1371,6 +1371,197 @@ BOOST_FIXTURE_TEST_CASE( nonminimal_sig_test, database_fixture )
    }
 }
 
+/*
+ * Nested multisig, minimize_required_signatures() must keep the smallest set it can reach by dropping keys
+ *
+ *             +-- styx (2 of alice, bob, cindy)
+ *  roco (2) --+-- thud (1 of daisy, edwin)
+ *             +-- frank_key
+ *
+ * and a custom authority which lets frank alone transfer from roco to bob.
+ */
+BOOST_FIXTURE_TEST_CASE( minimize_nested_multisig_test, database_fixture )
+{
+   try
+   {
+      generate_blocks( HARDFORK_BSIP_40_TIME );
+      generate_blocks( 5 );
+      db.modify( global_property_id_type()(db), []( global_property_object& gpo ) {
+         gpo.parameters.extensions.value.custom_authority_options = custom_authority_options_type();
+      });
+      set_expiration( db, trx );
+
+      ACTORS(
+         (alice)(bob)(cindy)(daisy)(edwin)(frank)
+         (roco)(styx)(thud)
+         );
+
+      auto set_auth = [&]( account_id_type aid, const authority& auth )
+      {
+         signed_transaction tx;
+         account_update_operation op;
+         op.account = aid;
+         op.active = auth;
+         op.owner = auth;
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         PUSH_TX( db, tx, database::skip_transaction_signatures );
+      };
+      auto get_active = [&]( account_id_type aid ) -> const authority* { return &(aid(db).active); };
+      auto get_owner = [&]( account_id_type aid ) -> const authority* { return &(aid(db).owner); };
+      auto get_custom = make_get_custom( db );
+
+      authority styx_auth( 2, alice_id, 1, bob_id, 1 );
+      styx_auth.add_authority( cindy_id, 1 );
+      set_auth( styx_id, styx_auth );
+      set_auth( thud_id, authority( 1, daisy_id, 1, edwin_id, 1 ) );
+      authority roco_auth( 2, styx_id, 1, thud_id, 1 );
+      roco_auth.add_authority( frank_public_key, 1 );
+      set_auth( roco_id, roco_auth );
+
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = roco_id;
+      op.to = bob_id;
+      op.amount = asset(1);
+      tx.operations.push_back( op );
+
+      const flat_set<public_key_type> all_keys = { alice_public_key, bob_public_key, cindy_public_key,
+                                                   daisy_public_key, edwin_public_key, frank_public_key };
+      auto minimize = [&]( const flat_set<public_key_type>& keys, bool allow_non_immediate_owner ) {
+         return tx.minimize_required_signatures( db.get_chain_id(), keys, get_active, get_owner, get_custom,
+                                                 allow_non_immediate_owner, false );
+      };
+      auto check_minimal = [&]( const set<public_key_type>& result ) {
+         const flat_set<public_key_type> keys( result.begin(), result.end() );
+         verify_authority( tx.operations, keys, get_active, get_owner, get_custom, true, false );
+         for( const auto& k : result )
+         {
+            flat_set<public_key_type> fewer = keys;
+            fewer.erase( k );
+            GRAPHENE_CHECK_THROW( verify_authority( tx.operations, fewer, get_active, get_owner, get_custom,
+                                                    true, false ), fc::exception );
+         }
+      };
+
+      set<public_key_type> result = minimize( all_keys, true );
+      BOOST_CHECK_LE( result.size(), 3u );
+      check_minimal( result );
+      BOOST_CHECK( result == minimize( all_keys, false ) );
+
+      result = minimize( { alice_public_key, bob_public_key, frank_public_key }, true );
+      BOOST_CHECK( result == set<public_key_type>( { alice_public_key, bob_public_key, frank_public_key } ) );
+
+      result = minimize( { cindy_public_key, edwin_public_key, frank_public_key }, true );
+      BOOST_CHECK( result == set<public_key_type>( { edwin_public_key, frank_public_key } ) );
+
+      BOOST_TEST_MESSAGE( "A custom authority lets a single key replace the whole tree" );
+      custom_authority_create_operation cop;
+      cop.account = roco_id;
+      cop.auth = authority( 1, frank_id, 1 );
+      cop.enabled = true;
+      cop.valid_from = db.head_block_time();
+      cop.valid_to = db.head_block_time() + 1000;
+      cop.operation_type = operation::tag<transfer_operation>::value;
+      cop.restrictions = { restriction( 2, restriction::func_eq, bob_id ) }; // transfer_operation::to
+      signed_transaction ctx;
+      ctx.operations.push_back( cop );
+      set_expiration( db, ctx );
+      PUSH_TX( db, ctx, database::skip_transaction_signatures );
+
+      result = minimize( all_keys, true );
+      BOOST_CHECK( result == set<public_key_type>( { frank_public_key } ) );
+      check_minimal( result );
+   }
+   catch(fc::exception& e)
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+/*
+ * At the recursion limit verify_authority only counts an account which it has approved elsewhere before
+ *
+ *  xeno (1) ----- alice
+ *
+ *                 +-- rick_key
+ *  rick (2) ------+-- rick_key2
+ *                 +-- mike (1) -- nora (1) -- alice
+ *
+ * A transaction of xeno and rick is signed by alice and both keys of rick.  Since alice approves xeno first,
+ * she also counts for nora at the maximum depth, so one key of rick is not needed.
+ */
+BOOST_FIXTURE_TEST_CASE( minimize_at_max_recursion_test, database_fixture )
+{
+   try
+   {
+      ACTORS( (xeno)(alice)(mike)(nora)(rick) );
+      BOOST_REQUIRE( xeno_id < rick_id );
+      const fc::ecc::private_key rick_private_key2 = generate_private_key( "rick2" );
+      const public_key_type rick_public_key2 = rick_private_key2.get_public_key();
+
+      auto set_auth = [&]( account_id_type aid, const authority& auth )
+      {
+         signed_transaction tx;
+         account_update_operation op;
+         op.account = aid;
+         op.active = auth;
+         op.owner = auth;
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         PUSH_TX( db, tx, database::skip_transaction_signatures );
+      };
+      auto get_active = [&]( account_id_type aid ) -> const authority* { return &(aid(db).active); };
+      auto get_owner = [&]( account_id_type aid ) -> const authority* { return &(aid(db).owner); };
+      auto get_custom = make_get_custom( db );
+
+      set_auth( xeno_id, authority( 1, alice_id, 1 ) );
+      set_auth( nora_id, authority( 1, alice_id, 1 ) );
+      set_auth( mike_id, authority( 1, nora_id, 1 ) );
+      authority rick_auth( 2, rick_public_key, 1, rick_public_key2, 1 );
+      rick_auth.add_authority( mike_id, 1 );
+      set_auth( rick_id, rick_auth );
+
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = xeno_id;
+      op.to = rick_id;
+      op.amount = asset(1);
+      tx.operations.push_back( op );
+      op.from = rick_id;
+      op.to = xeno_id;
+      tx.operations.push_back( op );
+
+      const flat_set<public_key_type> all_keys = { alice_public_key, rick_public_key, rick_public_key2 };
+      verify_authority( tx.operations, all_keys, get_active, get_owner, get_custom, false, false,
+                        GRAPHENE_MAX_SIG_CHECK_DEPTH );
+      BOOST_CHECK( tx.get_required_signatures( db.get_chain_id(), all_keys, get_active, get_owner, false, false )
+                   == set<public_key_type>( all_keys.begin(), all_keys.end() ) );
+
+      const set<public_key_type> result = tx.minimize_required_signatures( db.get_chain_id(), all_keys,
+                                                                           get_active, get_owner, get_custom,
+                                                                           false, false,
+                                                                           GRAPHENE_MAX_SIG_CHECK_DEPTH );
+      BOOST_CHECK_EQUAL( result.size(), 2u );
+      BOOST_CHECK( result.count( alice_public_key ) == 1 );
+      const flat_set<public_key_type> keys( result.begin(), result.end() );
+      verify_authority( tx.operations, keys, get_active, get_owner, get_custom, false, false,
+                        GRAPHENE_MAX_SIG_CHECK_DEPTH );
+
+      BOOST_TEST_MESSAGE( "Without the transfer of xeno both keys of rick are needed" );
+      tx.operations.erase( tx.operations.begin() );
+      BOOST_CHECK( tx.minimize_required_signatures( db.get_chain_id(), all_keys, get_active, get_owner, get_custom,
+                                                    false, false, GRAPHENE_MAX_SIG_CHECK_DEPTH )
+                   == set<public_key_type>( { rick_public_key, rick_public_key2 } ) );
+   }
+   catch(fc::exception& e)
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 /*
  * Active vs Owner https://github.com/bitshares/bitshares-core/issues/584
  *
@@ -2400,4 +2591,85 @@ BOOST_AUTO_TEST_CASE( self_deleting_proposal )
    db.get(pid1);
 } FC_LOG_AND_RETHROW() }
 
+
+BOOST_AUTO_TEST_CASE( authority_cache_test )
+{ try {
+   generate_blocks( HARDFORK_BSIP_40_TIME );
+   generate_blocks( 5 );
+   db.modify( global_property_id_type()(db), []( global_property_object& gpo ) {
+      gpo.parameters.extensions.value.custom_authority_options = custom_authority_options_type();
+   });
+   set_expiration( db, trx );
+
+   ACTORS( (alice)(bob) );
+   fund( alice );
+
+   auto transfer = [&]( int64_t amount, const fc::ecc::private_key& key ) {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = bob_id;
+      op.amount = asset( amount );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      sign( tx, key );
+      PUSH_TX( db, tx );
+   };
+
+   BOOST_TEST_MESSAGE( "A repeat signer is answered from the cache" );
+   transfer( 1, alice_private_key );
+   authority_cache_metrics before = db.get_authority_cache_metrics();
+   transfer( 2, alice_private_key );
+   authority_cache_metrics after = db.get_authority_cache_metrics();
+   BOOST_CHECK_EQUAL( after.hits, before.hits + 1 );
+   BOOST_CHECK_EQUAL( after.misses, before.misses );
+   BOOST_CHECK_GT( after.size, 0u );
+
+   BOOST_TEST_MESSAGE( "Changing the keys of alice drops her results" );
+   const fc::ecc::private_key new_key = generate_private_key( "alice2" );
+   {
+      signed_transaction tx;
+      account_update_operation op;
+      op.account = alice_id;
+      op.active = authority( 1, public_key_type( new_key.get_public_key() ), 1 );
+      op.owner = op.active;
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      PUSH_TX( db, tx, database::skip_transaction_signatures );
+   }
+   before = after;
+   after = db.get_authority_cache_metrics();
+   BOOST_CHECK_GT( after.invalidations, before.invalidations );
+   GRAPHENE_REQUIRE_THROW( transfer( 3, alice_private_key ), tx_missing_active_auth );
+   transfer( 4, new_key );
+
+   BOOST_TEST_MESSAGE( "Checks of accounts with custom authorities are not cached" );
+   {
+      custom_authority_create_operation op;
+      op.account = alice_id;
+      op.auth = authority( 1, bob_id, 1 );
+      op.enabled = true;
+      op.valid_from = db.head_block_time();
+      op.valid_to = db.head_block_time() + 1000;
+      op.operation_type = operation::tag<transfer_operation>::value;
+      signed_transaction tx;
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      PUSH_TX( db, tx, database::skip_transaction_signatures );
+   }
+   before = db.get_authority_cache_metrics();
+   transfer( 5, new_key );
+   transfer( 6, bob_private_key );
+   after = db.get_authority_cache_metrics();
+   BOOST_CHECK_EQUAL( after.uncacheable, before.uncacheable + 2 );
+   BOOST_CHECK_EQUAL( after.hits, before.hits );
+
+   BOOST_TEST_MESSAGE( "A size of 0 disables the cache" );
+   db.set_authority_cache_size( 0 );
+   BOOST_CHECK_EQUAL( db.get_authority_cache_metrics().size, 0u );
+   transfer( 7, bob_private_key );
+
+   generate_block();
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -29,11 +29,13 @@
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/exceptions.hpp>
+#include <graphene/chain/market_object.hpp>
 
 #include <graphene/db/simple_index.hpp>
 
 #include <fc/crypto/digest.hpp>
 #include <fc/crypto/hex.hpp>
+#include <fc/io/json.hpp>
 #include "../common/database_fixture.hpp"
 
 #include <algorithm>
@@ -453,6 +455,70 @@ BOOST_AUTO_TEST_CASE( price_multiplication_test )
    }
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( ranked_price_test )
+{ try {
+   ranked_price_less less;
+   ranked_price_greater greater;
+   const auto check_same_order = [&less,&greater]( const price& a, const price& b )
+   {
+      const ranked_price ra( a );
+      const ranked_price rb( b );
+      BOOST_CHECK_EQUAL( less( ra, rb ), a < b );
+      BOOST_CHECK_EQUAL( less( rb, ra ), b < a );
+      BOOST_CHECK_EQUAL( greater( ra, rb ), a > b );
+      BOOST_CHECK_EQUAL( less( ra, b ), a < b );
+      BOOST_CHECK_EQUAL( less( a, rb ), a < b );
+   };
+
+   // prices of the same value have the same rank
+   BOOST_CHECK( ranked_price( price( asset(1), asset(3, asset_id_type(1)) ) ).get_rank()
+                == ranked_price( price( asset(1000), asset(3000, asset_id_type(1)) ) ).get_rank() );
+   // prices without a positive amount have no rank
+   BOOST_CHECK( ranked_price().get_rank() == 0 );
+   BOOST_CHECK( ranked_price( price( asset(0), asset(1, asset_id_type(1)) ) ).get_rank() == 0 );
+
+   const price pmax = price::max( asset_id_type(), asset_id_type(1) );
+   const price pmin = price::min( asset_id_type(), asset_id_type(1) );
+   check_same_order( pmax, pmin );
+   check_same_order( pmin, price( asset(1), asset(GRAPHENE_MAX_SHARE_SUPPLY - 1, asset_id_type(1)) ) );
+   check_same_order( pmax, price( asset(GRAPHENE_MAX_SHARE_SUPPLY - 1), asset(1, asset_id_type(1)) ) );
+   check_same_order( price( asset(0), asset(1, asset_id_type(1)) ), pmin );
+   // different markets
+   check_same_order( pmax, price::min( asset_id_type(), asset_id_type(2) ) );
+   check_same_order( pmax, price::min( asset_id_type(1), asset_id_type() ) );
+
+   // random prices, with neighbours and multiples which may share their ranks
+   std::mt19937_64 gen( time(NULL) );
+   std::uniform_int_distribution<int64_t> amt_uid(1, GRAPHENE_MAX_SHARE_SUPPLY);
+   std::uniform_int_distribution<int64_t> amt_uid2(1, 1000);
+   for( int i = 0; i < 100*1000; ++i )
+   {
+      const int64_t base = ( i % 2 == 0 ) ? amt_uid(gen) : amt_uid2(gen);
+      const int64_t quote = ( i % 3 == 0 ) ? amt_uid(gen) : amt_uid2(gen);
+      const price a( asset(base), asset(quote, asset_id_type(1)) );
+      check_same_order( a, price( asset(amt_uid(gen)), asset(amt_uid(gen), asset_id_type(1)) ) );
+      check_same_order( a, price( asset(base), asset(quote + 1, asset_id_type(1)) ) );
+      check_same_order( a, price( asset(base - 1), asset(quote, asset_id_type(1)) ) );
+      if( base <= GRAPHENE_MAX_SHARE_SUPPLY / 3 && quote <= GRAPHENE_MAX_SHARE_SUPPLY / 3 )
+      {
+         check_same_order( a, price( asset(base * 3), asset(quote * 3, asset_id_type(1)) ) );
+         check_same_order( a, price( asset(base * 3 + 1), asset(quote * 3, asset_id_type(1)) ) );
+      }
+   }
+
+   // the rank is not serialized but restored
+   const ranked_price r( price( asset(7), asset(11, asset_id_type(1)) ) );
+   ranked_price unpacked;
+   unpacked = fc::raw::unpack<price>( fc::raw::pack( static_cast<const price&>( r ) ) );
+   BOOST_CHECK( unpacked.get_rank() == r.get_rank() );
+   fc::raw::unpack( fc::raw::pack( r ), unpacked );
+   BOOST_CHECK( unpacked.get_rank() == r.get_rank() );
+   BOOST_CHECK_EQUAL( fc::json::to_string( r ), fc::json::to_string( static_cast<const price&>( r ) ) );
+   const ranked_price from_json = fc::json::from_string( fc::json::to_string( r ) ).as<ranked_price>( 2 );
+   BOOST_CHECK( from_json.get_rank() == r.get_rank() );
+   BOOST_CHECK( from_json == r );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( memo_test )
 { try {
    memo_data m;
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/binary_rpc.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( binary_rpc_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( binary_rpc_calls )
+{ try {
+   ACTORS( (alice) );
+   transfer( account_id_type(), alice_id, asset( 10000 ) );
+   generate_blocks( 20 );
+
+   graphene::app::binary_rpc_server server( app );
+   server.listen( fc::ip::endpoint::from_string( "127.0.0.1:0" ) );
+   graphene::app::binary_rpc_client client( server.get_listening_endpoint() );
+   BOOST_CHECK_EQUAL( client.get_welcome().protocol_version, graphene::app::binary_rpc_protocol_version );
+   BOOST_CHECK( client.get_welcome().chain_id == db.get_chain_id() );
+
+   // the first blocks are irreversible and come from the block log, the last one from the fork database
+   for( const uint32_t block_num : { 1u, db.head_block_num() } )
+   {
+      const auto block = client.call< optional<signed_block> >( "get_block", block_num );
+      BOOST_REQUIRE( block.valid() );
+      BOOST_CHECK( block->id() == db.fetch_block_by_number( block_num )->id() );
+   }
+   BOOST_CHECK( !client.call< optional<signed_block> >( "get_block", db.head_block_num() + 1 ).valid() );
+
+   const auto blocks = client.call< vector<optional<signed_block>> >( "get_blocks", db.head_block_num() - 1, 3u );
+   BOOST_REQUIRE_EQUAL( blocks.size(), 3u );
+   BOOST_CHECK( blocks[0].valid() && blocks[0]->block_num() == db.head_block_num() - 1 );
+   BOOST_CHECK( blocks[1].valid() && blocks[1]->block_num() == db.head_block_num() );
+   BOOST_CHECK( !blocks[2].valid() );
+   BOOST_CHECK_THROW( client.call< vector<optional<signed_block>> >( "get_blocks", 1u,
+                                                                     graphene::app::binary_rpc_max_blocks + 1 ),
+                      fc::exception );
+
+   // objects are packed as the type which their ID refers to
+   const std::vector<char> packed_objects = client.call_packed( "get_objects",
+         fc::raw::pack( vector<object_id_type>{ alice_id, account_id_type( 10000 ), asset_id_type() } ) );
+   fc::datastream<const char*> ds( packed_objects.data(), packed_objects.size() );
+   fc::unsigned_int count;
+   fc::raw::unpack( ds, count );
+   BOOST_REQUIRE_EQUAL( count.value, 3u );
+   optional<account_object> account;
+   fc::raw::unpack( ds, account );
+   BOOST_REQUIRE( account.valid() );
+   BOOST_CHECK_EQUAL( account->name, "alice" );
+   fc::raw::unpack( ds, account );
+   BOOST_CHECK( !account.valid() );
+   optional<asset_object> core;
+   fc::raw::unpack( ds, core );
+   BOOST_REQUIRE( core.valid() );
+   BOOST_CHECK_EQUAL( core->symbol, GRAPHENE_SYMBOL );
+
+   const auto accounts = client.call< std::map<string, graphene::app::full_account, std::less<>> >(
+         "get_full_accounts", vector<string>{ "alice" } );
+   BOOST_REQUIRE_EQUAL( accounts.size(), 1u );
+   BOOST_CHECK_EQUAL( accounts.at( "alice" ).balances.size(), 1u );
+   BOOST_CHECK_EQUAL( accounts.at( "alice" ).balances[0].balance.value, 10000 );
+
+   BOOST_CHECK( client.call<dynamic_global_property_object>( "get_dynamic_global_properties" ).head_block_number
+                == db.head_block_num() );
+
+   // a failed call does not end the connection
+   BOOST_CHECK_THROW( client.call_packed( "no_such_method", {} ), fc::exception );
+   BOOST_CHECK( client.call< optional<signed_block> >( "get_block", 1u ).valid() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
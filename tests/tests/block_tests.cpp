@@ -40,6 +40,10 @@
 
 #include <fc/crypto/digest.hpp>
 #include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
+
+#include <atomic>
+#include <thread>
 
 #include "../common/database_fixture.hpp"
 
@@ -133,6 +137,150 @@ BOOST_AUTO_TEST_CASE( block_database_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( block_database_remove_and_concurrent_read_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      block_database bdb;
+      bdb.open( data_dir.path() );
+      FC_ASSERT( !bdb.last_id().valid() );
+      FC_ASSERT( !bdb.fetch_by_number( 1 ).valid() );
+
+      const uint32_t num_blocks = 200;
+      std::vector<block_id_type> ids;
+      clearable_block b;
+      for( uint32_t i = 0; i < num_blocks; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         b.clear();
+         bdb.store( b.id(), b );
+         ids.push_back( b.id() );
+      }
+      FC_ASSERT( bdb.total_block_size() > 0 );
+
+      // readers must be able to run in parallel while the writer appends
+      std::vector<std::thread> readers;
+      std::atomic<uint32_t> failures( 0 );
+      for( uint32_t t = 0; t < 4; ++t )
+         readers.emplace_back( [&bdb,&ids,&failures,t,num_blocks]() {
+            for( uint32_t n = 0; n < 10 * num_blocks; ++n )
+            {
+               const uint32_t num = 1 + ( n * 7 + t ) % num_blocks;
+               auto blk = bdb.fetch_by_number( num );
+               if( !blk.valid() || blk->id() != ids[num-1] || !bdb.contains( ids[num-1] )
+                     || bdb.fetch_block_id( num ) != ids[num-1] )
+                  ++failures;
+            }
+         });
+      for( uint32_t i = num_blocks; i < num_blocks + 50; ++i )
+      {
+         b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         b.clear();
+         bdb.store( b.id(), b );
+         ids.push_back( b.id() );
+      }
+      for( auto& reader : readers )
+         reader.join();
+      BOOST_CHECK_EQUAL( failures.load(), 0u );
+
+      // removing the last block makes the previous one the last
+      bdb.remove( ids.back() );
+      FC_ASSERT( !bdb.contains( ids.back() ) );
+      FC_ASSERT( !bdb.fetch_optional( ids.back() ).valid() );
+      FC_ASSERT( *bdb.last_id() == ids[ids.size() - 2] );
+
+      bdb.close();
+      bdb.open( data_dir.path() );
+      FC_ASSERT( *bdb.last_id() == ids[ids.size() - 2] );
+      for( uint32_t i = 0; i + 1 < ids.size(); ++i )
+      {
+         auto blk = bdb.fetch_optional( ids[i] );
+         FC_ASSERT( blk.valid() );
+         FC_ASSERT( blk->witness == witness_id_type(i+1) );
+      }
+      FC_ASSERT( !bdb.contains( block_id_type() ) );
+      FC_ASSERT( !bdb.fetch_by_number( uint32_t( ids.size() ) + 10 ).valid() );
+
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( compressed_block_database_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      block_database bdb;
+      bdb.enable_compression( 16 );
+      bdb.open( data_dir.path() );
+      FC_ASSERT( bdb.is_compressed() );
+
+      // enough blocks to span several segments
+      const uint32_t num_blocks = 100;
+      std::vector<block_id_type> ids;
+      clearable_block b;
+      for( uint32_t i = 0; i < num_blocks; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         b.clear();
+         bdb.store( b.id(), b );
+         ids.push_back( b.id() );
+
+         auto fetch = bdb.fetch_by_number( b.block_num() );
+         FC_ASSERT( fetch.valid() );
+         FC_ASSERT( fetch->id() == b.id() );
+      }
+      for( uint32_t i = 0; i < num_blocks; ++i )
+      {
+         auto blk = bdb.fetch_optional( ids[i] );
+         FC_ASSERT( blk.valid() );
+         FC_ASSERT( blk->witness == witness_id_type(i+1) );
+         FC_ASSERT( bdb.fetch_block_id( i+1 ) == ids[i] );
+      }
+
+      bdb.remove( ids.back() );
+      FC_ASSERT( !bdb.contains( ids.back() ) );
+      FC_ASSERT( *bdb.last_id() == ids[num_blocks - 2] );
+
+      // the format of an existing log wins over the settings
+      bdb.close();
+      bdb.enable_compression( 0 );
+      bdb.open( data_dir.path() );
+      FC_ASSERT( bdb.is_compressed() );
+      FC_ASSERT( *bdb.last_id() == ids[num_blocks - 2] );
+
+      // appending after reopening starts a new segment
+      b.previous = ids[num_blocks - 2];
+      b.witness = witness_id_type(1000);
+      b.clear();
+      bdb.store( b.id(), b );
+      for( uint32_t i = 0; i + 1 < num_blocks; ++i )
+         FC_ASSERT( bdb.fetch_by_number( i+1 )->id() == ids[i] );
+      FC_ASSERT( bdb.fetch_by_number( num_blocks )->witness == witness_id_type(1000) );
+      bdb.close();
+
+      // uncompressed logs stay uncompressed
+      fc::temp_directory plain_dir( graphene::utilities::temp_directory_path() );
+      bdb.open( plain_dir.path() );
+      FC_ASSERT( !bdb.is_compressed() );
+      bdb.close();
+      bdb.enable_compression( 16 );
+      bdb.open( plain_dir.path() );
+      FC_ASSERT( !bdb.is_compressed() );
+      bdb.close();
+
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( generate_empty_blocks )
 {
    try {
@@ -192,6 +340,82 @@ BOOST_AUTO_TEST_CASE( generate_empty_blocks )
    }
 }
 
+BOOST_AUTO_TEST_CASE( reindex_pipeline_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+
+      // the state which is affected by every block
+      auto get_state = []( const database& db ) {
+         std::string state = fc::json::to_string( db.get_dynamic_global_properties() )
+                           + fc::json::to_string( db.get_witness_schedule_object() );
+         for( const witness_object& wit : db.get_index_type<witness_index>().indices() )
+            state += fc::json::to_string( wit );
+         return state;
+      };
+
+      const uint32_t num_blocks = 150;
+      const uint32_t gap_block = 100;
+      std::vector<block_id_type> ids;
+      std::vector<std::string> states;
+      {
+         database db;
+         db.open( data_dir.path(), make_genesis, "TEST" );
+         for( uint32_t i = 1; i <= num_blocks; ++i )
+         {
+            // miss some slots, so that the blocks differ in more than their number
+            const uint32_t slot = 1 + i % 3;
+            db.generate_block( db.get_slot_time( slot ), db.get_scheduled_witness( slot ), init_account_priv_key,
+                               database::skip_nothing );
+            ids.push_back( db.head_block_id() );
+            states.push_back( get_state( db ) );
+         }
+         db.close();
+      }
+
+      // replay the whole block log through small queues, so that the pipeline stages wait for each other
+      {
+         database db;
+         db.set_reindex_read_ahead( 3 );
+         db.set_reindex_precompute_depth( 2 );
+         db.open( data_dir.path(), make_genesis, "TEST2" ); // a new version wipes the object database
+         BOOST_CHECK_EQUAL( db.head_block_num(), num_blocks );
+         BOOST_CHECK( db.head_block_id() == ids.back() );
+         BOOST_CHECK( get_state( db ) == states.back() );
+         db.close();
+      }
+
+      // remove a block from the block log, the replay stops before it and drops the blocks after it
+      {
+         block_database bdb;
+         bdb.open( data_dir.path() / "database" / "block_num_to_block" );
+         bdb.remove( ids[gap_block - 1] );
+         bdb.close();
+      }
+      {
+         database db;
+         db.set_reindex_read_ahead( 4 );
+         db.set_reindex_precompute_depth( 3 );
+         db.open( data_dir.path(), make_genesis, "TEST3" );
+         BOOST_CHECK_EQUAL( db.head_block_num(), gap_block - 1 );
+         BOOST_CHECK( db.head_block_id() == ids[gap_block - 2] );
+         BOOST_CHECK( get_state( db ) == states[gap_block - 2] );
+         BOOST_CHECK( !db.fetch_block_by_number( gap_block ).valid() );
+         BOOST_CHECK( !db.fetch_block_by_number( num_blocks ).valid() );
+
+         // the chain continues from the gap
+         db.generate_block( db.get_slot_time( 1 ), db.get_scheduled_witness( 1 ), init_account_priv_key,
+                            database::skip_nothing );
+         BOOST_CHECK_EQUAL( db.head_block_num(), gap_block );
+         db.close();
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( undo_block )
 {
    try {
@@ -484,6 +708,76 @@ BOOST_AUTO_TEST_CASE( fork_blocks )
 }
 
 
+BOOST_AUTO_TEST_CASE( persistent_fork_db_test )
+{
+   try {
+      fc::temp_directory data_dir1( graphene::utilities::temp_directory_path() );
+      fc::temp_directory data_dir2( graphene::utilities::temp_directory_path() );
+
+      auto init_account_priv_key  = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+
+      database db2;
+      db2.open(data_dir2.path(), make_genesis, "TEST");
+
+      block_id_type db1_tip;
+      {
+         database db1;
+         db1.enable_fork_db_persistence( true );
+         db1.open(data_dir1.path(), make_genesis, "TEST");
+
+         BOOST_TEST_MESSAGE( "Adding blocks 1 through 11" );
+         const auto first_slot = db1.get_slot_at_time( fc::time_point::now() );
+         PUSH_BLOCK( db2, db1.generate_block( db1.get_slot_time(first_slot), db1.get_scheduled_witness(first_slot),
+                                              init_account_priv_key, database::skip_nothing ) );
+         for( uint32_t i = 2; i <= 11; ++i )
+            PUSH_BLOCK( db2, db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness(1),
+                                                 init_account_priv_key, database::skip_nothing ) );
+
+         BOOST_TEST_MESSAGE( "Adding blocks 12 through 14 on two different forks" );
+         for( uint32_t i = 12; i <= 14; ++i )
+            db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness(1), init_account_priv_key,
+                                database::skip_nothing );
+         db1_tip = db1.head_block_id();
+         uint32_t next_slot = 3;
+         for( uint32_t i = 12; i <= 14; ++i )
+         {
+            PUSH_BLOCK( db1, db2.generate_block( db2.get_slot_time(next_slot), db2.get_scheduled_witness(next_slot),
+                                                 init_account_priv_key, database::skip_nothing ) );
+            next_slot = 1;
+         }
+         BOOST_CHECK( db1.head_block_id() == db1_tip );
+         BOOST_CHECK_EQUAL( db1.get_fork_db_metrics().branch_count, 2u );
+
+         db1.close();
+      }
+
+      BOOST_TEST_MESSAGE( "Reopening, the competing fork must survive the restart" );
+      database db1;
+      db1.enable_fork_db_persistence( true );
+      db1.open(data_dir1.path(), make_genesis, "TEST");
+      BOOST_CHECK( db1.head_block_id() == db1_tip );
+      BOOST_CHECK_EQUAL( db1.head_block_num(), 14u );
+
+      fork_database_metrics metrics = db1.get_fork_db_metrics();
+      BOOST_CHECK_EQUAL( metrics.branch_count, 2u );
+      BOOST_CHECK_GE( metrics.depth, 3u );
+      BOOST_CHECK_EQUAL( metrics.fork_switches, 0u );
+      BOOST_CHECK( db1.fetch_block_by_id( db2.head_block_id() ).valid() );
+
+      BOOST_TEST_MESSAGE( "Extending the restored fork, db1 must switch to it" );
+      PUSH_BLOCK( db1, db2.generate_block( db2.get_slot_time(1), db2.get_scheduled_witness(1),
+                                           init_account_priv_key, database::skip_nothing ) );
+      BOOST_CHECK( db1.head_block_id() == db2.head_block_id() );
+      metrics = db1.get_fork_db_metrics();
+      BOOST_CHECK_EQUAL( metrics.fork_switches, 1u );
+      BOOST_CHECK( metrics.last_switch_latency > fc::microseconds() );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+
 /**
  *  These test has been disabled, out of order blocks should result in the node getting disconnected.
  *  
@@ -1949,4 +2243,164 @@ BOOST_FIXTURE_TEST_CASE( block_size_test, database_fixture )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( pending_transaction_pool_test, database_fixture )
+{
+   try
+   {
+      ACTORS((alice)(bob)(carol)(dave));
+
+      const fc::ecc::private_key& key = generate_private_key("null_key");
+      for( const account_id_type& id : { alice_id, bob_id, carol_id, dave_id } )
+         transfer( committee_account, id, asset(100000) );
+      generate_block();
+
+      auto make_transfer = [&]( account_id_type from, const fc::ecc::private_key& from_key, int64_t fee )
+      {
+         signed_transaction tx;
+         transfer_operation xfer_op;
+         xfer_op.from = from;
+         xfer_op.to = committee_account;
+         xfer_op.amount = asset(1);
+         xfer_op.fee = asset(fee);
+         tx.operations.push_back( xfer_op );
+         tx.set_expiration( db.head_block_time() + fc::minutes(10) );
+         tx.set_reference_block( db.head_block_id() );
+         sign( tx, from_key );
+         return tx;
+      };
+      // an empty block, which does not touch the accounts of the pending transactions
+      auto push_empty_block = [&]()
+      {
+         signed_block b;
+         b.previous = db.head_block_id();
+         b.timestamp = db.get_slot_time(1);
+         b.witness = db.get_scheduled_witness(1);
+         b.transaction_merkle_root = b.calculate_merkle_root();
+         b.sign( key );
+         PUSH_BLOCK( db, b, database::skip_nothing );
+      };
+
+      const pending_transaction_pool_metrics initial = db.get_pending_transaction_pool_metrics();
+      BOOST_CHECK_EQUAL( initial.size, 0u );
+
+      BOOST_TEST_MESSAGE( "Pushing transactions with different fees" );
+      PUSH_TX( db, make_transfer( alice_id, alice_private_key, 100 ), database::skip_nothing );
+      PUSH_TX( db, make_transfer( bob_id, bob_private_key, 300 ), database::skip_nothing );
+      PUSH_TX( db, make_transfer( carol_id, carol_private_key, 200 ), database::skip_nothing );
+      pending_transaction_pool_metrics metrics = db.get_pending_transaction_pool_metrics();
+      BOOST_CHECK_EQUAL( metrics.size, 3u );
+      BOOST_CHECK_EQUAL( metrics.accepted, initial.accepted + 3 );
+
+      BOOST_TEST_MESSAGE( "A block which does not touch their accounts keeps them, with cached authority checks" );
+      const authority_cache_metrics initial_cache = db.get_authority_cache_metrics();
+      push_empty_block();
+      metrics = db.get_pending_transaction_pool_metrics();
+      BOOST_CHECK_EQUAL( metrics.size, 3u );
+      BOOST_CHECK_EQUAL( metrics.revalidated, initial.revalidated + 3 );
+      BOOST_CHECK_GE( db.get_authority_cache_metrics().hits, initial_cache.hits + 3 );
+
+      BOOST_TEST_MESSAGE( "A full pool rejects a transaction with a lower fee" );
+      const uint64_t max_size = metrics.bytes - 1;
+      db.set_max_pending_transactions_size( max_size );
+      GRAPHENE_REQUIRE_THROW( PUSH_TX( db, make_transfer( dave_id, dave_private_key, 50 ), database::skip_nothing ),
+                              pending_pool_full );
+      metrics = db.get_pending_transaction_pool_metrics();
+      BOOST_CHECK_EQUAL( metrics.size, 3u );
+      BOOST_CHECK_EQUAL( metrics.rejected, initial.rejected + 1 );
+
+      BOOST_TEST_MESSAGE( "The next block evicts the transaction with the lowest fee" );
+      push_empty_block();
+      metrics = db.get_pending_transaction_pool_metrics();
+      BOOST_CHECK_EQUAL( metrics.size, 2u );
+      BOOST_CHECK_EQUAL( metrics.evicted, initial.evicted + 1 );
+      BOOST_CHECK_LE( metrics.bytes, max_size );
+
+      BOOST_TEST_MESSAGE( "Blocks are filled by decreasing fee" );
+      db.set_max_pending_transactions_size( 0 );
+      PUSH_TX( db, make_transfer( dave_id, dave_private_key, 250 ), database::skip_nothing );
+      const signed_block b = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), key,
+                                                database::skip_nothing );
+      BOOST_REQUIRE_EQUAL( b.transactions.size(), 3u );
+      BOOST_CHECK( b.transactions[0].operations[0].get<transfer_operation>().from == bob_id );
+      BOOST_CHECK( b.transactions[1].operations[0].get<transfer_operation>().from == dave_id );
+      BOOST_CHECK( b.transactions[2].operations[0].get<transfer_operation>().from == carol_id );
+      BOOST_CHECK_EQUAL( db.get_pending_transaction_pool_metrics().size, 0u );
+   }
+   catch( fc::exception& e )
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( pending_transaction_nested_authority_change_test, database_fixture )
+{
+   try
+   {
+      ACTORS((alice)(bob));
+      transfer( committee_account, alice_id, asset(100000) );
+      transfer( committee_account, bob_id, asset(100000) );
+
+      BOOST_TEST_MESSAGE( "Letting bob approve the transactions of alice" );
+      {
+         signed_transaction tx;
+         account_update_operation op;
+         op.account = alice_id;
+         op.active = authority( 1, bob_id, 1 );
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         sign( tx, alice_private_key );
+         PUSH_TX( db, tx, database::skip_nothing );
+      }
+      generate_block();
+
+      BOOST_TEST_MESSAGE( "Pushing a transfer of alice signed by bob" );
+      signed_transaction alice_tx;
+      {
+         transfer_operation xfer_op;
+         xfer_op.from = alice_id;
+         xfer_op.to = committee_account;
+         xfer_op.amount = asset(1);
+         alice_tx.operations.push_back( xfer_op );
+         set_expiration( db, alice_tx );
+         sign( alice_tx, bob_private_key );
+      }
+      PUSH_TX( db, alice_tx, database::skip_nothing );
+
+      BOOST_TEST_MESSAGE( "Pushing a change of the key of bob, which does not touch alice" );
+      const fc::ecc::private_key bob_new_key = generate_private_key( "bob_new" );
+      processed_transaction bob_tx;
+      {
+         signed_transaction tx;
+         account_update_operation op;
+         op.account = bob_id;
+         op.active = authority( 1, public_key_type( bob_new_key.get_public_key() ), 1 );
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         sign( tx, bob_private_key );
+         bob_tx = PUSH_TX( db, tx, database::skip_nothing );
+      }
+      BOOST_CHECK_EQUAL( db.get_pending_transaction_pool_metrics().size, 2u );
+
+      BOOST_TEST_MESSAGE( "A block with the change of bob drops the transfer of alice" );
+      signed_block b;
+      b.transactions.push_back( bob_tx );
+      b.previous = db.head_block_id();
+      b.timestamp = db.get_slot_time(1);
+      b.witness = db.get_scheduled_witness(1);
+      b.transaction_merkle_root = b.calculate_merkle_root();
+      b.sign( generate_private_key("null_key") );
+      PUSH_BLOCK( db, b, database::skip_nothing );
+
+      BOOST_CHECK_EQUAL( db.get_pending_transaction_pool_metrics().size, 0u );
+      BOOST_CHECK( !db.is_known_transaction( alice_tx.id() ) );
+      BOOST_CHECK( db.is_known_transaction( bob_tx.id() ) );
+   }
+   catch( fc::exception& e )
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -454,6 +454,44 @@ BOOST_AUTO_TEST_CASE(container_in_not_in_checks) { try {
    BOOST_CHECK(!pred(op));
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE(custom_authority_predicate_cache) { try {
+   custom_authority_object cao;
+   cao.operation_type = operation::tag<transfer_operation>::value;
+
+   // An empty restriction list accepts every operation of the type, and nothing else
+   transfer_operation transfer;
+   BOOST_CHECK(cao.get_predicate()(transfer) == true);
+   BOOST_CHECK_THROW(cao.get_predicate()(limit_order_cancel_operation()), fc::assert_exception);
+
+   // The cached predicate is used until the cache is cleared
+   cao.restrictions[0] = restriction(member_index<transfer_operation>("to"), FUNC(eq), account_id_type(12));
+   BOOST_CHECK(cao.get_predicate()(transfer) == true);
+   cao.clear_predicate_cache();
+   auto result = cao.get_predicate()(transfer);
+   BOOST_CHECK(result == false);
+   // A single restriction is still referenced in the rejection path
+   BOOST_REQUIRE_EQUAL(result.rejection_path.size(), 2u);
+   BOOST_CHECK_EQUAL(result.rejection_path[0].get<size_t>(), 0u);
+   BOOST_CHECK(result.rejection_path[1].get<predicate_result::rejection_reason>()
+               == predicate_result::predicate_was_false);
+   transfer.to = account_id_type(12);
+   BOOST_CHECK(cao.get_predicate()(transfer) == true);
+
+   // Failures of the second restriction point at it, whether or not the first one holds
+   cao.restrictions[1] = restriction(member_index<transfer_operation>("amount"), FUNC(attr),
+                                     vector<restriction>{restriction(member_index<asset>("amount"), FUNC(le),
+                                                                     int64_t(100))});
+   cao.clear_predicate_cache();
+   transfer.amount = asset(101);
+   result = cao.get_predicate()(transfer);
+   BOOST_CHECK(result == false);
+   BOOST_REQUIRE_EQUAL(result.rejection_path.size(), 3u);
+   BOOST_CHECK_EQUAL(result.rejection_path[0].get<size_t>(), 1u);
+   BOOST_CHECK_EQUAL(result.rejection_path[1].get<size_t>(), 0u);
+   transfer.amount = asset(100);
+   BOOST_CHECK(cao.get_predicate()(transfer) == true);
+} FC_LOG_AND_RETHROW() }
+
    /**
     * Test predicates containing logical ORs
     * Test of authorization and revocation of one account (Alice) authorizing multiple other accounts (Bob and Charlie)
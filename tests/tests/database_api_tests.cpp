@@ -25,6 +25,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <graphene/app/database_api.hpp>
+#include <graphene/app/read_replica.hpp>
 #include <graphene/chain/hardfork.hpp>
 
 #include <fc/crypto/digest.hpp>
@@ -791,6 +792,49 @@ BOOST_AUTO_TEST_CASE( subscription_key_collision_test )
    BOOST_CHECK_EQUAL( objects_changed, 0 ); // UIATEST did not change in this block, so no notification
 } FC_CAPTURE_LOG_AND_RETHROW( (0) ) }
 
+BOOST_AUTO_TEST_CASE( shared_subscription_fanout_test )
+{ try {
+   ACTORS( (alice) );
+   fund( alice );
+   generate_block();
+
+   graphene::app::application_options opt = app.get_options();
+   const size_t connections = 10;
+   std::vector<uint32_t> objects_changed( connections, 0 );
+   std::vector< std::unique_ptr<graphene::app::database_api> > apis;
+   for( size_t i = 0; i < connections; ++i )
+   {
+      apis.push_back( std::make_unique<graphene::app::database_api>( db, &opt ) );
+      apis.back()->set_subscribe_callback( [&objects_changed,i]( const variant& ) { ++objects_changed[i]; }, false );
+      // only the first half subscribes to alice
+      if( i < connections / 2 )
+         apis.back()->get_full_accounts( { "alice" }, true );
+   }
+
+   const auto check_notified = [&]( size_t first_subscribed, size_t end_subscribed ) {
+      std::vector<uint32_t> before = objects_changed;
+      transfer( account_id_type(), alice_id, asset(1) );
+      generate_block();
+      fc::usleep(fc::milliseconds(200)); // sleep a while to execute callback in another thread
+      for( size_t i = 0; i < connections; ++i )
+      {
+         if( apis[i] == nullptr )
+            continue;
+         if( i >= first_subscribed && i < end_subscribed )
+            BOOST_CHECK_GT( objects_changed[i], before[i] );
+         else
+            BOOST_CHECK_EQUAL( objects_changed[i], before[i] );
+      }
+   };
+
+   check_notified( 0, connections / 2 );
+
+   // closing a connection or cancelling its subscriptions does not affect the others
+   apis[0].reset();
+   apis[1]->cancel_all_subscriptions();
+   check_notified( 2, connections / 2 );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( subscription_notification_test )
 {
    try {
@@ -2125,4 +2169,149 @@ BOOST_AUTO_TEST_CASE( get_trade_history )
 } FC_LOG_AND_RETHROW() }
 
 
+BOOST_AUTO_TEST_CASE( read_replicas_follow_the_chain )
+{ try {
+   ACTORS( (alice) );
+   transfer( account_id_type(), alice_id, asset( 10000 ) );
+   generate_block();
+
+   graphene::app::application_options opt = app.get_options();
+   auto replicas = std::make_shared<graphene::app::read_replica_set>( db, &opt, 2 );
+   graphene::app::database_api db_api( db, &opt, replicas );
+
+   auto alice_balance_on_replica = [&db_api]() {
+      const auto accounts = db_api.get_full_accounts( { "alice" }, false );
+      BOOST_REQUIRE_EQUAL( accounts.size(), 1u );
+      for( const auto& balance : accounts.at( "alice" ).balances )
+         if( balance.asset_type == asset_id_type() )
+            return balance.balance;
+      return share_type();
+   };
+
+   // calls go to both replicas in turn
+   for( int i = 0; i < 2; ++i )
+   {
+      BOOST_CHECK_EQUAL( alice_balance_on_replica().value, 10000 );
+      BOOST_CHECK( db_api.list_assets( "REPL", 1 ).empty() );
+   }
+
+   create_user_issued_asset( "REPL", alice, 0 );
+   transfer( account_id_type(), alice_id, asset( 500 ) );
+   generate_block();
+
+   // the blocks are applied by a replica before the calls which are made after them
+   for( int i = 0; i < 2; ++i )
+   {
+      BOOST_CHECK_EQUAL( alice_balance_on_replica().value, db.get_balance( alice_id, asset_id_type() ).amount.value );
+      const auto assets = db_api.list_assets( "REPL", 1 );
+      BOOST_REQUIRE_EQUAL( assets.size(), 1u );
+      BOOST_CHECK_EQUAL( assets.front().symbol, "REPL" );
+   }
+
+   // a block on another fork makes the replicas undo the popped block
+   transfer( account_id_type(), alice_id, asset( 700 ) );
+   generate_block();
+   db.pop_block();
+   db.clear_pending();
+   generate_block( ~0, generate_private_key( "null_key" ), 1 );
+   for( int i = 0; i < 2; ++i )
+      BOOST_CHECK_EQUAL( alice_balance_on_replica().value, db.get_balance( alice_id, asset_id_type() ).amount.value );
+
+   // the replicas have the indexes of the plugins too, and the same next IDs after undoing the popped block
+   const auto next_ids = []( const graphene::chain::database& d ) {
+      vector<object_id_type> ids;
+      d.inspect_all_indexes( [&ids]( const graphene::db::index& idx ) { ids.push_back( idx.get_next_id() ); } );
+      return ids;
+   };
+   const vector<object_id_type> primary_next_ids = next_ids( db );
+   for( int i = 0; i < 2; ++i )
+      BOOST_CHECK( replicas->run_with_database( next_ids ) == primary_next_ids );
+
+   const auto metrics = replicas->get_metrics();
+   BOOST_CHECK_EQUAL( metrics.replicas, 2u );
+   BOOST_CHECK_EQUAL( metrics.lag, 0u );
+   BOOST_CHECK_EQUAL( metrics.resyncs, 0u );
+   BOOST_CHECK_GE( metrics.calls, 10u );
+   BOOST_CHECK_EQUAL( metrics.blocks, 6u );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( read_replicas_copy_the_state_again )
+{ try {
+   ACTORS( (alice) );
+   transfer( account_id_type(), alice_id, asset( 10000 ) );
+   generate_block();
+
+   graphene::app::application_options opt = app.get_options();
+   auto replicas = std::make_shared<graphene::app::read_replica_set>( db, &opt, 1 );
+   graphene::app::database_api db_api( db, &opt, replicas );
+
+   auto alice_balance_on_replica = [&db_api]() {
+      const auto accounts = db_api.get_full_accounts( { "alice" }, false );
+      BOOST_REQUIRE_EQUAL( accounts.size(), 1u );
+      for( const auto& balance : accounts.at( "alice" ).balances )
+         if( balance.asset_type == asset_id_type() )
+            return balance.balance;
+      return share_type();
+   };
+
+   // the replica can not undo the block which was part of its copy of the state
+   db.pop_block();
+   db.clear_pending();
+   generate_block( ~0, generate_private_key( "null_key" ), 1 );
+   fc::usleep( fc::milliseconds( 50 ) );
+   BOOST_CHECK_EQUAL( replicas->get_metrics().resyncs, 0u );
+
+   // the next block schedules a copy, which is made after the block and without the pending transactions
+   transfer( account_id_type(), alice_id, asset( 300 ) );
+   generate_block();
+   const share_type balance_at_head = db.get_balance( alice_id, asset_id_type() ).amount;
+   transfer( account_id_type(), alice_id, asset( 200 ) );
+   fc::usleep( fc::milliseconds( 50 ) );
+   BOOST_CHECK_EQUAL( replicas->get_metrics().resyncs, 1u );
+   BOOST_CHECK_EQUAL( alice_balance_on_replica().value, balance_at_head.value );
+   BOOST_CHECK_EQUAL( db.get_balance( alice_id, asset_id_type() ).amount.value, balance_at_head.value + 200 );
+
+   // the replica follows the blocks after the copy
+   generate_block();
+   BOOST_CHECK_EQUAL( alice_balance_on_replica().value, db.get_balance( alice_id, asset_id_type() ).amount.value );
+
+   const auto metrics = replicas->get_metrics();
+   BOOST_CHECK_EQUAL( metrics.lag, 0u );
+   BOOST_CHECK_EQUAL( metrics.resyncs, 1u );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( nested_batches )
+{ try {
+   ACTORS( (alice) );
+   generate_block();
+
+   graphene::app::application_options opt = app.get_options();
+   auto replicas = std::make_shared<graphene::app::read_replica_set>( db, &opt, 1 );
+   graphene::app::database_api db_api( db, &opt, replicas );
+
+   // the calls of a batch are served by the chain database, also after an inner batch has ended
+   db_api.begin_batch();
+   db_api.begin_batch();
+   BOOST_CHECK_EQUAL( db_api.get_full_accounts( { "alice" }, false ).size(), 1u );
+   db_api.end_batch();
+   // bob is only pending, so only the chain database knows him
+   create_account( "bob" );
+   BOOST_CHECK_EQUAL( db_api.get_full_accounts( { "bob" }, false ).size(), 1u );
+   BOOST_CHECK_EQUAL( replicas->get_metrics().calls, 0u );
+   db_api.end_batch();
+
+   BOOST_CHECK( db_api.get_full_accounts( { "bob" }, false ).empty() );
+   BOOST_CHECK_EQUAL( replicas->get_metrics().calls, 1u );
+
+   // ending more batches than have been started does not make the next batch end early
+   db_api.end_batch();
+   db_api.begin_batch();
+   BOOST_CHECK_EQUAL( db_api.get_full_accounts( { "bob" }, false ).size(), 1u );
+   db_api.end_batch();
+   BOOST_CHECK_EQUAL( replicas->get_metrics().calls, 1u );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -29,6 +29,8 @@
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
 
+#include <graphene/utilities/tempdir.hpp>
+
 #include <fc/crypto/digest.hpp>
 
 #include "../common/database_fixture.hpp"
@@ -138,6 +140,154 @@ BOOST_AUTO_TEST_CASE( merge_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( undo_merge_and_reuse_test )
+{ try {
+   database db;
+   auto balance_of = [&db]( const object_id_type& id ) {
+      return db.find<account_balance_object>( id );
+   };
+   auto set_balance = [&db]( const object_id_type& id, int64_t amount ) {
+      db.modify( db.get<account_balance_object>( id ), [amount]( account_balance_object& obj ) {
+         obj.balance = amount;
+      });
+   };
+
+   db._undo_db.disable();
+   std::vector<object_id_type> existing;
+   for( int64_t i = 0; i < 1000; ++i )
+      existing.push_back( db.create<account_balance_object>( [i]( account_balance_object& obj ) {
+         obj.owner = account_id_type( i );
+         obj.balance = i;
+      }).id );
+   db._undo_db.enable();
+
+   // run several rounds to exercise recycled states and arenas
+   for( int round = 0; round < 3; ++round )
+   {
+      auto outer = db._undo_db.start_undo_session();
+      set_balance( existing[0], 100 );
+      const object_id_type created_outer = db.create<account_balance_object>( []( account_balance_object& obj ) {
+         obj.owner = account_id_type( 2000 );
+      }).id;
+      {
+         auto inner = db._undo_db.start_undo_session();
+         set_balance( existing[0], 200 );                                  // upd + upd
+         db.remove( db.get<account_balance_object>( created_outer ) );     // new + del
+         db.remove( db.get<account_balance_object>( existing[1] ) );       // nop + del
+         set_balance( existing[2], 300 );                                  // nop + upd
+         const object_id_type temp = db.create<account_balance_object>( []( account_balance_object& obj ) {
+            obj.owner = account_id_type( 2001 );
+         }).id;
+         db.remove( db.get<account_balance_object>( temp ) );              // created and removed in one session
+         for( size_t i = 10; i < existing.size(); ++i )                    // more entries than the initial table
+            set_balance( existing[i], -1 );
+         inner.merge();
+      }
+      const auto& head = db._undo_db.head();
+      BOOST_REQUIRE( head.find( existing[0] ) );
+      BOOST_CHECK( head.find( existing[0] )->kind == graphene::db::undo_state::modified );
+      BOOST_CHECK_EQUAL( 0, static_cast<const account_balance_object*>( head.find( existing[0] )->old_value )
+                               ->balance.value );
+      BOOST_CHECK( head.find( created_outer ) == nullptr );
+      BOOST_REQUIRE( head.find( existing[1] ) );
+      BOOST_CHECK( head.find( existing[1] )->kind == graphene::db::undo_state::removed );
+      BOOST_CHECK_EQUAL( 0u, head.count( graphene::db::undo_state::created ) );
+      BOOST_CHECK_EQUAL( existing.size() - 8, head.count( graphene::db::undo_state::modified ) );
+      BOOST_CHECK_EQUAL( 1u, head.count( graphene::db::undo_state::removed ) );
+
+      outer.undo();
+      for( size_t i = 0; i < existing.size(); ++i )
+      {
+         BOOST_REQUIRE( balance_of( existing[i] ) );
+         BOOST_CHECK_EQUAL( int64_t(i), balance_of( existing[i] )->balance.value );
+      }
+      BOOST_CHECK( balance_of( created_outer ) == nullptr );
+      // the next ID of the index has been restored
+      auto check = db._undo_db.start_undo_session();
+      BOOST_CHECK( db.create<account_balance_object>( []( account_balance_object& ){} ).id == created_outer );
+      check.undo();
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( object_database_delta_test )
+{ try {
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const auto delta_dir = data_dir.path() / "object_database.delta";
+   auto balance_of = []( const database& d, uint64_t instance ) {
+      return d.find( account_balance_id_type( instance ) );
+   };
+
+   {
+      database db1;
+      graphene::db::object_database& odb = db1;
+      odb.open( data_dir.path() );
+      for( int64_t i = 0; i < 100; ++i )
+         db1.create<account_balance_object>( [i]( account_balance_object& obj ) {
+            obj.owner = account_id_type( i );
+            obj.balance = i;
+         });
+      // nothing has been saved before, so the complete state is written
+      odb.flush();
+      BOOST_CHECK( fc::exists( data_dir.path() / "object_database" ) );
+      BOOST_CHECK( !fc::exists( delta_dir ) );
+
+      db1.modify( *balance_of( db1, 1 ), []( account_balance_object& obj ) { obj.balance = 1000; } );
+      db1.remove( *balance_of( db1, 2 ) );
+      db1.create<account_balance_object>( []( account_balance_object& obj ) {
+         obj.owner = account_id_type( 100 );
+         obj.balance = 100;
+      });
+      odb.flush();
+      BOOST_CHECK( fc::exists( delta_dir ) );
+   }
+
+   {
+      database db2;
+      graphene::db::object_database& odb = db2;
+      odb.open( data_dir.path() );
+      BOOST_REQUIRE( balance_of( db2, 1 ) );
+      BOOST_CHECK_EQUAL( 1000, balance_of( db2, 1 )->balance.value );
+      BOOST_CHECK( !balance_of( db2, 2 ) );
+      BOOST_REQUIRE( balance_of( db2, 100 ) );
+      BOOST_CHECK_EQUAL( 100, balance_of( db2, 100 )->balance.value );
+      BOOST_CHECK_EQUAL( 42, db2.get_balance( account_id_type( 42 ), asset_id_type() ).amount.value );
+      BOOST_CHECK( db2.create<account_balance_object>( []( account_balance_object& ){} ).id
+                   == account_balance_id_type( 101 ) );
+
+      // the next delta still contains the changes of the previous one
+      db2.modify( *balance_of( db2, 3 ), []( account_balance_object& obj ) { obj.balance = 3000; } );
+      odb.flush();
+      BOOST_CHECK( fc::exists( delta_dir ) );
+   }
+
+   {
+      database db3;
+      graphene::db::object_database& odb = db3;
+      odb.open( data_dir.path() );
+      BOOST_CHECK_EQUAL( 1000, balance_of( db3, 1 )->balance.value );
+      BOOST_CHECK( !balance_of( db3, 2 ) );
+      BOOST_CHECK_EQUAL( 3000, balance_of( db3, 3 )->balance.value );
+      BOOST_CHECK( balance_of( db3, 101 ) );
+
+      // too many changes, the complete state is written again and the delta is dropped
+      for( uint64_t i = 10; i < 60; ++i )
+         db3.modify( *balance_of( db3, i ), []( account_balance_object& obj ) { obj.balance += 1; } );
+      odb.flush();
+      BOOST_CHECK( !fc::exists( delta_dir ) );
+   }
+
+   {
+      database db4;
+      graphene::db::object_database& odb = db4;
+      odb.open( data_dir.path() );
+      BOOST_CHECK_EQUAL( 1000, balance_of( db4, 1 )->balance.value );
+      BOOST_CHECK( !balance_of( db4, 2 ) );
+      BOOST_CHECK_EQUAL( 3000, balance_of( db4, 3 )->balance.value );
+      BOOST_CHECK_EQUAL( 11, balance_of( db4, 10 )->balance.value );
+      BOOST_CHECK_EQUAL( 60, balance_of( db4, 60 )->balance.value );
+   }
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( direct_index_test )
 { try {
    try {
@@ -224,6 +374,96 @@ BOOST_AUTO_TEST_CASE( direct_index_test )
    // but the secondary has not updated its representation
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( sparse_direct_index_test )
+{ try {
+   database local_db;
+   graphene::db::primary_index< account_balance_index > my_balances( local_db );
+   using lookup_type = graphene::db::sparse_direct_index< account_balance_object, 4 >;
+   const auto& lookup = *my_balances.add_id_lookup_index< lookup_type >();
+   BOOST_CHECK_THROW( my_balances.add_id_lookup_index< lookup_type >(), fc::assert_exception );
+   BOOST_CHECK( nullptr == lookup.find( account_balance_id_type( 1 ) ) );
+   BOOST_CHECK_THROW( lookup.find( object_id_type( asset_id_type( 1 ) ) ), fc::assert_exception );
+   BOOST_CHECK_EQUAL( 0u, lookup.allocated_pages() );
+
+   // gaps far beyond what direct_index accepts
+   account_balance_object bal;
+   for( uint64_t instance : { 1000000, 3, 5, 100000, 17 } )
+   {
+      bal.id = object_id_type( account_balance_id_type( instance ) );
+      bal.balance = int64_t( instance );
+      my_balances.load( fc::raw::pack( bal ) );
+   }
+   BOOST_CHECK_EQUAL( 4u, lookup.allocated_pages() ); // 3 and 5 share a page of 16
+   for( uint64_t instance : { 1000000, 3, 5, 100000, 17 } )
+   {
+      BOOST_REQUIRE( lookup.find( account_balance_id_type( instance ) ) );
+      BOOST_CHECK_EQUAL( int64_t( instance ), lookup.get( account_balance_id_type( instance ) ).balance.value );
+      // the primary index uses the lookup index
+      BOOST_CHECK( my_balances.find( account_balance_id_type( instance ) )
+                   == lookup.find( account_balance_id_type( instance ) ) );
+   }
+   for( uint64_t instance : { 0, 4, 16, 99999, 1000001, 5000000 } )
+   {
+      BOOST_CHECK( nullptr == lookup.find( account_balance_id_type( instance ) ) );
+      BOOST_CHECK( nullptr == my_balances.find( account_balance_id_type( instance ) ) );
+   }
+   BOOST_CHECK_THROW( lookup.get( account_balance_id_type( 4 ) ), fc::assert_exception );
+
+   // pages are released when they become empty
+   my_balances.remove( lookup.get( account_balance_id_type( 1000000 ) ) );
+   my_balances.remove( lookup.get( account_balance_id_type( 3 ) ) );
+   BOOST_CHECK_EQUAL( 3u, lookup.allocated_pages() );
+   BOOST_CHECK( nullptr == my_balances.find( account_balance_id_type( 1000000 ) ) );
+   BOOST_CHECK( nullptr == my_balances.find( account_balance_id_type( 3 ) ) );
+   BOOST_REQUIRE( my_balances.find( account_balance_id_type( 5 ) ) );
+
+   my_balances.set_next_id( account_balance_id_type( 42 ) );
+   my_balances.create( []( object& o ) {
+      static_cast< account_balance_object& >( o ).balance = 42;
+   });
+   BOOST_CHECK_EQUAL( 42, lookup.get( account_balance_id_type( 42 ) ).balance.value );
+   my_balances.modify( lookup.get( account_balance_id_type( 42 ) ), []( object& o ) {
+      static_cast< account_balance_object& >( o ).balance = 43;
+   });
+   BOOST_CHECK_EQUAL( 43, lookup.get( account_balance_id_type( 42 ) ).balance.value );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( pool_allocator_test )
+{ try {
+   account_balance_index balances;
+   account_balance_index other_balances;
+   const graphene::db::node_arena& arena = balances.indices().get_allocator().arena();
+   const graphene::db::node_arena& other_arena = other_balances.indices().get_allocator().arena();
+   // every index has its own arena
+   BOOST_CHECK( &arena != &other_arena );
+
+   const size_t count = 10000;
+   std::vector<const account_balance_object*> objects;
+   for( size_t i = 0; i < count; ++i )
+      objects.push_back( static_cast<const account_balance_object*>( &balances.create( [i]( object& o ) {
+         static_cast< account_balance_object& >( o ).balance = int64_t( i );
+      }) ) );
+   other_balances.create( []( object& ) {} );
+   BOOST_CHECK_GE( arena.used_bytes(), count * sizeof( account_balance_object ) );
+   BOOST_CHECK_GE( arena.reserved_bytes(), arena.used_bytes() );
+   BOOST_CHECK_LE( other_arena.reserved_bytes(), graphene::db::node_arena::slab_size );
+
+   // freed nodes are reused
+   const size_t reserved = arena.reserved_bytes();
+   for( size_t i = 0; i < count; i += 2 )
+      balances.remove( *objects[i] );
+   for( size_t i = 0; i < count; i += 2 )
+      objects[i] = static_cast<const account_balance_object*>( &balances.create( []( object& ) {} ) );
+   BOOST_CHECK_EQUAL( arena.reserved_bytes(), reserved );
+
+   // the slabs are released when the index shrinks, only the one of the container header and a spare are kept
+   for( const auto* obj : objects )
+      balances.remove( *obj );
+   BOOST_CHECK_EQUAL( balances.indices().size(), 0u );
+   BOOST_CHECK_LE( arena.reserved_bytes(), 2 * graphene::db::node_arena::slab_size );
+   BOOST_CHECK_LT( arena.used_bytes(), 1024u );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( required_approval_index_test ) // see https://github.com/bitshares/bitshares-core/issues/1719
 { try {
    ACTORS( (alice)(bob)(charlie)(agnetha)(benny)(carlos) );
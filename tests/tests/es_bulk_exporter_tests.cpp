@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/asio.hpp>
+
+#include <graphene/utilities/es_bulk_exporter.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/time.hpp>
+
+#include <zlib.h>
+
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "../common/utils.hpp"
+
+using graphene::utilities::es_bulk_exporter;
+
+namespace {
+
+/**
+ * A minimal HTTP server which answers bulk requests like ES does, one connection at a time
+ */
+class mock_es_server
+{
+public:
+   mock_es_server()
+   : _acceptor( _io, boost::asio::ip::tcp::endpoint( boost::asio::ip::address_v4::loopback(), 0 ) )
+   {
+      _thread = std::thread( [this]() { run(); } );
+   }
+
+   ~mock_es_server()
+   {
+      _stopping = true;
+      // wake up the blocking accept
+      boost::system::error_code ec;
+      boost::asio::ip::tcp::socket socket( _io );
+      socket.connect( _acceptor.local_endpoint(), ec );
+      _thread.join();
+   }
+
+   std::string url() const
+   {
+      return "http://127.0.0.1:" + std::to_string( _acceptor.local_endpoint().port() ) + "/";
+   }
+
+   /// Answer the next @p count requests with a 503 error
+   void fail_next( uint32_t count ) { _failures = count; }
+
+   /// @return the lines of the accepted requests
+   std::vector<std::string> lines() const
+   {
+      std::lock_guard<std::mutex> guard( _mutex );
+      return _lines;
+   }
+
+   uint32_t accepted_requests() const { return _accepted; }
+   uint32_t compressed_requests() const { return _compressed; }
+
+private:
+   static std::string gunzip( const std::string& data )
+   {
+      z_stream stream {};
+      BOOST_REQUIRE( Z_OK == inflateInit2( &stream, MAX_WBITS + 16 ) );
+      std::string result;
+      char buffer[4096];
+      stream.next_in = reinterpret_cast<Bytef*>( const_cast<char*>( data.data() ) );
+      stream.avail_in = static_cast<uInt>( data.size() );
+      int status = Z_OK;
+      while( Z_OK == status )
+      {
+         stream.next_out = reinterpret_cast<Bytef*>( buffer );
+         stream.avail_out = sizeof(buffer);
+         status = inflate( &stream, Z_NO_FLUSH );
+         result.append( buffer, sizeof(buffer) - stream.avail_out );
+      }
+      inflateEnd( &stream );
+      BOOST_REQUIRE( Z_STREAM_END == status );
+      return result;
+   }
+
+   void run()
+   {
+      while( true )
+      {
+         boost::asio::ip::tcp::socket socket( _io );
+         boost::system::error_code ec;
+         _acceptor.accept( socket, ec );
+         if( _stopping )
+            return;
+         if( !ec )
+            handle( socket );
+      }
+   }
+
+   void handle( boost::asio::ip::tcp::socket& socket )
+   {
+      boost::system::error_code ec;
+      boost::asio::streambuf buffer;
+      boost::asio::read_until( socket, buffer, "\r\n\r\n", ec );
+      if( ec )
+         return;
+      std::string headers( boost::asio::buffers_begin( buffer.data() ), boost::asio::buffers_end( buffer.data() ) );
+      const size_t header_end = headers.find( "\r\n\r\n" ) + 4;
+      std::string body = headers.substr( header_end );
+      headers.resize( header_end );
+      std::string lower_headers = headers;
+      std::transform( lower_headers.begin(), lower_headers.end(), lower_headers.begin(), ::tolower );
+
+      size_t content_length = 0;
+      const size_t length_pos = lower_headers.find( "content-length:" );
+      if( length_pos != std::string::npos )
+         content_length = std::stoul( headers.substr( length_pos + 15 ) );
+      if( lower_headers.find( "expect: 100-continue" ) != std::string::npos )
+         boost::asio::write( socket, boost::asio::buffer( std::string( "HTTP/1.1 100 Continue\r\n\r\n" ) ), ec );
+      if( body.size() < content_length )
+      {
+         std::string rest( content_length - body.size(), '\0' );
+         boost::asio::read( socket, boost::asio::buffer( &rest[0], rest.size() ), ec );
+         body += rest;
+      }
+
+      std::string status = "200 OK";
+      std::string content = R"({"took":1,"errors":false,"items":[]})";
+      if( _failures > 0 )
+      {
+         --_failures;
+         status = "503 Service Unavailable";
+         content = R"({"error":"unavailable","status":503})";
+      }
+      else
+      {
+         if( lower_headers.find( "content-encoding: gzip" ) != std::string::npos )
+         {
+            body = gunzip( body );
+            ++_compressed;
+         }
+         std::lock_guard<std::mutex> guard( _mutex );
+         std::istringstream stream( body );
+         for( std::string line; std::getline( stream, line ); )
+            _lines.push_back( line );
+         ++_accepted;
+      }
+      const std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: application/json\r\n"
+                                   "Content-Length: " + std::to_string( content.size() ) + "\r\n"
+                                   "Connection: close\r\n\r\n" + content;
+      boost::asio::write( socket, boost::asio::buffer( response ), ec );
+      socket.shutdown( boost::asio::ip::tcp::socket::shutdown_both, ec );
+   }
+
+   boost::asio::io_service        _io;
+   boost::asio::ip::tcp::acceptor _acceptor;
+   std::thread                    _thread;
+   std::atomic<bool>              _stopping { false };
+   std::atomic<uint32_t>          _failures { 0 };
+   std::atomic<uint32_t>          _accepted { 0 };
+   std::atomic<uint32_t>          _compressed { 0 };
+   mutable std::mutex             _mutex;
+   std::vector<std::string>       _lines;
+};
+
+/// Two lines per document, like the bulk requests of the plugins
+std::vector<std::string> make_lines( uint32_t block_num, uint32_t docs )
+{
+   std::vector<std::string> lines;
+   for( uint32_t i = 0; i < docs; ++i )
+   {
+      const std::string id = std::to_string( block_num ) + "-" + std::to_string( i );
+      lines.push_back( R"({"index":{"_index":"test","_id":")" + id + R"("}})" );
+      lines.push_back( R"({"block":)" + std::to_string( block_num ) + "}" );
+   }
+   return lines;
+}
+
+es_bulk_exporter::options make_options( const mock_es_server& server )
+{
+   es_bulk_exporter::options opts;
+   opts.base_url = server.url();
+   opts.name = "test";
+   opts.max_batch_lines = 4;
+   opts.min_retry_delay_ms = 10;
+   opts.max_retry_delay_ms = 50;
+   opts.request_timeout_seconds = 10;
+   opts.close_timeout_ms = 100;
+   return opts;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE( es_bulk_exporter_tests )
+
+BOOST_AUTO_TEST_CASE( sends_compressed_batches )
+{ try {
+   mock_es_server server;
+   es_bulk_exporter exporter( make_options( server ) );
+
+   for( uint32_t block_num = 1; block_num <= 10; ++block_num )
+   {
+      exporter.add_lines( block_num, make_lines( block_num, 1 ) );
+      exporter.end_block( block_num );
+   }
+   BOOST_REQUIRE( exporter.wait_until_acknowledged( fc::seconds(10) ) );
+
+   const auto lines = server.lines();
+   BOOST_CHECK_EQUAL( lines.size(), 20u );
+   // every document is followed by its header, whatever the order of the batches
+   for( size_t i = 0; i + 1 < lines.size(); i += 2 )
+   {
+      BOOST_CHECK( lines[i].find( "\"index\"" ) != std::string::npos );
+      BOOST_CHECK( lines[i+1].find( "\"block\"" ) != std::string::npos );
+   }
+   BOOST_CHECK_EQUAL( server.accepted_requests(), 5u );
+   BOOST_CHECK_EQUAL( server.compressed_requests(), 5u );
+
+   const auto metrics = exporter.get_metrics();
+   BOOST_CHECK_EQUAL( metrics.accepted_batches, 5u );
+   BOOST_CHECK_EQUAL( metrics.accepted_lines, 20u );
+   BOOST_CHECK_EQUAL( metrics.pending_batches, 0u );
+   BOOST_CHECK_EQUAL( metrics.memory_bytes, 0u );
+   BOOST_CHECK_EQUAL( exporter.last_acknowledged_block(), 10u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( retries_until_accepted )
+{ try {
+   mock_es_server server;
+   server.fail_next( 3 );
+   es_bulk_exporter::options opts = make_options( server );
+   opts.workers = 1;
+   opts.compress = false;
+   es_bulk_exporter exporter( opts );
+
+   exporter.add_lines( 1, make_lines( 1, 2 ) );
+   exporter.end_block( 1 );
+   exporter.add_lines( 2, make_lines( 2, 1 ) );
+   // block 2 has not ended yet
+   BOOST_REQUIRE( exporter.wait_until_acknowledged( fc::seconds(10) ) );
+   BOOST_CHECK_EQUAL( exporter.last_acknowledged_block(), 1u );
+   exporter.end_block( 2 );
+   BOOST_CHECK_EQUAL( exporter.last_acknowledged_block(), 2u );
+
+   BOOST_CHECK_EQUAL( server.lines().size(), 6u );
+   BOOST_CHECK_EQUAL( server.compressed_requests(), 0u );
+   BOOST_CHECK_EQUAL( exporter.get_metrics().retries, 3u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( blocks_when_memory_is_full )
+{ try {
+   mock_es_server server;
+   server.fail_next( 2 );
+   es_bulk_exporter::options opts = make_options( server );
+   opts.workers = 1;
+   opts.max_memory_size = 1;
+   es_bulk_exporter exporter( opts );
+
+   // without a queue directory, the caller waits until the batch is accepted
+   exporter.add_lines( 1, make_lines( 1, 2 ) );
+   const auto metrics = exporter.get_metrics();
+   BOOST_CHECK_GT( metrics.blocked_microseconds, 0u );
+   BOOST_CHECK_EQUAL( metrics.accepted_batches, 1u );
+   BOOST_CHECK_EQUAL( metrics.retries, 2u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( resumes_from_queue_directory )
+{ try {
+   fc::temp_directory queue_dir( graphene::utilities::temp_directory_path() );
+   auto count_queue_files = [&queue_dir]() {
+      uint32_t count = 0;
+      for( fc::directory_iterator itr( queue_dir.path() ); itr != fc::directory_iterator(); ++itr )
+         if( (*itr).extension().string() == ".bulk" )
+            ++count;
+      return count;
+   };
+
+   {
+      BOOST_TEST_MESSAGE( "ES is down, the batches are moved to the queue directory" );
+      mock_es_server server;
+      server.fail_next( 1000000 );
+      es_bulk_exporter::options opts = make_options( server );
+      opts.queue_dir = queue_dir.path();
+      opts.workers = 1; // keeps one batch busy, the others are moved to the directory
+      opts.max_memory_size = 1;
+      es_bulk_exporter exporter( opts );
+      BOOST_CHECK_EQUAL( exporter.last_acknowledged_block(), 0u );
+
+      for( uint32_t block_num = 1; block_num <= 6; ++block_num )
+      {
+         exporter.add_lines( block_num, make_lines( block_num, 1 ) );
+         exporter.end_block( block_num );
+      }
+      fc::wait_for( fc::seconds(10), [&exporter]() { return exporter.get_metrics().spilled_batches >= 2; } );
+      BOOST_CHECK_EQUAL( exporter.get_metrics().blocked_microseconds, 0u );
+      BOOST_CHECK( !exporter.wait_until_acknowledged( fc::milliseconds(200) ) );
+      exporter.close();
+      BOOST_CHECK_EQUAL( exporter.last_acknowledged_block(), 0u );
+   }
+   BOOST_CHECK_EQUAL( count_queue_files(), 3u );
+   BOOST_CHECK( fc::exists( queue_dir.path() / "checkpoint.json" ) );
+
+   {
+      BOOST_TEST_MESSAGE( "The batches are sent after a restart" );
+      mock_es_server server;
+      es_bulk_exporter::options opts = make_options( server );
+      opts.queue_dir = queue_dir.path();
+      es_bulk_exporter exporter( opts );
+      BOOST_CHECK_EQUAL( exporter.last_stored_block(), 6u );
+
+      BOOST_REQUIRE( exporter.wait_until_acknowledged( fc::seconds(10) ) );
+      BOOST_CHECK_EQUAL( server.lines().size(), 12u );
+      BOOST_CHECK_EQUAL( exporter.last_acknowledged_block(), 6u );
+      BOOST_CHECK_EQUAL( count_queue_files(), 0u );
+
+      exporter.add_lines( 7, make_lines( 7, 1 ) );
+      exporter.end_block( 7 );
+      BOOST_REQUIRE( exporter.wait_until_acknowledged( fc::seconds(10) ) );
+      exporter.close();
+   }
+
+   {
+      BOOST_TEST_MESSAGE( "The checkpoint is kept" );
+      mock_es_server server;
+      es_bulk_exporter::options opts = make_options( server );
+      opts.queue_dir = queue_dir.path();
+      es_bulk_exporter exporter( opts );
+      BOOST_CHECK_EQUAL( exporter.last_acknowledged_block(), 7u );
+      BOOST_CHECK_EQUAL( exporter.last_stored_block(), 7u );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1015,6 +1015,91 @@ BOOST_AUTO_TEST_CASE(get_account_history_operations) {
       throw;
    }
 }
+BOOST_AUTO_TEST_CASE(history_by_operation_type_test) {
+   try {
+      graphene::app::history_api hist_api(app);
+
+      const auto& by_type_idx = db.get_index_type< primary_index< account_history_index > >()
+            .get_secondary_index< graphene::account_history::account_history_by_type_index >();
+      BOOST_REQUIRE( by_type_idx.is_ready() );
+
+      const int asset_create_op_id = operation::tag<asset_create_operation>::value;
+      const int account_create_op_id = operation::tag<account_create_operation>::value;
+      const int transfer_op_id = operation::tag<transfer_operation>::value;
+
+      create_bitasset("CNY", account_id_type());
+      const account_id_type alice_id = create_account("alice").get_id();
+      generate_block();
+      for( int i = 0; i < 10; ++i )
+      {
+         transfer( account_id_type(), alice_id, asset(i + 1) );
+         create_account( "mytempacct" + std::to_string(i) );
+      }
+      generate_block();
+      fc::usleep(fc::milliseconds(100));
+
+      BOOST_CHECK_EQUAL( by_type_idx.count( account_id_type(), transfer_op_id ), 10u );
+      BOOST_CHECK_EQUAL( by_type_idx.count( account_id_type(), account_create_op_id ), 11u );
+      BOOST_CHECK_EQUAL( by_type_idx.count( alice_id, transfer_op_id ), 10u );
+
+      vector<operation_history_object> histories = hist_api.get_account_history_operations(
+            "committee-account", asset_create_op_id, operation_history_id_type(), operation_history_id_type(), 100);
+      BOOST_REQUIRE_EQUAL( histories.size(), 1u );
+      BOOST_CHECK_EQUAL( histories[0].id.instance(), 0u );
+
+      histories = hist_api.get_account_history_operations(
+            "committee-account", transfer_op_id, operation_history_id_type(), operation_history_id_type(), 100);
+      BOOST_REQUIRE_EQUAL( histories.size(), 10u );
+      for( size_t i = 0; i < histories.size(); ++i )
+      {
+         BOOST_CHECK_EQUAL( histories[i].op.which(), transfer_op_id );
+         if( i > 0 )
+            BOOST_CHECK( histories[i].id < histories[i-1].id );
+      }
+      BOOST_CHECK_EQUAL( histories[0].op.get<transfer_operation>().amount.amount.value, 10 );
+
+      // start and stop are operation IDs, start is included and stop is not
+      const operation_history_id_type start = histories[2].get_id();
+      const operation_history_id_type stop = histories[6].get_id();
+      vector<operation_history_object> page = hist_api.get_account_history_operations(
+            "committee-account", transfer_op_id, start, stop, 100);
+      BOOST_REQUIRE_EQUAL( page.size(), 4u );
+      BOOST_CHECK( page.front().id == start );
+      BOOST_CHECK( page.back().id == histories[5].id );
+      page = hist_api.get_account_history_operations( "committee-account", transfer_op_id, start, stop, 2 );
+      BOOST_REQUIRE_EQUAL( page.size(), 2u );
+      BOOST_CHECK( page.back().id == histories[3].id );
+
+      // a page of the whole history filtered by type
+      history_api::history_operation_detail detail = hist_api.get_account_history_by_operations(
+            "committee-account", { static_cast<uint16_t>( transfer_op_id ) }, 0, 10 );
+      BOOST_CHECK_EQUAL( detail.total_count, 9u );
+      detail = hist_api.get_account_history_by_operations(
+            "committee-account",
+            { static_cast<uint16_t>( transfer_op_id ), static_cast<uint16_t>( account_create_op_id ) }, 1, 100 );
+      BOOST_CHECK_EQUAL( detail.total_count, 22u );
+      BOOST_REQUIRE_EQUAL( detail.operation_history_objs.size(), 21u );
+      for( size_t i = 1; i < detail.operation_history_objs.size(); ++i )
+         BOOST_CHECK( detail.operation_history_objs[i].id < detail.operation_history_objs[i-1].id );
+
+      // the index follows the undo of a block
+      transfer( account_id_type(), alice_id, asset(100) );
+      generate_block();
+      BOOST_CHECK_EQUAL( by_type_idx.count( alice_id, transfer_op_id ), 11u );
+      db.pop_block();
+      BOOST_CHECK_EQUAL( by_type_idx.count( alice_id, transfer_op_id ), 10u );
+
+      // unknown types return nothing
+      histories = hist_api.get_account_history_operations(
+            "committee-account", 10000, operation_history_id_type(), operation_history_id_type(), 100);
+      BOOST_CHECK_EQUAL( histories.size(), 0u );
+
+   } catch (fc::exception &e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 //new test case for increasing the limit based on the config file
 BOOST_AUTO_TEST_CASE(api_limit_get_account_history_operations) {
  try {
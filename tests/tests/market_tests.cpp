@@ -2459,4 +2459,102 @@ BOOST_AUTO_TEST_CASE(mcfr_rounding_test_after2481)
 
 } FC_LOG_AND_RETHROW() }
 
+/***
+ * The per-market order books have the same orders in the same order as the by_price index
+ */
+BOOST_AUTO_TEST_CASE(limit_order_book_index_test)
+{ try {
+   ACTORS((buyer)(seller));
+
+   const auto& usd = create_user_issued_asset( "MYUSD" );
+   const auto& eur = create_user_issued_asset( "MYEUR" );
+   asset_id_type core_id;
+   asset_id_type usd_id = usd.get_id();
+   asset_id_type eur_id = eur.get_id();
+
+   issue_uia( seller, usd.amount( 100000 ) );
+   issue_uia( buyer, usd.amount( 100000 ) );
+   issue_uia( buyer, eur.amount( 100000 ) );
+   transfer( committee_account, seller_id, asset( 100000 ) );
+   transfer( committee_account, buyer_id, asset( 100000 ) );
+
+   const auto& books = db.get_index_type< primary_index< limit_order_index > >()
+                          .get_secondary_index< limit_order_book_index >();
+
+   auto check_books = [this,&books]( const vector< std::pair< asset_id_type, asset_id_type > >& markets ) {
+      const auto& by_price_idx = db.get_index_type< limit_order_index >().indices().get<by_price>();
+      for( const auto& market : markets )
+      {
+         vector< limit_order_id_type > expected;
+         for( const limit_order_object& o : by_price_idx )
+         {
+            if( o.sell_asset_id() == market.first && o.receive_asset_id() == market.second )
+               expected.push_back( o.get_id() );
+         }
+         vector< limit_order_id_type > actual;
+         for( const limit_order_book_entry& entry : books.get_book( market.first, market.second ).get<by_price>() )
+         {
+            BOOST_CHECK( entry.id == entry.order->id );
+            BOOST_CHECK( entry.sell_price == entry.order->sell_price );
+            actual.push_back( limit_order_id_type( entry.id ) );
+         }
+         BOOST_CHECK_EQUAL( expected.size(), actual.size() );
+         BOOST_CHECK( expected == actual );
+      }
+   };
+   const vector< std::pair< asset_id_type, asset_id_type > > markets = {
+         { core_id, usd_id }, { usd_id, core_id }, { usd_id, eur_id }, { eur_id, usd_id } };
+
+   BOOST_CHECK( books.get_book( core_id, usd_id ).empty() );
+   BOOST_CHECK( books.get_book( usd_id, eur_id ).empty() );
+
+   // asks and bids which do not match each other, some with the same price
+   const limit_order_id_type ask1_id = create_sell_order( seller, asset(1000), usd.amount(3000) )->get_id();
+   const limit_order_id_type ask2_id = create_sell_order( seller, asset(1000), usd.amount(2000) )->get_id();
+   const limit_order_id_type ask3_id = create_sell_order( seller, asset(500), usd.amount(1000) )->get_id();
+   const limit_order_id_type ask4_id = create_sell_order( seller, asset(1000), usd.amount(2500) )->get_id();
+   const limit_order_id_type bid1_id = create_sell_order( buyer, usd.amount(1000), asset(1000) )->get_id();
+   const limit_order_id_type bid2_id = create_sell_order( buyer, usd.amount(1500), asset(1000) )->get_id();
+   create_sell_order( buyer, usd.amount(1000), eur.amount(1000) );
+   create_sell_order( buyer, eur.amount(1000), usd.amount(1100) );
+   create_sell_order( seller, usd.amount(1000), eur.amount(1200) );
+
+   BOOST_CHECK_EQUAL( books.get_book( core_id, usd_id ).size(), 4u );
+   BOOST_CHECK_EQUAL( books.get_book( usd_id, core_id ).size(), 2u );
+   BOOST_CHECK_EQUAL( books.get_book( usd_id, eur_id ).size(), 2u );
+   BOOST_CHECK_EQUAL( books.get_book( eur_id, usd_id ).size(), 1u );
+   BOOST_CHECK( books.get_book( core_id, eur_id ).empty() );
+   check_books( markets );
+
+   // the best ask is the oldest of the two asks at 2 USD per CORE
+   BOOST_CHECK( books.get_book( core_id, usd_id ).get<by_price>().begin()->id == ask2_id );
+   BOOST_CHECK( books.get_book( usd_id, core_id ).get<by_price>().begin()->id == bid2_id );
+
+   // re-pricing an order keeps the books in sync, and so does undoing it
+   {
+      auto session = db._undo_db.start_undo_session();
+      db.modify( ask1_id(db), []( limit_order_object& o ) {
+         o.sell_price = o.amount_for_sale() / asset( 1000, o.receive_asset_id() );
+      });
+      BOOST_CHECK( books.get_book( core_id, usd_id ).get<by_price>().begin()->id == ask1_id );
+      check_books( markets );
+   }
+   BOOST_CHECK( books.get_book( core_id, usd_id ).get<by_price>().begin()->id == ask2_id );
+   check_books( markets );
+
+   // a bid which takes the two best asks, the rest of it stays on the book
+   create_sell_order( buyer, usd.amount(4000), asset(1800) );
+   BOOST_CHECK( !db.find( ask2_id ) );
+   BOOST_CHECK( !db.find( ask3_id ) );
+   BOOST_CHECK( db.find( ask4_id ) );
+   BOOST_CHECK_EQUAL( books.get_book( core_id, usd_id ).size(), 2u );
+   BOOST_CHECK_EQUAL( books.get_book( usd_id, core_id ).size(), 3u );
+   check_books( markets );
+
+   cancel_limit_order( bid1_id(db) );
+   BOOST_CHECK_EQUAL( books.get_book( usd_id, core_id ).size(), 2u );
+   check_books( markets );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <iostream>
 #include <boost/test/unit_test.hpp>
@@ -338,6 +339,121 @@ private:
    std::string node_name;
 };
 
+/// A node delegate which records the sync blocks it precomputes and applies
+class sync_test_node_delegate : public test_node_delegate
+{
+public:
+   using test_node_delegate::test_node_delegate;
+
+   /// How long the precomputation of a block takes, by block number, only set before blocks arrive
+   std::map<uint32_t, fc::microseconds> precompute_time;
+
+   void precompute_sync_block( const graphene::net::block_message& blk_msg ) override
+   {
+      // the block must not be touched after a cancellation, so it is not used after sleeping
+      const uint32_t block_num = blk_msg.block.block_num();
+      const auto itr = precompute_time.find( block_num );
+      if( itr != precompute_time.end() )
+         fc::usleep( itr->second );
+      std::lock_guard<std::mutex> lock( _mutex );
+      _precomputed.push_back( block_num );
+   }
+
+   bool handle_block( const graphene::net::block_message& blk_msg, bool sync_mode,
+                      std::vector<graphene::net::message_hash_type>& contained_transaction_msg_ids ) override
+   {
+      const uint32_t block_num = blk_msg.block.block_num();
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( std::find( _precomputed.begin(), _precomputed.end(), block_num ) == _precomputed.end() )
+         _applied_before_precomputed.push_back( block_num );
+      _applied.push_back( block_num );
+      return true;
+   }
+
+   std::vector<uint32_t> precomputed()
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      return _precomputed;
+   }
+   std::vector<uint32_t> applied()
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      return _applied;
+   }
+   std::vector<uint32_t> applied_before_precomputed()
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      return _applied_before_precomputed;
+   }
+
+private:
+   std::mutex            _mutex;
+   std::vector<uint32_t> _precomputed;
+   std::vector<uint32_t> _applied;
+   std::vector<uint32_t> _applied_before_precomputed;
+};
+
+/// A node which receives sync blocks from a test peer
+class sync_test_node : public test_node
+{
+public:
+   using test_node::test_node;
+
+   /// Lets @p peer offer the blocks @p ids in this order, followed by more blocks
+   void expect_sync_blocks( const std::shared_ptr<test_peer>& peer,
+                            const std::vector<graphene::net::block_id_type>& ids )
+   {
+      my->get_thread()->async( [&]() {
+         peer->ids_of_items_to_get.assign( ids.begin(), ids.end() );
+         peer->number_of_unfetched_item_ids = 1;
+         peer->we_need_sync_items_from_peer = true;
+         my->move_peer_to_active_list( peer );
+      }).wait();
+   }
+
+   void receive_sync_block( const std::shared_ptr<test_peer>& peer, const graphene::protocol::signed_block& block )
+   {
+      my->get_thread()->async( [&]() {
+         const graphene::net::block_message msg( block );
+         my->process_block_during_syncing( peer.get(), msg, graphene::net::message( msg ).id() );
+      }).wait();
+   }
+
+   /// Simulates that the block @p id was accepted through the normal inventory mechanism
+   void mark_block_accepted( const graphene::net::block_id_type& id )
+   {
+      my->get_thread()->async( [&]() {
+         my->_most_recent_blocks_accepted.push_back( id );
+      }).wait();
+   }
+
+   bool is_being_processed( const std::shared_ptr<test_peer>& peer, const graphene::net::block_id_type& id )
+   {
+      return my->get_thread()->async( [&]() {
+         return peer->ids_of_items_being_processed.count( id ) > 0;
+      }).wait();
+   }
+
+   size_t num_queued_sync_blocks()
+   {
+      return my->get_thread()->async( [&]() {
+         return my->_new_received_sync_items.size() + my->_received_sync_items.size();
+      }).wait();
+   }
+
+   /// Whether the precomputations of all queued sync blocks are finished or cancelled
+   bool queued_precomputations_done()
+   {
+      return my->get_thread()->async( [&]() {
+         for( const auto* sync_items : { &my->_new_received_sync_items, &my->_received_sync_items } )
+            for( const auto& sync_block : *sync_items )
+               if( sync_block->precomputed.valid() && !sync_block->precomputed.ready() )
+                  return false;
+         return true;
+      }).wait();
+   }
+};
+
 // this class is to simulate that a test_node started to connect to the network and accepting connections
 class fake_network_connect_guard
 {
@@ -1002,4 +1118,76 @@ BOOST_AUTO_TEST_CASE( advertising_all_test )
    test_closing_connection_message( msg2 );
 }
 
+/****
+ * Sync blocks are applied in chain order while their precomputations overlap, a block which was accepted
+ * already is dropped, and closing the node stops the precomputations which are still running
+ */
+BOOST_AUTO_TEST_CASE( sync_block_pipeline )
+{ try {
+   int node1_port = fc::network::get_available_port();
+   fc::temp_directory node1_dir( graphene::utilities::temp_directory_path() );
+   sync_test_node node1( "Node1", node1_dir.path(), node1_port );
+
+   // the delegate is called on its own thread, like the application is
+   auto delegate = std::make_shared<sync_test_node_delegate>( "Node1" );
+   fc::thread delegate_thread( "delegate" );
+   delegate_thread.async( [&]() { node1.set_node_delegate( delegate ); } ).wait();
+
+   std::vector<graphene::protocol::signed_block> blocks( 6 );
+   for( size_t i = 0; i < blocks.size(); ++i )
+   {
+      if( i > 0 )
+         blocks[i].previous = blocks[i-1].id();
+      blocks[i].timestamp = fc::time_point_sec( 1000000 + 3 * i );
+   }
+   // the earlier a block, the longer its precomputation takes
+   delegate->precompute_time[1] = fc::milliseconds(300);
+   delegate->precompute_time[2] = fc::milliseconds(150);
+   delegate->precompute_time[4] = fc::milliseconds(300);
+   delegate->precompute_time[6] = fc::milliseconds(500);
+
+   auto wait_for = []( const std::function<bool()>& condition ) {
+      for( int i = 0; i < 500 && !condition(); ++i )
+         fc::usleep( fc::milliseconds(10) );
+      return condition();
+   };
+
+   auto peer = node1.create_test_peer( "1.2.3.4:5678" ).second;
+   node1.expect_sync_blocks( peer, { blocks[0].id(), blocks[1].id(), blocks[2].id() } );
+
+   BOOST_TEST_MESSAGE( "Blocks arriving out of order are applied in order" );
+   node1.receive_sync_block( peer, blocks[2] );
+   node1.receive_sync_block( peer, blocks[0] );
+   node1.receive_sync_block( peer, blocks[1] );
+   BOOST_REQUIRE( wait_for( [&]() { return delegate->applied().size() == 3; } ) );
+   BOOST_CHECK( delegate->applied() == std::vector<uint32_t>( { 1, 2, 3 } ) );
+   // the precomputations overlapped, the shortest finished first
+   BOOST_CHECK( delegate->precomputed() == std::vector<uint32_t>( { 3, 2, 1 } ) );
+   BOOST_CHECK( delegate->applied_before_precomputed().empty() );
+   BOOST_CHECK_EQUAL( node1.num_queued_sync_blocks(), 0u );
+
+   BOOST_TEST_MESSAGE( "A block which was accepted already is dropped while it is precomputed" );
+   node1.expect_sync_blocks( peer, { blocks[3].id() } );
+   node1.mark_block_accepted( blocks[3].id() );
+   node1.receive_sync_block( peer, blocks[3] );
+   BOOST_CHECK( wait_for( [&]() { return node1.num_queued_sync_blocks() == 0; } ) );
+   BOOST_CHECK( !node1.is_being_processed( peer, blocks[3].id() ) );
+   BOOST_CHECK( wait_for( [&]() { return delegate->precomputed().size() == 4; } ) );
+   BOOST_CHECK_EQUAL( delegate->precomputed().back(), 4u );
+   BOOST_CHECK_EQUAL( delegate->applied().size(), 3u );
+
+   BOOST_TEST_MESSAGE( "Closing the node stops the precomputation of a queued block" );
+   // block 5 is missing, so block 6 stays queued
+   node1.expect_sync_blocks( peer, { blocks[4].id(), blocks[5].id() } );
+   node1.receive_sync_block( peer, blocks[5] );
+   BOOST_CHECK_EQUAL( node1.num_queued_sync_blocks(), 1u );
+   BOOST_CHECK( !node1.queued_precomputations_done() );
+   node1.close();
+   BOOST_CHECK( node1.queued_precomputations_done() );
+   BOOST_CHECK_EQUAL( delegate->applied().size(), 3u );
+
+   // let the delegate finish before its thread goes away
+   fc::usleep( fc::milliseconds(600) );
+} FC_CAPTURE_LOG_AND_RETHROW( (0) ) }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2026 BitShares Blockchain Foundation, and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/snapshot/binary_snapshot.hpp>
+
+#include <graphene/chain/config.hpp>
+#include <graphene/chain/database.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <fstream>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+using namespace graphene::snapshot_plugin;
+
+BOOST_FIXTURE_TEST_SUITE( snapshot_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( binary_snapshot_restore )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice, asset(1000000) );
+   transfer( alice, bob, asset(12345) );
+   generate_blocks( 10 );
+
+   fc::temp_directory snapshot_dir( graphene::utilities::temp_directory_path() );
+   const fc::path snapshot = snapshot_dir.path() / "snapshot";
+   const auto head_block = db.fetch_block_by_number( db.head_block_num() );
+   BOOST_REQUIRE( head_block.valid() );
+   const auto state = capture_state( db, *head_block );
+   write_snapshot( *state, snapshot );
+
+   const auto manifest = read_manifest( snapshot );
+   BOOST_CHECK( manifest.chain_id == db.get_chain_id() );
+   BOOST_CHECK( manifest.head_block_id == db.head_block_id() );
+   BOOST_CHECK_EQUAL( manifest.head_block_num, db.head_block_num() );
+   BOOST_CHECK( !fc::exists( snapshot.generic_string() + ".tmp" ) );
+
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const fc::path chain_dir = data_dir.path() / "blockchain";
+   // a snapshot of another chain is refused
+   GRAPHENE_REQUIRE_THROW( restore_snapshot( snapshot, chain_dir, chain_id_type( fc::sha256::hash( "other" ) ) ),
+                           fc::exception );
+   BOOST_CHECK( !fc::exists( chain_dir / "object_database" ) );
+   restore_snapshot( snapshot, chain_dir, db.get_chain_id() );
+   // the state is only restored once
+   GRAPHENE_REQUIRE_THROW( restore_snapshot( snapshot, chain_dir, db.get_chain_id() ), fc::exception );
+
+   database restored;
+   restored.open( chain_dir, []{ return genesis_state_type(); }, GRAPHENE_CURRENT_DB_VERSION );
+   BOOST_CHECK( restored.head_block_id() == db.head_block_id() );
+   BOOST_CHECK( restored.get_chain_id() == db.get_chain_id() );
+
+   size_t compared = 0;
+   restored.inspect_all_indexes( [this,&compared]( const graphene::db::index& idx ) {
+      const auto& original = db.get_index( idx.object_space_id(), idx.object_type_id() );
+      BOOST_CHECK( idx.get_next_id() == original.get_next_id() );
+      size_t count = 0;
+      original.inspect_all_objects( [&idx,&count]( const graphene::db::object& o ) {
+         const auto* copy = idx.find( o.id );
+         BOOST_REQUIRE( copy != nullptr );
+         BOOST_CHECK_EQUAL( fc::json::to_string( copy->to_variant() ), fc::json::to_string( o.to_variant() ) );
+         ++count;
+      });
+      idx.inspect_all_objects( [&count]( const graphene::db::object& ) { --count; } );
+      BOOST_CHECK_EQUAL( count, 0u );
+      ++compared;
+   });
+   BOOST_CHECK_GT( compared, 0u );
+   BOOST_CHECK_EQUAL( restored.get_balance( bob_id, asset_id_type() ).amount.value, 12345 );
+
+   // both nodes produce the same next block
+   const auto slot_time = db.get_slot_time(1);
+   const auto witness = db.get_scheduled_witness(1);
+   const auto next = db.generate_block( slot_time, witness, init_account_priv_key, database::skip_nothing );
+   const auto restored_next = restored.generate_block( slot_time, witness, init_account_priv_key,
+                                                       database::skip_nothing );
+   BOOST_CHECK( restored_next.id() == next.id() );
+   restored.close();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( corrupted_binary_snapshot )
+{ try {
+   ACTORS( (alice) );
+   generate_block();
+
+   fc::temp_directory snapshot_dir( graphene::utilities::temp_directory_path() );
+   const fc::path snapshot = snapshot_dir.path() / "snapshot";
+   write_snapshot( *capture_state( db, *db.fetch_block_by_number( db.head_block_num() ) ), snapshot );
+
+   // flip a byte of the first account
+   const auto manifest = read_manifest( snapshot );
+   const auto itr = std::find_if( manifest.indexes.begin(), manifest.indexes.end(),
+                                  []( const snapshot_index_info& info ) {
+      return info.space_id == account_id_type::space_id && info.type_id == account_id_type::type_id;
+   });
+   BOOST_REQUIRE( itr != manifest.indexes.end() );
+   BOOST_REQUIRE_GT( itr->size, 100u );
+   {
+      std::fstream file( ( snapshot / itr->file_name() ).generic_string(),
+                         std::ios::in | std::ios::out | std::ios::binary );
+      file.seekg( 80 );
+      char c = 0;
+      file.read( &c, 1 );
+      c ^= 0x40;
+      file.seekp( 80 );
+      file.write( &c, 1 );
+   }
+
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const fc::path chain_dir = data_dir.path() / "blockchain";
+   GRAPHENE_REQUIRE_THROW( restore_snapshot( snapshot, chain_dir, db.get_chain_id() ), fc::exception );
+   // nothing is left behind that the node would open
+   BOOST_CHECK( !fc::exists( chain_dir / "object_database" ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( binary_snapshot_head_block_mismatch )
+{ try {
+   generate_blocks( 3 );
+
+   fc::temp_directory snapshot_dir( graphene::utilities::temp_directory_path() );
+   const fc::path snapshot = snapshot_dir.path() / "snapshot";
+   write_snapshot( *capture_state( db, *db.fetch_block_by_number( db.head_block_num() ) ), snapshot );
+
+   // the manifest claims a different head block number than the head block which was stored
+   auto manifest = read_manifest( snapshot );
+   ++manifest.head_block_num;
+   fc::json::save_to_file( manifest, snapshot / "manifest.json" );
+
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const fc::path chain_dir = data_dir.path() / "blockchain";
+   GRAPHENE_REQUIRE_THROW( restore_snapshot( snapshot, chain_dir, db.get_chain_id() ), fc::exception );
+   BOOST_CHECK( !fc::exists( chain_dir / "object_database" ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -981,4 +981,262 @@ BOOST_AUTO_TEST_CASE( committee_votes_calculation )
    } FC_LOG_AND_RETHROW()
 }
 
+/**
+ * Tallying the votes in parallel shards gives the same result as tallying them in one loop
+ */
+BOOST_AUTO_TEST_CASE( parallel_vote_tally_test )
+{ try {
+   generate_blocks( HARDFORK_CORE_2262_TIME );
+   generate_block();
+   set_expiration( db, trx );
+
+   const asset_id_type usd_id = create_user_issued_asset( "MYUSD" ).get_id();
+
+   const auto& gpo = db.get_global_properties();
+   vector<vote_id_type> witness_votes;
+   for( const witness_id_type& wit : gpo.active_witnesses )
+      witness_votes.push_back( wit(db).vote_id );
+   vector<vote_id_type> committee_votes;
+   for( const committee_member_id_type& cm : gpo.active_committee_members )
+      committee_votes.push_back( cm(db).vote_id );
+
+   // enough voters for several shards, after hard fork core-2262 only core in orders counts
+   const uint32_t num_voters = 2000;
+   const uint32_t batch_size = 100;
+   vector<account_id_type> voters;
+   for( uint32_t batch = 0; batch < num_voters / batch_size; ++batch )
+   {
+      trx.clear();
+      for( uint32_t i = batch * batch_size; i < ( batch + 1 ) * batch_size; ++i )
+      {
+         account_create_operation op = make_account( "voter" + fc::to_string( i ) );
+         op.options.votes.clear();
+         op.options.num_witness = 1 + i % witness_votes.size();
+         for( uint16_t j = 0; j < op.options.num_witness; ++j )
+            op.options.votes.insert( witness_votes[ ( i + j ) % witness_votes.size() ] );
+         op.options.num_committee = 1 + i % committee_votes.size();
+         for( uint16_t j = 0; j < op.options.num_committee; ++j )
+            op.options.votes.insert( committee_votes[ ( i + j ) % committee_votes.size() ] );
+         // some voters proxy to voters created before, which may be tallied in another shard
+         if( i % 7 == 6 && !voters.empty() )
+            op.options.voting_account = voters[ ( i * 31 ) % voters.size() ];
+         op.fee = db.current_fee_schedule().calculate_fee( op );
+         trx.operations.push_back( op );
+      }
+      processed_transaction ptx = PUSH_TX( db, trx, ~0 );
+      for( const auto& result : ptx.operation_results )
+         voters.emplace_back( result.get<object_id_type>() );
+
+      trx.clear();
+      for( uint32_t i = batch * batch_size; i < ( batch + 1 ) * batch_size; ++i )
+      {
+         transfer_operation transfer_op;
+         transfer_op.from = committee_account;
+         transfer_op.to = voters[i];
+         transfer_op.amount = asset( 1000000 + i );
+         transfer_op.fee = db.current_fee_schedule().calculate_fee( transfer_op );
+         trx.operations.push_back( transfer_op );
+
+         limit_order_create_operation order_op;
+         order_op.seller = voters[i];
+         order_op.amount_to_sell = asset( 100000 + i * 10 );
+         order_op.min_to_receive = asset( 1000000000, usd_id );
+         order_op.expiration = time_point_sec::maximum();
+         order_op.fee = db.current_fee_schedule().calculate_fee( order_op );
+         trx.operations.push_back( order_op );
+      }
+      PUSH_TX( db, trx, ~0 );
+      trx.clear();
+      generate_block();
+      set_expiration( db, trx );
+   }
+
+   auto get_tally_results = [this]() {
+      vector<uint64_t> results;
+      for( const witness_object& wit : db.get_index_type<witness_index>().indices() )
+         results.push_back( wit.total_votes );
+      for( const committee_member_object& cm : db.get_index_type<committee_member_index>().indices() )
+         results.push_back( cm.total_votes );
+      for( const account_statistics_object& stats : db.get_index_type<account_stats_index>().indices() )
+      {
+         results.push_back( stats.vp_all );
+         results.push_back( stats.vp_active );
+         results.push_back( stats.vp_committee );
+         results.push_back( stats.vp_witness );
+         results.push_back( stats.vp_worker );
+      }
+      for( const witness_id_type& wit : db.get_global_properties().active_witnesses )
+         results.push_back( wit.instance.value );
+      for( const committee_member_id_type& cm : db.get_global_properties().active_committee_members )
+         results.push_back( cm.instance.value );
+      return results;
+   };
+
+   const auto maint_time = db.get_dynamic_global_properties().next_maintenance_time;
+   const uint32_t slots_to_miss = db.get_slot_at_time( maint_time ) - 1;
+
+   db.enable_parallel_vote_tally( false );
+   generate_block( ~0, init_account_priv_key, slots_to_miss );
+   BOOST_REQUIRE( db.get_dynamic_global_properties().next_maintenance_time > maint_time );
+   const vector<uint64_t> sequential_results = get_tally_results();
+   BOOST_CHECK_GT( voters.front()(db).statistics(db).vp_all, 0u );
+   BOOST_CHECK_GT( (*gpo.active_witnesses.begin())(db).total_votes, 0u );
+
+   db.pop_block();
+   BOOST_REQUIRE( db.get_dynamic_global_properties().next_maintenance_time == maint_time );
+
+   db.enable_parallel_vote_tally( true );
+   generate_block( ~0, init_account_priv_key, slots_to_miss );
+   BOOST_REQUIRE( db.get_dynamic_global_properties().next_maintenance_time > maint_time );
+   BOOST_CHECK( get_tally_results() == sequential_results );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( incremental_vote_tally_test )
+{ try {
+   generate_blocks( HARDFORK_CORE_2262_TIME );
+   generate_block();
+   set_expiration( db, trx );
+
+   const asset_id_type usd_id = create_user_issued_asset( "MYUSD" ).get_id();
+
+   const auto& gpo = db.get_global_properties();
+   vector<vote_id_type> witness_votes;
+   for( const witness_id_type& wit : gpo.active_witnesses )
+      witness_votes.push_back( wit(db).vote_id );
+   vector<vote_id_type> committee_votes;
+   for( const committee_member_id_type& cm : gpo.active_committee_members )
+      committee_votes.push_back( cm(db).vote_id );
+
+   auto set_votes = [&]( account_id_type voter, uint32_t seed, account_id_type proxy ) {
+      account_update_operation op;
+      op.account = voter;
+      op.new_options = voter(db).options;
+      op.new_options->votes.clear();
+      op.new_options->num_witness = 1 + seed % witness_votes.size();
+      for( uint16_t j = 0; j < op.new_options->num_witness; ++j )
+         op.new_options->votes.insert( witness_votes[ ( seed + j ) % witness_votes.size() ] );
+      op.new_options->num_committee = 1 + seed % committee_votes.size();
+      for( uint16_t j = 0; j < op.new_options->num_committee; ++j )
+         op.new_options->votes.insert( committee_votes[ ( seed + j ) % committee_votes.size() ] );
+      op.new_options->voting_account = proxy;
+      op.fee = db.current_fee_schedule().calculate_fee( op );
+      trx.operations.push_back( op );
+      PUSH_TX( db, trx, ~0 );
+      trx.clear();
+   };
+
+   // after hard fork core-2262 only core in orders counts, every fifth voter proxies to another one
+   const uint32_t num_voters = 60;
+   vector<account_id_type> voters;
+   vector<limit_order_id_type> orders;
+   for( uint32_t i = 0; i < num_voters; ++i )
+   {
+      voters.push_back( create_account( "voter" + fc::to_string( i ) ).get_id() );
+      transfer( committee_account, voters[i], asset( 1000000 + i ) );
+      orders.push_back( create_sell_order( voters[i], asset( 100000 + i * 10 ), asset( 1000000000, usd_id ) )
+                        ->get_id() );
+      set_votes( voters[i], i, i % 5 == 4 ? voters[i - 3] : GRAPHENE_PROXY_TO_SELF_ACCOUNT );
+   }
+   generate_block();
+   set_expiration( db, trx );
+
+   auto get_tally_results = [this]() {
+      vector<uint64_t> results;
+      for( const witness_object& wit : db.get_index_type<witness_index>().indices() )
+         results.push_back( wit.total_votes );
+      for( const committee_member_object& cm : db.get_index_type<committee_member_index>().indices() )
+         results.push_back( cm.total_votes );
+      for( const account_statistics_object& stats : db.get_index_type<account_stats_index>().indices() )
+      {
+         results.push_back( stats.vp_all );
+         results.push_back( stats.vp_active );
+         results.push_back( stats.vp_committee );
+         results.push_back( stats.vp_witness );
+         results.push_back( stats.vp_worker );
+         results.push_back( stats.vote_tally_time.sec_since_epoch() );
+      }
+      for( const witness_id_type& wit : db.get_global_properties().active_witnesses )
+         results.push_back( wit.instance.value );
+      for( const committee_member_id_type& cm : db.get_global_properties().active_committee_members )
+         results.push_back( cm.instance.value );
+      return results;
+   };
+
+   // generates the first maintenance block at or after the time @p at, counting the changed accounts only,
+   // and checks the result against a full recount
+   auto check_maintenance = [&]( time_point_sec at ) {
+      const auto maint_time = db.get_dynamic_global_properties().next_maintenance_time;
+      const uint32_t slots_to_miss = db.get_slot_at_time( std::max( at, maint_time ) ) - 1;
+      BOOST_REQUIRE( db.get_vote_tally_cache().is_tracking() );
+
+      generate_block( ~0, init_account_priv_key, slots_to_miss );
+      BOOST_REQUIRE( db.get_dynamic_global_properties().next_maintenance_time > maint_time );
+      const vector<uint64_t> incremental_results = get_tally_results();
+      BOOST_CHECK_EQUAL( db.get_vote_tally_cache().get_block_num(), db.head_block_num() );
+      db.pop_block();
+
+      db.enable_incremental_vote_tally( false );
+      generate_block( ~0, init_account_priv_key, slots_to_miss );
+      BOOST_CHECK( get_tally_results() == incremental_results );
+      BOOST_CHECK( !db.get_vote_tally_cache().is_tracking() );
+      db.pop_block();
+
+      // counts all accounts again and keeps the votes for the next check
+      db.enable_incremental_vote_tally( true );
+      generate_block( ~0, init_account_priv_key, slots_to_miss );
+      BOOST_CHECK( get_tally_results() == incremental_results );
+      set_expiration( db, trx );
+   };
+
+   // fill the cache
+   generate_blocks( db.get_dynamic_global_properties().next_maintenance_time );
+   set_expiration( db, trx );
+   BOOST_CHECK_GT( voters.front()(db).statistics(db).vp_all, 0u );
+   BOOST_CHECK_GT( (*gpo.active_witnesses.begin())(db).total_votes, 0u );
+
+   // no changes
+   check_maintenance( db.head_block_time() );
+
+   // new votes, a proxy changes its votes, a voter changes its proxy, orders are cancelled and created
+   set_votes( voters[0], 7, GRAPHENE_PROXY_TO_SELF_ACCOUNT );
+   set_votes( voters[1], 11, GRAPHENE_PROXY_TO_SELF_ACCOUNT );
+   set_votes( voters[4], 4, voters[2] );
+   set_votes( voters[9], 9, GRAPHENE_PROXY_TO_SELF_ACCOUNT );
+   cancel_limit_order( orders[3](db) );
+   cancel_limit_order( orders[14](db) );
+   create_sell_order( voters[5], asset( 50000 ), asset( 1000000000, usd_id ) );
+   const account_id_type late_voter = create_account( "latevoter" ).get_id();
+   transfer( committee_account, late_voter, asset( 5000000 ) );
+   create_sell_order( late_voter, asset( 2000000 ), asset( 1000000000, usd_id ) );
+   set_votes( late_voter, 3, voters[1] );
+   generate_block();
+   set_expiration( db, trx );
+   check_maintenance( db.head_block_time() );
+
+   // the votes decay after a year, except those of a voter who votes again
+   set_votes( voters[20], 5, GRAPHENE_PROXY_TO_SELF_ACCOUNT );
+   generate_block();
+   set_expiration( db, trx );
+   check_maintenance( db.head_block_time() + fc::days(370) );
+   BOOST_CHECK_LT( voters[30](db).statistics(db).vp_witness, voters[30](db).statistics(db).vp_all );
+
+   // the decay advances, a proxy stops voting and its delegators follow its options
+   set_votes( voters[2], 2, voters[40] );
+   generate_block();
+   set_expiration( db, trx );
+   check_maintenance( db.head_block_time() + fc::days(46) );
+
+   // the cache is rebuilt when a parameter changes
+   db.modify( db.get_global_properties(), []( global_property_object& p ) {
+      p.parameters.maximum_witness_count -= 2;
+   });
+   const auto maint_time = db.get_dynamic_global_properties().next_maintenance_time;
+   generate_blocks( maint_time );
+   set_expiration( db, trx );
+   BOOST_REQUIRE( db.get_dynamic_global_properties().next_maintenance_time > maint_time );
+   check_maintenance( db.head_block_time() );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()